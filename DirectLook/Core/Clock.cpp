@@ -0,0 +1,65 @@
+#include "Clock.h"
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <errno.h>
+#include <time.h>
+#endif
+
+namespace DirectLook
+{
+	unsigned long long Clock::microseconds(void)
+	{
+#ifdef _WIN32
+		static LARGE_INTEGER frequency = { 0 };
+		if(frequency.QuadPart == 0)
+		{
+			QueryPerformanceFrequency( &frequency );
+		}
+
+		LARGE_INTEGER counter;
+		QueryPerformanceCounter( &counter );
+
+		// Split into seconds and remainder to avoid overflowing the 64 bit counter
+		unsigned long long seconds   = counter.QuadPart / frequency.QuadPart;
+		unsigned long long remainder = counter.QuadPart % frequency.QuadPart;
+		return seconds * 1000000ULL + (remainder * 1000000ULL) / frequency.QuadPart;
+#else
+		timespec now;
+		clock_gettime( CLOCK_MONOTONIC, &now );
+		return (unsigned long long) now.tv_sec * 1000000ULL + (unsigned long long) now.tv_nsec / 1000ULL;
+#endif
+	}
+
+	double Clock::milliseconds(void)
+	{
+		return (double) microseconds() / 1000.0;
+	}
+
+	double Clock::elapsedMilliseconds( const unsigned long long startMicroseconds )
+	{
+		return (double) (microseconds() - startMicroseconds) / 1000.0;
+	}
+
+	void Clock::sleepUntil( const unsigned long long targetMicroseconds )
+	{
+#ifdef _WIN32
+		// Sleep() only has millisecond granularity, so sleep coarse and spin for the rest
+		unsigned long long now = microseconds();
+		while(now < targetMicroseconds)
+		{
+			const unsigned long long remaining = targetMicroseconds - now;
+			Sleep( (remaining > 2000) ? (DWORD) (remaining / 1000 - 1) : 0 );
+			now = microseconds();
+		}
+#else
+		timespec target;
+		target.tv_sec = (time_t) (targetMicroseconds / 1000000ULL);
+		target.tv_nsec = (long) (targetMicroseconds % 1000000ULL) * 1000L;
+		while(clock_nanosleep( CLOCK_MONOTONIC, TIMER_ABSTIME, &target, 0 ) == EINTR)
+		{
+		}
+#endif
+	}
+};
@@ -0,0 +1,48 @@
+#pragma once
+
+namespace DirectLook
+{
+	/// \brief Die Klasse Clock stellt eine monotone, hochaufloesende Systemuhr fuer Zeitmessungen bereit.
+	class Clock
+	{
+
+	public:
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert die aktuelle Zeit der monotonen Systemuhr in Mikrosekunden zurueck.
+		///
+		/// Der Nullpunkt ist beliebig, es duerfen nur Differenzen zweier Zeitpunkte verwendet werden.
+		///
+		/// \return Zeitpunkt in Mikrosekunden
+		///
+		////////////////////////////////////////////////////////////
+		static unsigned long long microseconds(void);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert die aktuelle Zeit der monotonen Systemuhr in Millisekunden zurueck.
+		///
+		/// \return Zeitpunkt in Millisekunden
+		///
+		////////////////////////////////////////////////////////////
+		static double milliseconds(void);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert die vergangene Zeit seit "startMicroseconds" in Millisekunden zurueck.
+		///
+		/// \param startMicroseconds Startzeitpunkt in Mikrosekunden (siehe microseconds())
+		///
+		/// \return Vergangene Zeit in Millisekunden
+		///
+		////////////////////////////////////////////////////////////
+		static double elapsedMilliseconds( const unsigned long long startMicroseconds );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Blockiert den aufrufenden Thread bis zum Zeitpunkt "targetMicroseconds".
+		///
+		/// Liegt der Zeitpunkt in der Vergangenheit, kehrt die Methode sofort zurueck.
+		///
+		/// \param targetMicroseconds Zeitpunkt in Mikrosekunden (siehe microseconds())
+		///
+		////////////////////////////////////////////////////////////
+		static void sleepUntil( const unsigned long long targetMicroseconds );
+	};
+};
@@ -0,0 +1,170 @@
+#include "FramePool.h"
+
+#ifdef _WIN32
+#include <malloc.h>
+#else
+#include <stdlib.h>
+#endif
+
+namespace DirectLook
+{
+	// Every block starts with a header of one alignment unit that stores its size class,
+	// so release() doesn't need to know the size and the payload stays aligned.
+	static const size_t HEADER_SIZE = FramePool::ALIGNMENT;
+
+	FramePool& FramePool::instance(void)
+	{
+		static FramePool pool;
+		return pool;
+	}
+
+	FramePool::FramePool(void)
+		:
+		m_UsedBytes( 0 ),
+		m_CachedBytes( 0 )
+	{
+	}
+
+	FramePool::~FramePool(void)
+	{
+		trim();
+	}
+
+	void* FramePool::acquire( const size_t size )
+	{
+		if(size == 0)
+		{
+			return 0;
+		}
+
+		const size_t classSize = sizeClass( size );
+		void* pBlock = 0;
+
+		m_Mutex.lock();
+		FreeLists::iterator freeList = m_FreeLists.find( classSize );
+		if(freeList != m_FreeLists.end() && !freeList->second.empty())
+		{
+			pBlock = freeList->second.back();
+			freeList->second.pop_back();
+			m_CachedBytes -= classSize;
+		}
+		m_UsedBytes += classSize;
+		m_Mutex.unlock();
+
+		if(!pBlock)
+		{
+			pBlock = allocateBlock( classSize );
+			if(!pBlock)
+			{
+				m_Mutex.lock();
+				m_UsedBytes -= classSize;
+				m_Mutex.unlock();
+				return 0;
+			}
+		}
+
+		return static_cast<char*>( pBlock ) + HEADER_SIZE;
+	}
+
+	void FramePool::release( void* pBuffer )
+	{
+		if(!pBuffer)
+		{
+			return;
+		}
+
+		void* pBlock = static_cast<char*>( pBuffer ) - HEADER_SIZE;
+		const size_t classSize = *static_cast<size_t*>( pBlock );
+
+		m_Mutex.lock();
+		m_UsedBytes -= classSize;
+		const bool keep = (m_CachedBytes + classSize <= MAX_CACHED_BYTES);
+		if(keep)
+		{
+			m_FreeLists[classSize].push_back( pBlock );
+			m_CachedBytes += classSize;
+		}
+		m_Mutex.unlock();
+
+		if(!keep)
+		{
+			freeBlock( pBlock );
+		}
+	}
+
+	void FramePool::trim(void)
+	{
+		m_Mutex.lock();
+		FreeLists freeLists;
+		freeLists.swap( m_FreeLists );
+		m_CachedBytes = 0;
+		m_Mutex.unlock();
+
+		for(FreeLists::iterator freeList = freeLists.begin(); freeList != freeLists.end(); ++freeList)
+		{
+			for(size_t i = 0; i < freeList->second.size(); i++)
+			{
+				freeBlock( freeList->second[i] );
+			}
+		}
+	}
+
+	size_t FramePool::getUsedBytes(void)
+	{
+		m_Mutex.lock();
+		size_t usedBytes = m_UsedBytes;
+		m_Mutex.unlock();
+		return usedBytes;
+	}
+
+	size_t FramePool::getCachedBytes(void)
+	{
+		m_Mutex.lock();
+		size_t cachedBytes = m_CachedBytes;
+		m_Mutex.unlock();
+		return cachedBytes;
+	}
+
+	size_t FramePool::sizeClass( const size_t size )
+	{
+		const size_t granularity = 64 * 1024;
+		if(size > granularity)
+		{
+			return ((size + granularity - 1) / granularity) * granularity;
+		}
+
+		size_t classSize = ALIGNMENT;
+		while(classSize < size)
+		{
+			classSize <<= 1;
+		}
+		return classSize;
+	}
+
+	void* FramePool::allocateBlock( const size_t classSize )
+	{
+		void* pBlock = 0;
+#ifdef _WIN32
+		pBlock = _aligned_malloc( classSize + HEADER_SIZE, ALIGNMENT );
+#else
+		if(posix_memalign( &pBlock, ALIGNMENT, classSize + HEADER_SIZE ) != 0)
+		{
+			pBlock = 0;
+		}
+#endif
+		if(pBlock)
+		{
+			*static_cast<size_t*>( pBlock ) = classSize;
+		}
+		return pBlock;
+	}
+
+	void FramePool::freeBlock( void* pBlock )
+	{
+#ifdef _WIN32
+		_aligned_free( pBlock );
+#else
+		free( pBlock );
+#endif
+	}
+};
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <QMutex>
+
+#include <map>
+#include <vector>
+#include <stddef.h>
+
+#include "../NonCopyable.h"
+
+namespace DirectLook
+{
+	/// \brief Die Klasse FramePool verwaltet wiederverwendbare, 64 Byte ausgerichtete Bildpuffer.
+	///
+	/// Angeforderte Groessen werden auf Groessenklassen aufgerundet. Freigegebene Puffer landen in
+	/// einer Freiliste ihrer Klasse und werden beim naechsten Bild derselben Groesse wiederverwendet,
+	/// dadurch bleibt der Speicherverbrauch im laufenden Betrieb konstant. Alle Methoden sind threadsicher.
+	class FramePool : public NonCopyable
+	{
+
+	public:
+		static const size_t ALIGNMENT = 64;						///< Ausrichtung der Puffer in Byte (Cache-Line, AVX-512)
+		static const size_t MAX_CACHED_BYTES = 128 << 20;		///< Obergrenze fuer zwischengespeicherte, freie Puffer
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert den gemeinsamen Pool der Anwendung zurueck.
+		////////////////////////////////////////////////////////////
+		static FramePool& instance(void);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Destruktor
+		///
+		/// Gibt alle zwischengespeicherten Puffer frei.
+		///
+		////////////////////////////////////////////////////////////
+		~FramePool(void);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Fordert einen Puffer mit mindestens "size" Byte an.
+		///
+		/// \param size Groesse in Byte
+		///
+		/// \return 64 Byte ausgerichteter Puffer (0 bei size = 0 oder zu wenig Speicher)
+		///
+		////////////////////////////////////////////////////////////
+		void* acquire( const size_t size );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Gibt einen mit acquire() angeforderten Puffer an den Pool zurueck.
+		///
+		/// \param pBuffer Puffer (0 wird ignoriert)
+		///
+		////////////////////////////////////////////////////////////
+		void release( void* pBuffer );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Fordert ein Feld mit "count" Elementen vom Typ T an.
+		////////////////////////////////////////////////////////////
+		template<typename T>
+		T* acquireArray( const size_t count )
+		{
+			return static_cast<T*>( acquire( count * sizeof( T ) ) );
+		}
+
+		////////////////////////////////////////////////////////////
+		/// \brief Gibt alle zwischengespeicherten, freien Puffer an das Betriebssystem zurueck.
+		////////////////////////////////////////////////////////////
+		void trim(void);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert die Anzahl der Byte zurueck, die gerade an Bilder vergeben sind.
+		////////////////////////////////////////////////////////////
+		size_t getUsedBytes(void);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert die Anzahl der Byte zurueck, die frei im Pool liegen.
+		////////////////////////////////////////////////////////////
+		size_t getCachedBytes(void);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Rundet "size" auf die zugehoerige Groessenklasse auf.
+		///
+		/// Bis 64 KiB wird auf die naechste Zweierpotenz gerundet, darueber auf ein Vielfaches von 64 KiB.
+		///
+		////////////////////////////////////////////////////////////
+		static size_t sizeClass( const size_t size );
+
+	private:
+		////////////////////////////////////////////////////////////
+		/// \brief Privater Konstruktor, siehe instance().
+		////////////////////////////////////////////////////////////
+		FramePool(void);
+
+		static void* allocateBlock( const size_t classSize );
+
+		static void freeBlock( void* pBlock );
+
+		typedef std::map< size_t, std::vector<void*> > FreeLists;
+
+		QMutex m_Mutex;				///< Schuetzt die Freilisten und Zaehler
+		FreeLists m_FreeLists;		///< Freie Puffer je Groessenklasse
+		size_t m_UsedBytes;			///< Vergebene Byte
+		size_t m_CachedBytes;		///< Freie Byte in den Freilisten
+	};
+};
@@ -0,0 +1,206 @@
+#pragma once
+
+#include <QMutex>
+#include <QWaitCondition>
+
+#include <vector>
+
+#include "../NonCopyable.h"
+
+namespace DirectLook
+{
+	/// \brief Verhalten einer vollen FrameQueue beim Einfuegen
+	enum DropPolicy
+	{
+		DROP_NONE,		///< Erzeuger wartet, bis wieder Platz ist (kein Bild geht verloren)
+		DROP_OLDEST,	///< Aeltestes Bild verwerfen (geringste Latenz, z.B. fuer die Live-Anzeige)
+		DROP_NEWEST		///< Neues Bild verwerfen (Reihenfolge der angenommenen Bilder bleibt lueckenlos)
+	};
+
+	/// \brief Die Klasse FrameQueue verbindet genau einen Erzeuger mit genau einem Verbraucher.
+	///
+	/// Die Warteschlange ist ein Ringpuffer fester Groesse. Die Elemente sind in der Regel
+	/// referenzgezaehlte FrameHandle-Objekte, daher wird der kurze kritische Abschnitt mit einem
+	/// QMutex geschuetzt statt mit reinen Atomics. Nach close() kehren alle wartenden Aufrufe zurueck.
+	///
+	/// \tparam T Elementtyp (kopierbar und standardkonstruierbar)
+	template<typename T>
+	class FrameQueue : public NonCopyable
+	{
+
+	private:
+		std::vector<T> m_Items;				///< Ringpuffer
+		unsigned int m_Head;				///< Index des aeltesten Elementes
+		unsigned int m_Count;				///< Anzahl der Elemente
+		unsigned int m_MaxCount;			///< Groesste beobachtete Fuellung
+		unsigned long long m_Dropped;		///< Anzahl der verworfenen Elemente
+		DropPolicy m_Policy;				///< Verhalten bei voller Warteschlange
+		bool m_Closed;						///< Geschlossen?
+		QMutex m_Mutex;						///< Schuetzt alle Member
+		QWaitCondition m_NotEmpty;			///< Weckt den Verbraucher
+		QWaitCondition m_NotFull;			///< Weckt den Erzeuger (nur DROP_NONE)
+
+	public:
+		////////////////////////////////////////////////////////////
+		/// \brief Konstruktor
+		///
+		/// \param capacity Maximale Anzahl der Elemente (mindestens 1)
+		/// \param policy   Verhalten bei voller Warteschlange
+		///
+		////////////////////////////////////////////////////////////
+		FrameQueue( const unsigned int capacity, const DropPolicy policy )
+			:
+			m_Items( (capacity > 0) ? capacity : 1 ),
+			m_Head( 0 ),
+			m_Count( 0 ),
+			m_MaxCount( 0 ),
+			m_Dropped( 0 ),
+			m_Policy( policy ),
+			m_Closed( false )
+		{
+		}
+
+		////////////////////////////////////////////////////////////
+		/// \brief Fuegt ein Element am Ende ein.
+		///
+		/// \param item  Element
+		/// \param force Niemals verwerfen, sondern wie DROP_NONE warten (z.B. fuer das Ende des Datenstroms)
+		///
+		/// \return false, wenn das Element verworfen wurde oder die Warteschlange geschlossen ist
+		///
+		////////////////////////////////////////////////////////////
+		bool push( const T& item, const bool force = false )
+		{
+			m_Mutex.lock();
+			const unsigned int capacity = (unsigned int) m_Items.size();
+
+			if(m_Count == capacity && !m_Closed)
+			{
+				if(m_Policy == DROP_NONE || force)
+				{
+					while(m_Count == capacity && !m_Closed)
+					{
+						m_NotFull.wait( &m_Mutex );
+					}
+				}
+				else if(m_Policy == DROP_NEWEST)
+				{
+					m_Dropped++;
+					m_Mutex.unlock();
+					return false;
+				}
+				else
+				{
+					// DROP_OLDEST: release the oldest frame right away instead of when it is overwritten
+					m_Items[m_Head] = T();
+					m_Head = (m_Head + 1) % capacity;
+					m_Count--;
+					m_Dropped++;
+				}
+			}
+
+			if(m_Closed)
+			{
+				m_Mutex.unlock();
+				return false;
+			}
+
+			m_Items[(m_Head + m_Count) % capacity] = item;
+			m_Count++;
+			if(m_Count > m_MaxCount)
+			{
+				m_MaxCount = m_Count;
+			}
+
+			m_NotEmpty.wakeOne();
+			m_Mutex.unlock();
+			return true;
+		}
+
+		////////////////////////////////////////////////////////////
+		/// \brief Entnimmt das aelteste Element.
+		///
+		/// \param item      Ziel fuer das Element
+		/// \param timeoutMs Maximale Wartezeit in Millisekunden (0 = nicht warten)
+		///
+		/// \return false, wenn innerhalb der Wartezeit kein Element verfuegbar war
+		///
+		////////////////////////////////////////////////////////////
+		bool pop( T& item, const unsigned long timeoutMs )
+		{
+			m_Mutex.lock();
+			if(m_Count == 0 && !m_Closed && timeoutMs > 0)
+			{
+				m_NotEmpty.wait( &m_Mutex, timeoutMs );
+			}
+
+			if(m_Count == 0)
+			{
+				m_Mutex.unlock();
+				return false;
+			}
+
+			const unsigned int capacity = (unsigned int) m_Items.size();
+			item = m_Items[m_Head];
+			m_Items[m_Head] = T();
+			m_Head = (m_Head + 1) % capacity;
+			m_Count--;
+
+			m_NotFull.wakeOne();
+			m_Mutex.unlock();
+			return true;
+		}
+
+		////////////////////////////////////////////////////////////
+		/// \brief Schliesst die Warteschlange und weckt alle wartenden Threads.
+		///
+		/// Bereits eingereihte Elemente koennen weiterhin entnommen werden.
+		///
+		////////////////////////////////////////////////////////////
+		void close(void)
+		{
+			m_Mutex.lock();
+			m_Closed = true;
+			m_NotEmpty.wakeAll();
+			m_NotFull.wakeAll();
+			m_Mutex.unlock();
+		}
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert die aktuelle Anzahl der Elemente zurueck.
+		////////////////////////////////////////////////////////////
+		unsigned int getDepth(void)
+		{
+			m_Mutex.lock();
+			const unsigned int count = m_Count;
+			m_Mutex.unlock();
+			return count;
+		}
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert die groesste beobachtete Anzahl der Elemente zurueck.
+		////////////////////////////////////////////////////////////
+		unsigned int getMaxDepth(void)
+		{
+			m_Mutex.lock();
+			const unsigned int maxCount = m_MaxCount;
+			m_Mutex.unlock();
+			return maxCount;
+		}
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert die Anzahl der verworfenen Elemente zurueck.
+		////////////////////////////////////////////////////////////
+		unsigned long long getDropped(void)
+		{
+			m_Mutex.lock();
+			const unsigned long long dropped = m_Dropped;
+			m_Mutex.unlock();
+			return dropped;
+		}
+
+		unsigned int getCapacity(void) const { return (unsigned int) m_Items.size(); }
+
+		DropPolicy getPolicy(void) const { return m_Policy; }
+	};
+};
@@ -0,0 +1,190 @@
+#include "Metrics.h"
+
+#include <algorithm>
+
+namespace DirectLook
+{
+	RollingStatistic::RollingStatistic( const unsigned int windowSize )
+		:
+		m_Samples( (windowSize > 0) ? windowSize : 1, 0.0 ),
+		m_Next( 0 ),
+		m_Filled( 0 ),
+		m_Sum( 0.0 ),
+		m_Count( 0 )
+	{
+	}
+
+	void RollingStatistic::add( const double value )
+	{
+		if(m_Filled == m_Samples.size())
+		{
+			m_Sum -= m_Samples[m_Next];
+		}
+		else
+		{
+			m_Filled++;
+		}
+
+		m_Samples[m_Next] = value;
+		m_Sum += value;
+		m_Next = (m_Next + 1) % (unsigned int) m_Samples.size();
+		m_Count++;
+
+		// Rebuild the sum now and then so rounding errors of the running sum don't pile up
+		if(m_Next == 0)
+		{
+			m_Sum = 0.0;
+			for(unsigned int i = 0; i < m_Filled; i++)
+			{
+				m_Sum += m_Samples[i];
+			}
+		}
+	}
+
+	void RollingStatistic::reset(void)
+	{
+		m_Next = 0;
+		m_Filled = 0;
+		m_Sum = 0.0;
+		m_Count = 0;
+	}
+
+	double RollingStatistic::getMean(void) const
+	{
+		return (m_Filled > 0) ? m_Sum / (double) m_Filled : 0.0;
+	}
+
+	double RollingStatistic::getMin(void) const
+	{
+		if(m_Filled == 0)
+		{
+			return 0.0;
+		}
+
+		double minimum = m_Samples[0];
+		for(unsigned int i = 1; i < m_Filled; i++)
+		{
+			if(m_Samples[i] < minimum) minimum = m_Samples[i];
+		}
+		return minimum;
+	}
+
+	double RollingStatistic::getMax(void) const
+	{
+		if(m_Filled == 0)
+		{
+			return 0.0;
+		}
+
+		double maximum = m_Samples[0];
+		for(unsigned int i = 1; i < m_Filled; i++)
+		{
+			if(m_Samples[i] > maximum) maximum = m_Samples[i];
+		}
+		return maximum;
+	}
+
+	double RollingStatistic::getLast(void) const
+	{
+		if(m_Filled == 0)
+		{
+			return 0.0;
+		}
+
+		const unsigned int size = (unsigned int) m_Samples.size();
+		return m_Samples[(m_Next + size - 1) % size];
+	}
+
+	double RollingStatistic::getPercentile( const double fraction ) const
+	{
+		if(m_Filled == 0)
+		{
+			return 0.0;
+		}
+
+		// Nearest rank on a copy, the window is small enough to select in place every call
+		std::vector<double> samples( m_Samples.begin(), m_Samples.begin() + m_Filled );
+		const double clamped = (fraction < 0.0) ? 0.0 : ((fraction > 1.0) ? 1.0 : fraction);
+		unsigned int rank = (unsigned int) (clamped * (double) m_Filled + 0.999999);
+		rank = (rank > 0) ? rank - 1 : 0;
+		std::nth_element( samples.begin(), samples.begin() + rank, samples.end() );
+		return samples[rank];
+	}
+
+	unsigned long long RollingStatistic::getCount(void) const
+	{
+		return m_Count;
+	}
+
+	LatencyHistogram::LatencyHistogram(void)
+		:
+		m_Buckets( BUCKET_COUNT, 0 ),
+		m_Count( 0 ),
+		m_Sum( 0 ),
+		m_Max( 0 )
+	{
+	}
+
+	void LatencyHistogram::add( const unsigned long long microseconds )
+	{
+		const unsigned long long bucket = microseconds / BUCKET_MICROSECONDS;
+		m_Buckets[(bucket < BUCKET_COUNT) ? (unsigned int) bucket : BUCKET_COUNT - 1]++;
+		m_Count++;
+		m_Sum += microseconds;
+		if(microseconds > m_Max)
+		{
+			m_Max = microseconds;
+		}
+	}
+
+	void LatencyHistogram::reset(void)
+	{
+		std::fill( m_Buckets.begin(), m_Buckets.end(), 0u );
+		m_Count = 0;
+		m_Sum = 0;
+		m_Max = 0;
+	}
+
+	unsigned long long LatencyHistogram::getCount(void) const
+	{
+		return m_Count;
+	}
+
+	double LatencyHistogram::getMean(void) const
+	{
+		return (m_Count > 0) ? (double) m_Sum / (double) m_Count / 1000.0 : 0.0;
+	}
+
+	double LatencyHistogram::getMax(void) const
+	{
+		return (double) m_Max / 1000.0;
+	}
+
+	double LatencyHistogram::getPercentile( const double fraction ) const
+	{
+		if(m_Count == 0)
+		{
+			return 0.0;
+		}
+
+		const double clamped = (fraction < 0.0) ? 0.0 : ((fraction > 1.0) ? 1.0 : fraction);
+		unsigned long long rank = (unsigned long long) (clamped * (double) m_Count + 0.999999);
+		if(rank == 0)
+		{
+			rank = 1;
+		}
+
+		unsigned long long seen = 0;
+		for(unsigned int i = 0; i < BUCKET_COUNT; i++)
+		{
+			seen += m_Buckets[i];
+			if(seen >= rank)
+			{
+				// Upper edge of the bucket, but never more than the largest value actually seen
+				const unsigned long long upper = (unsigned long long) (i + 1) * BUCKET_MICROSECONDS;
+				return (double) ((upper < m_Max) ? upper : m_Max) / 1000.0;
+			}
+		}
+		return getMax();
+	}
+};
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <vector>
+
+namespace DirectLook
+{
+	/// \brief Die Klasse RollingStatistic fasst die letzten N Messwerte zusammen (Mittelwert, Minimum, Maximum, Perzentile).
+	///
+	/// Die Klasse ist nicht threadsicher, der Aufrufer muss den Zugriff schuetzen.
+	class RollingStatistic
+	{
+
+	public:
+		////////////////////////////////////////////////////////////
+		/// \brief Konstruktor
+		///
+		/// \param windowSize Anzahl der beruecksichtigten Messwerte
+		///
+		////////////////////////////////////////////////////////////
+		explicit RollingStatistic( const unsigned int windowSize = 120 );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Fuegt einen Messwert hinzu und verdraengt gegebenenfalls den aeltesten.
+		////////////////////////////////////////////////////////////
+		void add( const double value );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Verwirft alle Messwerte.
+		////////////////////////////////////////////////////////////
+		void reset(void);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert den Mittelwert im Fenster zurueck (0 ohne Messwerte).
+		////////////////////////////////////////////////////////////
+		double getMean(void) const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert den kleinsten Messwert im Fenster zurueck (0 ohne Messwerte).
+		////////////////////////////////////////////////////////////
+		double getMin(void) const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert den groessten Messwert im Fenster zurueck (0 ohne Messwerte).
+		////////////////////////////////////////////////////////////
+		double getMax(void) const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert den zuletzt hinzugefuegten Messwert zurueck (0 ohne Messwerte).
+		////////////////////////////////////////////////////////////
+		double getLast(void) const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert ein Perzentil der Messwerte im Fenster zurueck (0 ohne Messwerte).
+		///
+		/// \param fraction Anteil zwischen 0 und 1, z.B. 0.95 fuer das 95. Perzentil
+		///
+		/// \return Kleinster Messwert, den mindestens "fraction" aller Messwerte nicht ueberschreiten
+		///
+		////////////////////////////////////////////////////////////
+		double getPercentile( const double fraction ) const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert die Anzahl aller jemals hinzugefuegten Messwerte zurueck.
+		////////////////////////////////////////////////////////////
+		unsigned long long getCount(void) const;
+
+	private:
+		std::vector<double> m_Samples;		///< Ringpuffer der Messwerte
+		unsigned int m_Next;				///< Naechste Schreibposition im Ringpuffer
+		unsigned int m_Filled;				///< Anzahl gueltiger Messwerte im Ringpuffer
+		double m_Sum;						///< Summe der gueltigen Messwerte
+		unsigned long long m_Count;			///< Anzahl aller Messwerte
+	};
+
+	/// \brief Die Klasse LatencyHistogram sammelt Latenzen eines ganzen Durchlaufes in festen Klassen.
+	///
+	/// Anders als RollingStatistic vergisst das Histogramm keine Messwerte, der Speicherbedarf bleibt
+	/// trotzdem konstant. Die Klassen sind 100 Mikrosekunden breit und reichen bis eine Sekunde, laengere
+	/// Latenzen landen in der letzten Klasse. Perzentile werden auf die Obergrenze ihrer Klasse gerundet,
+	/// liegen also nie unter dem wahren Wert. Die Klasse ist nicht threadsicher.
+	class LatencyHistogram
+	{
+
+	public:
+		static const unsigned int BUCKET_MICROSECONDS = 100;	///< Breite einer Klasse
+		static const unsigned int BUCKET_COUNT = 10000;			///< Anzahl der Klassen (Bereich 0 bis 1 s)
+
+		////////////////////////////////////////////////////////////
+		/// \brief Konstruktor
+		////////////////////////////////////////////////////////////
+		LatencyHistogram(void);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Zaehlt eine Latenz.
+		///
+		/// \param microseconds Latenz in Mikrosekunden
+		///
+		////////////////////////////////////////////////////////////
+		void add( const unsigned long long microseconds );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Verwirft alle Messwerte.
+		////////////////////////////////////////////////////////////
+		void reset(void);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert die Anzahl der Messwerte zurueck.
+		////////////////////////////////////////////////////////////
+		unsigned long long getCount(void) const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert die mittlere Latenz in Millisekunden zurueck (0 ohne Messwerte).
+		////////////////////////////////////////////////////////////
+		double getMean(void) const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert die groesste Latenz in Millisekunden zurueck (exakt, 0 ohne Messwerte).
+		////////////////////////////////////////////////////////////
+		double getMax(void) const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert ein Perzentil der Latenz in Millisekunden zurueck (0 ohne Messwerte).
+		///
+		/// \param fraction Anteil zwischen 0 und 1, z.B. 0.99 fuer das 99. Perzentil
+		///
+		////////////////////////////////////////////////////////////
+		double getPercentile( const double fraction ) const;
+
+	private:
+		std::vector<unsigned int> m_Buckets;	///< Anzahl der Messwerte je Klasse
+		unsigned long long m_Count;				///< Anzahl aller Messwerte
+		unsigned long long m_Sum;				///< Summe aller Messwerte in Mikrosekunden
+		unsigned long long m_Max;				///< Groesster Messwert in Mikrosekunden
+	};
+};
@@ -0,0 +1,286 @@
+#include "OutputRing.h"
+#include "Trace.h"
+#include "../../DirectLookRing/DirectLookRing.h"
+
+#include <iostream>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <process.h>
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <linux/futex.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace DirectLook
+{
+	// Slots start on cache lines, so a slot never shares a line with the header or its neighbour
+	static const size_t SLOT_ALIGNMENT = 64;
+
+	static size_t alignUp( const size_t size )
+	{
+		return (size + SLOT_ALIGNMENT - 1) & ~(SLOT_ALIGNMENT - 1);
+	}
+
+	static bool isValidName( const std::string& name )
+	{
+		if(name.empty() || name.size() >= DL_RING_NAME_SIZE)
+		{
+			return false;
+		}
+		for(size_t i = 0; i < name.size(); i++)
+		{
+			const char c = name[i];
+			if(!((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' || c == '-'))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	OutputRing::OutputRing(void)
+		:
+		m_pHeader( 0 ),
+		m_Size( 0 ),
+		m_FrameSize( 0 ),
+		m_Published( 0 )
+#ifdef _WIN32
+		,
+		m_pMapping( 0 )
+#endif
+	{
+#ifdef _WIN32
+		m_pEvents[0] = 0;
+		m_pEvents[1] = 0;
+#endif
+	}
+
+	OutputRing::~OutputRing(void)
+	{
+		destroy();
+	}
+
+	bool OutputRing::create( const std::string& name, const unsigned int width, const unsigned int height,
+		const bool bgr, const bool bottomUp, const unsigned int slotCount )
+	{
+		destroy();
+		if(!isValidName( name ) || width == 0 || height == 0 || slotCount < 2 || slotCount > DL_RING_MAX_SLOTS)
+		{
+			std::cerr << "Invalid output ring \"" << name << "\"" << std::endl;
+			return false;
+		}
+
+		m_Name = name;
+		m_FrameSize = width * height * 3;
+		const size_t headerSize = alignUp( sizeof( DirectLookRingHeader ) );
+		const size_t slotSize = alignUp( m_FrameSize );
+		if(!map( headerSize + slotCount * slotSize ))
+		{
+			std::cerr << "Couldn't create output ring \"" << name << "\" (already used by another writer?)" << std::endl;
+			destroy();
+			return false;
+		}
+
+		memset( m_pHeader, 0, sizeof( DirectLookRingHeader ) );
+		m_pHeader->version = DL_RING_VERSION;
+		m_pHeader->headerSize = sizeof( DirectLookRingHeader );
+		m_pHeader->format = bgr ? DL_RING_FORMAT_BGR24 : DL_RING_FORMAT_RGB24;
+		m_pHeader->flags = bottomUp ? DL_RING_FLAG_BOTTOM_UP : 0;
+		m_pHeader->width = width;
+		m_pHeader->height = height;
+		m_pHeader->stride = width * 3;
+		m_pHeader->slotCount = slotCount;
+		m_pHeader->slotSize = (uint32_t) slotSize;
+		m_pHeader->totalSize = m_Size;
+		for(unsigned int i = 0; i < slotCount; i++)
+		{
+			m_pHeader->slots[i].offset = headerSize + i * slotSize;
+		}
+		m_pHeader->writerState = DL_RING_WRITER_OPEN;
+#ifdef _WIN32
+		m_pHeader->writerPid = (uint32_t) _getpid();
+#else
+		m_pHeader->writerPid = (uint32_t) getpid();
+#endif
+		m_Published = 0;
+
+		// Readers check the magic first, so it marks the header as complete
+		DL_RING_BARRIER();
+		m_pHeader->magic = DL_RING_MAGIC;
+		return true;
+	}
+
+	void OutputRing::destroy(void)
+	{
+		if(m_pHeader)
+		{
+			m_pHeader->writerState = DL_RING_WRITER_CLOSED;
+			DL_RING_BARRIER();
+			signal();
+		}
+
+#ifdef _WIN32
+		if(m_pHeader) { UnmapViewOfFile( m_pHeader ); m_pHeader = 0; }
+		if(m_pMapping) { CloseHandle( (HANDLE) m_pMapping ); m_pMapping = 0; }
+		for(unsigned int i = 0; i < 2; i++)
+		{
+			if(m_pEvents[i]) { CloseHandle( (HANDLE) m_pEvents[i] ); m_pEvents[i] = 0; }
+		}
+#else
+		if(m_pHeader)
+		{
+			munmap( m_pHeader, m_Size );
+			m_pHeader = 0;
+			shm_unlink( ("/directlook_" + m_Name).c_str() );
+		}
+#endif
+		m_Size = 0;
+	}
+
+	bool OutputRing::publish( const unsigned char* pPixels, const unsigned long long timestamp )
+	{
+		DL_TRACE_SCOPE( "OutputRing::publish" );
+		if(!m_pHeader)
+		{
+			return false;
+		}
+
+		const unsigned int index = (unsigned int) (m_Published % m_pHeader->slotCount);
+		DirectLookRingSlot& slot = m_pHeader->slots[index];
+
+#ifdef _WIN32
+		// Readers of the frame before the last one wait for the frame after this one on the same event,
+		// the signal of that older frame must not wake them
+		ResetEvent( (HANDLE) m_pEvents[m_Published & 1] );
+#endif
+
+		// Odd sequence: readers of this slot see that their pixels are being overwritten
+		slot.sequence++;
+		DL_RING_BARRIER();
+		memcpy( reinterpret_cast<unsigned char*>( m_pHeader ) + slot.offset, pPixels, m_FrameSize );
+		slot.frame = m_Published + 1;
+		slot.timestamp = timestamp;
+		DL_RING_BARRIER();
+		slot.sequence++;
+
+		m_Published++;
+		m_pHeader->latest = index;
+		DL_RING_BARRIER();
+		m_pHeader->published = (uint32_t) m_Published;
+		DL_RING_BARRIER();
+		signal();
+		return true;
+	}
+
+#ifdef _WIN32
+	bool OutputRing::map( const size_t size )
+	{
+		const std::string mappingName = "Local\\directlook_" + m_Name;
+		const std::string eventName = "Local\\directlook_" + m_Name + "_frame";
+
+		m_pMapping = CreateFileMappingA( INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0, (DWORD) size, mappingName.c_str() );
+		if(!m_pMapping || GetLastError() == ERROR_ALREADY_EXISTS)
+		{
+			// Another writer owns the name
+			return false;
+		}
+		m_pHeader = static_cast<DirectLookRingHeader*>( MapViewOfFile( (HANDLE) m_pMapping, FILE_MAP_ALL_ACCESS, 0, 0, size ) );
+
+		// Manual reset: one SetEvent wakes every reader. One event per frame parity, a reader waits on the one
+		// of the frame it expects, so the still set event of the frame it already has can't wake it
+		m_pEvents[0] = CreateEventA( NULL, TRUE, FALSE, (eventName + "0").c_str() );
+		m_pEvents[1] = CreateEventA( NULL, TRUE, FALSE, (eventName + "1").c_str() );
+		m_Size = size;
+		return m_pHeader && m_pEvents[0] && m_pEvents[1];
+	}
+
+	void OutputRing::signal(void)
+	{
+		// After the last frame the readers wait for the next one, wake them so they see the closed state
+		const unsigned long long frame = m_pHeader->writerState == DL_RING_WRITER_OPEN ? m_Published : m_Published + 1;
+		if(m_pEvents[frame & 1])
+		{
+			SetEvent( (HANDLE) m_pEvents[frame & 1] );
+		}
+	}
+#else
+	static bool isStale( const std::string& shmName )
+	{
+		const int fd = shm_open( shmName.c_str(), O_RDONLY, 0 );
+		if(fd < 0)
+		{
+			// Unlinked meanwhile, the name is free
+			return errno == ENOENT;
+		}
+
+		struct stat status;
+		bool stale = false;
+		if(fstat( fd, &status ) == 0 && (size_t) status.st_size >= sizeof( DirectLookRingHeader ))
+		{
+			void* pAddress = mmap( 0, sizeof( DirectLookRingHeader ), PROT_READ, MAP_SHARED, fd, 0 );
+			if(pAddress != MAP_FAILED)
+			{
+				// A header that isn't complete yet may belong to a writer inside create(), so it stays
+				const DirectLookRingHeader* pHeader = static_cast<const DirectLookRingHeader*>( pAddress );
+				if(pHeader->magic == DL_RING_MAGIC && pHeader->writerPid != 0)
+				{
+					stale = pHeader->writerState != DL_RING_WRITER_OPEN
+						|| (kill( (pid_t) pHeader->writerPid, 0 ) != 0 && errno == ESRCH);
+				}
+				munmap( pAddress, sizeof( DirectLookRingHeader ) );
+			}
+		}
+		close( fd );
+		return stale;
+	}
+
+	bool OutputRing::map( const size_t size )
+	{
+		// Like on Windows a running writer keeps its name. A ring left behind by a writer that has exited
+		// is replaced, its readers keep their old mapping
+		const std::string shmName = "/directlook_" + m_Name;
+		int fd = shm_open( shmName.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644 );
+		if(fd < 0 && errno == EEXIST && isStale( shmName ))
+		{
+			shm_unlink( shmName.c_str() );
+			fd = shm_open( shmName.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644 );
+		}
+		if(fd < 0)
+		{
+			return false;
+		}
+		if(ftruncate( fd, (off_t) size ) != 0)
+		{
+			close( fd );
+			shm_unlink( shmName.c_str() );
+			return false;
+		}
+
+		void* pAddress = mmap( 0, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+		close( fd );
+		if(pAddress == MAP_FAILED)
+		{
+			shm_unlink( shmName.c_str() );
+			return false;
+		}
+		m_pHeader = static_cast<DirectLookRingHeader*>( pAddress );
+		m_Size = size;
+		return true;
+	}
+
+	void OutputRing::signal(void)
+	{
+		// Shared futex (no FUTEX_PRIVATE_FLAG), the readers live in other processes
+		syscall( SYS_futex, &m_pHeader->published, FUTEX_WAKE, INT_MAX, NULL, NULL, 0 );
+	}
+#endif
+};
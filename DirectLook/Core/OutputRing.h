@@ -0,0 +1,108 @@
+#pragma once
+
+#include "../NonCopyable.h"
+
+#include <string>
+
+struct DirectLookRingHeader;
+
+namespace DirectLook
+{
+	/// \brief Die Klasse OutputRing stellt die ausgelesenen Bilder anderen Prozessen im Shared Memory bereit.
+	///
+	/// Der Speicherblock hat das Layout aus DirectLookRing/DirectLookRing.h: einen Kopf mit Format,
+	/// Groesse und Zaehlern, gefolgt von mehreren Slots, die der Reihe nach beschrieben werden. Jeder Slot
+	/// ist mit einer Sequenzsperre geschuetzt, Leser (z.B. mit dem C-Client aus DirectLookRing) lesen die
+	/// Pixel also direkt aus dem gemeinsamen Speicher, ohne Kopie und ohne den Schreiber je aufzuhalten.
+	/// Nach jedem Bild werden wartende Leser geweckt (Linux: Futex, Windows: zwei benannte Events, die sich
+	/// nach der Bildnummer abwechseln).
+	///
+	/// Es darf nur einen Schreiber geben, publish() wird vom Thread des Auslesens aufgerufen.
+	class OutputRing : public NonCopyable
+	{
+
+	public:
+		static const unsigned int DEFAULT_SLOTS = 4;	///< Slots, ein Leser hat damit drei Bildzeiten zum Lesen
+
+		////////////////////////////////////////////////////////////
+		/// \brief Standardkonstruktor
+		////////////////////////////////////////////////////////////
+		OutputRing(void);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Destruktor, siehe destroy().
+		////////////////////////////////////////////////////////////
+		~OutputRing(void);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Legt den Speicherblock an (ein vorhandener Ring wird vorher geschlossen).
+		///
+		/// \param name      Name des Ringes (Buchstaben, Ziffern, '_' und '-')
+		/// \param width     Bildbreite
+		/// \param height    Bildhoehe
+		/// \param bgr       Pixel in der Reihenfolge BGR statt RGB?
+		/// \param bottomUp  Zeilen von unten nach oben (OpenGL-Textur)?
+		/// \param slotCount Anzahl der Slots (2 bis DL_RING_MAX_SLOTS)
+		///
+		/// \return True wenn erfolgreich, false wenn fehlgeschlagen
+		///
+		////////////////////////////////////////////////////////////
+		bool create( const std::string& name, const unsigned int width, const unsigned int height,
+			const bool bgr, const bool bottomUp, const unsigned int slotCount = DEFAULT_SLOTS );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Markiert den Ring als geschlossen, weckt die Leser und gibt den Namen frei.
+		///
+		/// Leser, die den Ring noch eingeblendet haben, behalten ihre Abbildung bis dlRingClose().
+		///
+		////////////////////////////////////////////////////////////
+		void destroy(void);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Kopiert ein Bild in den naechsten Slot und weckt die Leser.
+		///
+		/// \param pPixels   Pixel in Format und Groesse aus create()
+		/// \param timestamp Zeitstempel in Mikrosekunden
+		///
+		/// \return false, wenn kein Ring angelegt ist
+		///
+		////////////////////////////////////////////////////////////
+		bool publish( const unsigned char* pPixels, const unsigned long long timestamp );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert true zurueck, solange der Ring angelegt ist.
+		////////////////////////////////////////////////////////////
+		bool isOpen(void) const { return m_pHeader != 0; }
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert den Namen des Ringes zurueck.
+		////////////////////////////////////////////////////////////
+		const std::string& getName(void) const { return m_Name; }
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert die Anzahl der veroeffentlichten Bilder seit create() zurueck.
+		////////////////////////////////////////////////////////////
+		unsigned long long getPublished(void) const { return m_Published; }
+
+	private:
+		////////////////////////////////////////////////////////////
+		/// \brief Legt den benannten Speicherblock an und blendet ihn ein.
+		////////////////////////////////////////////////////////////
+		bool map( const size_t size );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Weckt alle Leser, die auf ein neues Bild warten.
+		////////////////////////////////////////////////////////////
+		void signal(void);
+
+		std::string m_Name;					///< Name des Ringes
+		DirectLookRingHeader* m_pHeader;	///< Anfang des eingeblendeten Speicherblocks, 0 wenn geschlossen
+		size_t m_Size;						///< Groesse des Speicherblocks in Byte
+		unsigned int m_FrameSize;			///< Byte eines Bildes
+		unsigned long long m_Published;		///< Veroeffentlichte Bilder
+#ifdef _WIN32
+		void* m_pMapping;					///< Handle des File Mappings
+		void* m_pEvents[2];					///< Handles der Events "neues Bild", je eines fuer gerade und ungerade Bildnummern
+#endif
+	};
+};
@@ -0,0 +1,383 @@
+#include "Pipeline.h"
+#include "Clock.h"
+#include "Trace.h"
+
+#include <QThread>
+
+#include <iomanip>
+
+namespace DirectLook
+{
+	class Pipeline::WorkerThread : public QThread
+	{
+
+	public:
+		WorkerThread( Pipeline& pipeline, const unsigned int stageIndex )
+			:
+			m_Pipeline( pipeline ),
+			m_StageIndex( stageIndex )
+		{
+		}
+
+	protected:
+		void run(void)
+		{
+			m_Pipeline.workerLoop( m_StageIndex );
+		}
+
+	private:
+		Pipeline& m_Pipeline;
+		unsigned int m_StageIndex;
+	};
+
+	// Worker threads poll their input queue at this interval so they notice stop()
+	static const unsigned long WORKER_POLL_MS = 50;
+
+	Pipeline::Pipeline(void)
+		:
+		m_Stop( 0 ),
+		m_Running( false ),
+		m_NextSequence( 0 ),
+		m_StartTime( 0 ),
+		m_OutputStage( 0 )
+	{
+	}
+
+	Pipeline::~Pipeline(void)
+	{
+		stop();
+
+		for(size_t i = 0; i < m_Stages.size(); i++)
+		{
+			if(m_Stages[i]->m_pInput){ delete m_Stages[i]->m_pInput; m_Stages[i]->m_pInput = 0; }
+			delete m_Stages[i];
+		}
+		m_Stages.clear();
+	}
+
+	void Pipeline::addStage( const std::string& name, const StageFunction& function, const StageThread thread, const unsigned int queueCapacity, const DropPolicy policy )
+	{
+		if(m_Running)
+		{
+			std::cerr << "Pipeline: stage " << name << " added after start()" << std::endl;
+			return;
+		}
+
+		Stage* pStage = new Stage;
+		pStage->m_Name = name;
+		pStage->m_pTraceName = Trace::intern( name );
+		pStage->m_Function = function;
+		pStage->m_Thread = thread;
+		pStage->m_pInput = m_Stages.empty() ? 0 : new FrameQueue<PipelineFrame>( queueCapacity, policy );
+		pStage->m_pWorker = 0;
+		pStage->m_Finished = 0;
+		pStage->m_Processed = 0;
+		pStage->m_Rejected = 0;
+		pStage->m_BusyMicroseconds = 0;
+		m_Stages.push_back( pStage );
+	}
+
+	void Pipeline::setOutputStage( const std::string& name )
+	{
+		m_OutputStageName = name;
+	}
+
+	bool Pipeline::start(void)
+	{
+		if(m_Running || m_Stages.empty())
+		{
+			return false;
+		}
+
+		m_OutputStage = (unsigned int) m_Stages.size() - 1;
+		for(unsigned int i = 0; i < m_Stages.size(); i++)
+		{
+			if(m_Stages[i]->m_Name == m_OutputStageName)
+			{
+				m_OutputStage = i;
+			}
+		}
+
+		m_Running = true;
+		m_StartTime = Clock::microseconds();
+
+		for(unsigned int i = 0; i < m_Stages.size(); i++)
+		{
+			if(m_Stages[i]->m_Thread == STAGE_WORKER)
+			{
+				m_Stages[i]->m_pWorker = new WorkerThread( *this, i );
+				m_Stages[i]->m_pWorker->start();
+			}
+		}
+		return true;
+	}
+
+	unsigned int Pipeline::pump( const unsigned long timeoutMs )
+	{
+		unsigned int processed = 0;
+		unsigned long waitMs = timeoutMs;
+		bool sourceDone = false;
+		bool progress = true;
+
+		// Move one frame at a time through all caller stages, so e.g. frame N is rendered
+		// before frame N + 1 is uploaded over it
+		while(progress)
+		{
+			progress = false;
+			for(unsigned int i = 0; i < m_Stages.size(); i++)
+			{
+				Stage* pStage = m_Stages[i];
+				if(pStage->m_Thread != STAGE_CALLER)
+				{
+					continue;
+				}
+
+				// A source on the calling thread produces one frame per pump()
+				if(!pStage->m_pInput)
+				{
+					if(sourceDone)
+					{
+						continue;
+					}
+					sourceDone = true;
+				}
+
+				if(processOne( i, waitMs ))
+				{
+					processed++;
+					progress = true;
+				}
+				waitMs = 0;
+			}
+		}
+
+		return processed;
+	}
+
+	bool Pipeline::isFinished(void) const
+	{
+		return !m_Stages.empty() && m_Stages.back()->m_Finished != 0;
+	}
+
+	void Pipeline::stop(void)
+	{
+		m_Stop = 1;
+
+		for(size_t i = 0; i < m_Stages.size(); i++)
+		{
+			if(m_Stages[i]->m_pInput)
+			{
+				m_Stages[i]->m_pInput->close();
+			}
+		}
+
+		for(size_t i = 0; i < m_Stages.size(); i++)
+		{
+			if(m_Stages[i]->m_pWorker)
+			{
+				m_Stages[i]->m_pWorker->wait();
+				delete m_Stages[i]->m_pWorker;
+				m_Stages[i]->m_pWorker = 0;
+			}
+		}
+	}
+
+	std::vector<PipelineStageStatistics> Pipeline::getStatistics(void)
+	{
+		std::vector<PipelineStageStatistics> statistics;
+		const double elapsed = (double) (Clock::microseconds() - m_StartTime);
+
+		m_StatisticsMutex.lock();
+		for(size_t i = 0; i < m_Stages.size(); i++)
+		{
+			Stage* pStage = m_Stages[i];
+			PipelineStageStatistics stage;
+			stage.m_Name = pStage->m_Name;
+			stage.m_Processed = pStage->m_Processed;
+			stage.m_Dropped = pStage->m_Rejected;
+			stage.m_QueueDepth = 0;
+			stage.m_MaxQueueDepth = 0;
+			stage.m_QueueCapacity = 0;
+			if(pStage->m_pInput)
+			{
+				stage.m_Dropped += pStage->m_pInput->getDropped();
+				stage.m_QueueDepth = pStage->m_pInput->getDepth();
+				stage.m_MaxQueueDepth = pStage->m_pInput->getMaxDepth();
+				stage.m_QueueCapacity = pStage->m_pInput->getCapacity();
+			}
+			stage.m_MeanMilliseconds = pStage->m_Milliseconds.getMean();
+			stage.m_P95Milliseconds = pStage->m_Milliseconds.getPercentile( 0.95 );
+			stage.m_MaxMilliseconds = pStage->m_Milliseconds.getMax();
+			stage.m_Occupancy = (m_Running && elapsed > 0.0) ? (double) pStage->m_BusyMicroseconds / elapsed : 0.0;
+			stage.m_LatencyP50Milliseconds = pStage->m_Latency.getPercentile( 0.5 );
+			stage.m_LatencyP95Milliseconds = pStage->m_Latency.getPercentile( 0.95 );
+			stage.m_LatencyP99Milliseconds = pStage->m_Latency.getPercentile( 0.99 );
+			statistics.push_back( stage );
+		}
+		m_StatisticsMutex.unlock();
+
+		return statistics;
+	}
+
+	void Pipeline::printStatistics( std::ostream& stream )
+	{
+		const std::vector<PipelineStageStatistics> statistics = getStatistics();
+
+		stream << std::left << std::setw( 12 ) << "Stage" << std::right
+			<< std::setw( 10 ) << "Frames"
+			<< std::setw( 10 ) << "Dropped"
+			<< std::setw( 10 ) << "Queue"
+			<< std::setw( 12 ) << "Mean ms"
+			<< std::setw( 12 ) << "p95 ms"
+			<< std::setw( 12 ) << "Max ms"
+			<< std::setw( 8 ) << "Busy" << std::endl;
+
+		for(size_t i = 0; i < statistics.size(); i++)
+		{
+			const PipelineStageStatistics& stage = statistics[i];
+			stream << std::left << std::setw( 12 ) << stage.m_Name << std::right
+				<< std::setw( 10 ) << stage.m_Processed
+				<< std::setw( 10 ) << stage.m_Dropped
+				<< std::setw( 6 ) << stage.m_MaxQueueDepth << "/" << std::setw( 3 ) << std::left << stage.m_QueueCapacity << std::right
+				<< std::setw( 12 ) << std::fixed << std::setprecision( 2 ) << stage.m_MeanMilliseconds
+				<< std::setw( 12 ) << stage.m_P95Milliseconds
+				<< std::setw( 12 ) << stage.m_MaxMilliseconds
+				<< std::setw( 7 ) << std::setprecision( 0 ) << stage.m_Occupancy * 100.0 << "%" << std::endl;
+		}
+
+		// Latency per stage counts from the moment the frame left the previous stage,
+		// so queue waits show up where they happen
+		const LatencyHistogram outputLatency = getOutputLatency();
+		stream << std::endl << std::left << std::setw( 22 ) << "Latency" << std::right
+			<< std::setw( 10 ) << "p50 ms"
+			<< std::setw( 10 ) << "p95 ms"
+			<< std::setw( 10 ) << "p99 ms" << std::endl;
+
+		for(size_t i = 0; i < statistics.size(); i++)
+		{
+			const PipelineStageStatistics& stage = statistics[i];
+			stream << std::left << std::setw( 22 ) << ((i == 0) ? stage.m_Name : "-> " + stage.m_Name) << std::right
+				<< std::setw( 10 ) << std::fixed << std::setprecision( 2 ) << stage.m_LatencyP50Milliseconds
+				<< std::setw( 10 ) << stage.m_LatencyP95Milliseconds
+				<< std::setw( 10 ) << stage.m_LatencyP99Milliseconds << std::endl;
+		}
+
+		const std::string outputName = (m_OutputStage < m_Stages.size()) ? m_Stages[m_OutputStage]->m_Name : "output";
+		stream << std::left << std::setw( 22 ) << "capture to " + outputName << std::right
+			<< std::setw( 10 ) << outputLatency.getPercentile( 0.5 )
+			<< std::setw( 10 ) << outputLatency.getPercentile( 0.95 )
+			<< std::setw( 10 ) << outputLatency.getPercentile( 0.99 ) << std::endl;
+
+		stream.unsetf( std::ios::fixed );
+		stream << std::setprecision( 6 );
+	}
+
+	LatencyHistogram Pipeline::getOutputLatency(void)
+	{
+		m_StatisticsMutex.lock();
+		const LatencyHistogram latency = m_OutputLatency;
+		m_StatisticsMutex.unlock();
+		return latency;
+	}
+
+	bool Pipeline::processOne( const unsigned int stageIndex, const unsigned long timeoutMs )
+	{
+		Stage* pStage = m_Stages[stageIndex];
+		if(pStage->m_Finished != 0)
+		{
+			return false;
+		}
+
+		PipelineFrame frame;
+		if(pStage->m_pInput)
+		{
+			if(!pStage->m_pInput->pop( frame, timeoutMs ))
+			{
+				return false;
+			}
+
+			if(frame.m_EndOfStream)
+			{
+				pStage->m_Finished = 1;
+				forward( stageIndex, frame );
+				return true;
+			}
+		}
+		else
+		{
+			frame.m_Sequence = m_NextSequence++;
+		}
+
+		const unsigned long long startTime = Clock::microseconds();
+		bool accepted;
+		{
+			DL_TRACE_SCOPE( pStage->m_pTraceName );
+			accepted = pStage->m_Function( frame );
+		}
+		const unsigned long long endTime = Clock::microseconds();
+		const unsigned long long busyTime = endTime - startTime;
+
+		if(accepted && !pStage->m_pInput)
+		{
+			// The source may set the capture time itself, e.g. when the sensor grabbed the frame
+			if(frame.m_CaptureTime == 0)
+			{
+				frame.m_CaptureTime = endTime;
+			}
+			frame.m_StageTime = startTime;
+		}
+
+		m_StatisticsMutex.lock();
+		pStage->m_BusyMicroseconds += busyTime;
+		pStage->m_Milliseconds.add( (double) busyTime / 1000.0 );
+		if(accepted)
+		{
+			pStage->m_Processed++;
+			pStage->m_Latency.add( (endTime > frame.m_StageTime) ? endTime - frame.m_StageTime : 0 );
+			if(stageIndex == m_OutputStage)
+			{
+				m_OutputLatency.add( (endTime > frame.m_CaptureTime) ? endTime - frame.m_CaptureTime : 0 );
+			}
+		}
+		else if(pStage->m_pInput)
+		{
+			pStage->m_Rejected++;
+		}
+		m_StatisticsMutex.unlock();
+
+		if(accepted)
+		{
+			frame.m_StageTime = endTime;
+			forward( stageIndex, frame );
+		}
+		else if(!pStage->m_pInput)
+		{
+			// The source is exhausted, let the end of stream travel down the pipeline
+			PipelineFrame endOfStream;
+			endOfStream.m_EndOfStream = true;
+			pStage->m_Finished = 1;
+			forward( stageIndex, endOfStream );
+		}
+		return true;
+	}
+
+	void Pipeline::forward( const unsigned int stageIndex, const PipelineFrame& frame )
+	{
+		if(stageIndex + 1 < m_Stages.size())
+		{
+			// The end of stream must never be dropped, otherwise the following stages would wait forever
+			m_Stages[stageIndex + 1]->m_pInput->push( frame, frame.m_EndOfStream );
+		}
+	}
+
+	void Pipeline::workerLoop( const unsigned int stageIndex )
+	{
+		Stage* pStage = m_Stages[stageIndex];
+		DL_TRACE_THREAD_NAME( "Pipeline " + pStage->m_Name );
+
+		while(m_Stop == 0 && pStage->m_Finished == 0)
+		{
+			processOne( stageIndex, WORKER_POLL_MS );
+		}
+	}
+};
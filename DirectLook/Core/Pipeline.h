@@ -0,0 +1,199 @@
+#pragma once
+
+#include <QAtomicInt>
+#include <QMutex>
+
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../NonCopyable.h"
+#include "../Image/FrameHandle.h"
+#include "FrameQueue.h"
+#include "Metrics.h"
+
+namespace DirectLook
+{
+	/// \brief Ein Bild auf dem Weg durch die Pipeline. Jede Stufe fuellt die Felder, die sie erzeugt.
+	struct PipelineFrame
+	{
+		unsigned long long m_Sequence;		///< Laufende Nummer, vergeben von der ersten Stufe
+		unsigned long long m_CaptureTime;	///< Zeitpunkt der Aufnahme (Clock::microseconds()), setzt die Quelle
+		unsigned long long m_SensorTimestamp;	///< Zeitstempel des Sensors (Uhr des Sensors, nicht Clock)
+		unsigned long long m_StageTime;		///< Zeitpunkt, an dem das Bild die letzte Stufe verlassen hat
+		bool m_EndOfStream;					///< Markiert das Ende des Datenstroms, traegt keine Bilddaten
+		ImageFrame m_Image;					///< RGB-Bild der Kamera
+		DepthFrame m_Depth;					///< Tiefenkarte des Sensors
+		DepthFrame m_SmoothDepth;			///< Geglaettete Tiefenkarte
+		ImageFrame m_TextureHeightMap;		///< Grauwert-Textur der Height-Map (1 Kanal)
+		VertexFrame m_VertexHeightMap;		///< Vertices der Height-Map
+		ImageFrame m_Output;				///< Ausgelesenes Ergebnisbild
+		std::vector<ImageFrame> m_OutputLevels;	///< Verkleinerte Stufen des Ergebnisbildes (Stufe 1, 2, ...), siehe GLScene::setOutputSize()
+		std::vector<ImageFrame> m_ViewOutputs;	///< Ergebnisbilder der zusaetzlichen Ansichten, siehe GLScene::addView()
+
+		PipelineFrame(void)
+			:
+			m_Sequence( 0 ),
+			m_CaptureTime( 0 ),
+			m_SensorTimestamp( 0 ),
+			m_StageTime( 0 ),
+			m_EndOfStream( false )
+		{
+		}
+	};
+
+	/// \brief Thread, auf dem eine Stufe der Pipeline laeuft
+	enum StageThread
+	{
+		STAGE_WORKER,	///< Eigener Thread der Stufe
+		STAGE_CALLER	///< Thread, der Pipeline::pump() aufruft (z.B. fuer OpenGL-Aufrufe)
+	};
+
+	/// \brief Momentaufnahme der Kennzahlen einer Stufe, siehe Pipeline::getStatistics().
+	struct PipelineStageStatistics
+	{
+		std::string m_Name;					///< Name der Stufe
+		unsigned long long m_Processed;		///< Anzahl der bearbeiteten Bilder
+		unsigned long long m_Dropped;		///< Verworfene Bilder (Eingangswarteschlange und Stufe selbst)
+		unsigned int m_QueueDepth;			///< Aktuelle Fuellung der Eingangswarteschlange
+		unsigned int m_MaxQueueDepth;		///< Groesste Fuellung der Eingangswarteschlange
+		unsigned int m_QueueCapacity;		///< Groesse der Eingangswarteschlange (0 fuer die erste Stufe)
+		double m_MeanMilliseconds;			///< Mittlere Bearbeitungszeit der letzten Bilder
+		double m_P95Milliseconds;			///< 95. Perzentil der Bearbeitungszeit der letzten Bilder
+		double m_MaxMilliseconds;			///< Laengste Bearbeitungszeit der letzten Bilder
+		double m_Occupancy;					///< Anteil der Laufzeit, in dem die Stufe gearbeitet hat (0..1)
+		double m_LatencyP50Milliseconds;	///< Median der Latenz seit der vorherigen Stufe (Warteschlange + Bearbeitung)
+		double m_LatencyP95Milliseconds;	///< 95. Perzentil der Latenz seit der vorherigen Stufe
+		double m_LatencyP99Milliseconds;	///< 99. Perzentil der Latenz seit der vorherigen Stufe
+	};
+
+	/// \brief Die Klasse Pipeline fuehrt eine Kette von Verarbeitungsstufen ueberlappend aus.
+	///
+	/// Zwischen zwei Stufen liegt jeweils eine FrameQueue, sodass z.B. Bild N+1 gefiltert wird,
+	/// waehrend Bild N gerendert wird. Der Durchsatz ist damit durch die langsamste Stufe begrenzt
+	/// und nicht durch die Summe aller Stufen.
+	///
+	/// Die erste Stufe ist die Quelle: sie fuellt ein leeres PipelineFrame und liefert false am Ende
+	/// des Datenstroms. Jede weitere Stufe bearbeitet ein Bild und liefert false, wenn es verworfen
+	/// werden soll. Stufen mit STAGE_CALLER laufen in pump() auf dem aufrufenden Thread, alle anderen
+	/// auf einem eigenen Thread.
+	class Pipeline : public NonCopyable
+	{
+
+	public:
+		typedef std::function<bool( PipelineFrame& )> StageFunction;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Standardkonstruktor
+		////////////////////////////////////////////////////////////
+		Pipeline(void);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Destruktor
+		///
+		/// Haelt die Pipeline an, siehe stop().
+		///
+		////////////////////////////////////////////////////////////
+		~Pipeline(void);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Haengt eine Stufe an das Ende der Pipeline an. Nur vor start() erlaubt.
+		///
+		/// \param name          Name fuer die Statistik
+		/// \param function      Verarbeitungsfunktion
+		/// \param thread        Thread, auf dem die Stufe laeuft
+		/// \param queueCapacity Groesse der Eingangswarteschlange (wird fuer die erste Stufe ignoriert)
+		/// \param policy        Verhalten der vollen Eingangswarteschlange
+		///
+		////////////////////////////////////////////////////////////
+		void addStage( const std::string& name, const StageFunction& function, const StageThread thread = STAGE_WORKER, const unsigned int queueCapacity = 2, const DropPolicy policy = DROP_NONE );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Legt fest, an welcher Stufe die Latenz seit der Aufnahme gemessen wird (Standard: letzte Stufe).
+		///
+		/// \param name Name der Stufe, z.B. die Stufe, die das Ergebnis ausliest oder anzeigt
+		///
+		////////////////////////////////////////////////////////////
+		void setOutputStage( const std::string& name );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Startet die Threads aller STAGE_WORKER-Stufen.
+		///
+		/// \return false, wenn keine Stufe vorhanden ist oder die Pipeline bereits laeuft
+		///
+		////////////////////////////////////////////////////////////
+		bool start(void);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Fuehrt alle STAGE_CALLER-Stufen fuer die verfuegbaren Bilder aus.
+		///
+		/// \param timeoutMs Maximale Wartezeit auf das erste Bild jeder Stufe in Millisekunden
+		///
+		/// \return Anzahl der bearbeiteten Bilder
+		///
+		////////////////////////////////////////////////////////////
+		unsigned int pump( const unsigned long timeoutMs );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert true zurueck, sobald das Ende des Datenstroms die letzte Stufe erreicht hat.
+		////////////////////////////////////////////////////////////
+		bool isFinished(void) const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Haelt alle Stufen an und wartet auf ihre Threads. Eingereihte Bilder werden verworfen.
+		////////////////////////////////////////////////////////////
+		void stop(void);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert die Kennzahlen aller Stufen zurueck.
+		////////////////////////////////////////////////////////////
+		std::vector<PipelineStageStatistics> getStatistics(void);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Gibt die Kennzahlen aller Stufen als Tabelle aus.
+		////////////////////////////////////////////////////////////
+		void printStatistics( std::ostream& stream );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert die Latenzen von PipelineFrame::m_CaptureTime bis zum Verlassen der Ausgabestufe zurueck.
+		////////////////////////////////////////////////////////////
+		LatencyHistogram getOutputLatency(void);
+
+	private:
+		class WorkerThread;
+
+		/// \brief Eine Stufe der Pipeline
+		struct Stage
+		{
+			std::string m_Name;							///< Name fuer die Statistik
+			const char* m_pTraceName;					///< Dauerhaft gueltiger Name fuer Trace
+			StageFunction m_Function;					///< Verarbeitungsfunktion
+			StageThread m_Thread;						///< Thread der Stufe
+			FrameQueue<PipelineFrame>* m_pInput;		///< Eingangswarteschlange (0 fuer die Quelle)
+			WorkerThread* m_pWorker;					///< Eigener Thread (nur STAGE_WORKER)
+			QAtomicInt m_Finished;						///< Ende des Datenstroms erreicht?
+			unsigned long long m_Processed;				///< Bearbeitete Bilder
+			unsigned long long m_Rejected;				///< Von der Stufe selbst verworfene Bilder
+			unsigned long long m_BusyMicroseconds;		///< Summe der Bearbeitungszeiten
+			RollingStatistic m_Milliseconds;			///< Bearbeitungszeiten der letzten Bilder
+			LatencyHistogram m_Latency;					///< Latenz seit der vorherigen Stufe
+		};
+
+		bool processOne( const unsigned int stageIndex, const unsigned long timeoutMs );
+
+		void forward( const unsigned int stageIndex, const PipelineFrame& frame );
+
+		void workerLoop( const unsigned int stageIndex );
+
+		std::vector<Stage*> m_Stages;			///< Stufen in Verarbeitungsreihenfolge
+		QMutex m_StatisticsMutex;				///< Schuetzt die Kennzahlen der Stufen
+		QAtomicInt m_Stop;						///< Threads beenden?
+		bool m_Running;							///< Wurde start() aufgerufen?
+		unsigned long long m_NextSequence;		///< Naechste laufende Nummer (nur von der Quelle verwendet)
+		unsigned long long m_StartTime;			///< Startzeitpunkt fuer die Auslastung
+		std::string m_OutputStageName;			///< Name der Ausgabestufe (leer = letzte Stufe)
+		unsigned int m_OutputStage;				///< Index der Ausgabestufe, wird in start() bestimmt
+		LatencyHistogram m_OutputLatency;		///< Latenz von der Aufnahme bis zur Ausgabestufe
+	};
+};
@@ -0,0 +1,128 @@
+#include "QualityGovernor.h"
+
+namespace DirectLook
+{
+	// Step down when the 90th percentile exceeds the budget, step up only with a wide margin
+	static const double DOWN_PERCENTILE = 0.9;
+	static const double UP_THRESHOLD = 0.6;
+
+	// Windows of headroom needed before stepping up, doubled after every reverted step up
+	static const unsigned int UP_WINDOWS = 3;
+	static const unsigned int MAX_UP_WINDOWS = 32;
+
+	QualityGovernor::QualityGovernor( const unsigned int levelCount, const double budgetMilliseconds, const unsigned int window )
+		:
+		m_LevelCount( (levelCount > 0) ? levelCount : 1 ),
+		m_Level( 0 ),
+		m_Fixed( false ),
+		m_Budget( budgetMilliseconds ),
+		m_Window( (window > 0) ? window : 1 ),
+		m_FrameTime( m_Window ),
+		m_HeadroomFrames( 0 ),
+		m_UpFrames( UP_WINDOWS * m_Window ),
+		m_SteppedUp( false ),
+		m_Changes( 0 )
+	{
+	}
+
+	void QualityGovernor::setBudget( const double budgetMilliseconds )
+	{
+		m_Budget = budgetMilliseconds;
+		m_FrameTime.reset();
+		m_HeadroomFrames = 0;
+	}
+
+	double QualityGovernor::getBudget(void) const
+	{
+		return m_Budget;
+	}
+
+	bool QualityGovernor::addFrameTime( const double milliseconds )
+	{
+		m_FrameTime.add( milliseconds );
+		if(m_Fixed || m_Budget <= 0.0 || m_FrameTime.getCount() < m_Window)
+		{
+			return false;
+		}
+
+		if(m_Level + 1 < m_LevelCount && m_FrameTime.getPercentile( DOWN_PERCENTILE ) > m_Budget)
+		{
+			// A step up that didn't even survive one window: wait longer before the next attempt
+			if(m_SteppedUp && m_FrameTime.getCount() <= m_Window)
+			{
+				m_UpFrames = (m_UpFrames * 2 < MAX_UP_WINDOWS * m_Window) ? m_UpFrames * 2 : MAX_UP_WINDOWS * m_Window;
+			}
+			m_SteppedUp = false;
+			changeLevel( m_Level + 1 );
+			return true;
+		}
+
+		// The step up held, forget the back-off
+		if(m_SteppedUp && m_FrameTime.getCount() >= 2 * m_Window)
+		{
+			m_UpFrames = UP_WINDOWS * m_Window;
+			m_SteppedUp = false;
+		}
+
+		if(m_FrameTime.getMean() < m_Budget * UP_THRESHOLD)
+		{
+			m_HeadroomFrames++;
+		}
+		else
+		{
+			m_HeadroomFrames = 0;
+		}
+
+		if(m_Level > 0 && m_HeadroomFrames >= m_UpFrames)
+		{
+			m_SteppedUp = true;
+			changeLevel( m_Level - 1 );
+			return true;
+		}
+		return false;
+	}
+
+	unsigned int QualityGovernor::getLevel(void) const
+	{
+		return m_Level;
+	}
+
+	unsigned int QualityGovernor::getLevelCount(void) const
+	{
+		return m_LevelCount;
+	}
+
+	void QualityGovernor::setFixedLevel( const unsigned int level )
+	{
+		m_Fixed = true;
+		m_Level = (level < m_LevelCount) ? level : m_LevelCount - 1;
+	}
+
+	void QualityGovernor::setAutomatic(void)
+	{
+		m_Fixed = false;
+		m_FrameTime.reset();
+		m_HeadroomFrames = 0;
+		m_SteppedUp = false;
+	}
+
+	bool QualityGovernor::isFixed(void) const
+	{
+		return m_Fixed;
+	}
+
+	unsigned long long QualityGovernor::getLevelChanges(void) const
+	{
+		return m_Changes;
+	}
+
+	void QualityGovernor::changeLevel( const unsigned int level )
+	{
+		m_Level = level;
+		m_Changes++;
+
+		// Timings of the old level say nothing about the new one
+		m_FrameTime.reset();
+		m_HeadroomFrames = 0;
+	}
+};
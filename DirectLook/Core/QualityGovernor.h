@@ -0,0 +1,99 @@
+#pragma once
+
+#include "../NonCopyable.h"
+#include "Metrics.h"
+
+namespace DirectLook
+{
+	/// \brief Die Klasse QualityGovernor waehlt anhand der gemessenen Bildzeiten eine Qualitaetsstufe.
+	///
+	/// Stufe 0 ist die beste Qualitaet, jede hoehere Stufe ist guenstiger. Ueberschreitet das 90. Perzentil
+	/// der Bildzeiten im Messfenster das Zeitbudget, wird eine Stufe herabgeschaltet. Hinaufgeschaltet wird
+	/// erst, wenn der Mittelwert ueber mehrere Fenster deutlich unter dem Budget liegt (Hysterese). Muss ein
+	/// Hinaufschalten sofort wieder zurueckgenommen werden, verdoppelt sich die Wartezeit bis zum naechsten
+	/// Versuch, damit die Qualitaet nicht zwischen zwei Stufen pendelt.
+	///
+	/// Die Klasse kennt die Stufen selbst nicht, der Aufrufer setzt sie um (z.B. mit GLScene::setQuality()).
+	/// Die Klasse ist nicht threadsicher.
+	class QualityGovernor : public NonCopyable
+	{
+
+	public:
+		////////////////////////////////////////////////////////////
+		/// \brief Konstruktor
+		///
+		/// \param levelCount         Anzahl der Qualitaetsstufen
+		/// \param budgetMilliseconds Zeitbudget pro Bild in Millisekunden
+		/// \param window             Anzahl der Bilder, die fuer eine Entscheidung gemessen werden
+		///
+		////////////////////////////////////////////////////////////
+		QualityGovernor( const unsigned int levelCount, const double budgetMilliseconds, const unsigned int window = 30 );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Setzt das Zeitbudget pro Bild und verwirft die bisherigen Messwerte.
+		////////////////////////////////////////////////////////////
+		void setBudget( const double budgetMilliseconds );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert das Zeitbudget pro Bild in Millisekunden zurueck.
+		////////////////////////////////////////////////////////////
+		double getBudget(void) const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Fuegt die Arbeitszeit eines Bildes hinzu und passt die Stufe gegebenenfalls an.
+		///
+		/// \param milliseconds Arbeitszeit des Bildes (ohne Wartezeiten, z.B. auf VSync oder den Sensor)
+		///
+		/// \return true, wenn sich die Stufe geaendert hat und der Aufrufer sie umsetzen muss
+		///
+		////////////////////////////////////////////////////////////
+		bool addFrameTime( const double milliseconds );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert die aktuelle Stufe zurueck.
+		////////////////////////////////////////////////////////////
+		unsigned int getLevel(void) const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert die Anzahl der Stufen zurueck.
+		////////////////////////////////////////////////////////////
+		unsigned int getLevelCount(void) const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Haelt die Stufe fest, addFrameTime() aendert sie danach nicht mehr.
+		///
+		/// \param level Feste Stufe (groessere Werte werden auf die letzte Stufe begrenzt)
+		///
+		////////////////////////////////////////////////////////////
+		void setFixedLevel( const unsigned int level );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Hebt eine feste Stufe auf, die Stufe wird wieder automatisch gewaehlt.
+		////////////////////////////////////////////////////////////
+		void setAutomatic(void);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert true zurueck, wenn die Stufe mit setFixedLevel() festgehalten wird.
+		////////////////////////////////////////////////////////////
+		bool isFixed(void) const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert die Anzahl der automatischen Stufenwechsel zurueck.
+		////////////////////////////////////////////////////////////
+		unsigned long long getLevelChanges(void) const;
+
+	private:
+		void changeLevel( const unsigned int level );
+
+		unsigned int m_LevelCount;			///< Anzahl der Stufen
+		unsigned int m_Level;				///< Aktuelle Stufe
+		bool m_Fixed;						///< Stufe festgehalten?
+		double m_Budget;					///< Zeitbudget pro Bild in ms
+		unsigned int m_Window;				///< Bilder pro Entscheidung
+		RollingStatistic m_FrameTime;		///< Bildzeiten seit dem letzten Stufenwechsel
+		unsigned int m_HeadroomFrames;		///< Aufeinanderfolgende Bilder mit Reserve
+		unsigned int m_UpFrames;			///< Noetige Bilder mit Reserve vor dem Hinaufschalten
+		bool m_SteppedUp;					///< War der letzte Wechsel ein Hinaufschalten?
+		unsigned long long m_Changes;		///< Anzahl der automatischen Stufenwechsel
+	};
+};
@@ -0,0 +1,76 @@
+#include "ScratchArena.h"
+#include "FramePool.h"
+
+namespace DirectLook
+{
+	static const size_t MIN_BLOCK_SIZE = 64 * 1024;
+
+	ScratchArena::ScratchArena(void)
+		:
+		m_BlockSize( 0 ),
+		m_Offset( 0 ),
+		m_TotalSize( 0 )
+	{
+	}
+
+	ScratchArena::~ScratchArena(void)
+	{
+		releaseBlocks();
+	}
+
+	void* ScratchArena::allocate( const size_t size )
+	{
+		// Keep every allocation on its own cache line
+		const size_t alignedSize = (size + FramePool::ALIGNMENT - 1) & ~(FramePool::ALIGNMENT - 1);
+
+		if(m_Blocks.empty() || m_Offset + alignedSize > m_BlockSize)
+		{
+			// Earlier pointers stay valid, so start a new block instead of growing the current one
+			const size_t blockSize = (alignedSize > MIN_BLOCK_SIZE) ? alignedSize : MIN_BLOCK_SIZE;
+			unsigned char* pBlock = FramePool::instance().acquireArray<unsigned char>( blockSize );
+			if(!pBlock)
+			{
+				return 0;
+			}
+
+			m_Blocks.push_back( pBlock );
+			m_BlockSize = blockSize;
+			m_Offset = 0;
+			m_TotalSize += blockSize;
+		}
+
+		void* pMemory = m_Blocks.back() + m_Offset;
+		m_Offset += alignedSize;
+		return pMemory;
+	}
+
+	void ScratchArena::reset(void)
+	{
+		if(m_Blocks.size() > 1)
+		{
+			const size_t totalSize = m_TotalSize;
+			releaseBlocks();
+
+			unsigned char* pBlock = FramePool::instance().acquireArray<unsigned char>( totalSize );
+			if(pBlock)
+			{
+				m_Blocks.push_back( pBlock );
+				m_BlockSize = totalSize;
+				m_TotalSize = totalSize;
+			}
+		}
+		m_Offset = 0;
+	}
+
+	void ScratchArena::releaseBlocks(void)
+	{
+		for(size_t i = 0; i < m_Blocks.size(); i++)
+		{
+			FramePool::instance().release( m_Blocks[i] );
+		}
+		m_Blocks.clear();
+		m_BlockSize = 0;
+		m_Offset = 0;
+		m_TotalSize = 0;
+	}
+};
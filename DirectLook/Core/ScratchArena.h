@@ -0,0 +1,71 @@
+#pragma once
+
+#include <vector>
+#include <stddef.h>
+
+#include "../NonCopyable.h"
+
+namespace DirectLook
+{
+	/// \brief Die Klasse ScratchArena stellt kurzlebigen Zwischenspeicher fuer eine Aufgabe bereit.
+	///
+	/// Speicher wird linear aus Bloecken des FramePool vergeben und mit reset() auf einen Schlag
+	/// wieder freigegeben. Jeder Worker des TaskPool besitzt eine eigene Arena, die vor jeder Aufgabe
+	/// zurueckgesetzt wird. Eine Arena darf nur von einem Thread gleichzeitig verwendet werden.
+	class ScratchArena : public NonCopyable
+	{
+
+	public:
+		////////////////////////////////////////////////////////////
+		/// \brief Standardkonstruktor
+		///
+		/// Es wird erst beim ersten allocate() Speicher angefordert.
+		///
+		////////////////////////////////////////////////////////////
+		ScratchArena(void);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Destruktor
+		///
+		/// Gibt alle Bloecke an den FramePool zurueck.
+		///
+		////////////////////////////////////////////////////////////
+		~ScratchArena(void);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Vergibt "size" Byte, 64 Byte ausgerichtet.
+		///
+		/// \param size Groesse in Byte
+		///
+		/// \return Zeiger auf den Speicher, gueltig bis zum naechsten reset()
+		///
+		////////////////////////////////////////////////////////////
+		void* allocate( const size_t size );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Vergibt ein Feld mit "count" Elementen vom Typ T.
+		////////////////////////////////////////////////////////////
+		template<typename T>
+		T* allocateArray( const size_t count )
+		{
+			return static_cast<T*>( allocate( count * sizeof( T ) ) );
+		}
+
+		////////////////////////////////////////////////////////////
+		/// \brief Gibt allen vergebenen Speicher frei.
+		///
+		/// Wurden seit dem letzten reset() mehrere Bloecke benoetigt, werden sie zu einem
+		/// Block zusammengefasst, damit die naechste Aufgabe ohne weitere Anforderung auskommt.
+		///
+		////////////////////////////////////////////////////////////
+		void reset(void);
+
+	private:
+		void releaseBlocks(void);
+
+		std::vector<unsigned char*> m_Blocks;	///< Angeforderte Bloecke, der letzte ist der aktuelle
+		size_t m_BlockSize;						///< Groesse des aktuellen Blocks
+		size_t m_Offset;						///< Belegte Byte im aktuellen Block
+		size_t m_TotalSize;						///< Summe aller Blockgroessen
+	};
+};
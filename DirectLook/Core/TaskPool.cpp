@@ -0,0 +1,392 @@
+#include "TaskPool.h"
+#include "FramePool.h"
+#include "Trace.h"
+
+#include <QThread>
+
+#include <sstream>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#ifdef _MSC_VER
+#define DIRECTLOOK_THREAD_LOCAL __declspec(thread)
+#else
+#define DIRECTLOOK_THREAD_LOCAL __thread
+#endif
+
+namespace DirectLook
+{
+	// Settings for the shared pool, see TaskPool::configure()
+	static unsigned int s_ThreadCount = 0;
+	static bool s_PinThreads = false;
+	static bool s_Started = false;
+
+	// Index of the worker running on this thread, -1 outside the pool
+	static DIRECTLOOK_THREAD_LOCAL int t_WorkerIndex = -1;
+
+	class TaskPool::Worker : public QThread
+	{
+
+	public:
+		Worker( TaskPool& pool, const unsigned int index )
+			:
+			m_Pool( pool ),
+			m_Index( index )
+		{
+		}
+
+	protected:
+		void run(void)
+		{
+			m_Pool.workerLoop( m_Index );
+		}
+
+	private:
+		TaskPool& m_Pool;
+		unsigned int m_Index;
+	};
+
+#pragma region TaskGroup
+	TaskGroup::TaskGroup( TaskPool& pool )
+		:
+		m_Pool( pool ),
+		m_Pending( 0 )
+	{
+	}
+
+	TaskGroup::~TaskGroup(void)
+	{
+		wait();
+	}
+
+	void TaskGroup::run( const Task& task )
+	{
+		m_Pending.ref();
+
+		TaskPool::TaskItem item;
+		item.m_Task = task;
+		item.m_pGroup = this;
+		m_Pool.push( item );
+	}
+
+	void TaskGroup::wait(void)
+	{
+		// A worker must not block here: the tasks it waits for may sit in its own queue
+		const int workerIndex = TaskPool::currentWorker();
+		if(workerIndex >= 0)
+		{
+			while(m_Pending > 0)
+			{
+				if(!m_Pool.tryExecute( workerIndex ))
+				{
+					QThread::yieldCurrentThread();
+				}
+			}
+		}
+
+		// Taking the lock also makes sure the last finishTask() has left the group
+		m_Mutex.lock();
+		while(m_Pending > 0)
+		{
+			m_Done.wait( &m_Mutex );
+		}
+		m_Mutex.unlock();
+	}
+
+	void TaskGroup::finishTask(void)
+	{
+		m_Mutex.lock();
+		if(!m_Pending.deref())
+		{
+			m_Done.wakeAll();
+		}
+		m_Mutex.unlock();
+	}
+#pragma endregion
+
+#pragma region TaskPool
+	TaskPool& TaskPool::instance(void)
+	{
+		// The worker arenas return their blocks to the FramePool on shutdown, so it has to outlive this pool
+		FramePool::instance();
+
+		static TaskPool pool( s_ThreadCount, s_PinThreads );
+		return pool;
+	}
+
+	bool TaskPool::configure( const unsigned int threadCount, const bool pinThreads )
+	{
+		if(s_Started)
+		{
+			return false;
+		}
+
+		s_ThreadCount = threadCount;
+		s_PinThreads = pinThreads;
+		return true;
+	}
+
+	int TaskPool::currentWorker(void)
+	{
+		return t_WorkerIndex;
+	}
+
+	TaskPool::TaskPool( const unsigned int threadCount, const bool pinThreads )
+		:
+		m_QueuedTasks( 0 ),
+		m_NextQueue( 0 ),
+		m_Stop( 0 ),
+		m_PinThreads( pinThreads )
+	{
+		s_Started = true;
+
+		unsigned int count = threadCount;
+		if(count == 0)
+		{
+			const int idealCount = QThread::idealThreadCount();
+			count = (idealCount > 0) ? (unsigned int) idealCount : 1;
+		}
+
+		for(unsigned int i = 0; i < count; i++)
+		{
+			m_Queues.push_back( new WorkerQueue );
+			m_Scratch.push_back( new ScratchArena );
+		}
+
+		// Start the threads only once all queues exist, they steal from each other right away
+		for(unsigned int i = 0; i < count; i++)
+		{
+			m_Workers.push_back( new Worker( *this, i ) );
+			m_Workers.back()->start();
+		}
+	}
+
+	TaskPool::~TaskPool(void)
+	{
+		m_SleepMutex.lock();
+		m_Stop = 1;
+		m_WorkAvailable.wakeAll();
+		m_SleepMutex.unlock();
+
+		for(size_t i = 0; i < m_Workers.size(); i++)
+		{
+			m_Workers[i]->wait();
+			delete m_Workers[i];
+		}
+
+		for(size_t i = 0; i < m_Queues.size(); i++)
+		{
+			delete m_Queues[i];
+			delete m_Scratch[i];
+		}
+	}
+
+	unsigned int TaskPool::getThreadCount(void) const
+	{
+		return (unsigned int) m_Workers.size();
+	}
+
+	void TaskPool::parallelFor( const unsigned int begin, const unsigned int end, const unsigned int grain, const std::function<void( unsigned int, unsigned int, ScratchArena& )>& body )
+	{
+		if(end <= begin)
+		{
+			return;
+		}
+
+		// Aim for a few chunks per worker so stealing can even out uneven chunks
+		const unsigned int count = end - begin;
+		const unsigned int minChunk = (grain > 0) ? grain : 1;
+		unsigned int chunk = count / (getThreadCount() * 4);
+		if(chunk < minChunk)
+		{
+			chunk = minChunk;
+		}
+
+		if(chunk >= count || getThreadCount() <= 1)
+		{
+			ScratchArena scratch;
+			body( begin, end, scratch );
+			return;
+		}
+
+		TaskGroup group( *this );
+		for(unsigned int first = begin; first < end; first += chunk)
+		{
+			const unsigned int last = (end - first > chunk) ? first + chunk : end;
+			group.run( [&body, first, last]( ScratchArena& scratch )
+			{
+				body( first, last, scratch );
+			} );
+		}
+		group.wait();
+	}
+
+	void TaskPool::parallelFor2D( const unsigned int width, const unsigned int height, const unsigned int tileWidth, const unsigned int tileHeight, const std::function<void( const TileRange&, ScratchArena& )>& body )
+	{
+		if(width == 0 || height == 0)
+		{
+			return;
+		}
+
+		const unsigned int stepX = (tileWidth  > 0 && tileWidth  < width)  ? tileWidth  : width;
+		const unsigned int stepY = (tileHeight > 0 && tileHeight < height) ? tileHeight : height;
+		const bool singleTile = (stepX == width && stepY == height);
+
+		ScratchArena inlineScratch;
+		TaskGroup group( *this );
+
+		for(unsigned int y = 0; y < height; y += stepY)
+		{
+			for(unsigned int x = 0; x < width; x += stepX)
+			{
+				TileRange tile;
+				tile.m_X0 = x;
+				tile.m_Y0 = y;
+				tile.m_X1 = (width  - x > stepX) ? x + stepX : width;
+				tile.m_Y1 = (height - y > stepY) ? y + stepY : height;
+
+				if(singleTile || getThreadCount() <= 1)
+				{
+					inlineScratch.reset();
+					body( tile, inlineScratch );
+				}
+				else
+				{
+					group.run( [&body, tile]( ScratchArena& scratch )
+					{
+						body( tile, scratch );
+					} );
+				}
+			}
+		}
+
+		group.wait();
+	}
+
+	void TaskPool::push( const TaskItem& item )
+	{
+		// Workers keep their own tasks local, everybody else spreads them round robin
+		const int workerIndex = currentWorker();
+		const unsigned int queueIndex = (workerIndex >= 0)
+			? (unsigned int) workerIndex
+			: (unsigned int) m_NextQueue.fetchAndAddOrdered( 1 ) % m_Queues.size();
+
+		WorkerQueue* pQueue = m_Queues[queueIndex];
+		pQueue->m_Mutex.lock();
+		pQueue->m_Tasks.push_back( item );
+		pQueue->m_Mutex.unlock();
+		m_QueuedTasks.ref();
+
+		m_SleepMutex.lock();
+		m_WorkAvailable.wakeOne();
+		m_SleepMutex.unlock();
+	}
+
+	bool TaskPool::pop( const unsigned int workerIndex, TaskItem& item )
+	{
+		const size_t queueCount = m_Queues.size();
+
+		// Own queue first (newest task, still warm in the cache), then steal the oldest task of the others
+		for(size_t i = 0; i < queueCount; i++)
+		{
+			WorkerQueue* pQueue = m_Queues[(workerIndex + i) % queueCount];
+			pQueue->m_Mutex.lock();
+			if(!pQueue->m_Tasks.empty())
+			{
+				if(i == 0)
+				{
+					item = pQueue->m_Tasks.back();
+					pQueue->m_Tasks.pop_back();
+				}
+				else
+				{
+					item = pQueue->m_Tasks.front();
+					pQueue->m_Tasks.pop_front();
+				}
+				pQueue->m_Mutex.unlock();
+				m_QueuedTasks.deref();
+				return true;
+			}
+			pQueue->m_Mutex.unlock();
+		}
+		return false;
+	}
+
+	bool TaskPool::tryExecute( const unsigned int workerIndex )
+	{
+		TaskItem item;
+		if(!pop( workerIndex, item ))
+		{
+			return false;
+		}
+
+		// Nested waits run tasks on the same worker, so only reset the arena at the outermost level
+		ScratchArena* pScratch = m_Scratch[workerIndex];
+		static DIRECTLOOK_THREAD_LOCAL unsigned int depth = 0;
+		if(depth == 0)
+		{
+			pScratch->reset();
+		}
+
+		depth++;
+		item.m_Task( *pScratch );
+		depth--;
+
+		item.m_pGroup->finishTask();
+		return true;
+	}
+
+	void TaskPool::workerLoop( const unsigned int workerIndex )
+	{
+		t_WorkerIndex = (int) workerIndex;
+#ifdef DIRECTLOOK_TRACE
+		std::ostringstream threadName;
+		threadName << "TaskPool worker " << workerIndex;
+		DL_TRACE_THREAD_NAME( threadName.str() );
+#endif
+
+		if(m_PinThreads)
+		{
+			pinCurrentThread( workerIndex );
+		}
+
+		while(m_Stop == 0)
+		{
+			if(tryExecute( workerIndex ))
+			{
+				continue;
+			}
+
+			m_SleepMutex.lock();
+			if(m_QueuedTasks == 0 && m_Stop == 0)
+			{
+				m_WorkAvailable.wait( &m_SleepMutex );
+			}
+			m_SleepMutex.unlock();
+		}
+	}
+
+	void TaskPool::pinCurrentThread( const unsigned int workerIndex )
+	{
+		const int coreCount = QThread::idealThreadCount();
+		const unsigned int core = (coreCount > 0) ? workerIndex % (unsigned int) coreCount : workerIndex;
+
+#ifdef _WIN32
+		if(core < sizeof( DWORD_PTR ) * 8)
+		{
+			SetThreadAffinityMask( GetCurrentThread(), ((DWORD_PTR) 1) << core );
+		}
+#else
+		cpu_set_t cpuSet;
+		CPU_ZERO( &cpuSet );
+		CPU_SET( core, &cpuSet );
+		pthread_setaffinity_np( pthread_self(), sizeof( cpuSet ), &cpuSet );
+#endif
+	}
+#pragma endregion
+};
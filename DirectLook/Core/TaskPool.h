@@ -0,0 +1,196 @@
+#pragma once
+
+#include <QAtomicInt>
+#include <QMutex>
+#include <QWaitCondition>
+
+#include <deque>
+#include <functional>
+#include <vector>
+
+#include "../NonCopyable.h"
+#include "ScratchArena.h"
+
+namespace DirectLook
+{
+	class TaskPool;
+
+	/// \brief Rechteckiger Bildausschnitt [m_X0, m_X1) x [m_Y0, m_Y1), siehe TaskPool::parallelFor2D().
+	struct TileRange
+	{
+		unsigned int m_X0;	///< Erste Spalte
+		unsigned int m_Y0;	///< Erste Zeile
+		unsigned int m_X1;	///< Erste Spalte hinter dem Ausschnitt
+		unsigned int m_Y1;	///< Erste Zeile hinter dem Ausschnitt
+	};
+
+	/// \brief Die Klasse TaskGroup fasst Aufgaben zusammen, auf deren Ende gemeinsam gewartet wird.
+	///
+	/// Der Destruktor wartet auf alle noch offenen Aufgaben der Gruppe.
+	class TaskGroup : public NonCopyable
+	{
+
+	public:
+		typedef std::function<void( ScratchArena& )> Task;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Konstruktor
+		///
+		/// \param pool TaskPool, der die Aufgaben ausfuehrt
+		///
+		////////////////////////////////////////////////////////////
+		explicit TaskGroup( TaskPool& pool );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Destruktor
+		///
+		/// Wartet auf alle offenen Aufgaben der Gruppe.
+		///
+		////////////////////////////////////////////////////////////
+		~TaskGroup(void);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Reiht eine Aufgabe in den TaskPool ein.
+		///
+		/// \param task Aufgabe, erhaelt die Scratch-Arena des ausfuehrenden Workers
+		///
+		////////////////////////////////////////////////////////////
+		void run( const Task& task );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Wartet, bis alle Aufgaben der Gruppe erledigt sind.
+		///
+		/// Ein Worker des Pools arbeitet waehrenddessen weitere Aufgaben ab, andere Threads schlafen.
+		///
+		////////////////////////////////////////////////////////////
+		void wait(void);
+
+	private:
+		friend class TaskPool;
+
+		void finishTask(void);
+
+		TaskPool& m_Pool;			///< Ausfuehrender TaskPool
+		QAtomicInt m_Pending;		///< Anzahl der offenen Aufgaben
+		QMutex m_Mutex;				///< Schuetzt m_Done
+		QWaitCondition m_Done;		///< Wird geweckt, wenn die letzte Aufgabe erledigt ist
+	};
+
+	/// \brief Die Klasse TaskPool verteilt Aufgaben auf einen gemeinsamen Satz von Worker-Threads.
+	///
+	/// Jeder Worker besitzt eine eigene Warteschlange. Neue Aufgaben eines Workers landen in seiner
+	/// eigenen Schlange und werden dort zuletzt-rein-zuerst-raus abgearbeitet; ist sie leer, stiehlt er
+	/// die aeltesten Aufgaben der anderen Worker (Work Stealing). Alle parallelen Stufen der Anwendung
+	/// teilen sich diesen Pool, damit die CPU nicht ueberbelegt wird.
+	class TaskPool : public NonCopyable
+	{
+
+	public:
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert den gemeinsamen Pool der Anwendung zurueck.
+		///
+		/// Die Worker werden beim ersten Aufruf mit den Werten aus configure() gestartet.
+		///
+		////////////////////////////////////////////////////////////
+		static TaskPool& instance(void);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Legt Threadanzahl und Kernbindung fest. Muss vor dem ersten instance() aufgerufen werden.
+		///
+		/// \param threadCount	Anzahl der Worker (0 = Anzahl der logischen Kerne)
+		/// \param pinThreads	Worker i wird fest an den logischen Kern i gebunden
+		///
+		/// \return false, wenn der Pool bereits laeuft
+		///
+		////////////////////////////////////////////////////////////
+		static bool configure( const unsigned int threadCount, const bool pinThreads );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert den Index des aufrufenden Workers zurueck (-1 fuer Threads ausserhalb des Pools).
+		////////////////////////////////////////////////////////////
+		static int currentWorker(void);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Destruktor
+		///
+		/// Beendet alle Worker. Noch eingereihte Aufgaben werden verworfen.
+		///
+		////////////////////////////////////////////////////////////
+		~TaskPool(void);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert die Anzahl der Worker zurueck.
+		////////////////////////////////////////////////////////////
+		unsigned int getThreadCount(void) const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Fuehrt "body" parallel fuer Teilbereiche von [begin, end) aus und wartet auf das Ergebnis.
+		///
+		/// \param begin	Erster Index
+		/// \param end		Index hinter dem letzten Element
+		/// \param grain	Mindestanzahl der Indizes pro Aufgabe
+		/// \param body		Wird mit (first, last, scratch) fuer den Teilbereich [first, last) aufgerufen
+		///
+		////////////////////////////////////////////////////////////
+		void parallelFor( const unsigned int begin, const unsigned int end, const unsigned int grain, const std::function<void( unsigned int, unsigned int, ScratchArena& )>& body );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Zerlegt ein Bild in Kacheln und fuehrt "body" parallel fuer jede Kachel aus.
+		///
+		/// Fuer zeilenweise Filter bietet sich tileWidth = width an, dann ist jede Kachel ein
+		/// zusammenhaengender Speicherbereich.
+		///
+		/// \param width		Bildbreite
+		/// \param height		Bildhoehe
+		/// \param tileWidth	Kachelbreite
+		/// \param tileHeight	Kachelhoehe
+		/// \param body			Wird mit (tile, scratch) fuer jede Kachel aufgerufen
+		///
+		////////////////////////////////////////////////////////////
+		void parallelFor2D( const unsigned int width, const unsigned int height, const unsigned int tileWidth, const unsigned int tileHeight, const std::function<void( const TileRange&, ScratchArena& )>& body );
+
+	private:
+		friend class TaskGroup;
+
+		class Worker;
+
+		/// \brief Eingereihte Aufgabe
+		struct TaskItem
+		{
+			TaskGroup::Task m_Task;		///< Auszufuehrende Funktion
+			TaskGroup* m_pGroup;		///< Gruppe, der das Ende gemeldet wird
+		};
+
+		/// \brief Warteschlange eines Workers
+		struct WorkerQueue
+		{
+			QMutex m_Mutex;					///< Schuetzt m_Tasks (Besitzer und Diebe)
+			std::deque<TaskItem> m_Tasks;	///< Besitzer arbeitet hinten, Diebe nehmen vorne
+		};
+
+		////////////////////////////////////////////////////////////
+		/// \brief Privater Konstruktor, siehe instance().
+		////////////////////////////////////////////////////////////
+		TaskPool( const unsigned int threadCount, const bool pinThreads );
+
+		void push( const TaskItem& item );
+
+		bool pop( const unsigned int workerIndex, TaskItem& item );
+
+		bool tryExecute( const unsigned int workerIndex );
+
+		void workerLoop( const unsigned int workerIndex );
+
+		void pinCurrentThread( const unsigned int workerIndex );
+
+		std::vector<Worker*> m_Workers;			///< Worker-Threads
+		std::vector<WorkerQueue*> m_Queues;		///< Eine Warteschlange je Worker
+		std::vector<ScratchArena*> m_Scratch;	///< Eine Scratch-Arena je Worker
+		QAtomicInt m_QueuedTasks;				///< Anzahl der eingereihten, noch nicht begonnenen Aufgaben
+		QAtomicInt m_NextQueue;					///< Round-Robin-Zaehler fuer Aufgaben von ausserhalb des Pools
+		QAtomicInt m_Stop;						///< Worker beenden?
+		QMutex m_SleepMutex;					///< Schuetzt m_WorkAvailable
+		QWaitCondition m_WorkAvailable;			///< Weckt schlafende Worker
+		bool m_PinThreads;						///< Worker an Kerne binden?
+	};
+};
@@ -0,0 +1,204 @@
+#include "Trace.h"
+#include "Clock.h"
+
+#include <QAtomicInt>
+#include <QMutex>
+
+#include <iostream>
+#include <set>
+#include <vector>
+#include <stdio.h>
+
+#ifdef _MSC_VER
+#define DIRECTLOOK_THREAD_LOCAL __declspec(thread)
+#else
+#define DIRECTLOOK_THREAD_LOCAL __thread
+#endif
+
+namespace DirectLook
+{
+	struct TraceEvent
+	{
+		const char* m_pName;
+		unsigned long long m_Start;
+		unsigned long long m_Duration;
+	};
+
+	// Only the owning thread writes its buffer. It publishes new events by raising m_Count
+	// after the event is complete, so dump() can read up to m_Count without a lock.
+	struct TraceBuffer
+	{
+		std::vector<TraceEvent> m_Events;
+		QAtomicInt m_Count;
+		QAtomicInt m_Dropped;
+		unsigned int m_ThreadId;
+		std::string m_ThreadName;
+	};
+
+	static QAtomicInt s_Enabled( 0 );
+	static QMutex s_RegistryMutex;
+	static std::vector<TraceBuffer*> s_Buffers;
+	static std::set<std::string> s_Names;
+	static DIRECTLOOK_THREAD_LOCAL TraceBuffer* t_pBuffer = 0;
+
+	static TraceBuffer* threadBuffer(void)
+	{
+		if(!t_pBuffer)
+		{
+			TraceBuffer* pBuffer = new TraceBuffer;
+			pBuffer->m_Events.resize( Trace::EVENTS_PER_THREAD );
+
+			s_RegistryMutex.lock();
+			pBuffer->m_ThreadId = (unsigned int) s_Buffers.size() + 1;
+			s_Buffers.push_back( pBuffer );
+			s_RegistryMutex.unlock();
+
+			t_pBuffer = pBuffer;
+		}
+		return t_pBuffer;
+	}
+
+	static void writeEscaped( FILE* pFile, const char* pText )
+	{
+		for(; *pText; pText++)
+		{
+			if(*pText == '"' || *pText == '\\')
+			{
+				fputc( '\\', pFile );
+			}
+			fputc( *pText, pFile );
+		}
+	}
+
+#pragma region Trace
+	void Trace::setEnabled( const bool enabled )
+	{
+		s_Enabled = enabled ? 1 : 0;
+	}
+
+	bool Trace::isEnabled(void)
+	{
+		return s_Enabled != 0;
+	}
+
+	bool Trace::isCompiledIn(void)
+	{
+#ifdef DIRECTLOOK_TRACE
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	void Trace::record( const char* pName, const unsigned long long start, const unsigned long long duration )
+	{
+		TraceBuffer* pBuffer = threadBuffer();
+		const int index = pBuffer->m_Count;
+		if(index >= (int) EVENTS_PER_THREAD)
+		{
+			pBuffer->m_Dropped.ref();
+			return;
+		}
+
+		TraceEvent& event = pBuffer->m_Events[index];
+		event.m_pName = pName;
+		event.m_Start = start;
+		event.m_Duration = duration;
+		pBuffer->m_Count.fetchAndStoreOrdered( index + 1 );
+	}
+
+	void Trace::setThreadName( const std::string& name )
+	{
+		TraceBuffer* pBuffer = threadBuffer();
+		s_RegistryMutex.lock();
+		pBuffer->m_ThreadName = name;
+		s_RegistryMutex.unlock();
+	}
+
+	const char* Trace::intern( const std::string& name )
+	{
+		s_RegistryMutex.lock();
+		const char* pName = s_Names.insert( name ).first->c_str();
+		s_RegistryMutex.unlock();
+		return pName;
+	}
+
+	bool Trace::dump( const std::string& fileName )
+	{
+		FILE* pFile = fopen( fileName.c_str(), "w" );
+		if(!pFile)
+		{
+			std::cerr << "Couldn't write trace " << fileName << std::endl;
+			return false;
+		}
+
+		s_RegistryMutex.lock();
+		const std::vector<TraceBuffer*> buffers = s_Buffers;
+		std::vector<std::string> threadNames;
+		for(size_t i = 0; i < buffers.size(); i++)
+		{
+			threadNames.push_back( buffers[i]->m_ThreadName );
+		}
+		s_RegistryMutex.unlock();
+
+		fprintf( pFile, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n" );
+		bool first = true;
+		unsigned int dropped = 0;
+
+		for(size_t i = 0; i < buffers.size(); i++)
+		{
+			const TraceBuffer* pBuffer = buffers[i];
+			if(!threadNames[i].empty())
+			{
+				fprintf( pFile, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"", first ? "" : ",\n", pBuffer->m_ThreadId );
+				writeEscaped( pFile, threadNames[i].c_str() );
+				fprintf( pFile, "\"}}" );
+				first = false;
+			}
+
+			const int count = const_cast<QAtomicInt&>( pBuffer->m_Count ).fetchAndAddOrdered( 0 );
+			for(int e = 0; e < count; e++)
+			{
+				const TraceEvent& event = pBuffer->m_Events[e];
+				fprintf( pFile, "%s{\"name\":\"", first ? "" : ",\n" );
+				writeEscaped( pFile, event.m_pName );
+				fprintf( pFile, "\",\"cat\":\"DirectLook\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%llu,\"dur\":%llu}",
+					pBuffer->m_ThreadId, event.m_Start, event.m_Duration );
+				first = false;
+			}
+			dropped += (unsigned int) (int) pBuffer->m_Dropped;
+		}
+
+		fprintf( pFile, "\n]}\n" );
+		const bool success = (ferror( pFile ) == 0);
+		fclose( pFile );
+
+		if(dropped > 0)
+		{
+			std::cerr << "Trace: " << dropped << " events dropped, thread buffers were full" << std::endl;
+		}
+		return success;
+	}
+#pragma endregion
+
+#pragma region TraceScope
+	TraceScope::TraceScope( const char* pName )
+		:
+		m_pName( Trace::isEnabled() ? pName : 0 ),
+		m_Start( 0 )
+	{
+		if(m_pName)
+		{
+			m_Start = Clock::microseconds();
+		}
+	}
+
+	TraceScope::~TraceScope(void)
+	{
+		if(m_pName)
+		{
+			Trace::record( m_pName, m_Start, Clock::microseconds() - m_Start );
+		}
+	}
+#pragma endregion
+};
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <string>
+
+namespace DirectLook
+{
+	/// \brief Die Klasse Trace zeichnet Zeitabschnitte auf und speichert sie im Chrome trace_event Format.
+	///
+	/// Jeder Thread schreibt in einen eigenen Puffer fester Groesse, ohne Sperren. Aufgezeichnet wird nur,
+	/// wenn das Projekt mit DIRECTLOOK_TRACE uebersetzt wurde und setEnabled( true ) aufgerufen wurde;
+	/// ohne DIRECTLOOK_TRACE verschwinden die Makros DL_TRACE_SCOPE und DL_TRACE_THREAD_NAME vollstaendig.
+	/// Die Datei laesst sich in chrome://tracing oder Perfetto oeffnen.
+	class Trace
+	{
+
+	public:
+		static const unsigned int EVENTS_PER_THREAD = 1 << 16;	///< Kapazitaet eines Thread-Puffers
+
+		////////////////////////////////////////////////////////////
+		/// \brief Schaltet die Aufzeichnung an oder aus.
+		////////////////////////////////////////////////////////////
+		static void setEnabled( const bool enabled );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert true zurueck wenn gerade aufgezeichnet wird.
+		////////////////////////////////////////////////////////////
+		static bool isEnabled(void);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert true zurueck wenn das Projekt mit DIRECTLOOK_TRACE uebersetzt wurde.
+		////////////////////////////////////////////////////////////
+		static bool isCompiledIn(void);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Speichert einen abgeschlossenen Zeitabschnitt im Puffer des aufrufenden Threads.
+		///
+		/// \param pName		Name des Abschnitts (muss bis zum dump() gueltig bleiben, siehe intern())
+		/// \param start		Beginn in Mikrosekunden (Clock::microseconds())
+		/// \param duration		Dauer in Mikrosekunden
+		///
+		////////////////////////////////////////////////////////////
+		static void record( const char* pName, const unsigned long long start, const unsigned long long duration );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Benennt den aufrufenden Thread in der Ausgabe.
+		////////////////////////////////////////////////////////////
+		static void setThreadName( const std::string& name );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert eine dauerhaft gueltige Kopie von "name" zurueck, z.B. fuer Namen zur Laufzeit.
+		////////////////////////////////////////////////////////////
+		static const char* intern( const std::string& name );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Schreibt alle bisher aufgezeichneten Abschnitte als JSON-Datei.
+		///
+		/// Darf aufgerufen werden, waehrend andere Threads weiter aufzeichnen.
+		///
+		/// \param fileName Zieldatei
+		///
+		/// \return True wenn erfolgreich, false wenn fehlgeschlagen
+		///
+		////////////////////////////////////////////////////////////
+		static bool dump( const std::string& fileName );
+	};
+
+	/// \brief Misst die Lebensdauer des Objektes als Zeitabschnitt, siehe DL_TRACE_SCOPE.
+	class TraceScope
+	{
+
+	public:
+		explicit TraceScope( const char* pName );
+
+		~TraceScope(void);
+
+	private:
+		const char* m_pName;			///< Name des Abschnitts (0 = Aufzeichnung war beim Beginn aus)
+		unsigned long long m_Start;		///< Beginn in Mikrosekunden
+	};
+};
+
+#ifdef DIRECTLOOK_TRACE
+#define DL_TRACE_CONCAT_IMPL( a, b ) a##b
+#define DL_TRACE_CONCAT( a, b ) DL_TRACE_CONCAT_IMPL( a, b )
+#define DL_TRACE_SCOPE( name ) DirectLook::TraceScope DL_TRACE_CONCAT( traceScope, __LINE__ )( name )
+#define DL_TRACE_THREAD_NAME( name ) DirectLook::Trace::setThreadName( name )
+#else
+#define DL_TRACE_SCOPE( name )
+#define DL_TRACE_THREAD_NAME( name )
+#endif
@@ -0,0 +1,258 @@
+#include "BitMask.h"
+#include "../Core/Trace.h"
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+namespace DirectLook
+{
+	static inline unsigned int countTrailingZeros( const unsigned long long word )
+	{
+		// Callers never pass 0
+#if defined(_MSC_VER) && defined(_M_X64)
+		unsigned long index;
+		_BitScanForward64( &index, word );
+		return (unsigned int) index;
+#elif defined(__GNUC__)
+		return (unsigned int) __builtin_ctzll( word );
+#else
+		unsigned int count = 0;
+		while(((word >> count) & 1) == 0)
+		{
+			count++;
+		}
+		return count;
+#endif
+	}
+
+	static inline unsigned int countBits( const unsigned long long word )
+	{
+#if defined(_MSC_VER) && defined(_M_X64)
+		return (unsigned int) __popcnt64( word );
+#elif defined(__GNUC__)
+		return (unsigned int) __builtin_popcountll( word );
+#else
+		unsigned long long bits = word;
+		unsigned int count = 0;
+		while(bits)
+		{
+			bits &= bits - 1;
+			count++;
+		}
+		return count;
+#endif
+	}
+
+	// Bits x0 to x1 - 1 of one word, 0 <= x0 < x1 <= 64
+	static inline unsigned long long rangeBits( const unsigned int x0, const unsigned int x1 )
+	{
+		const unsigned long long upper = (x1 >= BitMask::WORD_BITS) ? ~0ULL : (1ULL << x1) - 1;
+		return upper & ~((1ULL << x0) - 1);
+	}
+
+	BitMask::BitMask(void)
+		:
+		m_Width( 0 ),
+		m_Height( 0 ),
+		m_WordsPerRow( 0 )
+	{
+	}
+
+	void BitMask::resize( const unsigned int width, const unsigned int height )
+	{
+		m_Width = width;
+		m_Height = height;
+		m_WordsPerRow = (width + WORD_BITS - 1) / WORD_BITS;
+		m_Words.assign( m_WordsPerRow * height, 0 );
+		m_RowCounts.assign( height, 0 );
+	}
+
+	void BitMask::clear(void)
+	{
+		m_Words.assign( m_Words.size(), 0 );
+		m_RowCounts.assign( m_RowCounts.size(), 0 );
+	}
+
+	unsigned int BitMask::threshold(
+		const unsigned short* pDepthPixels, const unsigned int width, const unsigned int height,
+		const unsigned short nearThreshold, const unsigned short farThreshold,
+		const bool mirror, const TileRange& region, unsigned int* pNearestIndex
+	)
+	{
+		DL_TRACE_SCOPE( "BitMask::threshold" );
+		if(width != m_Width || height != m_Height)
+		{
+			resize( width, height );
+		}
+		else
+		{
+			clear();
+		}
+
+		const unsigned int x0 = (region.m_X0 < width)  ? region.m_X0 : width;
+		const unsigned int y0 = (region.m_Y0 < height) ? region.m_Y0 : height;
+		const unsigned int x1 = (region.m_X1 < width)  ? ((region.m_X1 > x0) ? region.m_X1 : x0) : width;
+		const unsigned int y1 = (region.m_Y1 < height) ? ((region.m_Y1 > y0) ? region.m_Y1 : y0) : height;
+
+		// Mask columns covering the region
+		const unsigned int maskX0 = mirror ? width - x1 : x0;
+		const unsigned int maskX1 = mirror ? width - x0 : x1;
+
+		unsigned short nearest = 0;
+		unsigned int nearestIndex = 0;
+		unsigned int count = 0;
+
+		for(unsigned int y = y0; y < y1; y++)
+		{
+			const unsigned short* pRow = pDepthPixels + y * width;
+			unsigned long long* pWords = &m_Words[y * m_WordsPerRow];
+			unsigned int rowCount = 0;
+
+			for(unsigned int x = maskX0; x < maskX1; )
+			{
+				const unsigned int wordEnd = ((x / WORD_BITS + 1) * WORD_BITS < maskX1) ? (x / WORD_BITS + 1) * WORD_BITS : maskX1;
+				unsigned long long bits = 0;
+				for(; x < wordEnd; x++)
+				{
+					const unsigned short depth = pRow[mirror ? width - 1 - x : x];
+					const bool valid = depth >= nearThreshold && depth <= farThreshold;
+					bits |= (unsigned long long) valid << (x % WORD_BITS);
+					if(valid && (nearest == 0 || depth < nearest))
+					{
+						nearest = depth;
+						nearestIndex = y * width + x;
+					}
+				}
+				pWords[(wordEnd - 1) / WORD_BITS] = bits;
+				rowCount += countBits( bits );
+			}
+
+			m_RowCounts[y] = rowCount;
+			count += rowCount;
+		}
+
+		if(pNearestIndex)
+		{
+			*pNearestIndex = nearestIndex;
+		}
+		return count;
+	}
+
+	void BitMask::setRange( const unsigned int y, const unsigned int x0, const unsigned int x1 )
+	{
+		unsigned long long* pWords = &m_Words[y * m_WordsPerRow];
+		for(unsigned int x = x0; x < x1; )
+		{
+			const unsigned int word = x / WORD_BITS;
+			const unsigned int wordEnd = ((word + 1) * WORD_BITS < x1) ? (word + 1) * WORD_BITS : x1;
+			const unsigned long long bits = rangeBits( x % WORD_BITS, wordEnd - word * WORD_BITS );
+			m_RowCounts[y] += countBits( bits & ~pWords[word] );
+			pWords[word] |= bits;
+			x = wordEnd;
+		}
+	}
+
+	void BitMask::clearRange( const unsigned int y, const unsigned int x0, const unsigned int x1 )
+	{
+		unsigned long long* pWords = &m_Words[y * m_WordsPerRow];
+		for(unsigned int x = x0; x < x1; )
+		{
+			const unsigned int word = x / WORD_BITS;
+			const unsigned int wordEnd = ((word + 1) * WORD_BITS < x1) ? (word + 1) * WORD_BITS : x1;
+			const unsigned long long bits = rangeBits( x % WORD_BITS, wordEnd - word * WORD_BITS );
+			m_RowCounts[y] -= countBits( bits & pWords[word] );
+			pWords[word] &= ~bits;
+			x = wordEnd;
+		}
+	}
+
+	void BitMask::updateRowCount( const unsigned int y )
+	{
+		unsigned long long* pWords = &m_Words[y * m_WordsPerRow];
+		if(m_WordsPerRow > 0 && m_Width % WORD_BITS != 0)
+		{
+			pWords[m_WordsPerRow - 1] &= rangeBits( 0, m_Width % WORD_BITS );
+		}
+
+		unsigned int count = 0;
+		for(unsigned int word = 0; word < m_WordsPerRow; word++)
+		{
+			count += countBits( pWords[word] );
+		}
+		m_RowCounts[y] = count;
+	}
+
+	void BitMask::appendRuns( const unsigned int y, std::vector<MaskRun>& runs ) const
+	{
+		if(m_RowCounts[y] == 0)
+		{
+			return;
+		}
+
+		const unsigned long long* pWords = &m_Words[y * m_WordsPerRow];
+		bool open = false;		// A run continues from the previous word
+		for(unsigned int word = 0; word < m_WordsPerRow; word++)
+		{
+			unsigned long long bits = pWords[word];
+			const unsigned int base = word * WORD_BITS;
+
+			if(bits == 0)
+			{
+				if(open)
+				{
+					runs.back().m_X1 = (unsigned short) base;
+					open = false;
+				}
+				continue;
+			}
+
+			unsigned int position = 0;
+			while(position < WORD_BITS)
+			{
+				if(!open)
+				{
+					// Next set bit starts a run
+					const unsigned long long remaining = (position == 0) ? bits : bits >> position;
+					if(remaining == 0)
+					{
+						break;
+					}
+					position += countTrailingZeros( remaining );
+					MaskRun run;
+					run.m_X0 = (unsigned short) (base + position);
+					run.m_X1 = run.m_X0;
+					runs.push_back( run );
+					open = true;
+				}
+				else
+				{
+					// Next clear bit ends it
+					const unsigned long long remaining = (position == 0) ? ~bits : ~bits >> position;
+					if(remaining == 0)
+					{
+						break;
+					}
+					position += countTrailingZeros( remaining );
+					runs.back().m_X1 = (unsigned short) (base + position);
+					open = false;
+				}
+			}
+		}
+
+		if(open)
+		{
+			runs.back().m_X1 = (unsigned short) m_Width;
+		}
+	}
+
+	unsigned int BitMask::getCount(void) const
+	{
+		unsigned int count = 0;
+		for(size_t y = 0; y < m_RowCounts.size(); y++)
+		{
+			count += m_RowCounts[y];
+		}
+		return count;
+	}
+};
@@ -0,0 +1,138 @@
+#pragma once
+
+#include "../Core/TaskPool.h"
+
+#include <vector>
+
+namespace DirectLook
+{
+	/// \brief Zusammenhaengende gesetzte Pixel einer Zeile, siehe BitMask::appendRuns().
+	struct MaskRun
+	{
+		unsigned short m_X0;	///< Erste Spalte
+		unsigned short m_X1;	///< Erste Spalte hinter dem Lauf
+	};
+
+	/// \brief Die Klasse BitMask speichert ein Bit pro Pixel, 64 Pixel pro Wort.
+	///
+	/// Bit "x % 64" des Wortes "x / 64" einer Zeile gehoert zur Spalte x. Jede Zeile beginnt mit einem
+	/// neuen Wort, die Bits hinter der Bildbreite sind immer 0. Zusaetzlich wird die Anzahl der gesetzten
+	/// Bits pro Zeile gefuehrt, damit Verbraucher leere Zeilen und leere Woerter ohne weitere Pruefung
+	/// ueberspringen koennen.
+	class BitMask
+	{
+
+	public:
+		static const unsigned int WORD_BITS = 64;	///< Pixel pro Wort
+
+		////////////////////////////////////////////////////////////
+		/// \brief Standardkonstruktor
+		///
+		/// Erzeugt eine leere Maske ohne Pixel.
+		///
+		////////////////////////////////////////////////////////////
+		BitMask(void);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Setzt die Groesse der Maske und loescht alle Bits.
+		///
+		/// \param width  Breite in Pixeln
+		/// \param height Hoehe in Pixeln
+		///
+		////////////////////////////////////////////////////////////
+		void resize( const unsigned int width, const unsigned int height );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Loescht alle Bits.
+		////////////////////////////////////////////////////////////
+		void clear(void);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Setzt die Bits aller Pixel, deren Tiefenwert zwischen "nearThreshold" und "farThreshold" liegt.
+		///
+		/// Die Maske erhaelt die Groesse der Tiefenkarte, Bits ausserhalb von "region" bleiben 0.
+		///
+		/// \param pDepthPixels  Tiefenwerte (width x height)
+		/// \param width         Breite der Tiefenkarte
+		/// \param height        Hoehe der Tiefenkarte
+		/// \param nearThreshold Kleinster gueltiger Tiefenwert
+		/// \param farThreshold  Groesster gueltiger Tiefenwert
+		/// \param mirror        Spalten gespiegelt ablegen (Bit x gehoert zum Tiefenwert width - 1 - x)
+		/// \param region        Ausgewerteter Ausschnitt in Koordinaten der Tiefenkarte
+		/// \param pNearestIndex Erhaelt den Index (y * width + x in der Maske) des naechsten gueltigen Pixels (0 = nicht benoetigt)
+		///
+		/// \return Anzahl der gesetzten Bits
+		///
+		////////////////////////////////////////////////////////////
+		unsigned int threshold(
+			const unsigned short* pDepthPixels, const unsigned int width, const unsigned int height,
+			const unsigned short nearThreshold, const unsigned short farThreshold,
+			const bool mirror, const TileRange& region, unsigned int* pNearestIndex = 0
+		);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Setzt die Bits der Spalten "x0" bis "x1 - 1" in Zeile "y".
+		////////////////////////////////////////////////////////////
+		void setRange( const unsigned int y, const unsigned int x0, const unsigned int x1 );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Loescht die Bits der Spalten "x0" bis "x1 - 1" in Zeile "y".
+		////////////////////////////////////////////////////////////
+		void clearRange( const unsigned int y, const unsigned int x0, const unsigned int x1 );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Haengt die Laeufe gesetzter Bits der Zeile "y" von links nach rechts an "runs" an.
+		///
+		/// Leere Woerter werden dabei ganz uebersprungen.
+		///
+		////////////////////////////////////////////////////////////
+		void appendRuns( const unsigned int y, std::vector<MaskRun>& runs ) const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert true zurueck, wenn das Bit des Pixels (x, y) gesetzt ist.
+		////////////////////////////////////////////////////////////
+		bool isSet( const unsigned int x, const unsigned int y ) const
+		{
+			return ((m_Words[y * m_WordsPerRow + x / WORD_BITS] >> (x % WORD_BITS)) & 1) != 0;
+		}
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert die Woerter der Zeile "y" zurueck.
+		////////////////////////////////////////////////////////////
+		const unsigned long long* getRow( const unsigned int y ) const { return &m_Words[y * m_WordsPerRow]; }
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert die Woerter der Zeile "y" zum Ueberschreiben zurueck.
+		///
+		/// Nach dem Schreiben muss updateRowCount() fuer die Zeile aufgerufen werden.
+		///
+		////////////////////////////////////////////////////////////
+		unsigned long long* getMutableRow( const unsigned int y ) { return &m_Words[y * m_WordsPerRow]; }
+
+		////////////////////////////////////////////////////////////
+		/// \brief Loescht die Bits hinter der Bildbreite und zaehlt die gesetzten Bits der Zeile "y" neu.
+		////////////////////////////////////////////////////////////
+		void updateRowCount( const unsigned int y );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert true zurueck, wenn in Zeile "y" kein Bit gesetzt ist.
+		////////////////////////////////////////////////////////////
+		bool isRowEmpty( const unsigned int y ) const { return m_RowCounts[y] == 0; }
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert die Anzahl der gesetzten Bits zurueck.
+		////////////////////////////////////////////////////////////
+		unsigned int getCount(void) const;
+
+		unsigned int getWidth(void) const { return m_Width; }
+		unsigned int getHeight(void) const { return m_Height; }
+		unsigned int getWordsPerRow(void) const { return m_WordsPerRow; }
+
+	private:
+		unsigned int m_Width;						///< Breite in Pixeln
+		unsigned int m_Height;						///< Hoehe in Pixeln
+		unsigned int m_WordsPerRow;					///< Woerter pro Zeile
+		std::vector<unsigned long long> m_Words;	///< Bits aller Zeilen
+		std::vector<unsigned int> m_RowCounts;		///< Gesetzte Bits pro Zeile
+	};
+};
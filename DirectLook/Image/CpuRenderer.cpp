@@ -0,0 +1,658 @@
+#include "CpuRenderer.h"
+#include "../Core/Clock.h"
+#include "../Core/Trace.h"
+
+#include <QAtomicInt>
+
+#include <math.h>
+#include <string.h>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define DIRECTLOOK_CPU_RENDER_SIMD
+#include <emmintrin.h>
+#endif
+
+namespace DirectLook
+{
+	static const float DEPTH_EMPTY = 2.0f;				// Cleared z-buffer, every visible point lies within [-1, 1]
+	static const unsigned int MAX_SPLAT = 16;			// Largest splat edge in pixels
+	static const unsigned int CHUNKS_PER_THREAD = 4;	// Row blocks per worker for projection and binning
+	static const float SCREEN_LIMIT = 32768.0f;			// Splat origins are clamped to +-SCREEN_LIMIT before they become ints
+
+	enum PointClass
+	{
+		POINT_HIDDEN = 0,
+		POINT_FOREGROUND = 1,
+		POINT_BACKGROUND = 2
+	};
+
+	/// \brief Konstanten der Projektion eines Bildes, siehe projectPoints().
+	struct ProjectionSetup
+	{
+		float m_Front[4][4];		///< matW * matVP fuer den Kopf
+		float m_Back[4][4];			///< matVP fuer die Hintergrundebene
+		float m_NearThreshold;		///< Near-Threshold in mm
+		float m_FarThreshold;		///< Far-Threshold in mm
+		float m_Offset;				///< Mitte zwischen den Thresholds, wie im Vertex-Shader
+		float m_HalfWidth;			///< Halbe Breite der Ausgabe
+		float m_HalfHeight;			///< Halbe Hoehe der Ausgabe
+		float m_SplatOffset[3];		///< Abstand der linken unteren Ecke vom Mittelpunkt je Punktklasse
+		bool m_Background;			///< Hintergrundebene zeichnen?
+	};
+
+	static inline int toPixel( const float value )
+	{
+		// Shifted to positive values, so the truncation rounds down
+		const float clamped = (value > SCREEN_LIMIT) ? SCREEN_LIMIT : ((value < -SCREEN_LIMIT) ? -SCREEN_LIMIT : value);
+		return (int) (clamped + SCREEN_LIMIT) - (int) SCREEN_LIMIT;
+	}
+
+	static inline unsigned char projectPoint( const float* pVertex, const ProjectionSetup& setup, int& x, int& y, float& depth )
+	{
+		// Same segmentation as the vertex shader: too near or too far goes to the background plane
+		float value = pVertex[2];
+		if(value < setup.m_NearThreshold || value > setup.m_FarThreshold)
+		{
+			value = setup.m_FarThreshold;
+		}
+		const bool front = value < setup.m_FarThreshold;
+		const float (*pRows)[4] = front ? setup.m_Front : setup.m_Back;
+		const float z = setup.m_Offset - value;
+
+		float clip[4];
+		for(unsigned int c = 0; c < 4; c++)
+		{
+			clip[c] = pVertex[0] * pRows[0][c] + pVertex[1] * pRows[1][c] + z * pRows[2][c] + pRows[3][c];
+		}
+		if(!(clip[3] > 0.0f))
+		{
+			return POINT_HIDDEN;
+		}
+
+		const float invW = 1.0f / clip[3];
+		depth = clip[2] * invW;
+		if(!(depth >= -1.0f && depth <= 1.0f) || (!front && !setup.m_Background))
+		{
+			return POINT_HIDDEN;
+		}
+
+		const unsigned char pointClass = front ? POINT_FOREGROUND : POINT_BACKGROUND;
+		x = toPixel( (clip[0] * invW + 1.0f) * setup.m_HalfWidth - setup.m_SplatOffset[pointClass] );
+		y = toPixel( (clip[1] * invW + 1.0f) * setup.m_HalfHeight - setup.m_SplatOffset[pointClass] );
+		return pointClass;
+	}
+
+	static void projectPointsScalar( const float* pVertices, const unsigned int count, const ProjectionSetup& setup, int* pX, int* pY, float* pDepth, unsigned char* pClass )
+	{
+		for(unsigned int i = 0; i < count; i++)
+		{
+			pClass[i] = projectPoint( pVertices + i * 3, setup, pX[i], pY[i], pDepth[i] );
+		}
+	}
+
+#ifdef DIRECTLOOK_CPU_RENDER_SIMD
+	static inline __m128 select( const __m128 mask, const __m128 a, const __m128 b )
+	{
+		return _mm_or_ps( _mm_and_ps( mask, a ), _mm_andnot_ps( mask, b ) );
+	}
+
+	static inline __m128 transform( const __m128 x, const __m128 y, const __m128 z, const __m128 rows[4][4], const unsigned int c )
+	{
+		// Summed left to right like projectPoint(), so the tail of a row block rounds exactly like the rest
+		return _mm_add_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( x, rows[0][c] ), _mm_mul_ps( y, rows[1][c] ) ), _mm_mul_ps( z, rows[2][c] ) ), rows[3][c] );
+	}
+
+	static void projectPoints( const float* pVertices, const unsigned int count, const ProjectionSetup& setup, int* pX, int* pY, float* pDepth, unsigned char* pClass )
+	{
+		// SSE2 is part of every x86-64 CPU, see MirrorKernels
+		__m128 front[4][4], back[4][4];
+		for(unsigned int r = 0; r < 4; r++)
+		{
+			for(unsigned int c = 0; c < 4; c++)
+			{
+				front[r][c] = _mm_set1_ps( setup.m_Front[r][c] );
+				back[r][c] = _mm_set1_ps( setup.m_Back[r][c] );
+			}
+		}
+		const __m128 nearThreshold = _mm_set1_ps( setup.m_NearThreshold );
+		const __m128 farThreshold = _mm_set1_ps( setup.m_FarThreshold );
+		const __m128 offset = _mm_set1_ps( setup.m_Offset );
+		const __m128 halfWidth = _mm_set1_ps( setup.m_HalfWidth );
+		const __m128 halfHeight = _mm_set1_ps( setup.m_HalfHeight );
+		const __m128 frontSplat = _mm_set1_ps( setup.m_SplatOffset[POINT_FOREGROUND] );
+		const __m128 backSplat = _mm_set1_ps( setup.m_SplatOffset[POINT_BACKGROUND] );
+		const __m128 one = _mm_set1_ps( 1.0f );
+		const __m128 minusOne = _mm_set1_ps( -1.0f );
+		const __m128 limit = _mm_set1_ps( SCREEN_LIMIT );
+		const __m128 negativeLimit = _mm_set1_ps( -SCREEN_LIMIT );
+		const __m128i bias = _mm_set1_epi32( (int) SCREEN_LIMIT );
+
+		unsigned int i = 0;
+		for(; i + 4 <= count; i += 4)
+		{
+			const float* p = pVertices + i * 3;
+			const __m128 x = _mm_setr_ps( p[0], p[3], p[6], p[9] );
+			const __m128 y = _mm_setr_ps( p[1], p[4], p[7], p[10] );
+			__m128 value = _mm_setr_ps( p[2], p[5], p[8], p[11] );
+
+			// Segmentation and both transforms for four points, the mask picks the matrix per point
+			const __m128 outside = _mm_or_ps( _mm_cmplt_ps( value, nearThreshold ), _mm_cmpgt_ps( value, farThreshold ) );
+			value = select( outside, farThreshold, value );
+			const __m128 isFront = _mm_cmplt_ps( value, farThreshold );
+			const __m128 z = _mm_sub_ps( offset, value );
+
+			__m128 clip[4];
+			for(unsigned int c = 0; c < 4; c++)
+			{
+				clip[c] = select( isFront, transform( x, y, z, front, c ), transform( x, y, z, back, c ) );
+			}
+
+			const __m128 invW = _mm_div_ps( one, clip[3] );
+			const __m128 depth = _mm_mul_ps( clip[2], invW );
+			const __m128 visible = _mm_and_ps( _mm_cmpgt_ps( clip[3], _mm_setzero_ps() ), _mm_and_ps( _mm_cmpge_ps( depth, minusOne ), _mm_cmple_ps( depth, one ) ) );
+
+			// NaN and far off positions end up at the limit, max returns the second operand for NaN
+			const __m128 splat = select( isFront, frontSplat, backSplat );
+			__m128 sx = _mm_sub_ps( _mm_mul_ps( _mm_add_ps( _mm_mul_ps( clip[0], invW ), one ), halfWidth ), splat );
+			__m128 sy = _mm_sub_ps( _mm_mul_ps( _mm_add_ps( _mm_mul_ps( clip[1], invW ), one ), halfHeight ), splat );
+			sx = _mm_add_ps( _mm_min_ps( _mm_max_ps( sx, negativeLimit ), limit ), limit );
+			sy = _mm_add_ps( _mm_min_ps( _mm_max_ps( sy, negativeLimit ), limit ), limit );
+			_mm_storeu_si128( (__m128i*) (pX + i), _mm_sub_epi32( _mm_cvttps_epi32( sx ), bias ) );
+			_mm_storeu_si128( (__m128i*) (pY + i), _mm_sub_epi32( _mm_cvttps_epi32( sy ), bias ) );
+			_mm_storeu_ps( pDepth + i, depth );
+
+			const int visibleBits = _mm_movemask_ps( visible );
+			const int frontBits = _mm_movemask_ps( isFront );
+			for(unsigned int k = 0; k < 4; k++)
+			{
+				const bool isFrontPoint = ((frontBits >> k) & 1) != 0;
+				pClass[i + k] = (((visibleBits >> k) & 1) == 0 || (!isFrontPoint && !setup.m_Background))
+					? (unsigned char) POINT_HIDDEN
+					: (unsigned char) (isFrontPoint ? POINT_FOREGROUND : POINT_BACKGROUND);
+			}
+		}
+
+		projectPointsScalar( pVertices + i * 3, count - i, setup, pX + i, pY + i, pDepth + i, pClass + i );
+	}
+#else
+	static void projectPoints( const float* pVertices, const unsigned int count, const ProjectionSetup& setup, int* pX, int* pY, float* pDepth, unsigned char* pClass )
+	{
+		projectPointsScalar( pVertices, count, setup, pX, pY, pDepth, pClass );
+	}
+#endif
+
+	static unsigned int getSplatSize( const float rows[4][4], const float z, const float spacing, const float halfWidth, const float halfHeight )
+	{
+		const float w = z * rows[2][3] + rows[3][3];
+		if(!(w > 0.0f))
+		{
+			return 1;
+		}
+
+		// One grid step in x and y spans a parallelogram on screen, the square splat covers its bounding box
+		const float scale = spacing / w;
+		const float width  = (fabsf( rows[0][0] ) + fabsf( rows[1][0] )) * scale * halfWidth;
+		const float height = (fabsf( rows[0][1] ) + fabsf( rows[1][1] )) * scale * halfHeight;
+		const float edge = ceilf( ((width > height) ? width : height) - 0.01f );
+		return (edge < 1.0f) ? 1 : ((edge > (float) MAX_SPLAT) ? MAX_SPLAT : (unsigned int) edge);
+	}
+
+	static inline bool getTileRange( const int x, const int y, const unsigned int size, const unsigned int width, const unsigned int height, unsigned int range[4] )
+	{
+		const int x1 = x + (int) size - 1;
+		const int y1 = y + (int) size - 1;
+		if(x1 < 0 || y1 < 0 || x >= (int) width || y >= (int) height)
+		{
+			return false;
+		}
+
+		range[0] = (x > 0) ? (unsigned int) x / CpuRenderer::TILE_SIZE : 0;
+		range[1] = (y > 0) ? (unsigned int) y / CpuRenderer::TILE_SIZE : 0;
+		range[2] = ((x1 < (int) width)  ? (unsigned int) x1 : width - 1)  / CpuRenderer::TILE_SIZE;
+		range[3] = ((y1 < (int) height) ? (unsigned int) y1 : height - 1) / CpuRenderer::TILE_SIZE;
+		return true;
+	}
+
+	CpuRenderer::CpuRenderer(void)
+		:
+		m_Width( 0 ),
+		m_Height( 0 ),
+		m_TilesX( 0 ),
+		m_TilesY( 0 ),
+		m_MaxHoleSize( DEFAULT_MAX_HOLE )
+	{
+		m_ClearColor[0] = m_ClearColor[1] = m_ClearColor[2] = 0;
+		m_SplatSize[0] = m_SplatSize[1] = m_SplatSize[2] = 1;
+		memset( &m_Statistics, 0, sizeof( m_Statistics ) );
+	}
+
+	CpuRenderer::~CpuRenderer(void)
+	{
+	}
+
+	bool CpuRenderer::setSize( const unsigned int width, const unsigned int height )
+	{
+		if(width == 0 || height == 0)
+		{
+			return false;
+		}
+
+		m_Width = width;
+		m_Height = height;
+		m_TilesX = (width  + TILE_SIZE - 1) / TILE_SIZE;
+		m_TilesY = (height + TILE_SIZE - 1) / TILE_SIZE;
+
+		m_Color.resize( width * height * 3 );
+		for(unsigned int i = 0; i < width * height; i++)
+		{
+			memcpy( &m_Color[i * 3], m_ClearColor, 3 );
+		}
+		m_Depth.assign( width * height, DEPTH_EMPTY );
+		m_TileStart.assign( m_TilesX * m_TilesY + 1, 0 );
+		return true;
+	}
+
+	void CpuRenderer::setClearColor( const unsigned char red, const unsigned char green, const unsigned char blue )
+	{
+		m_ClearColor[0] = red;
+		m_ClearColor[1] = green;
+		m_ClearColor[2] = blue;
+	}
+
+	void CpuRenderer::render( const ImageFrame& imageFrame, const VertexFrame& vertexHeightMap, const CpuRenderParameters& parameters )
+	{
+		DL_TRACE_SCOPE( "CpuRenderer::render" );
+		if(m_Color.empty() || !imageFrame.isValid() || imageFrame.getChannels() != 3 || !vertexHeightMap.isValid() || vertexHeightMap.getChannels() != 3)
+		{
+			return;
+		}
+
+		unsigned long long phaseStart = Clock::microseconds();
+		const unsigned int gridWidth = vertexHeightMap.getWidth();
+		const unsigned int gridHeight = vertexHeightMap.getHeight();
+		const unsigned int pointCount = gridWidth * gridHeight;
+		if(m_PointClass.size() < pointCount)
+		{
+			m_PointX.resize( pointCount );
+			m_PointY.resize( pointCount );
+			m_PointDepth.resize( pointCount );
+			m_PointColor.resize( pointCount );
+			m_PointClass.resize( pointCount );
+		}
+
+		ProjectionSetup setup;
+		const Matrix front = parameters.m_World * parameters.m_ViewProjection;
+		for(unsigned int r = 0; r < 4; r++)
+		{
+			for(unsigned int c = 0; c < 4; c++)
+			{
+				setup.m_Front[r][c] = front.dataAt( r, c );
+				setup.m_Back[r][c] = parameters.m_ViewProjection.dataAt( r, c );
+			}
+		}
+		setup.m_NearThreshold = parameters.m_NearThreshold;
+		setup.m_FarThreshold = parameters.m_FarThreshold;
+		setup.m_Offset = (parameters.m_FarThreshold - parameters.m_NearThreshold) * 0.5f + parameters.m_NearThreshold;
+		setup.m_HalfWidth = (float) m_Width * 0.5f;
+		setup.m_HalfHeight = (float) m_Height * 0.5f;
+		setup.m_Background = parameters.m_Background;
+
+		// Splat edges are measured in the middle of the head and on the background plane
+		m_SplatSize[POINT_HIDDEN] = 0;
+		m_SplatSize[POINT_FOREGROUND] = getSplatSize( setup.m_Front, 0.0f, parameters.m_GridSpacing, setup.m_HalfWidth, setup.m_HalfHeight );
+		m_SplatSize[POINT_BACKGROUND] = getSplatSize( setup.m_Back, setup.m_Offset - setup.m_FarThreshold, parameters.m_GridSpacing, setup.m_HalfWidth, setup.m_HalfHeight );
+		for(unsigned int i = 0; i < 3; i++)
+		{
+			setup.m_SplatOffset[i] = ((float) m_SplatSize[i] - 1.0f) * 0.5f;
+		}
+
+		// Every block of grid rows counts its points per tile, so binning needs no locks either
+		TaskPool& pool = TaskPool::instance();
+		const unsigned int tileCount = m_TilesX * m_TilesY;
+		const unsigned int chunkCount = pool.getThreadCount() * CHUNKS_PER_THREAD;
+		const unsigned int chunkRows = (gridHeight + chunkCount - 1) / chunkCount;
+		m_ChunkCounts.assign( chunkCount * tileCount, 0 );
+
+		const float* pVertices = vertexHeightMap.getData();
+		const unsigned char* pImage = imageFrame.getData();
+		const int imageWidth = (int) imageFrame.getWidth();
+		const int imageHeight = (int) imageFrame.getHeight();
+		const float imageHalfWidth = (float) imageWidth * 0.5f;
+		const float imageHalfHeight = (float) imageHeight * 0.5f;
+		QAtomicInt visiblePoints( 0 );
+
+		pool.parallelFor( 0, chunkCount, 1, [&]( unsigned int first, unsigned int last, ScratchArena& )
+		{
+			int chunkPoints = 0;
+			for(unsigned int chunk = first; chunk < last; chunk++)
+			{
+				const unsigned int begin = ((chunk * chunkRows < gridHeight) ? chunk * chunkRows : gridHeight) * gridWidth;
+				const unsigned int end = (((chunk + 1) * chunkRows < gridHeight) ? (chunk + 1) * chunkRows : gridHeight) * gridWidth;
+				if(begin >= end)
+				{
+					continue;
+				}
+
+				projectPoints( pVertices + begin * 3, end - begin, setup, &m_PointX[begin], &m_PointY[begin], &m_PointDepth[begin], &m_PointClass[begin] );
+
+				unsigned int* pCounts = &m_ChunkCounts[chunk * tileCount];
+				for(unsigned int i = begin; i < end; i++)
+				{
+					unsigned int range[4];
+					if(m_PointClass[i] == POINT_HIDDEN)
+					{
+						continue;
+					}
+					if(!getTileRange( m_PointX[i], m_PointY[i], m_SplatSize[m_PointClass[i]], m_Width, m_Height, range ))
+					{
+						m_PointClass[i] = POINT_HIDDEN;
+						continue;
+					}
+
+					// Texture lookup of the vertex shader, nearest camera pixel
+					const float* pVertex = pVertices + i * 3;
+					int column = (int) (pVertex[0] + imageHalfWidth);
+					int row = (int) (imageHalfHeight - pVertex[1]);
+					column = (column < 0) ? 0 : ((column >= imageWidth)  ? imageWidth - 1  : column);
+					row    = (row < 0)    ? 0 : ((row >= imageHeight)    ? imageHeight - 1 : row);
+					const unsigned char* pPixel = pImage + (row * imageWidth + column) * 3;
+					m_PointColor[i] = (unsigned int) pPixel[0] | ((unsigned int) pPixel[1] << 8) | ((unsigned int) pPixel[2] << 16);
+
+					for(unsigned int ty = range[1]; ty <= range[3]; ty++)
+					{
+						for(unsigned int tx = range[0]; tx <= range[2]; tx++)
+						{
+							pCounts[ty * m_TilesX + tx]++;
+						}
+					}
+					chunkPoints++;
+				}
+			}
+			visiblePoints.fetchAndAddOrdered( chunkPoints );
+		} );
+
+		// Counts become write positions: tile by tile, within a tile in grid order
+		unsigned int total = 0;
+		for(unsigned int tile = 0; tile < tileCount; tile++)
+		{
+			m_TileStart[tile] = total;
+			for(unsigned int chunk = 0; chunk < chunkCount; chunk++)
+			{
+				const unsigned int count = m_ChunkCounts[chunk * tileCount + tile];
+				m_ChunkCounts[chunk * tileCount + tile] = total;
+				total += count;
+			}
+		}
+		m_TileStart[tileCount] = total;
+		if(m_TileEntries.size() < total)
+		{
+			m_TileEntries.resize( total );
+		}
+
+		pool.parallelFor( 0, chunkCount, 1, [&]( unsigned int first, unsigned int last, ScratchArena& )
+		{
+			for(unsigned int chunk = first; chunk < last; chunk++)
+			{
+				const unsigned int begin = ((chunk * chunkRows < gridHeight) ? chunk * chunkRows : gridHeight) * gridWidth;
+				const unsigned int end = (((chunk + 1) * chunkRows < gridHeight) ? (chunk + 1) * chunkRows : gridHeight) * gridWidth;
+
+				unsigned int* pCursor = &m_ChunkCounts[chunk * tileCount];
+				for(unsigned int i = begin; i < end; i++)
+				{
+					unsigned int range[4];
+					if(m_PointClass[i] == POINT_HIDDEN || !getTileRange( m_PointX[i], m_PointY[i], m_SplatSize[m_PointClass[i]], m_Width, m_Height, range ))
+					{
+						continue;
+					}
+					for(unsigned int ty = range[1]; ty <= range[3]; ty++)
+					{
+						for(unsigned int tx = range[0]; tx <= range[2]; tx++)
+						{
+							m_TileEntries[pCursor[ty * m_TilesX + tx]++] = i;
+						}
+					}
+				}
+			}
+		} );
+		m_Statistics.m_ProjectMilliseconds = Clock::elapsedMilliseconds( phaseStart );
+
+		// Each tile owns its pixels, so the z-test needs no atomics
+		phaseStart = Clock::microseconds();
+		pool.parallelFor2D( m_Width, m_Height, TILE_SIZE, TILE_SIZE, [this]( const TileRange& tile, ScratchArena& )
+		{
+			splatTile( tile );
+		} );
+		m_Statistics.m_SplatMilliseconds = Clock::elapsedMilliseconds( phaseStart );
+
+		// Behind the background plane every hole is a disocclusion, without it only cracks between the splats are closed
+		phaseStart = Clock::microseconds();
+		const unsigned int maxHole = parameters.m_Background ? m_MaxHoleSize : 2 * m_SplatSize[POINT_FOREGROUND];
+		QAtomicInt filledPixels( 0 );
+		if(maxHole > 0)
+		{
+			pool.parallelFor2D( m_Width, m_Height, m_Width, 16, [&]( const TileRange& tile, ScratchArena& )
+			{
+				filledPixels.fetchAndAddOrdered( (int) fillHoles( tile, false, maxHole ) );
+			} );
+			pool.parallelFor2D( m_Width, m_Height, 16, m_Height, [&]( const TileRange& tile, ScratchArena& )
+			{
+				filledPixels.fetchAndAddOrdered( (int) fillHoles( tile, true, maxHole ) );
+			} );
+		}
+		m_Statistics.m_FillMilliseconds = Clock::elapsedMilliseconds( phaseStart );
+
+		m_Statistics.m_Points = (unsigned int) (int) visiblePoints;
+		m_Statistics.m_SplatSize = m_SplatSize[POINT_FOREGROUND];
+		m_Statistics.m_FilledPixels = (unsigned int) (int) filledPixels;
+	}
+
+	void CpuRenderer::splatTile( const TileRange& tile )
+	{
+		for(unsigned int y = tile.m_Y0; y < tile.m_Y1; y++)
+		{
+			float* pDepth = &m_Depth[y * m_Width];
+			unsigned char* pColor = &m_Color[y * m_Width * 3];
+			for(unsigned int x = tile.m_X0; x < tile.m_X1; x++)
+			{
+				pDepth[x] = DEPTH_EMPTY;
+				pColor[x * 3]     = m_ClearColor[0];
+				pColor[x * 3 + 1] = m_ClearColor[1];
+				pColor[x * 3 + 2] = m_ClearColor[2];
+			}
+		}
+
+		const unsigned int index = (tile.m_Y0 / TILE_SIZE) * m_TilesX + tile.m_X0 / TILE_SIZE;
+		for(unsigned int entry = m_TileStart[index]; entry < m_TileStart[index + 1]; entry++)
+		{
+			const unsigned int i = m_TileEntries[entry];
+			const int size = (int) m_SplatSize[m_PointClass[i]];
+			const int x0 = (m_PointX[i] > (int) tile.m_X0) ? m_PointX[i] : (int) tile.m_X0;
+			const int y0 = (m_PointY[i] > (int) tile.m_Y0) ? m_PointY[i] : (int) tile.m_Y0;
+			const int x1 = (m_PointX[i] + size < (int) tile.m_X1) ? m_PointX[i] + size : (int) tile.m_X1;
+			const int y1 = (m_PointY[i] + size < (int) tile.m_Y1) ? m_PointY[i] + size : (int) tile.m_Y1;
+			const float depth = m_PointDepth[i];
+			const unsigned int color = m_PointColor[i];
+
+			for(int y = y0; y < y1; y++)
+			{
+				float* pDepth = &m_Depth[y * m_Width];
+				unsigned char* pColor = &m_Color[y * m_Width * 3];
+				for(int x = x0; x < x1; x++)
+				{
+					// GL_LESS: the first of two points at the same depth stays
+					if(depth < pDepth[x])
+					{
+						pDepth[x] = depth;
+						pColor[x * 3]     = (unsigned char) color;
+						pColor[x * 3 + 1] = (unsigned char) (color >> 8);
+						pColor[x * 3 + 2] = (unsigned char) (color >> 16);
+					}
+				}
+			}
+		}
+	}
+
+	unsigned int CpuRenderer::fillHoles( const TileRange& tile, const bool columns, const unsigned int maxHole )
+	{
+		// A line is a row of the tile or a column of the whole image
+		const unsigned int lineCount = columns ? tile.m_X1 - tile.m_X0 : tile.m_Y1 - tile.m_Y0;
+		const unsigned int length = columns ? m_Height : m_Width;
+		const unsigned int stride = columns ? m_Width : 1;
+		unsigned int filled = 0;
+
+		for(unsigned int line = 0; line < lineCount; line++)
+		{
+			const unsigned int first = columns ? tile.m_X0 + line : (tile.m_Y0 + line) * m_Width;
+
+			// Pixels before the first covered one have a neighbour on one side only
+			unsigned int position = 0;
+			while(position < length && m_Depth[first + position * stride] == DEPTH_EMPTY)
+			{
+				position++;
+			}
+
+			while(position < length)
+			{
+				while(position < length && m_Depth[first + position * stride] != DEPTH_EMPTY)
+				{
+					position++;
+				}
+				const unsigned int holeStart = position;
+				while(position < length && m_Depth[first + position * stride] == DEPTH_EMPTY)
+				{
+					position++;
+				}
+				if(position >= length || position - holeStart > maxHole)
+				{
+					continue;
+				}
+
+				// A disocclusion shows the surface behind, so the farther neighbour fills the hole
+				const unsigned int before = first + (holeStart - 1) * stride;
+				const unsigned int after = first + position * stride;
+				const unsigned int source = (m_Depth[before] > m_Depth[after]) ? before : after;
+				for(unsigned int p = holeStart; p < position; p++)
+				{
+					const unsigned int target = first + p * stride;
+					m_Depth[target] = m_Depth[source];
+					memcpy( &m_Color[target * 3], &m_Color[source * 3], 3 );
+				}
+				filled += position - holeStart;
+			}
+		}
+		return filled;
+	}
+
+	bool CpuRenderer::getRGBPixels( unsigned char* pBuffer, const unsigned int size ) const
+	{
+		if(m_Color.empty() || size < m_Color.size())
+		{
+			return false; //Too small buffer
+		}
+
+		memcpy( pBuffer, &m_Color[0], m_Color.size() );
+		return true;
+	}
+
+	bool CpuRenderer::getBGRPixels( unsigned char* pBuffer, const unsigned int size ) const
+	{
+		if(m_Color.empty() || size < m_Color.size())
+		{
+			return false; //Too small buffer
+		}
+
+		for(unsigned int i = 0; i < m_Color.size(); i += 3)
+		{
+			pBuffer[i]     = m_Color[i + 2];
+			pBuffer[i + 1] = m_Color[i + 1];
+			pBuffer[i + 2] = m_Color[i];
+		}
+		return true;
+	}
+
+	unsigned int CpuRenderer::checkProjection( const unsigned int pointCount )
+	{
+#ifdef DIRECTLOOK_CPU_RENDER_SIMD
+		std::vector<float> vertices( pointCount * 3 );
+		unsigned int seed = 12345;
+		for(unsigned int i = 0; i < pointCount * 3; i++)
+		{
+			// Grid positions within a 640x480 sensor, depth values around both thresholds
+			seed = seed * 1664525 + 1013904223;
+			const float random = (float) (seed >> 8) / 16777216.0f;
+			vertices[i] = (i % 3 == 2) ? random * 1200.0f : (random - 0.5f) * 700.0f;
+		}
+
+		std::vector<int> x[2], y[2];
+		std::vector<float> depth[2];
+		std::vector<unsigned char> pointClass[2];
+		for(unsigned int k = 0; k < 2; k++)
+		{
+			x[k].resize( pointCount );
+			y[k].resize( pointCount );
+			depth[k].resize( pointCount );
+			pointClass[k].resize( pointCount );
+		}
+
+		unsigned int mismatches = 0;
+		for(unsigned int pass = 0; pass < 2; pass++)
+		{
+			// First pass perspective with a rotated head, second pass like GLCamera (orthographic, w = 1)
+			ProjectionSetup setup;
+			memset( &setup, 0, sizeof( setup ) );
+			for(unsigned int r = 0; r < 4; r++)
+			{
+				for(unsigned int c = 0; c < 4; c++)
+				{
+					setup.m_Back[r][c] = (r == c) ? 1.0f : 0.0f;
+				}
+			}
+			setup.m_Back[0][0] = 2.0f / 640.0f;
+			setup.m_Back[1][1] = 2.0f / 480.0f;
+			setup.m_Back[2][2] = -0.0005f;
+			setup.m_Back[3][2] = 0.5f;
+			if(pass == 0)
+			{
+				setup.m_Back[0][3] = 0.00011f;
+				setup.m_Back[1][3] = -0.00017f;
+				setup.m_Back[2][3] = -0.0007f;
+				setup.m_Back[3][3] = 1.1f;
+			}
+
+			// The rotation fills every column, so all four terms of a sum are non-zero
+			memcpy( setup.m_Front, setup.m_Back, sizeof( setup.m_Front ) );
+			setup.m_Front[0][1] = 0.0011f;
+			setup.m_Front[0][2] = 0.00023f;
+			setup.m_Front[1][0] = -0.0013f;
+			setup.m_Front[1][2] = -0.00031f;
+			setup.m_Front[2][0] = 0.00093f;
+			setup.m_Front[2][1] = -0.00041f;
+			setup.m_Front[3][0] = 0.07f;
+			setup.m_Front[3][1] = -0.05f;
+			setup.m_NearThreshold = 500.0f;
+			setup.m_FarThreshold = 800.0f;
+			setup.m_Offset = 650.0f;
+			setup.m_HalfWidth = 320.0f;
+			setup.m_HalfHeight = 240.0f;
+			setup.m_SplatOffset[POINT_FOREGROUND] = 3.5f;
+			setup.m_SplatOffset[POINT_BACKGROUND] = 4.0f;
+			setup.m_Background = true;
+
+			projectPoints( &vertices[0], pointCount, setup, &x[0][0], &y[0][0], &depth[0][0], &pointClass[0][0] );
+			projectPointsScalar( &vertices[0], pointCount, setup, &x[1][0], &y[1][0], &depth[1][0], &pointClass[1][0] );
+			for(unsigned int i = 0; i < pointCount; i++)
+			{
+				// Hidden points leave position and depth undefined
+				if(pointClass[0][i] != pointClass[1][i] || (pointClass[0][i] != POINT_HIDDEN &&
+					(x[0][i] != x[1][i] || y[0][i] != y[1][i] || memcmp( &depth[0][i], &depth[1][i], sizeof( float ) ) != 0)))
+				{
+					mismatches++;
+				}
+			}
+		}
+		return mismatches;
+#else
+		return 0;
+#endif
+	}
+};
@@ -0,0 +1,182 @@
+#pragma once
+
+#include <vector>
+
+#include "FrameHandle.h"
+#include "../NonCopyable.h"
+#include "../Core/TaskPool.h"
+#include "../Math/Matrix.h"
+
+namespace DirectLook
+{
+	/// \brief Eingaben von CpuRenderer::render(), sie entsprechen den Uniforms von data/shader/vertex.glsl.
+	struct CpuRenderParameters
+	{
+		Matrix m_World;				///< Weltmatrix des Kopfes (matW)
+		Matrix m_ViewProjection;	///< View-Projection-Matrix der virtuellen Kamera (matVP)
+		float m_NearThreshold;		///< Naehere Tiefenwerte liegen auf der Hintergrundebene
+		float m_FarThreshold;		///< Tiefenwerte ab hier liegen auf der Hintergrundebene
+		float m_GridSpacing;		///< Abstand zweier Gitterpunkte in Kamerapixeln
+		bool m_Background;			///< Hintergrundebene zeichnen? Sonst bleibt dort die Loeschfarbe stehen
+	};
+
+	/// \brief Zeiten und Mengen des letzten CpuRenderer::render().
+	struct CpuRenderStatistics
+	{
+		double m_ProjectMilliseconds;	///< Projektion der Gitterpunkte und Einsortieren in die Kacheln
+		double m_SplatMilliseconds;		///< Zeichnen der Punkte mit Z-Buffer
+		double m_FillMilliseconds;		///< Fuellen der Luecken
+		unsigned int m_Points;			///< Sichtbare Gitterpunkte
+		unsigned int m_SplatSize;		///< Kantenlaenge der Punkte des Kopfes in Pixeln
+		unsigned int m_FilledPixels;	///< Vom Lueckenfuellen gesetzte Pixel
+	};
+
+	/// \brief Die Klasse CpuRenderer zeichnet die korrigierte Ansicht ohne Grafikkarte (Depth-Image-Based Rendering).
+	///
+	/// Jeder Gitterpunkt aus GLScene::buildMesh() wird wie im Vertex-Shader mit Welt- und View-Projection-Matrix
+	/// in die virtuelle Kamera projiziert (mit SSE2 vier Punkte auf einmal) und als Quadrat, das den Gitterabstand
+	/// abdeckt, mit Z-Buffer gezeichnet (Forward Warping). Die Ausgabe ist in Kacheln zu TILE_SIZE x TILE_SIZE
+	/// Pixeln zerlegt: die Punkte werden parallel nach Kacheln einsortiert, danach zeichnet jeder Worker des
+	/// TaskPool seine Kacheln ohne Sperren. Zum Schluss werden Luecken zeilen- und spaltenweise mit dem weiter
+	/// entfernten der beiden Nachbarn gefuellt. Mit Hintergrundebene sind das die Stellen, die der verschobene
+	/// Kopf freigibt (bis setMaxHoleSize() Pixel breit), ohne Hintergrundebene nur Risse zwischen den Punkten.
+	///
+	/// Die Ausgabe hat das Format von RenderTarget::getPixels(): RGB, Zeilen von unten nach oben, ohne Auffuellung.
+	/// Eingefaerbt wird immer mit dem Kamerabild (naechster Pixel), das Hintergrundvideo zeichnet nur OpenGL.
+	class CpuRenderer : public NonCopyable
+	{
+
+	public:
+		static const unsigned int TILE_SIZE = 64;			///< Kantenlaenge einer Kachel in Pixeln
+		static const unsigned int DEFAULT_MAX_HOLE = 64;	///< Voreinstellung fuer setMaxHoleSize()
+
+		////////////////////////////////////////////////////////////
+		/// \brief Standardkonstruktor
+		///
+		/// Die Ausgabe ist leer, bis setSize() aufgerufen wird. Die Loeschfarbe ist schwarz.
+		///
+		////////////////////////////////////////////////////////////
+		CpuRenderer(void);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Destruktor
+		////////////////////////////////////////////////////////////
+		~CpuRenderer(void);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Legt die Groesse der Ausgabe fest.
+		///
+		/// \param width  Breite in Pixeln
+		/// \param height Hoehe in Pixeln
+		///
+		/// \return False bei ungueltiger Groesse
+		///
+		////////////////////////////////////////////////////////////
+		bool setSize( const unsigned int width, const unsigned int height );
+
+		unsigned int getWidth(void) const { return m_Width; }
+		unsigned int getHeight(void) const { return m_Height; }
+
+		////////////////////////////////////////////////////////////
+		/// \brief Setzt die Farbe der Pixel, die kein Punkt trifft (wie glClearColor()).
+		////////////////////////////////////////////////////////////
+		void setClearColor( const unsigned char red, const unsigned char green, const unsigned char blue );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Setzt die groesste Luecke, die mit Hintergrundebene gefuellt wird.
+		///
+		/// \param pixels Breite bzw. Hoehe in Pixeln der Ausgabe (0 = nicht fuellen)
+		///
+		////////////////////////////////////////////////////////////
+		void setMaxHoleSize( const unsigned int pixels ) { m_MaxHoleSize = pixels; }
+
+		unsigned int getMaxHoleSize(void) const { return m_MaxHoleSize; }
+
+		////////////////////////////////////////////////////////////
+		/// \brief Zeichnet ein Bild.
+		///
+		/// \param imageFrame      RGB-Werte des Sensors, farbig wird in Kamerapixeln wie im Vertex-Shader nachgeschlagen
+		/// \param vertexHeightMap Vertices aus GLScene::buildMesh() (x, y, Tiefenwert in mm)
+		/// \param parameters      Matrizen und Segmentierung, siehe GLScene::renderCpu()
+		///
+		////////////////////////////////////////////////////////////
+		void render( const ImageFrame& imageFrame, const VertexFrame& vertexHeightMap, const CpuRenderParameters& parameters );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert das letzte Bild im RGB-Format zurueck (Breite * Hoehe * 3 Byte).
+		////////////////////////////////////////////////////////////
+		const unsigned char* getPixels(void) const { return m_Color.empty() ? 0 : &m_Color[0]; }
+
+		////////////////////////////////////////////////////////////
+		/// \brief Kopiert das letzte Bild im RGB-Format.
+		///
+		/// \param pBuffer Zeiger auf den zu beschreibenden Puffer
+		/// \param size    Groesse des Puffers, mindestens Breite * Hoehe * 3 Byte
+		///
+		/// \return True wenn erfolgreich, false wenn der Puffer zu klein ist
+		///
+		////////////////////////////////////////////////////////////
+		bool getRGBPixels( unsigned char* pBuffer, const unsigned int size ) const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Kopiert das letzte Bild im BGR-Format, siehe getRGBPixels().
+		////////////////////////////////////////////////////////////
+		bool getBGRPixels( unsigned char* pBuffer, const unsigned int size ) const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert Zeiten und Mengen des letzten render() zurueck.
+		////////////////////////////////////////////////////////////
+		const CpuRenderStatistics& getStatistics(void) const { return m_Statistics; }
+
+		////////////////////////////////////////////////////////////
+		/// \brief Vergleicht die SSE2-Projektion mit der skalaren Projektion.
+		///
+		/// Die letzten Punkte jedes Zeilenblocks werden skalar projiziert, die Anzahl der Bloecke haengt von
+		/// der Threadanzahl ab. Nur wenn beide Wege bitgleich rechnen, ist das Bild unabhaengig davon.
+		/// Projiziert werden zufaellige Punkte mit einer perspektivischen und einer orthografischen Matrix.
+		///
+		/// \param pointCount Anzahl der Testpunkte
+		///
+		/// \return Anzahl der Punkte, bei denen Klasse, Position oder Tiefe abweichen (0 ohne SSE2)
+		///
+		////////////////////////////////////////////////////////////
+		static unsigned int checkProjection( const unsigned int pointCount = 100003 );
+
+	private:
+		////////////////////////////////////////////////////////////
+		/// \brief Zeichnet die Punkte einer Kachel, siehe render().
+		////////////////////////////////////////////////////////////
+		void splatTile( const TileRange& tile );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Fuellt Luecken bis "maxHole" Pixel in den Zeilen bzw. Spalten eines Ausschnitts.
+		///
+		/// \return Anzahl der gefuellten Pixel
+		///
+		////////////////////////////////////////////////////////////
+		unsigned int fillHoles( const TileRange& tile, const bool columns, const unsigned int maxHole );
+
+		unsigned int m_Width;						///< Breite der Ausgabe
+		unsigned int m_Height;						///< Hoehe der Ausgabe
+		unsigned int m_TilesX;						///< Kacheln pro Zeile
+		unsigned int m_TilesY;						///< Kacheln pro Spalte
+		unsigned char m_ClearColor[3];				///< Farbe der nicht getroffenen Pixel
+		unsigned int m_MaxHoleSize;					///< Groesste gefuellte Luecke mit Hintergrundebene
+		unsigned int m_SplatSize[3];				///< Kantenlaenge je Punktklasse (unsichtbar, Kopf, Hintergrund)
+
+		std::vector<unsigned char> m_Color;			///< Ausgabe, RGB von unten nach oben
+		std::vector<float> m_Depth;					///< Z-Buffer der Ausgabe (normierte Geraetekoordinaten)
+
+		std::vector<int> m_PointX;					///< Linke Spalte des Quadrats je Gitterpunkt
+		std::vector<int> m_PointY;					///< Untere Zeile des Quadrats je Gitterpunkt
+		std::vector<float> m_PointDepth;			///< Tiefe je Gitterpunkt
+		std::vector<unsigned int> m_PointColor;		///< Farbe je Gitterpunkt (R | G << 8 | B << 16)
+		std::vector<unsigned char> m_PointClass;	///< Unsichtbar, Kopf oder Hintergrundebene
+
+		std::vector<unsigned int> m_ChunkCounts;	///< Punkte je Zeilenblock und Kachel, danach Schreibpositionen
+		std::vector<unsigned int> m_TileStart;		///< Erster Eintrag je Kachel in m_TileEntries (plus Ende)
+		std::vector<unsigned int> m_TileEntries;	///< Gitterindizes der Punkte, nach Kacheln sortiert
+
+		CpuRenderStatistics m_Statistics;			///< Zeiten und Mengen des letzten Bildes
+	};
+};
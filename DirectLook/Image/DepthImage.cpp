@@ -1,4 +1,7 @@
 #include "DepthImage.h"
+#include "MirrorKernels.h"
+
+#include <string.h>
 
 namespace DirectLook
 {
@@ -22,13 +25,21 @@ namespace DirectLook
 	{
 		if(copy.m_pImagePixels)
 		{
-			m_pImagePixels = new unsigned short[m_PixelSize];
-			for(unsigned int i = 0; i < m_PixelSize; i++)
-			{
-				m_pImagePixels[i] = copy.m_pImagePixels[i];
-			}
+			allocatePixels();
+			memcpy( m_pImagePixels, copy.m_pImagePixels, m_PixelSize * sizeof( unsigned short ) );
 		}
 	}
+
+	DepthImage::DepthImage( DepthImage&& other )
+		:
+		m_pImagePixels( 0 ),
+		m_Width( 0 ),
+		m_Height( 0 ),
+		m_PixelSize( 0 ),
+		m_MirrorMode( false )
+	{
+		takeFrom( other );
+	}
 	
 	DepthImage::DepthImage( const unsigned short width, const unsigned short height, const bool mirrorMode )
 		:
@@ -37,7 +48,7 @@ namespace DirectLook
 		m_PixelSize( m_Width * m_Height ),
 		m_MirrorMode( mirrorMode )	
 	{
-		m_pImagePixels = new unsigned short[m_PixelSize];
+		allocatePixels();
 	}
 
 	DepthImage::DepthImage(
@@ -58,6 +69,41 @@ namespace DirectLook
 		clear();
 	}
 
+	DepthImage& DepthImage::operator=( const DepthImage& copy )
+	{
+		if(this != &copy)
+		{
+			if(m_PixelSize != copy.m_PixelSize || !m_pImagePixels)
+			{
+				DepthImage::clear();
+				m_PixelSize = copy.m_PixelSize;
+				if(copy.m_pImagePixels)
+				{
+					allocatePixels();
+				}
+			}
+
+			m_Width = copy.m_Width;
+			m_Height = copy.m_Height;
+			m_MirrorMode = copy.m_MirrorMode;
+			if(copy.m_pImagePixels)
+			{
+				memcpy( m_pImagePixels, copy.m_pImagePixels, m_PixelSize * sizeof( unsigned short ) );
+			}
+		}
+		return *this;
+	}
+
+	DepthImage& DepthImage::operator=( DepthImage&& other )
+	{
+		if(this != &other)
+		{
+			DepthImage::clear();
+			takeFrom( other );
+		}
+		return *this;
+	}
+
 	void DepthImage::setImage( const unsigned short* pImagePixels, const unsigned short width, const unsigned short height )
 	{
 		if(pImagePixels)
@@ -66,7 +112,7 @@ namespace DirectLook
 			m_Width = width;
 			m_Height = height;
 			m_PixelSize = m_Width * m_Height;
-			m_pImagePixels = new unsigned short[m_PixelSize];
+			allocatePixels();
 			updateImage( pImagePixels );
 		}
 	}
@@ -75,18 +121,13 @@ namespace DirectLook
 	{
 		if(pImagePixels)
 		{
-			if(m_MirrorMode) {
-				for(unsigned int y = 0; y < m_Height; y++) {
-					for(unsigned int x = 0; x < m_Width; x++) {
-						m_pImagePixels[y * m_Width + x] = pImagePixels[y * m_Width + (m_Width - 1) - x];
-					}
-				}
-			}else {
-				for(int y = 0; y < m_Height; y++) {
-					for(int x = 0; x < m_Width; x++) {
-						m_pImagePixels[y * m_Width + x] = pImagePixels[y * m_Width + x];
-					}
-				}
+			if(m_MirrorMode)
+			{
+				MirrorKernels::mirrorImage16( pImagePixels, m_pImagePixels, m_Width, m_Height );
+			}
+			else
+			{
+				memcpy( m_pImagePixels, pImagePixels, m_PixelSize * sizeof( unsigned short ) );
 			}
 		}
 	}
@@ -103,7 +144,7 @@ namespace DirectLook
 		m_Width = width;
 		m_Height = height;
 		m_PixelSize = m_Width * m_Height;
-		m_pImagePixels = new unsigned short[m_PixelSize];
+		allocatePixels();
 	}
 
 	const unsigned short DepthImage::pixelAt( const unsigned int index )
@@ -148,8 +189,27 @@ namespace DirectLook
 	{
 		if(m_pImagePixels != 0)
 		{
-			delete[] m_pImagePixels;
+			FramePool::instance().release( m_pImagePixels );
 			m_pImagePixels = 0;
 		}
 	}
+
+	void DepthImage::allocatePixels(void)
+	{
+		m_pImagePixels = FramePool::instance().acquireArray<unsigned short>( m_PixelSize );
+	}
+
+	void DepthImage::takeFrom( DepthImage& other )
+	{
+		m_pImagePixels = other.m_pImagePixels;
+		m_Width = other.m_Width;
+		m_Height = other.m_Height;
+		m_PixelSize = other.m_PixelSize;
+		m_MirrorMode = other.m_MirrorMode;
+
+		other.m_pImagePixels = 0;
+		other.m_Width = 0;
+		other.m_Height = 0;
+		other.m_PixelSize = 0;
+	}
 }
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "../Core/FramePool.h"
+
 namespace DirectLook
 {
 	/// \brief Die Klasse DepthImage repraesentiert eine einheitliche Datenstruktur des Tiefensensors.
@@ -25,6 +27,16 @@ namespace DirectLook
 		////////////////////////////////////////////////////////////
 		DepthImage( const DepthImage& copy );
 
+		////////////////////////////////////////////////////////////
+		/// \brief Move-Konstruktor
+		///
+		/// Uebernimmt die Bilddaten von "other" ohne Kopie, "other" ist danach leer.
+		///
+		/// \param other
+		///
+		////////////////////////////////////////////////////////////
+		DepthImage( DepthImage&& other );
+
 		////////////////////////////////////////////////////////////
 		/// \brief Konstruktor A
 		///
@@ -58,6 +70,26 @@ namespace DirectLook
 		///
 		////////////////////////////////////////////////////////////
 		virtual ~DepthImage(void);
+
+		////////////////////////////////////////////////////////////
+		/// \brief = operator
+		///
+		/// Erzeugt eine tiefe Kopie des uebergebenen Sensor-Image Objektes.
+		///
+		/// \param copy
+		///
+		////////////////////////////////////////////////////////////
+		DepthImage& operator=( const DepthImage& copy );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Move = operator
+		///
+		/// Uebernimmt die Bilddaten von "other" ohne Kopie, "other" ist danach leer.
+		///
+		/// \param other
+		///
+		////////////////////////////////////////////////////////////
+		DepthImage& operator=( DepthImage&& other );
 		
 		////////////////////////////////////////////////////////////
 		/// \brief Erzeugt einen neuen Sensor-Image Datenzeiger mit der Aufloesung "width" x "height".
@@ -168,6 +200,16 @@ namespace DirectLook
 		////////////////////////////////////////////////////////////
 		virtual void clear(void);
 
+		////////////////////////////////////////////////////////////
+		/// \brief Fordert den Bildpuffer fuer "m_PixelSize" Tiefenwerte aus dem FramePool an.
+		////////////////////////////////////////////////////////////
+		void allocatePixels(void);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Uebernimmt Bilddaten und Eigenschaften von "other" und hinterlaesst es leer.
+		////////////////////////////////////////////////////////////
+		void takeFrom( DepthImage& other );
+
 		unsigned short* m_pImagePixels;	///< 16 bit Tiefenwert in der Einheit Millimeter
 		unsigned short m_Width;			///< Bildbreite
 		unsigned short m_Height;		///< Bildhoehe
@@ -0,0 +1,137 @@
+#include "DepthUpsampler.h"
+#include "../Core/TaskPool.h"
+#include "../Core/Trace.h"
+
+#include <QAtomicInt>
+
+#include <math.h>
+#include <stdlib.h>
+
+namespace DirectLook
+{
+	DepthUpsampler::DepthUpsampler( const float spatialSigma, const float colorSigma, const unsigned short edgeThreshold )
+		:
+		m_SpatialSigma( (spatialSigma > 0.0f) ? spatialSigma : 0.75f ),
+		m_EdgeThreshold( edgeThreshold ),
+		m_ColorWeights( 766 )
+	{
+		const float sigma = (colorSigma > 0.0f) ? colorSigma : 30.0f;
+		for(unsigned int i = 0; i < m_ColorWeights.size(); i++)
+		{
+			m_ColorWeights[i] = expf( -(float) (i * i) / (2.0f * sigma * sigma) );
+		}
+	}
+
+	unsigned int DepthUpsampler::upsample(
+		const unsigned short* pLowDepth,
+		const unsigned char* pGuide, const unsigned int guideWidth, const unsigned int guideHeight,
+		unsigned short* pDepth, const unsigned int width, const unsigned int height
+	) const
+	{
+		DL_TRACE_SCOPE( "DepthUpsampler::upsample" );
+		const int lowWidth = (int) (width + 1) / 2;
+		const int lowHeight = (int) (height + 1) / 2;
+		const float spatialFactor = -1.0f / (2.0f * m_SpatialSigma * m_SpatialSigma);
+		QAtomicInt edgePixels( 0 );
+
+		TaskPool::instance().parallelFor2D( width, height, width, 16, [&]( const TileRange& tile, ScratchArena& )
+		{
+			int tileEdges = 0;
+			for(int y = (int) tile.m_Y0; y < (int) tile.m_Y1; y++)
+			{
+				// The output pixel center lies a quarter low-res pixel away from the covering one, towards "ny"
+				const int cy = y >> 1;
+				const int ny = (y & 1) ? ((cy + 1 < lowHeight) ? cy + 1 : cy) : ((cy > 0) ? cy - 1 : cy);
+				const unsigned char* pGuideRow = pGuide ? pGuide + ((unsigned int) y * guideHeight / height) * guideWidth * 3 : 0;
+
+				for(int x = (int) tile.m_X0; x < (int) tile.m_X1; x++)
+				{
+					const int cx = x >> 1;
+					const int nx = (x & 1) ? ((cx + 1 < lowWidth) ? cx + 1 : cx) : ((cx > 0) ? cx - 1 : cx);
+
+					const unsigned short d00 = pLowDepth[cy * lowWidth + cx];
+					const unsigned short d01 = pLowDepth[cy * lowWidth + nx];
+					const unsigned short d10 = pLowDepth[ny * lowWidth + cx];
+					const unsigned short d11 = pLowDepth[ny * lowWidth + nx];
+
+					const unsigned short min0 = (d00 < d01) ? d00 : d01, min1 = (d10 < d11) ? d10 : d11;
+					const unsigned short max0 = (d00 > d01) ? d00 : d01, max1 = (d10 > d11) ? d10 : d11;
+					const unsigned short minDepth = (min0 < min1) ? min0 : min1;
+					const unsigned short maxDepth = (max0 > max1) ? max0 : max1;
+
+					// Flat and complete: plain bilinear weights 9/16, 3/16, 3/16, 1/16
+					if(minDepth != 0 && maxDepth - minDepth <= m_EdgeThreshold)
+					{
+						pDepth[y * width + x] = (unsigned short) ((9 * d00 + 3 * d01 + 3 * d10 + d11 + 8) >> 4);
+						continue;
+					}
+
+					// Nothing to interpolate from, the hole stays a hole
+					if(maxDepth == 0)
+					{
+						pDepth[y * width + x] = 0;
+						continue;
+					}
+
+					tileEdges++;
+
+					const unsigned char* pColor = pGuideRow ? pGuideRow + ((unsigned int) x * guideWidth / width) * 3 : 0;
+					const float px = ((float) x + 0.5f) * 0.5f;
+					const float py = ((float) y + 0.5f) * 0.5f;
+
+					// Joint bilateral weights of the valid 3x3 neighbours
+					float weights[9];
+					unsigned short depths[9];
+					int count = 0, best = 0;
+					for(int qy = cy - 1; qy <= cy + 1; qy++)
+					{
+						if(qy < 0 || qy >= lowHeight) continue;
+						for(int qx = cx - 1; qx <= cx + 1; qx++)
+						{
+							if(qx < 0 || qx >= lowWidth) continue;
+							const unsigned short depth = pLowDepth[qy * lowWidth + qx];
+							if(depth == 0) continue;
+
+							const float dx = (float) qx + 0.5f - px;
+							const float dy = (float) qy + 0.5f - py;
+							float weight = expf( (dx * dx + dy * dy) * spatialFactor );
+
+							if(pColor)
+							{
+								// Compare with the guide pixel at the neighbour's center
+								const unsigned int gx = (unsigned int) (2 * qx) * guideWidth / width;
+								const unsigned int gy = (unsigned int) (2 * qy) * guideHeight / height;
+								const unsigned char* pOther = pGuide + (gy * guideWidth + gx) * 3;
+								const int difference = abs( (int) pColor[0] - (int) pOther[0] ) + abs( (int) pColor[1] - (int) pOther[1] ) + abs( (int) pColor[2] - (int) pOther[2] );
+								weight *= m_ColorWeights[difference];
+							}
+
+							weights[count] = weight;
+							depths[count] = depth;
+							if(count == 0 || weight > weights[best])
+							{
+								best = count;
+							}
+							count++;
+						}
+					}
+
+					// Average only the neighbours on the same side of the edge as the strongest one
+					float weightSum = 0.0f, depthSum = 0.0f;
+					for(int i = 0; i < count; i++)
+					{
+						if(abs( (int) depths[i] - (int) depths[best] ) <= (int) m_EdgeThreshold)
+						{
+							weightSum += weights[i];
+							depthSum += weights[i] * (float) depths[i];
+						}
+					}
+					pDepth[y * width + x] = (weightSum > 0.0f) ? (unsigned short) (depthSum / weightSum + 0.5f) : depths[best];
+				}
+			}
+			edgePixels.fetchAndAddOrdered( tileEdges );
+		} );
+
+		return (unsigned int) (int) edgePixels;
+	}
+};
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <vector>
+
+namespace DirectLook
+{
+	/// \brief Die Klasse DepthUpsampler vergroessert eine Tiefenkarte auf die doppelte Breite und Hoehe.
+	///
+	/// Liegen die vier naechsten Tiefenwerte eines Zielpixels dicht beieinander, wird bilinear interpoliert.
+	/// Nur an Tiefenkanten und Loechern wird ein Joint-Bilateral-Filter ueber die 3x3 Nachbarschaft
+	/// berechnet, der zusaetzlich das RGB-Bild als Fuehrung verwendet: Nachbarn mit aehnlicher Farbe wie
+	/// das Zielpixel zaehlen mehr. Gemittelt werden nur Nachbarn auf derselben Seite der Kante wie der
+	/// staerkste Nachbar, damit keine Tiefenwerte zwischen Kopf und Hintergrund entstehen.
+	///
+	/// Tiefenwerte 0 sind Loecher und werden nie gemittelt. Die Zeilen werden parallel auf dem TaskPool berechnet.
+	class DepthUpsampler
+	{
+
+	public:
+		////////////////////////////////////////////////////////////
+		/// \brief Konstruktor
+		///
+		/// \param spatialSigma  Breite der raeumlichen Gewichtung in Pixeln der kleinen Tiefenkarte
+		/// \param colorSigma    Breite der Farbgewichtung (Summe der Betraege der RGB-Differenzen)
+		/// \param edgeThreshold Tiefendifferenz in mm, ab der zwei Nachbarn als Kante gelten
+		///
+		////////////////////////////////////////////////////////////
+		DepthUpsampler( const float spatialSigma = 0.75f, const float colorSigma = 30.0f, const unsigned short edgeThreshold = 40 );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Vergroessert "pLowDepth" auf width x height.
+		///
+		/// \param pLowDepth   Kleine Tiefenkarte ((width + 1) / 2 x (height + 1) / 2)
+		/// \param pGuide      RGB-Bild als Fuehrung (0 = nur raeumliche Gewichtung)
+		/// \param guideWidth  Breite des RGB-Bildes
+		/// \param guideHeight Hoehe des RGB-Bildes
+		/// \param pDepth      Zielpuffer (width x height)
+		/// \param width       Breite der Zielkarte
+		/// \param height      Hoehe der Zielkarte
+		///
+		/// \return Anzahl der Zielpixel, fuer die der Joint-Bilateral-Filter noetig war
+		///
+		////////////////////////////////////////////////////////////
+		unsigned int upsample(
+			const unsigned short* pLowDepth,
+			const unsigned char* pGuide, const unsigned int guideWidth, const unsigned int guideHeight,
+			unsigned short* pDepth, const unsigned int width, const unsigned int height
+		) const;
+
+		unsigned short getEdgeThreshold(void) const { return m_EdgeThreshold; }
+
+	private:
+		float m_SpatialSigma;				///< Breite der raeumlichen Gewichtung
+		unsigned short m_EdgeThreshold;		///< Tiefendifferenz einer Kante in mm
+		std::vector<float> m_ColorWeights;	///< Farbgewichte fuer Differenzen 0..765
+	};
+};
@@ -0,0 +1,143 @@
+#include "ForegroundSegmenter.h"
+#include "../Core/Trace.h"
+
+namespace DirectLook
+{
+	ForegroundSegmenter::ForegroundSegmenter(void)
+		:
+		m_ComponentCount( 0 )
+	{
+	}
+
+	unsigned int ForegroundSegmenter::extract( BitMask& mask, const ForegroundMode mode, const unsigned int seedX, const unsigned int seedY )
+	{
+		DL_TRACE_SCOPE( "ForegroundSegmenter::extract" );
+		if(mode == FOREGROUND_ALL)
+		{
+			m_ComponentCount = 0;
+			return mask.getCount();
+		}
+
+		// Runs of every row
+		const unsigned int height = mask.getHeight();
+		m_Runs.clear();
+		m_RowStarts.resize( height + 1 );
+		for(unsigned int y = 0; y < height; y++)
+		{
+			m_RowStarts[y] = (unsigned int) m_Runs.size();
+			mask.appendRuns( y, m_Runs );
+		}
+		m_RowStarts[height] = (unsigned int) m_Runs.size();
+
+		const unsigned int runCount = (unsigned int) m_Runs.size();
+		m_ComponentCount = 0;
+		if(runCount == 0)
+		{
+			return 0;
+		}
+
+		m_Parents.resize( runCount );
+		for(unsigned int i = 0; i < runCount; i++)
+		{
+			m_Parents[i] = i;
+		}
+
+		// Join runs touching a run of the row above, diagonal neighbours included
+		for(unsigned int y = 1; y < height; y++)
+		{
+			unsigned int above = m_RowStarts[y - 1];
+			const unsigned int aboveEnd = m_RowStarts[y];
+			for(unsigned int run = m_RowStarts[y]; run < m_RowStarts[y + 1]; run++)
+			{
+				const MaskRun& current = m_Runs[run];
+
+				// Runs above that end left of this one can't touch any later run either
+				while(above < aboveEnd && m_Runs[above].m_X1 < current.m_X0)
+				{
+					above++;
+				}
+				for(unsigned int other = above; other < aboveEnd && m_Runs[other].m_X0 <= current.m_X1; other++)
+				{
+					unite( other, run );
+				}
+			}
+		}
+
+		// Size of every component
+		m_Sizes.assign( runCount, 0 );
+		for(unsigned int i = 0; i < runCount; i++)
+		{
+			const unsigned int root = findRoot( i );
+			if(root == i)
+			{
+				m_ComponentCount++;
+			}
+			m_Sizes[root] += m_Runs[i].m_X1 - m_Runs[i].m_X0;
+		}
+
+		unsigned int keep = runCount;
+		if(mode == FOREGROUND_NEAREST && seedY < height)
+		{
+			for(unsigned int run = m_RowStarts[seedY]; run < m_RowStarts[seedY + 1]; run++)
+			{
+				if(seedX >= m_Runs[run].m_X0 && seedX < m_Runs[run].m_X1)
+				{
+					keep = findRoot( run );
+					break;
+				}
+			}
+		}
+		if(keep == runCount)
+		{
+			// FOREGROUND_LARGEST, or the seed isn't set in the mask
+			keep = 0;
+			for(unsigned int i = 1; i < runCount; i++)
+			{
+				if(m_Sizes[i] > m_Sizes[keep])
+				{
+					keep = i;
+				}
+			}
+		}
+
+		// Remove every run of the other components
+		for(unsigned int y = 0; y < height; y++)
+		{
+			for(unsigned int run = m_RowStarts[y]; run < m_RowStarts[y + 1]; run++)
+			{
+				if(m_Parents[run] != keep && findRoot( run ) != keep)
+				{
+					mask.clearRange( y, m_Runs[run].m_X0, m_Runs[run].m_X1 );
+				}
+			}
+		}
+		return m_Sizes[keep];
+	}
+
+	unsigned int ForegroundSegmenter::findRoot( unsigned int run )
+	{
+		// Path halving keeps the trees flat without recursion
+		while(m_Parents[run] != run)
+		{
+			m_Parents[run] = m_Parents[m_Parents[run]];
+			run = m_Parents[run];
+		}
+		return run;
+	}
+
+	void ForegroundSegmenter::unite( const unsigned int a, const unsigned int b )
+	{
+		const unsigned int rootA = findRoot( a );
+		const unsigned int rootB = findRoot( b );
+
+		// The smaller index becomes the root, so roots always precede their runs
+		if(rootA < rootB)
+		{
+			m_Parents[rootB] = rootA;
+		}
+		else if(rootB < rootA)
+		{
+			m_Parents[rootA] = rootB;
+		}
+	}
+};
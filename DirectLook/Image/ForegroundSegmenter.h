@@ -0,0 +1,61 @@
+#pragma once
+
+#include "BitMask.h"
+
+#include <vector>
+
+namespace DirectLook
+{
+	/// \brief Welche Pixel zwischen Near- und Far-Threshold als Vordergrund gelten, siehe ForegroundSegmenter.
+	enum ForegroundMode
+	{
+		FOREGROUND_ALL,			///< Alle Pixel zwischen den Thresholds (keine Zusammenhangsanalyse)
+		FOREGROUND_LARGEST,		///< Nur die groesste zusammenhaengende Komponente
+		FOREGROUND_NEAREST		///< Nur die Komponente mit dem naechsten Pixel (der Kopf, siehe HeadTracker)
+	};
+
+	/// \brief Die Klasse ForegroundSegmenter behaelt in einer BitMask nur eine zusammenhaengende Komponente.
+	///
+	/// Die gesetzten Bits jeder Zeile werden zu Laeufen zusammengefasst, Laeufe benachbarter Zeilen, die
+	/// sich beruehren (8er-Nachbarschaft), werden mit Union-Find verbunden. Dadurch haengt der Aufwand von
+	/// der Anzahl der Laeufe ab, nicht von der Anzahl der Pixel. Alle Puffer werden wiederverwendet.
+	///
+	/// Die Klasse ist nicht threadsicher.
+	class ForegroundSegmenter
+	{
+
+	public:
+		////////////////////////////////////////////////////////////
+		/// \brief Standardkonstruktor
+		////////////////////////////////////////////////////////////
+		ForegroundSegmenter(void);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Loescht alle Bits von "mask", die nicht zur gewaehlten Komponente gehoeren.
+		///
+		/// \param mask  Maske, wird veraendert
+		/// \param mode  FOREGROUND_LARGEST oder FOREGROUND_NEAREST (FOREGROUND_ALL laesst die Maske unveraendert)
+		/// \param seedX Spalte des naechsten Pixels (nur FOREGROUND_NEAREST)
+		/// \param seedY Zeile des naechsten Pixels (nur FOREGROUND_NEAREST)
+		///
+		/// \return Anzahl der verbliebenen Pixel
+		///
+		////////////////////////////////////////////////////////////
+		unsigned int extract( BitMask& mask, const ForegroundMode mode, const unsigned int seedX = 0, const unsigned int seedY = 0 );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert die Anzahl der Komponenten des letzten Aufrufs von extract() zurueck.
+		////////////////////////////////////////////////////////////
+		unsigned int getComponentCount(void) const { return m_ComponentCount; }
+
+	private:
+		unsigned int findRoot( unsigned int run );
+		void unite( const unsigned int a, const unsigned int b );
+
+		std::vector<MaskRun> m_Runs;			///< Laeufe aller Zeilen
+		std::vector<unsigned int> m_RowStarts;	///< Index des ersten Laufes jeder Zeile (plus Ende)
+		std::vector<unsigned int> m_Parents;	///< Union-Find Eltern der Laeufe
+		std::vector<unsigned int> m_Sizes;		///< Pixel pro Wurzel
+		unsigned int m_ComponentCount;			///< Komponenten des letzten Bildes
+	};
+};
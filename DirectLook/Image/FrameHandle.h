@@ -0,0 +1,263 @@
+#pragma once
+
+#include <QAtomicInt>
+#include <string.h>
+
+#include "../Core/FramePool.h"
+
+namespace DirectLook
+{
+	/// \brief Gemeinsamer, referenzgezaehlter Speicherblock eines Sensorbildes.
+	///
+	/// Wird ausschliesslich ueber FrameHandle verwendet.
+	struct FrameBuffer
+	{
+		QAtomicInt m_RefCount;				///< Anzahl der FrameHandle-Objekte, die auf den Block verweisen
+		void* m_pData;						///< Bilddaten
+		bool m_Owned;						///< Stammen die Bilddaten aus dem FramePool (true) oder gehoeren sie dem Treiber (false)?
+		unsigned int m_Width;				///< Bildbreite
+		unsigned int m_Height;				///< Bildhoehe
+		unsigned int m_Channels;			///< Kanaele pro Pixel
+		unsigned long long m_Timestamp;		///< Zeitstempel des Sensors in Mikrosekunden
+	};
+
+	/// \brief Die Klasse FrameHandle verweist ohne Kopie auf die Bilddaten eines Sensors.
+	///
+	/// Ein FrameHandle kann entweder einen fremden Puffer (z.B. die Metadaten des OpenNI-Treibers)
+	/// umhuellen oder einen eigenen Puffer aus dem FramePool besitzen. Kopien des Handles teilen sich denselben
+	/// Speicher; der Referenzzaehler ist threadsicher. Fremde Puffer sind nur bis zum naechsten
+	/// ISensorInterface::grabFrame() gueltig, wer die Daten laenger braucht, ruft detach() auf.
+	///
+	/// \tparam T Datentyp eines Kanals (unsigned char fuer RGB, unsigned short fuer Tiefenwerte)
+	template<typename T>
+	class FrameHandle
+	{
+
+	private:
+		FrameBuffer* m_pBuffer;	///< Gemeinsamer Speicherblock (0 = leeres Handle)
+
+	public:
+		////////////////////////////////////////////////////////////
+		/// \brief Standardkonstruktor
+		///
+		/// Erzeugt ein leeres FrameHandle.
+		///
+		////////////////////////////////////////////////////////////
+		FrameHandle(void)
+			:
+			m_pBuffer( 0 )
+		{
+		}
+
+		////////////////////////////////////////////////////////////
+		/// \brief Kopierkonstruktor
+		///
+		/// Teilt sich die Bilddaten mit "copy", die Daten selbst werden nicht kopiert.
+		///
+		/// \param copy
+		///
+		////////////////////////////////////////////////////////////
+		FrameHandle( const FrameHandle& copy )
+			:
+			m_pBuffer( copy.m_pBuffer )
+		{
+			if(m_pBuffer)
+			{
+				m_pBuffer->m_RefCount.ref();
+			}
+		}
+
+		////////////////////////////////////////////////////////////
+		/// \brief Move-Konstruktor
+		///
+		/// Uebernimmt den Verweis von "other" ohne den Referenzzaehler zu veraendern.
+		///
+		/// \param other
+		///
+		////////////////////////////////////////////////////////////
+		FrameHandle( FrameHandle&& other )
+			:
+			m_pBuffer( other.m_pBuffer )
+		{
+			other.m_pBuffer = 0;
+		}
+
+		////////////////////////////////////////////////////////////
+		/// \brief Destruktor
+		///
+		/// Gibt eigene Bilddaten frei, sobald das letzte Handle geloescht wird.
+		///
+		////////////////////////////////////////////////////////////
+		~FrameHandle(void)
+		{
+			release();
+		}
+
+		////////////////////////////////////////////////////////////
+		/// \brief = operator
+		///
+		/// \param copy
+		///
+		////////////////////////////////////////////////////////////
+		FrameHandle& operator=( const FrameHandle& copy )
+		{
+			if(m_pBuffer != copy.m_pBuffer)
+			{
+				if(copy.m_pBuffer)
+				{
+					copy.m_pBuffer->m_RefCount.ref();
+				}
+				release();
+				m_pBuffer = copy.m_pBuffer;
+			}
+			return *this;
+		}
+
+		////////////////////////////////////////////////////////////
+		/// \brief Move = operator
+		///
+		/// \param other
+		///
+		////////////////////////////////////////////////////////////
+		FrameHandle& operator=( FrameHandle&& other )
+		{
+			if(this != &other)
+			{
+				release();
+				m_pBuffer = other.m_pBuffer;
+				other.m_pBuffer = 0;
+			}
+			return *this;
+		}
+
+		////////////////////////////////////////////////////////////
+		/// \brief Umhuellt einen fremden Puffer ohne Kopie.
+		///
+		/// \param pData     Bilddaten (gehoeren weiterhin dem Aufrufer)
+		/// \param width     Bildbreite
+		/// \param height    Bildhoehe
+		/// \param channels  Kanaele pro Pixel
+		/// \param timestamp Zeitstempel in Mikrosekunden
+		///
+		/// \return FrameHandle auf die Bilddaten
+		///
+		////////////////////////////////////////////////////////////
+		static FrameHandle wrap( const T* pData, const unsigned int width, const unsigned int height, const unsigned int channels = 1, const unsigned long long timestamp = 0 )
+		{
+			FrameHandle handle;
+			if(pData)
+			{
+				handle.m_pBuffer = createBuffer( const_cast<T*>( pData ), false, width, height, channels, timestamp );
+			}
+			return handle;
+		}
+
+		////////////////////////////////////////////////////////////
+		/// \brief Fordert einen eigenen, uninitialisierten Puffer aus dem FramePool an.
+		///
+		/// \param width    Bildbreite
+		/// \param height   Bildhoehe
+		/// \param channels Kanaele pro Pixel
+		///
+		/// \return FrameHandle auf den neuen Puffer
+		///
+		////////////////////////////////////////////////////////////
+		static FrameHandle allocate( const unsigned int width, const unsigned int height, const unsigned int channels = 1 )
+		{
+			FrameHandle handle;
+			handle.m_pBuffer = createBuffer( FramePool::instance().acquireArray<T>( width * height * channels ), true, width, height, channels, 0 );
+			return handle;
+		}
+
+		////////////////////////////////////////////////////////////
+		/// \brief Sorgt dafuer, dass das Handle eigene Bilddaten besitzt, die es mit niemandem teilt.
+		///
+		/// Verweist das Handle auf einen fremden oder geteilten Puffer, werden die Daten einmalig kopiert.
+		///
+		////////////////////////////////////////////////////////////
+		void detach(void)
+		{
+			if(m_pBuffer && (!m_pBuffer->m_Owned || !isUnique()))
+			{
+				FrameHandle copy = allocate( m_pBuffer->m_Width, m_pBuffer->m_Height, m_pBuffer->m_Channels );
+				memcpy( copy.m_pBuffer->m_pData, m_pBuffer->m_pData, getSize() * sizeof( T ) );
+				copy.m_pBuffer->m_Timestamp = m_pBuffer->m_Timestamp;
+				*this = copy;
+			}
+		}
+
+		////////////////////////////////////////////////////////////
+		/// \brief Gibt den Verweis auf die Bilddaten frei. Das Handle ist danach leer.
+		////////////////////////////////////////////////////////////
+		void release(void)
+		{
+			if(m_pBuffer && !m_pBuffer->m_RefCount.deref())
+			{
+				if(m_pBuffer->m_Owned)
+				{
+					FramePool::instance().release( m_pBuffer->m_pData );
+				}
+				delete m_pBuffer;
+			}
+			m_pBuffer = 0;
+		}
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert true zurueck wenn das Handle auf Bilddaten verweist.
+		////////////////////////////////////////////////////////////
+		bool isValid(void) const { return m_pBuffer != 0; }
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert true zurueck wenn kein anderes Handle dieselben Bilddaten verwendet.
+		////////////////////////////////////////////////////////////
+		bool isUnique(void) const { return m_pBuffer && m_pBuffer->m_RefCount == 1; }
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert true zurueck wenn die Bilddaten aus dem FramePool stammen und nicht dem Treiber gehoeren.
+		////////////////////////////////////////////////////////////
+		bool isOwned(void) const { return m_pBuffer && m_pBuffer->m_Owned; }
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert die Bilddaten zurueck (0 bei einem leeren Handle).
+		////////////////////////////////////////////////////////////
+		const T* getData(void) const { return m_pBuffer ? static_cast<const T*>( m_pBuffer->m_pData ) : 0; }
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert die beschreibbaren Bilddaten zurueck. Nur fuer eigene Puffer, siehe detach().
+		////////////////////////////////////////////////////////////
+		T* getMutableData(void) const { return (m_pBuffer && m_pBuffer->m_Owned) ? static_cast<T*>( m_pBuffer->m_pData ) : 0; }
+
+		unsigned int getWidth(void) const { return m_pBuffer ? m_pBuffer->m_Width : 0; }
+
+		unsigned int getHeight(void) const { return m_pBuffer ? m_pBuffer->m_Height : 0; }
+
+		unsigned int getChannels(void) const { return m_pBuffer ? m_pBuffer->m_Channels : 0; }
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert die Anzahl der Werte zurueck (Breite x Hoehe x Kanaele).
+		////////////////////////////////////////////////////////////
+		unsigned int getSize(void) const { return m_pBuffer ? m_pBuffer->m_Width * m_pBuffer->m_Height * m_pBuffer->m_Channels : 0; }
+
+		unsigned long long getTimestamp(void) const { return m_pBuffer ? m_pBuffer->m_Timestamp : 0; }
+
+		void setTimestamp( const unsigned long long timestamp ) { if(m_pBuffer) m_pBuffer->m_Timestamp = timestamp; }
+
+	private:
+		static FrameBuffer* createBuffer( T* pData, const bool owned, const unsigned int width, const unsigned int height, const unsigned int channels, const unsigned long long timestamp )
+		{
+			FrameBuffer* pBuffer = new FrameBuffer;
+			pBuffer->m_RefCount = 1;
+			pBuffer->m_pData = pData;
+			pBuffer->m_Owned = owned;
+			pBuffer->m_Width = width;
+			pBuffer->m_Height = height;
+			pBuffer->m_Channels = channels;
+			pBuffer->m_Timestamp = timestamp;
+			return pBuffer;
+		}
+	};
+
+	typedef FrameHandle<unsigned char>  ImageFrame;	///< RGB-Bild der Kamera (3 Kanaele)
+	typedef FrameHandle<unsigned short> DepthFrame;	///< Tiefenkarte in der Einheit Millimeter (1 Kanal)
+	typedef FrameHandle<float>          VertexFrame;	///< Vertices der Height-Map (3 Kanaele: x, y, z)
+};
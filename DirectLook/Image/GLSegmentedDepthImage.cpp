@@ -1,4 +1,9 @@
 #include "GLSegmentedDepthImage.h"
+#include "MirrorKernels.h"
+#include "../Core/Trace.h"
+
+#include <string.h>
+#include <utility>
 
 namespace DirectLook
 {
@@ -8,37 +13,49 @@ namespace DirectLook
 		m_pTextureHeightMap( 0 ),
 		m_pVertexHeightMap( 0 ),
 		m_Invert( false ),
-		m_VertexRangeFactor( 1.0f )
+		m_VertexRangeFactor( 1.0f ),
+		m_RetainPixels( true ),
+		m_GridSpacing( 1.0f )
 	{
-		initVertexHeightMap();
 	}
 
 	GLSegmentedDepthImage::GLSegmentedDepthImage( const GLSegmentedDepthImage& copy )
 		:
 		SegmentedDepthImage( copy ),
-		m_pTextureHeightMap( new GLubyte[m_PixelSize] ),
-		m_pVertexHeightMap( new GLfloat[m_PixelSize * 3] ),
+		m_pTextureHeightMap( 0 ),
+		m_pVertexHeightMap( 0 ),
 		m_Invert( copy.m_Invert ),
-		m_VertexRangeFactor( copy.m_VertexRangeFactor )
+		m_VertexRangeFactor( copy.m_VertexRangeFactor ),
+		m_RetainPixels( copy.m_RetainPixels ),
+		m_GridSpacing( copy.m_GridSpacing )
 	{
+		allocateHeightMaps();
+
 		if(copy.m_pTextureHeightMap)
 		{
-			for(unsigned int i = 0; i < m_PixelSize; i++)
-			{
-				m_pTextureHeightMap[i] = copy.m_pTextureHeightMap[i];
-			}
+			memcpy( m_pTextureHeightMap, copy.m_pTextureHeightMap, m_PixelSize * sizeof( GLubyte ) );
 		}
 
 		if(copy.m_pVertexHeightMap)
 		{
-			unsigned int size = m_PixelSize * 3;
-			for(unsigned int i = 0; i < size; i++)
-			{
-				m_pVertexHeightMap[i] = copy.m_pVertexHeightMap[i];
-			}
+			memcpy( m_pVertexHeightMap, copy.m_pVertexHeightMap, m_PixelSize * 3 * sizeof( GLfloat ) );
 		}
 	}
 
+	GLSegmentedDepthImage::GLSegmentedDepthImage( GLSegmentedDepthImage&& other )
+		:
+		SegmentedDepthImage( std::move( other ) ),
+		m_pTextureHeightMap( other.m_pTextureHeightMap ),
+		m_pVertexHeightMap( other.m_pVertexHeightMap ),
+		m_Invert( other.m_Invert ),
+		m_VertexRangeFactor( other.m_VertexRangeFactor ),
+		m_RetainPixels( other.m_RetainPixels ),
+		m_GridSpacing( other.m_GridSpacing )
+	{
+		other.m_pTextureHeightMap = 0;
+		other.m_pVertexHeightMap = 0;
+	}
+
 	GLSegmentedDepthImage::GLSegmentedDepthImage(
 		const unsigned short width,
 		const unsigned short height,
@@ -50,12 +67,15 @@ namespace DirectLook
 	)
 		:
 		SegmentedDepthImage( width, height, nearThreshold, farThreshold, mirrorMode ),
-		m_pTextureHeightMap( new GLubyte[m_Height * m_Width] ),
+		m_pTextureHeightMap( 0 ),
 		m_pVertexHeightMap( 0 ),
 		m_Invert( invert ),
-		m_VertexRangeFactor( 1.0f )
+		m_VertexRangeFactor( 1.0f ),
+		m_RetainPixels( true ),
+		m_GridSpacing( 1.0f )
 	{
 		setVertexRangeFactor( vertexRangeFactor );
+		allocateHeightMaps();
 		initVertexHeightMap();
 	}
 
@@ -74,7 +94,9 @@ namespace DirectLook
 		m_pTextureHeightMap( 0 ),
 		m_pVertexHeightMap( 0 ),
 		m_Invert( invert ),
-		m_VertexRangeFactor( 1.0f )
+		m_VertexRangeFactor( 1.0f ),
+		m_RetainPixels( true ),
+		m_GridSpacing( 1.0f )
 	{
 		setVertexRangeFactor( vertexRangeFactor );
 		setImage( pDepthPixels, width, height );
@@ -85,6 +107,36 @@ namespace DirectLook
 		clear();
 	}
 
+	GLSegmentedDepthImage& GLSegmentedDepthImage::operator=( const GLSegmentedDepthImage& copy )
+	{
+		if(this != &copy)
+		{
+			GLSegmentedDepthImage temp( copy );
+			*this = std::move( temp );
+		}
+		return *this;
+	}
+
+	GLSegmentedDepthImage& GLSegmentedDepthImage::operator=( GLSegmentedDepthImage&& other )
+	{
+		if(this != &other)
+		{
+			clear();
+			SegmentedDepthImage::operator=( std::move( other ) );
+
+			m_pTextureHeightMap = other.m_pTextureHeightMap;
+			m_pVertexHeightMap = other.m_pVertexHeightMap;
+			m_Invert = other.m_Invert;
+			m_VertexRangeFactor = other.m_VertexRangeFactor;
+			m_RetainPixels = other.m_RetainPixels;
+			m_GridSpacing = other.m_GridSpacing;
+
+			other.m_pTextureHeightMap = 0;
+			other.m_pVertexHeightMap = 0;
+		}
+		return *this;
+	}
+
 	void GLSegmentedDepthImage::setImage( const unsigned short* pDepthPixels, const unsigned short width, const unsigned short height )
 	{
 		if(pDepthPixels)
@@ -93,8 +145,8 @@ namespace DirectLook
 			m_Width = width;
 			m_Height = height;
 			m_PixelSize = m_Width * m_Height;
-			m_pImagePixels = new unsigned short[m_PixelSize];
-			m_pTextureHeightMap = new GLubyte[m_PixelSize];
+			allocatePixels();
+			allocateHeightMaps();
 			initVertexHeightMap();
 			updateImage( pDepthPixels );
 		}
@@ -102,88 +154,169 @@ namespace DirectLook
 
 	void GLSegmentedDepthImage::updateImage( const unsigned short* pDepthPixels )
 	{
-		if(pDepthPixels)
+		segment( pDepthPixels, m_RetainPixels ? m_pImagePixels : 0, m_pTextureHeightMap, m_pVertexHeightMap );
+	}
+
+	void GLSegmentedDepthImage::segment( const unsigned short* pDepthPixels, unsigned short* pImagePixels, GLubyte* pTextureHeightMap, GLfloat* pVertexHeightMap )
+	{
+		DL_TRACE_SCOPE( "GLSegmentedDepthImage::segment" );
+		if(pDepthPixels && pTextureHeightMap && pVertexHeightMap)
 		{
-			m_MinDistance = m_FarThreshold;
-			m_MaxDistance = m_NearThreshold;
-	
-			// Create index
-			unsigned int index = 0;
+			const TileRange fullFrame = { 0, 0, m_Width, m_Height };
+			segmentRows( pDepthPixels, pImagePixels, pTextureHeightMap, pVertexHeightMap, fullFrame, buildForegroundMask( pDepthPixels, fullFrame ) );
+		}
+	}
+
+	TileRange GLSegmentedDepthImage::segmentRegion( const unsigned short* pDepthPixels, const TileRange& region )
+	{
+		DL_TRACE_SCOPE( "GLSegmentedDepthImage::segmentRegion" );
+		const unsigned int x0 = (region.m_X0 < m_Width)  ? region.m_X0 : m_Width;
+		const unsigned int y0 = (region.m_Y0 < m_Height) ? region.m_Y0 : m_Height;
+		const unsigned int x1 = (region.m_X1 < m_Width)  ? ((region.m_X1 > x0) ? region.m_X1 : x0) : m_Width;
+		const unsigned int y1 = (region.m_Y1 < m_Height) ? ((region.m_Y1 > y0) ? region.m_Y1 : y0) : m_Height;
+
+		// Same mapping as segment(): mirror mode reverses the columns, otherwise the rows are flipped
+		TileRange gridRegion;
+		gridRegion.m_X0 = m_MirrorMode ? m_Width - x1 : x0;
+		gridRegion.m_X1 = m_MirrorMode ? m_Width - x0 : x1;
+		gridRegion.m_Y0 = m_MirrorMode ? y0 : m_Height - y1;
+		gridRegion.m_Y1 = m_MirrorMode ? y1 : m_Height - y0;
+
+		if(!pDepthPixels || !m_pTextureHeightMap || !m_pVertexHeightMap || x0 == x1 || y0 == y1)
+		{
+			return gridRegion;
+		}
+
+		const TileRange clamped = { x0, y0, x1, y1 };
+		segmentRows( pDepthPixels, m_RetainPixels ? m_pImagePixels : 0, m_pTextureHeightMap, m_pVertexHeightMap, clamped, buildForegroundMask( pDepthPixels, clamped ) );
+		return gridRegion;
+	}
 
-			if(m_MirrorMode)
+	void GLSegmentedDepthImage::segmentRows( const unsigned short* pDepthPixels, unsigned short* pImagePixels, GLubyte* pTextureHeightMap, GLfloat* pVertexHeightMap, const TileRange& region, const BitMask* pMask )
+	{
+		m_MinDistance = m_FarThreshold;
+		m_MaxDistance = m_NearThreshold;
+
+		// Grid coordinates of the vertices, see initVertexHeightMap()
+		const GLfloat widthHalf  = (GLfloat) m_Width  * 0.5f;
+		const GLfloat heightHalf = (GLfloat) m_Height * 0.5f;
+		const GLfloat spacing = m_GridSpacing;
+		const GLubyte background = mapToRangeUByte( 0 );
+
+		// Grid columns of the region, mask bit x belongs to grid column x
+		const unsigned int gridX0 = m_MirrorMode ? m_Width - region.m_X1 : region.m_X0;
+		const unsigned int gridX1 = m_MirrorMode ? m_Width - region.m_X0 : region.m_X1;
+
+		// In mirror mode the columns of each row are reversed into a scratch row first, the segmentation then reads it linearly
+		unsigned short* pMirrorRow = m_MirrorMode ? FramePool::instance().acquireArray<unsigned short>( m_Width ) : 0;
+
+		for(unsigned int y = region.m_Y0; y < region.m_Y1; y++)
+		{
+			// Mirror mode keeps the row order of the sensor, otherwise the rows are flipped for OpenGL
+			const unsigned int gridY = m_MirrorMode ? y : m_Height - 1 - y;
+			const unsigned int rowIndex = gridY * m_Width;
+			const GLfloat vertexY = ((GLfloat) gridY - heightHalf) * spacing;
+			const bool emptyRow = pMask && pMask->isRowEmpty( y );
+
+			const unsigned short* pRow = pDepthPixels + y * m_Width;
+			if(pMirrorRow && !emptyRow)
 			{
-				for(int y = m_Height - 1; y > 0; y--)
+				MirrorKernels::mirrorRow16( pRow + (m_Width - gridX1), pMirrorRow + gridX0, gridX1 - gridX0 );
+				pRow = pMirrorRow;
+			}
+			const unsigned long long* pBits = pMask ? pMask->getRow( y ) : 0;
+
+			for(unsigned int x = gridX0; x < gridX1; )
+			{
+				// One mask word at a time, pixels outside the foreground don't need their depth read
+				const unsigned int wordEnd = ((x / BitMask::WORD_BITS + 1) * BitMask::WORD_BITS < gridX1) ? (x / BitMask::WORD_BITS + 1) * BitMask::WORD_BITS : gridX1;
+				const unsigned long long bits = emptyRow ? 0 : (pBits ? pBits[x / BitMask::WORD_BITS] : ~0ULL);
+
+				if(bits == 0)
 				{
-					for(int x = 0; x < m_Width; x++)
+					for(; x < wordEnd; x++)
 					{
-						unsigned short pixelValue = pDepthPixels[y * m_Width + (m_Width - 1) - x];
-						if(m_NearThreshold > pixelValue)
-						{
-							pixelValue = 0;
-						}
-						else if(m_MinDistance > pixelValue)
+						const unsigned int index = rowIndex + x;
+						if(pImagePixels)
 						{
-							m_MinDistance = pixelValue;
-						}
-						
-						if(m_FarThreshold  < pixelValue)
-						{
-							pixelValue = 0;
-						}
-						else if(m_MaxDistance < pixelValue)
-						{
-							m_MaxDistance = pixelValue;
+							pImagePixels[index] = 0;
 						}
+						pTextureHeightMap[index]		 = background;
+						pVertexHeightMap[index * 3]		 = ((GLfloat) x - widthHalf) * spacing;
+						pVertexHeightMap[index * 3 + 1] = vertexY;
+						pVertexHeightMap[index * 3 + 2] = 0.0f;
+					}
+					continue;
+				}
 
-						// Compute current index
-						index = y * m_Width + x;
-						
-						// Write height map value
-						m_pImagePixels[index]			  = pixelValue;
-						m_pTextureHeightMap[index]		  = mapToRangeUByte( pixelValue );
-						m_pVertexHeightMap[index * 3 + 2] = (GLfloat) pixelValue;	//mapToRangeFloat( pixelValue );
+				for(; x < wordEnd; x++)
+				{
+					unsigned short pixelValue = ((bits >> (x % BitMask::WORD_BITS)) & 1) ? pRow[x] : 0;
+					
+					if(pixelValue < m_NearThreshold)
+					{
+						pixelValue = 0;
+					}
+					else if(m_MinDistance > pixelValue)
+					{
+						m_MinDistance = pixelValue;
+					}
+					
+					if(pixelValue > m_FarThreshold)
+					{
+						pixelValue = 0;
+					}
+					else if(m_MaxDistance < pixelValue)
+					{
+						m_MaxDistance = pixelValue;
 					}
+					
+					// Compute current index
+					const unsigned int index = rowIndex + x;
+					
+					// Write height map value
+					if(pImagePixels)
+					{
+						pImagePixels[index] = pixelValue;
+					}
+					pTextureHeightMap[index]		 = mapToRangeUByte( pixelValue );
+					pVertexHeightMap[index * 3]		 = ((GLfloat) x - widthHalf) * spacing;
+					pVertexHeightMap[index * 3 + 1] = vertexY;
+					pVertexHeightMap[index * 3 + 2] = (GLfloat) pixelValue;	//mapToRangeFloat( pixelValue );
 				}
 			}
-			else
+		}
+
+		FramePool::instance().release( pMirrorRow );
+
+		if(m_MinDistance == m_FarThreshold)  m_MinDistance = m_NearThreshold;
+		if(m_MaxDistance == m_NearThreshold) m_MaxDistance = m_FarThreshold;
+	}
+
+	void GLSegmentedDepthImage::clearRegion( const TileRange& gridRegion )
+	{
+		if(!m_pTextureHeightMap || !m_pVertexHeightMap)
+		{
+			return;
+		}
+
+		const unsigned int x1 = (gridRegion.m_X1 < m_Width)  ? gridRegion.m_X1 : m_Width;
+		const unsigned int y1 = (gridRegion.m_Y1 < m_Height) ? gridRegion.m_Y1 : m_Height;
+		const GLubyte background = mapToRangeUByte( 0 );
+		unsigned short* pImagePixels = m_RetainPixels ? m_pImagePixels : 0;
+
+		for(unsigned int y = gridRegion.m_Y0; y < y1; y++)
+		{
+			for(unsigned int x = gridRegion.m_X0; x < x1; x++)
 			{
-				for(unsigned int y = m_Height - 1; y > 0; y--)
+				const unsigned int index = y * m_Width + x;
+				if(pImagePixels)
 				{
-					for(unsigned int x = 0; x < m_Width; x++)
-					{
-						unsigned short pixelValue = pDepthPixels[y * m_Width + x];
-						
-						if(pixelValue < m_NearThreshold)
-						{
-							pixelValue = 0;
-						}
-						else if(m_MinDistance > pixelValue)
-						{
-							m_MinDistance = pixelValue;
-						}
-						
-						if(pixelValue > m_FarThreshold)
-						{
-							pixelValue = 0;
-						}
-						else if(m_MaxDistance < pixelValue)
-						{
-							m_MaxDistance = pixelValue;
-						}
-						
-						// Compute current index
-						index = (m_Height - 1 - y) * m_Width + x;
-						
-						// Write height map value
-						m_pImagePixels[index]			  = pixelValue;
-						m_pTextureHeightMap[index]		  = mapToRangeUByte( pixelValue );
-						m_pVertexHeightMap[index * 3 + 2] = (GLfloat) pixelValue;	//mapToRangeFloat( pixelValue );
-					}
+					pImagePixels[index] = 0;
 				}
+				m_pTextureHeightMap[index] = background;
+				m_pVertexHeightMap[index * 3 + 2] = 0.0f;
 			}
-	
-			if(m_MinDistance == m_FarThreshold)  m_MinDistance = m_NearThreshold;
-			if(m_MaxDistance == m_NearThreshold) m_MaxDistance = m_FarThreshold;
 		}
 	}
 
@@ -206,10 +339,8 @@ namespace DirectLook
 		m_Height = height;
 		m_PixelSize = m_Width * m_Height;
 
-		m_pImagePixels		= new unsigned short[m_PixelSize];
-		m_pTextureHeightMap = new GLubyte[m_PixelSize];
-		m_pVertexHeightMap	= new GLfloat[m_PixelSize * 3];
-		
+		allocatePixels();
+		allocateHeightMaps();
 		initVertexHeightMap();
 	}
 
@@ -241,11 +372,34 @@ namespace DirectLook
 		return m_VertexRangeFactor;
 	}
 
+	void GLSegmentedDepthImage::setRetainPixels( const bool retainPixels )
+	{
+		m_RetainPixels = retainPixels;
+	}
+
+	void GLSegmentedDepthImage::setGridSpacing( const GLfloat gridSpacing )
+	{
+		m_GridSpacing = (gridSpacing > 0.0f) ? gridSpacing : 1.0f;
+		initVertexHeightMap();
+	}
+
+	GLfloat GLSegmentedDepthImage::getGridSpacing(void) const
+	{
+		return m_GridSpacing;
+	}
+
+	void GLSegmentedDepthImage::allocateHeightMaps(void)
+	{
+		m_pTextureHeightMap = FramePool::instance().acquireArray<GLubyte>( m_PixelSize );
+		m_pVertexHeightMap = FramePool::instance().acquireArray<GLfloat>( m_PixelSize * 3 );
+	}
+
 	void GLSegmentedDepthImage::initVertexHeightMap(void)
 	{
-		// Leeren Vertex-Buffer erzeugen
-		unsigned int bufferSize = m_Height * m_Width * 3;
-		m_pVertexHeightMap = new GLfloat[bufferSize];
+		if(!m_pVertexHeightMap)
+		{
+			return;
+		}
 
 		// Halbe Hoehe und Breite berechnen
 		GLfloat widthHalf  = (GLfloat) m_Width  * 0.5f;
@@ -258,8 +412,8 @@ namespace DirectLook
 			unsigned int index = y * m_Width * 3;			
 			for(unsigned int i = 0; i < (unsigned int)m_Width * 3; i += 3)
 			{
-				m_pVertexHeightMap[index + i]	  = (GLfloat) x - widthHalf;
-				m_pVertexHeightMap[index + i + 1] = (GLfloat) y - heightHalf;
+				m_pVertexHeightMap[index + i]	  = ((GLfloat) x - widthHalf) * m_GridSpacing;
+				m_pVertexHeightMap[index + i + 1] = ((GLfloat) y - heightHalf) * m_GridSpacing;
 				m_pVertexHeightMap[index + i + 2] = 0.0f;
 				x++;
 			}
@@ -317,13 +471,13 @@ namespace DirectLook
 		SegmentedDepthImage::clear();
 		if(m_pTextureHeightMap)
 		{
-			delete[] m_pTextureHeightMap;
+			FramePool::instance().release( m_pTextureHeightMap );
 			m_pTextureHeightMap = 0;
 		}
 		
 		if(m_pVertexHeightMap)
 		{
-			delete[] m_pVertexHeightMap;
+			FramePool::instance().release( m_pVertexHeightMap );
 			m_pVertexHeightMap = 0;
 		}
 	}
@@ -2,6 +2,7 @@
 
 #include <GL/glew.h>
 #include "SegmentedDepthImage.h"
+#include "../Core/TaskPool.h"
 #include <iostream>
 
 using namespace std;
@@ -30,6 +31,16 @@ namespace DirectLook
 		///
 		////////////////////////////////////////////////////////////
 		GLSegmentedDepthImage( const GLSegmentedDepthImage& copy );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Move-Konstruktor
+		///
+		/// Uebernimmt Tiefenwerte, Textur und Vertex-Buffer von "other" ohne Kopie, "other" ist danach leer.
+		///
+		/// \param other
+		///
+		////////////////////////////////////////////////////////////
+		GLSegmentedDepthImage( GLSegmentedDepthImage&& other );
 		
 		////////////////////////////////////////////////////////////
 		/// \brief Konstruktor A
@@ -89,6 +100,22 @@ namespace DirectLook
 		///
 		////////////////////////////////////////////////////////////
 		virtual ~GLSegmentedDepthImage(void);
+
+		////////////////////////////////////////////////////////////
+		/// \brief = operator
+		///
+		/// \param copy
+		///
+		////////////////////////////////////////////////////////////
+		GLSegmentedDepthImage& operator=( const GLSegmentedDepthImage& copy );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Move = operator
+		///
+		/// \param other
+		///
+		////////////////////////////////////////////////////////////
+		GLSegmentedDepthImage& operator=( GLSegmentedDepthImage&& other );
 		
 		//////////////////////////////////////////
 		// ueberschriebene Sensor-Image Methoden //
@@ -113,6 +140,43 @@ namespace DirectLook
 		////////////////////////////////////////////////////////////
 		virtual void updateImage( const unsigned short* pImagePixels );
 
+		////////////////////////////////////////////////////////////
+		/// \brief Segmentiert Tiefenwerte in fremde Puffer mit der Aufloesung dieses Objektes.
+		///
+		/// Schreibt Textur und vollstaendige Vertices (x, y, z), die Puffer muessen also nicht
+		/// vorbereitet sein. Die eigenen Bilddaten bleiben unveraendert, damit mehrere Bilder
+		/// gleichzeitig in verschiedenen Stufen einer Pipeline sein koennen.
+		///
+		/// \param pDepthPixels		Tiefenwerte des Sensors
+		/// \param pImagePixels		Segmentierte Tiefenwerte (Breite x Hoehe, 0 = nicht speichern)
+		/// \param pTextureHeightMap	Grauwert-Textur (Breite x Hoehe)
+		/// \param pVertexHeightMap	Vertex-Buffer (Breite x Hoehe x 3)
+		///
+		////////////////////////////////////////////////////////////
+		void segment( const unsigned short* pDepthPixels, unsigned short* pImagePixels, GLubyte* pTextureHeightMap, GLfloat* pVertexHeightMap );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Segmentiert nur einen Ausschnitt der Tiefenwerte in die eigene Textur und den eigenen Vertex-Buffer.
+		///
+		/// Pixel ausserhalb des Ausschnitts bleiben unveraendert (siehe clearRegion()). Minimale und
+		/// maximale Distanz werden nur aus dem Ausschnitt bestimmt.
+		///
+		/// \param pDepthPixels Tiefenwerte (Breite x Hoehe)
+		/// \param region       Ausschnitt in Bildkoordinaten der Tiefenwerte
+		///
+		/// \return Derselbe Ausschnitt in Koordinaten des 3D-Grids (Zeilen fuer OpenGL umgedreht, ggf. gespiegelt)
+		///
+		////////////////////////////////////////////////////////////
+		TileRange segmentRegion( const unsigned short* pDepthPixels, const TileRange& region );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Setzt einen Ausschnitt des 3D-Grids auf den Tiefenwert 0 (nicht segmentiert) zurueck.
+		///
+		/// \param gridRegion Ausschnitt in Koordinaten des 3D-Grids, wie ihn segmentRegion() liefert
+		///
+		////////////////////////////////////////////////////////////
+		void clearRegion( const TileRange& gridRegion );
+
 		////////////////////////////////////////////////////////////
 		/// \brief Ersetzt den Tiefenwert an der Bildposition (x, y).
 		/// Falls die Bildposition ungueltig ist, wird der Tiefenwert nicht ersetzt.
@@ -169,9 +233,41 @@ namespace DirectLook
 		////////////////////////////////////////////////////////////
 		GLfloat getVertexRangeFactor(void);
 
+		////////////////////////////////////////////////////////////
+		/// \brief Legt fest, ob updateImage() die segmentierten Tiefenwerte zusaetzlich speichert.
+		///
+		/// Wird nur die Textur und der Vertex-Buffer benoetigt, spart das Abschalten eine Kopie pro Bild.
+		/// pixelAt() liefert dann nicht mehr die aktuellen Tiefenwerte.
+		///
+		/// \param retainPixels Tiefenwerte speichern: an / aus
+		///
+		////////////////////////////////////////////////////////////
+		void setRetainPixels( const bool retainPixels );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Setzt den Abstand zweier Gitterpunkte in Sensorpixeln.
+		///
+		/// Wird das 3D-Grid mit geringerer Aufloesung als der Sensor berechnet (z.B. jedes zweite Pixel),
+		/// behaelt das Modell mit dem passenden Abstand seine Groesse und die Texturkoordinaten bleiben gueltig.
+		///
+		/// \param gridSpacing Abstand der Gitterpunkte (1 = volle Aufloesung)
+		///
+		////////////////////////////////////////////////////////////
+		void setGridSpacing( const GLfloat gridSpacing );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert den Abstand zweier Gitterpunkte in Sensorpixeln zurueck.
+		////////////////////////////////////////////////////////////
+		GLfloat getGridSpacing(void) const;
+
 	protected:
 		////////////////////////////////////////////////////////////
-		/// \brief Erzeugt und initialisiert das 3D-Grid der Height-Map.
+		/// \brief Fordert Textur und Vertex-Buffer fuer "m_PixelSize" Pixel aus dem FramePool an.
+		////////////////////////////////////////////////////////////
+		void allocateHeightMaps(void);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Initialisiert das 3D-Grid der Height-Map im bereits angeforderten Vertex-Buffer.
 		///
 		////////////////////////////////////////////////////////////
 		void initVertexHeightMap(void);
@@ -197,9 +293,23 @@ namespace DirectLook
 		////////////////////////////////////////////////////////////
 		virtual void clear(void);
 
+		////////////////////////////////////////////////////////////
+		/// \brief Segmentiert die Zeilen "region" der Tiefenwerte, gemeinsamer Teil von segment() und segmentRegion().
+		///
+		/// Ist "pMask" gesetzt, werden nur Pixel mit gesetztem Bit uebernommen. Leere Zeilen und leere
+		/// Woerter der Maske werden ohne Lesen der Tiefenwerte als Hintergrund geschrieben.
+		///
+		/// \param region Ausschnitt in Bildkoordinaten der Tiefenwerte (bereits auf das Bild begrenzt)
+		/// \param pMask  Vordergrundmaske (0 = alle Pixel zwischen den Thresholds)
+		///
+		////////////////////////////////////////////////////////////
+		void segmentRows( const unsigned short* pDepthPixels, unsigned short* pImagePixels, GLubyte* pTextureHeightMap, GLfloat* pVertexHeightMap, const TileRange& region, const BitMask* pMask );
+
 		GLubyte* m_pTextureHeightMap;	///< Die Tiefenwerte werden als Grauwert-Textur mit der Groesse "Breite x Hoehe" gespeichert
 		GLfloat* m_pVertexHeightMap;	///< Die Tiefenwerte werden als OpenGL Vertex-Buffer mit der Groesse "Breite x Hoehe x 3" gespeichert
 		bool m_Invert;					///< Tiefenwerte invertieren : "Kleine Werte in weiss und grosse Werte in schwarz" oder "kleine Werte in schwarz und grosse Werte in weiss"
 		GLfloat m_VertexRangeFactor;	///< Wird in der Methode "mapToRangeFloat" verwendet um den maximalen Hoehenwert zu bestimmen
+		bool m_RetainPixels;			///< Segmentierte Tiefenwerte in m_pImagePixels speichern?
+		GLfloat m_GridSpacing;			///< Abstand zweier Gitterpunkte in Sensorpixeln
 	};
 }
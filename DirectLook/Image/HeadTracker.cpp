@@ -0,0 +1,242 @@
+#include "HeadTracker.h"
+#include "../Core/Trace.h"
+
+#include <stdlib.h>
+
+namespace DirectLook
+{
+	// Only every fourth pixel in both directions is inspected, a head is far larger than that
+	static const unsigned int SAMPLE_STEP = 4;
+
+	// Depth jump between two neighbouring samples that separates two objects
+	static const int EDGE_MM = 60;
+
+	// Extra border around the predicted head that is searched in the next frame
+	static const int SEARCH_MARGIN = 32;
+
+	// Frames the last head position is kept before the whole frame is searched again
+	static const unsigned int LOST_FRAMES = 10;
+
+	static TileRange expandRange( const TileRange& range, const int marginX, const int marginY, const unsigned int width, const unsigned int height )
+	{
+		const int x0 = (int) range.m_X0 - marginX;
+		const int y0 = (int) range.m_Y0 - marginY;
+		const int x1 = (int) range.m_X1 + marginX;
+		const int y1 = (int) range.m_Y1 + marginY;
+
+		TileRange result;
+		result.m_X0 = (x0 > 0) ? (unsigned int) x0 : 0;
+		result.m_Y0 = (y0 > 0) ? (unsigned int) y0 : 0;
+		result.m_X1 = (x1 < (int) width)  ? (unsigned int) ((x1 > 0) ? x1 : 0) : width;
+		result.m_Y1 = (y1 < (int) height) ? (unsigned int) ((y1 > 0) ? y1 : 0) : height;
+		if(result.m_X1 < result.m_X0) result.m_X1 = result.m_X0;
+		if(result.m_Y1 < result.m_Y0) result.m_Y1 = result.m_Y0;
+		return result;
+	}
+
+	static TileRange shiftRange( const TileRange& range, const int shiftX, const int shiftY )
+	{
+		// Negative coordinates are clamped later by expandRange()
+		TileRange result;
+		result.m_X0 = ((int) range.m_X0 + shiftX > 0) ? (unsigned int) ((int) range.m_X0 + shiftX) : 0;
+		result.m_Y0 = ((int) range.m_Y0 + shiftY > 0) ? (unsigned int) ((int) range.m_Y0 + shiftY) : 0;
+		result.m_X1 = ((int) range.m_X1 + shiftX > 0) ? (unsigned int) ((int) range.m_X1 + shiftX) : 0;
+		result.m_Y1 = ((int) range.m_Y1 + shiftY > 0) ? (unsigned int) ((int) range.m_Y1 + shiftY) : 0;
+		return result;
+	}
+
+	HeadTracker::HeadTracker( const unsigned int margin, const unsigned short headDepth )
+		:
+		m_Margin( margin ),
+		m_HeadDepth( headDepth ),
+		m_Width( 0 ),
+		m_Height( 0 ),
+		m_Locked( false ),
+		m_LostFrames( 0 ),
+		m_VelocityX( 0.0f ),
+		m_VelocityY( 0.0f )
+	{
+		setFullFrame();
+		m_Head = m_Region;
+	}
+
+	const TileRange& HeadTracker::track( const unsigned short* pDepthPixels, const unsigned int width, const unsigned int height, const unsigned short nearThreshold, const unsigned short farThreshold )
+	{
+		DL_TRACE_SCOPE( "HeadTracker::track" );
+		if(width != m_Width || height != m_Height)
+		{
+			m_Width = width;
+			m_Height = height;
+			reset();
+		}
+		if(!pDepthPixels || width == 0 || height == 0)
+		{
+			reset();
+			return m_Region;
+		}
+
+		TileRange fullFrame = { 0, 0, width, height };
+		TileRange head;
+		bool found = false;
+
+		if(m_Locked)
+		{
+			// Look where the head should be now, a little wider the faster it moves
+			const int shiftX = (int) (m_VelocityX + ((m_VelocityX < 0.0f) ? -0.5f : 0.5f));
+			const int shiftY = (int) (m_VelocityY + ((m_VelocityY < 0.0f) ? -0.5f : 0.5f));
+			const TileRange predicted = shiftRange( m_Head, shiftX, shiftY );
+			const TileRange search = expandRange( predicted, SEARCH_MARGIN + abs( shiftX ), SEARCH_MARGIN + abs( shiftY ), width, height );
+			found = findHead( pDepthPixels, search, nearThreshold, farThreshold, head );
+
+			// A head cut off by the search window has moved further than predicted
+			const bool clipped = found && (
+				(head.m_X0 < search.m_X0 + SAMPLE_STEP && search.m_X0 > 0) || (head.m_X1 >= search.m_X1 && search.m_X1 < width) ||
+				(head.m_Y0 < search.m_Y0 + SAMPLE_STEP && search.m_Y0 > 0) || (head.m_Y1 >= search.m_Y1 && search.m_Y1 < height));
+			if(clipped)
+			{
+				found = findHead( pDepthPixels, fullFrame, nearThreshold, farThreshold, head );
+			}
+		}
+		else
+		{
+			found = findHead( pDepthPixels, fullFrame, nearThreshold, farThreshold, head );
+		}
+
+		if(found)
+		{
+			if(m_Locked)
+			{
+				const float moveX = ((float) (head.m_X0 + head.m_X1) - (float) (m_Head.m_X0 + m_Head.m_X1)) * 0.5f;
+				const float moveY = ((float) (head.m_Y0 + head.m_Y1) - (float) (m_Head.m_Y0 + m_Head.m_Y1)) * 0.5f;
+				m_VelocityX = 0.5f * m_VelocityX + 0.5f * moveX;
+				m_VelocityY = 0.5f * m_VelocityY + 0.5f * moveY;
+			}
+			m_Head = head;
+			m_Locked = true;
+			m_LostFrames = 0;
+		}
+		else if(!m_Locked || ++m_LostFrames > LOST_FRAMES)
+		{
+			reset();
+			return m_Region;
+		}
+
+		m_Region = expandRange( m_Head, (int) m_Margin, (int) m_Margin, width, height );
+		return m_Region;
+	}
+
+	void HeadTracker::reset(void)
+	{
+		m_Locked = false;
+		m_LostFrames = 0;
+		m_VelocityX = 0.0f;
+		m_VelocityY = 0.0f;
+		setFullFrame();
+		m_Head = m_Region;
+	}
+
+	void HeadTracker::setFullFrame(void)
+	{
+		m_Region.m_X0 = 0;
+		m_Region.m_Y0 = 0;
+		m_Region.m_X1 = m_Width;
+		m_Region.m_Y1 = m_Height;
+	}
+
+	bool HeadTracker::findHead( const unsigned short* pDepthPixels, const TileRange& search, const unsigned short nearThreshold, const unsigned short farThreshold, TileRange& head )
+	{
+		if(search.m_X1 <= search.m_X0 || search.m_Y1 <= search.m_Y0)
+		{
+			return false;
+		}
+
+		// Samples lie on a fixed lattice over the whole image, so sample indices are the same for every search window
+		const unsigned int columns = (m_Width + SAMPLE_STEP - 1) / SAMPLE_STEP;
+		const unsigned int rows = (m_Height + SAMPLE_STEP - 1) / SAMPLE_STEP;
+		const unsigned int sx0 = (search.m_X0 + SAMPLE_STEP - 1) / SAMPLE_STEP;
+		const unsigned int sy0 = (search.m_Y0 + SAMPLE_STEP - 1) / SAMPLE_STEP;
+		const unsigned int sx1 = (search.m_X1 + SAMPLE_STEP - 1) / SAMPLE_STEP;
+		const unsigned int sy1 = (search.m_Y1 + SAMPLE_STEP - 1) / SAMPLE_STEP;
+		if(sx1 <= sx0 || sy1 <= sy0)
+		{
+			return false;
+		}
+
+		// Nearest valid sample
+		unsigned short nearest = 0;
+		unsigned int seed = 0;
+		for(unsigned int sy = sy0; sy < sy1; sy++)
+		{
+			const unsigned short* pRow = pDepthPixels + sy * SAMPLE_STEP * m_Width;
+			for(unsigned int sx = sx0; sx < sx1; sx++)
+			{
+				const unsigned short depth = pRow[sx * SAMPLE_STEP];
+				if(depth >= nearThreshold && depth <= farThreshold && (nearest == 0 || depth < nearest))
+				{
+					nearest = depth;
+					seed = sy * columns + sx;
+				}
+			}
+		}
+		if(nearest == 0)
+		{
+			return false;
+		}
+
+		// Flood fill the blob around it
+		const unsigned int limit = (unsigned int) nearest + m_HeadDepth;
+		// The visited flags cover the whole lattice and are cleared on every call, only the buffer is reused
+		m_Visited.assign( columns * rows, 0 );
+		m_Stack.clear();
+		m_Stack.push_back( seed );
+		m_Visited[seed] = 1;
+
+		unsigned int minX = seed % columns, maxX = minX;
+		unsigned int minY = seed / columns, maxY = minY;
+		while(!m_Stack.empty())
+		{
+			const unsigned int sample = m_Stack.back();
+			m_Stack.pop_back();
+			const unsigned int sx = sample % columns;
+			const unsigned int sy = sample / columns;
+			const int depth = pDepthPixels[sy * SAMPLE_STEP * m_Width + sx * SAMPLE_STEP];
+
+			if(sx < minX) minX = sx;
+			if(sx > maxX) maxX = sx;
+			if(sy < minY) minY = sy;
+			if(sy > maxY) maxY = sy;
+
+			const unsigned int neighbours[4][2] = { { sx - 1, sy }, { sx + 1, sy }, { sx, sy - 1 }, { sx, sy + 1 } };
+			for(unsigned int i = 0; i < 4; i++)
+			{
+				// sx - 1 and sy - 1 wrap around at the border and fail the upper bound check
+				const unsigned int nx = neighbours[i][0];
+				const unsigned int ny = neighbours[i][1];
+				if(nx < sx0 || nx >= sx1 || ny < sy0 || ny >= sy1)
+				{
+					continue;
+				}
+
+				const unsigned int neighbour = ny * columns + nx;
+				if(m_Visited[neighbour])
+				{
+					continue;
+				}
+
+				const unsigned short other = pDepthPixels[ny * SAMPLE_STEP * m_Width + nx * SAMPLE_STEP];
+				if(other >= nearThreshold && other <= farThreshold && other <= limit && abs( (int) other - depth ) <= EDGE_MM)
+				{
+					m_Visited[neighbour] = 1;
+					m_Stack.push_back( neighbour );
+				}
+			}
+		}
+
+		// Each sample stands for the SAMPLE_STEP x SAMPLE_STEP block to its lower right
+		head.m_X0 = minX * SAMPLE_STEP;
+		head.m_Y0 = minY * SAMPLE_STEP;
+		head.m_X1 = ((maxX + 1) * SAMPLE_STEP < m_Width)  ? (maxX + 1) * SAMPLE_STEP : m_Width;
+		head.m_Y1 = ((maxY + 1) * SAMPLE_STEP < m_Height) ? (maxY + 1) * SAMPLE_STEP : m_Height;
+		return true;
+	}
+};
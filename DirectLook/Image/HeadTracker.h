@@ -0,0 +1,79 @@
+#pragma once
+
+#include "../Core/TaskPool.h"
+
+#include <vector>
+
+namespace DirectLook
+{
+	/// \brief Die Klasse HeadTracker findet den Kopf des Benutzers in der Tiefenkarte und verfolgt ihn von Bild zu Bild.
+	///
+	/// Der Kopf ist der naechste zusammenhaengende Bereich zwischen Near- und Far-Threshold: Ausgehend vom
+	/// naechsten gueltigen Tiefenwert werden alle Nachbarn ohne Tiefensprung und hoechstens "headDepth" mm
+	/// dahinter gesammelt. Gesucht wird auf jedem vierten Pixel in beiden Richtungen. Sobald der Kopf gefunden
+	/// ist, wird nur noch im vorhergesagten Rechteck (letzte Position plus Geschwindigkeit) gesucht. Geht der
+	/// Kopf einige Bilder lang verloren, umfasst der Ausschnitt wieder das ganze Bild.
+	///
+	/// Die Klasse ist nicht threadsicher.
+	class HeadTracker
+	{
+
+	public:
+		////////////////////////////////////////////////////////////
+		/// \brief Konstruktor
+		///
+		/// \param margin    Rand in Pixeln, um den der gefundene Kopf fuer die Verarbeitung vergroessert wird
+		/// \param headDepth Tiefe des Kopfes in mm, weiter entfernte Werte gehoeren nicht mehr dazu
+		///
+		////////////////////////////////////////////////////////////
+		HeadTracker( const unsigned int margin = 16, const unsigned short headDepth = 250 );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Sucht den Kopf in einer Tiefenkarte und liefert den zu verarbeitenden Ausschnitt zurueck.
+		///
+		/// \param pDepthPixels  Tiefenwerte des Sensors
+		/// \param width         Breite der Tiefenkarte
+		/// \param height        Hoehe der Tiefenkarte
+		/// \param nearThreshold Kleinster gueltiger Tiefenwert
+		/// \param farThreshold  Groesster gueltiger Tiefenwert
+		///
+		/// \return Ausschnitt inklusive Rand (das ganze Bild, solange kein Kopf gefunden ist)
+		///
+		////////////////////////////////////////////////////////////
+		const TileRange& track( const unsigned short* pDepthPixels, const unsigned int width, const unsigned int height, const unsigned short nearThreshold, const unsigned short farThreshold );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert den Ausschnitt des letzten Aufrufs von track() zurueck.
+		////////////////////////////////////////////////////////////
+		const TileRange& getRegion(void) const { return m_Region; }
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert true zurueck, solange der Kopf verfolgt wird.
+		////////////////////////////////////////////////////////////
+		bool isLocked(void) const { return m_Locked; }
+
+		////////////////////////////////////////////////////////////
+		/// \brief Vergisst den Kopf, das naechste Bild wird wieder vollstaendig durchsucht.
+		////////////////////////////////////////////////////////////
+		void reset(void);
+
+	private:
+		bool findHead( const unsigned short* pDepthPixels, const TileRange& search, const unsigned short nearThreshold, const unsigned short farThreshold, TileRange& head );
+		void setFullFrame(void);
+
+		unsigned int m_Margin;					///< Rand um den Kopf in Pixeln
+		unsigned short m_HeadDepth;				///< Tiefe des Kopfes in mm
+		unsigned int m_Width;					///< Breite der letzten Tiefenkarte
+		unsigned int m_Height;					///< Hoehe der letzten Tiefenkarte
+
+		bool m_Locked;							///< Wird der Kopf verfolgt?
+		unsigned int m_LostFrames;				///< Bilder in Folge ohne Kopf
+		TileRange m_Head;						///< Zuletzt gefundener Kopf ohne Rand
+		float m_VelocityX;						///< Geglaettete Bewegung des Kopfes in Pixeln pro Bild
+		float m_VelocityY;						///< Geglaettete Bewegung des Kopfes in Pixeln pro Bild
+		TileRange m_Region;						///< Ausschnitt des letzten Bildes
+
+		std::vector<unsigned char> m_Visited;	///< Besuchte Stichproben der Flutfuellung
+		std::vector<unsigned int> m_Stack;		///< Offene Stichproben der Flutfuellung
+	};
+};
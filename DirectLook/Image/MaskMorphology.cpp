@@ -0,0 +1,174 @@
+#include "MaskMorphology.h"
+#include "../Core/Trace.h"
+
+#include <string.h>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define DIRECTLOOK_MASK_SIMD
+#include <emmintrin.h>
+#endif
+
+namespace DirectLook
+{
+	// Combines "count" words of the rows in "ppRows" with AND (erosion) or OR (dilation)
+	static void combineRows( const unsigned long long* const* ppRows, const unsigned int rowCount, unsigned long long* pTarget, const unsigned int count, const bool erosion )
+	{
+		unsigned int word = 0;
+#ifdef DIRECTLOOK_MASK_SIMD
+		// Two words (128 pixels) per instruction
+		for(; word + 2 <= count; word += 2)
+		{
+			__m128i result = _mm_loadu_si128( (const __m128i*) (ppRows[0] + word) );
+			for(unsigned int row = 1; row < rowCount; row++)
+			{
+				const __m128i other = _mm_loadu_si128( (const __m128i*) (ppRows[row] + word) );
+				result = erosion ? _mm_and_si128( result, other ) : _mm_or_si128( result, other );
+			}
+			_mm_storeu_si128( (__m128i*) (pTarget + word), result );
+		}
+#endif
+		for(; word < count; word++)
+		{
+			unsigned long long result = ppRows[0][word];
+			for(unsigned int row = 1; row < rowCount; row++)
+			{
+				result = erosion ? (result & ppRows[row][word]) : (result | ppRows[row][word]);
+			}
+			pTarget[word] = result;
+		}
+	}
+
+	MaskMorphology::MaskMorphology(void)
+	{
+	}
+
+	void MaskMorphology::erode( BitMask& mask, const unsigned int radiusX, const unsigned int radiusY )
+	{
+		DL_TRACE_SCOPE( "MaskMorphology::erode" );
+		apply( mask, radiusX, radiusY, true );
+	}
+
+	void MaskMorphology::dilate( BitMask& mask, const unsigned int radiusX, const unsigned int radiusY )
+	{
+		DL_TRACE_SCOPE( "MaskMorphology::dilate" );
+		apply( mask, radiusX, radiusY, false );
+	}
+
+	void MaskMorphology::open( BitMask& mask, const unsigned int radiusX, const unsigned int radiusY )
+	{
+		erode( mask, radiusX, radiusY );
+		dilate( mask, radiusX, radiusY );
+	}
+
+	void MaskMorphology::close( BitMask& mask, const unsigned int radiusX, const unsigned int radiusY )
+	{
+		dilate( mask, radiusX, radiusY );
+		erode( mask, radiusX, radiusY );
+	}
+
+	void MaskMorphology::apply( BitMask& mask, const unsigned int radiusX, const unsigned int radiusY, const bool erosion )
+	{
+		const unsigned int rx = (radiusX < MAX_RADIUS) ? radiusX : MAX_RADIUS;
+		const unsigned int ry = (radiusY < MAX_RADIUS) ? radiusY : MAX_RADIUS;
+		if((rx == 0 && ry == 0) || mask.getWidth() == 0 || mask.getHeight() == 0)
+		{
+			return;
+		}
+
+		if(m_Temp.getWidth() != mask.getWidth() || m_Temp.getHeight() != mask.getHeight())
+		{
+			m_Temp.resize( mask.getWidth(), mask.getHeight() );
+		}
+
+		// Both passes write every row of their target, so the result ends up in "mask" again
+		filterRows( mask, m_Temp, rx, erosion );
+		filterColumns( m_Temp, mask, ry, erosion );
+	}
+
+	void MaskMorphology::filterRows( const BitMask& source, BitMask& target, const unsigned int radius, const bool erosion )
+	{
+		const unsigned int words = source.getWordsPerRow();
+		const unsigned int tailBits = source.getWidth() % BitMask::WORD_BITS;
+
+		// Pixels beyond the image border: set for erosion, clear for dilation
+		const unsigned long long border = erosion ? ~0ULL : 0ULL;
+		m_Row.resize( words + 2 );
+
+		for(unsigned int y = 0; y < source.getHeight(); y++)
+		{
+			unsigned long long* pTarget = target.getMutableRow( y );
+			if(source.isRowEmpty( y ) || radius == 0)
+			{
+				memcpy( pTarget, source.getRow( y ), words * sizeof( unsigned long long ) );
+				target.updateRowCount( y );
+				continue;
+			}
+
+			// m_Row[1 + i] is word i, so the neighbours of the first and last word are border words
+			unsigned long long* pRow = &m_Row[1];
+			memcpy( pRow, source.getRow( y ), words * sizeof( unsigned long long ) );
+			m_Row[0] = border;
+			m_Row[words + 1] = border;
+			if(erosion && tailBits != 0)
+			{
+				pRow[words - 1] |= ~0ULL << tailBits;
+			}
+
+			for(unsigned int word = 0; word < words; word++)
+			{
+				const unsigned long long current = pRow[word];
+				const unsigned long long left = m_Row[word];
+				const unsigned long long right = m_Row[word + 2];
+				unsigned long long result = current;
+				for(unsigned int shift = 1; shift <= radius; shift++)
+				{
+					// Pixel x looks at x - shift and x + shift, across the word boundary
+					const unsigned long long fromLeft  = (current << shift) | (left >> (BitMask::WORD_BITS - shift));
+					const unsigned long long fromRight = (current >> shift) | (right << (BitMask::WORD_BITS - shift));
+					result = erosion ? (result & fromLeft & fromRight) : (result | fromLeft | fromRight);
+				}
+				pTarget[word] = result;
+			}
+			target.updateRowCount( y );
+		}
+	}
+
+	void MaskMorphology::filterColumns( const BitMask& source, BitMask& target, const unsigned int radius, const bool erosion )
+	{
+		const unsigned int words = source.getWordsPerRow();
+		const unsigned int height = source.getHeight();
+		const unsigned long long* ppRows[2 * MAX_RADIUS + 1];
+
+		for(unsigned int y = 0; y < height; y++)
+		{
+			// Rows outside the image are left out, which treats them as set for erosion and clear for dilation
+			const unsigned int y0 = (y > radius) ? y - radius : 0;
+			const unsigned int y1 = (y + radius + 1 < height) ? y + radius + 1 : height;
+
+			unsigned int rowCount = 0;
+			bool emptyResult = erosion && source.isRowEmpty( y );
+			for(unsigned int other = y0; other < y1 && !emptyResult; other++)
+			{
+				if(!source.isRowEmpty( other ))
+				{
+					ppRows[rowCount++] = source.getRow( other );
+				}
+				else if(erosion)
+				{
+					emptyResult = true;
+				}
+			}
+
+			unsigned long long* pTarget = target.getMutableRow( y );
+			if(emptyResult || rowCount == 0)
+			{
+				memset( pTarget, 0, words * sizeof( unsigned long long ) );
+			}
+			else
+			{
+				combineRows( ppRows, rowCount, pTarget, words, erosion );
+			}
+			target.updateRowCount( y );
+		}
+	}
+};
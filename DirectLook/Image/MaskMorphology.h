@@ -0,0 +1,75 @@
+#pragma once
+
+#include "BitMask.h"
+
+#include <vector>
+
+namespace DirectLook
+{
+	/// \brief Die Klasse MaskMorphology wendet Erosion und Dilatation auf eine BitMask an.
+	///
+	/// Das Strukturelement ist ein Rechteck mit (2 * radiusX + 1) x (2 * radiusY + 1) Pixeln und wird
+	/// separiert: zuerst jede Zeile mit Verschiebungen ganzer Woerter (64 Pixel pro Operation), danach
+	/// jede Spalte mit UND bzw. ODER der benachbarten Zeilen (mit SSE2 128 Pixel pro Operation).
+	/// Leere Zeilen werden uebersprungen. Pixel ausserhalb des Bildes gelten bei der Erosion als gesetzt
+	/// und bei der Dilatation als nicht gesetzt, der Bildrand wird also nicht abgetragen.
+	///
+	/// Die Klasse ist nicht threadsicher.
+	class MaskMorphology
+	{
+
+	public:
+		static const unsigned int MAX_RADIUS = 63;	///< Groesster Radius, der mit einer Wortverschiebung auskommt
+
+		////////////////////////////////////////////////////////////
+		/// \brief Standardkonstruktor
+		////////////////////////////////////////////////////////////
+		MaskMorphology(void);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Erodiert die Maske: ein Pixel bleibt nur gesetzt, wenn alle Pixel des Rechtecks gesetzt sind.
+		///
+		/// \param mask    Maske, wird veraendert
+		/// \param radiusX Horizontaler Radius (0 = keine horizontale Filterung, hoechstens MAX_RADIUS)
+		/// \param radiusY Vertikaler Radius (0 = keine vertikale Filterung, hoechstens MAX_RADIUS)
+		///
+		////////////////////////////////////////////////////////////
+		void erode( BitMask& mask, const unsigned int radiusX, const unsigned int radiusY );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Dilatiert die Maske: ein Pixel wird gesetzt, wenn ein Pixel des Rechtecks gesetzt ist.
+		///
+		/// \param mask    Maske, wird veraendert
+		/// \param radiusX Horizontaler Radius (0 = keine horizontale Filterung, hoechstens MAX_RADIUS)
+		/// \param radiusY Vertikaler Radius (0 = keine vertikale Filterung, hoechstens MAX_RADIUS)
+		///
+		////////////////////////////////////////////////////////////
+		void dilate( BitMask& mask, const unsigned int radiusX, const unsigned int radiusY );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Oeffnen (Erosion, danach Dilatation): entfernt Sprenkel und schmale Auslaeufer.
+		////////////////////////////////////////////////////////////
+		void open( BitMask& mask, const unsigned int radiusX, const unsigned int radiusY );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Schliessen (Dilatation, danach Erosion): fuellt kleine Loecher und Einkerbungen.
+		////////////////////////////////////////////////////////////
+		void close( BitMask& mask, const unsigned int radiusX, const unsigned int radiusY );
+
+	private:
+		////////////////////////////////////////////////////////////
+		/// \brief Horizontaler Durchlauf von "source" nach "target" (gleiche Groesse).
+		////////////////////////////////////////////////////////////
+		void filterRows( const BitMask& source, BitMask& target, const unsigned int radius, const bool erosion );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Vertikaler Durchlauf von "source" nach "target" (gleiche Groesse).
+		////////////////////////////////////////////////////////////
+		void filterColumns( const BitMask& source, BitMask& target, const unsigned int radius, const bool erosion );
+
+		void apply( BitMask& mask, const unsigned int radiusX, const unsigned int radiusY, const bool erosion );
+
+		BitMask m_Temp;								///< Ergebnis des horizontalen Durchlaufs
+		std::vector<unsigned long long> m_Row;		///< Zeile mit je einem Randwort links und rechts
+	};
+};
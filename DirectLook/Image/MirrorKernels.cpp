@@ -0,0 +1,155 @@
+#include "MirrorKernels.h"
+
+#include <string.h>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define DIRECTLOOK_MIRROR_SIMD
+#include <emmintrin.h>
+#include <tmmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+// GCC and Clang only emit SSSE3 instructions inside functions that ask for them
+#if defined(DIRECTLOOK_MIRROR_SIMD) && defined(__GNUC__)
+#define DIRECTLOOK_TARGET_SSSE3 __attribute__((target("ssse3")))
+#else
+#define DIRECTLOOK_TARGET_SSSE3
+#endif
+
+namespace DirectLook
+{
+#pragma region Scalar
+	static void mirrorRow16Scalar( const unsigned short* pSrc, unsigned short* pDst, const unsigned int width )
+	{
+		const unsigned short* pIn = pSrc + width;
+		for(unsigned int x = 0; x < width; x++)
+		{
+			pDst[x] = *--pIn;
+		}
+	}
+
+	static void mirrorRow24Scalar( const unsigned char* pSrc, unsigned char* pDst, const unsigned int width )
+	{
+		const unsigned char* pIn = pSrc + width * 3;
+		for(unsigned int x = 0; x < width; x++)
+		{
+			pIn -= 3;
+			pDst[0] = pIn[0];
+			pDst[1] = pIn[1];
+			pDst[2] = pIn[2];
+			pDst += 3;
+		}
+	}
+#pragma endregion
+
+#ifdef DIRECTLOOK_MIRROR_SIMD
+#pragma region SIMD
+	static void mirrorRow16SSE2( const unsigned short* pSrc, unsigned short* pDst, const unsigned int width )
+	{
+		unsigned int x = 0;
+
+		// Reverse 8 depth values per step: swap the 64 bit halves, then the words within each half
+		for(; x + 8 <= width; x += 8)
+		{
+			__m128i values = _mm_loadu_si128( (const __m128i*) (pSrc + width - 8 - x) );
+			values = _mm_shuffle_epi32( values, _MM_SHUFFLE( 1, 0, 3, 2 ) );
+			values = _mm_shufflelo_epi16( values, _MM_SHUFFLE( 0, 1, 2, 3 ) );
+			values = _mm_shufflehi_epi16( values, _MM_SHUFFLE( 0, 1, 2, 3 ) );
+			_mm_storeu_si128( (__m128i*) (pDst + x), values );
+		}
+
+		mirrorRow16Scalar( pSrc, pDst + x, width - x );
+	}
+
+	DIRECTLOOK_TARGET_SSSE3
+	static void mirrorRow24SSSE3( const unsigned char* pSrc, unsigned char* pDst, const unsigned int width )
+	{
+		// A 16 byte register holds 5 whole pixels. The load starts one byte before them so it never
+		// reads past the end of the row; byte 0 is that extra byte, pixel k sits at bytes 1 + 3k.
+		// Output pixel j takes input pixel 4 - j, the 16th output byte is overwritten by the next step.
+		const __m128i shuffle = _mm_setr_epi8(
+			13, 14, 15,
+			10, 11, 12,
+			 7,  8,  9,
+			 4,  5,  6,
+			 1,  2,  3,
+			(char) 0x80 );
+
+		unsigned int x = 0;
+
+		// The 16 byte store must stay inside the row, so leave at least one pixel for the tail
+		for(; x + 6 <= width; x += 5)
+		{
+			__m128i pixels = _mm_loadu_si128( (const __m128i*) (pSrc + (width - 5 - x) * 3 - 1) );
+			_mm_storeu_si128( (__m128i*) (pDst + x * 3), _mm_shuffle_epi8( pixels, shuffle ) );
+		}
+
+		mirrorRow24Scalar( pSrc, pDst + x * 3, width - x );
+	}
+#pragma endregion
+#endif
+
+	void MirrorKernels::mirrorRow16( const unsigned short* pSrc, unsigned short* pDst, const unsigned int width )
+	{
+#ifdef DIRECTLOOK_MIRROR_SIMD
+		// SSE2 is part of every x86-64 CPU and every CPU OpenNI runs on
+		mirrorRow16SSE2( pSrc, pDst, width );
+#else
+		mirrorRow16Scalar( pSrc, pDst, width );
+#endif
+	}
+
+	void MirrorKernels::mirrorRow24( const unsigned char* pSrc, unsigned char* pDst, const unsigned int width )
+	{
+#ifdef DIRECTLOOK_MIRROR_SIMD
+		static const bool ssse3 = hasSSSE3();
+		if(ssse3)
+		{
+			mirrorRow24SSSE3( pSrc, pDst, width );
+			return;
+		}
+#endif
+		mirrorRow24Scalar( pSrc, pDst, width );
+	}
+
+	void MirrorKernels::mirrorImage16( const unsigned short* pSrc, unsigned short* pDst, const unsigned int width, const unsigned int height )
+	{
+		for(unsigned int y = 0; y < height; y++)
+		{
+			mirrorRow16( pSrc + y * width, pDst + y * width, width );
+		}
+	}
+
+	void MirrorKernels::mirrorImage24( const unsigned char* pSrc, unsigned char* pDst, const unsigned int width, const unsigned int height )
+	{
+		const unsigned int stride = width * 3;
+		for(unsigned int y = 0; y < height; y++)
+		{
+			mirrorRow24( pSrc + y * stride, pDst + y * stride, width );
+		}
+	}
+
+	bool MirrorKernels::hasSSSE3(void)
+	{
+#ifdef DIRECTLOOK_MIRROR_SIMD
+#ifdef _MSC_VER
+		int info[4];
+		__cpuid( info, 1 );
+		return (info[2] & (1 << 9)) != 0;
+#else
+		unsigned int eax, ebx, ecx, edx;
+		if(!__get_cpuid( 1, &eax, &ebx, &ecx, &edx ))
+		{
+			return false;
+		}
+		return (ecx & bit_SSSE3) != 0;
+#endif
+#else
+		return false;
+#endif
+	}
+};
@@ -0,0 +1,61 @@
+#pragma once
+
+namespace DirectLook
+{
+	/// \brief Die Klasse MirrorKernels spiegelt Bildzeilen horizontal.
+	///
+	/// Tiefenwerte werden mit SSE2 in Bloecken zu 8 Werten umgedreht, RGB-Pixel mit SSSE3 (pshufb)
+	/// in Bloecken zu 5 Pixeln. Welcher Pfad verwendet wird, entscheidet die CPU-Erkennung zur Laufzeit;
+	/// ohne SSSE3 bzw. ausserhalb von x86 wird skalar gespiegelt. Quelle und Ziel duerfen sich nicht ueberlappen.
+	class MirrorKernels
+	{
+
+	public:
+		////////////////////////////////////////////////////////////
+		/// \brief Spiegelt eine Zeile mit 16 bit Tiefenwerten.
+		///
+		/// \param pSrc		Quellzeile
+		/// \param pDst		Zielzeile
+		/// \param width	Anzahl der Pixel in der Zeile
+		///
+		////////////////////////////////////////////////////////////
+		static void mirrorRow16( const unsigned short* pSrc, unsigned short* pDst, const unsigned int width );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Spiegelt eine Zeile mit 24 bit RGB-Pixeln.
+		///
+		/// \param pSrc		Quellzeile
+		/// \param pDst		Zielzeile
+		/// \param width	Anzahl der Pixel in der Zeile
+		///
+		////////////////////////////////////////////////////////////
+		static void mirrorRow24( const unsigned char* pSrc, unsigned char* pDst, const unsigned int width );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Spiegelt alle Zeilen einer Tiefenkarte.
+		///
+		/// \param pSrc		Quellbild
+		/// \param pDst		Zielbild
+		/// \param width	Bildbreite
+		/// \param height	Bildhoehe
+		///
+		////////////////////////////////////////////////////////////
+		static void mirrorImage16( const unsigned short* pSrc, unsigned short* pDst, const unsigned int width, const unsigned int height );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Spiegelt alle Zeilen eines RGB-Bildes.
+		///
+		/// \param pSrc		Quellbild
+		/// \param pDst		Zielbild
+		/// \param width	Bildbreite
+		/// \param height	Bildhoehe
+		///
+		////////////////////////////////////////////////////////////
+		static void mirrorImage24( const unsigned char* pSrc, unsigned char* pDst, const unsigned int width, const unsigned int height );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert true zurueck wenn die CPU SSSE3 unterstuetzt.
+		////////////////////////////////////////////////////////////
+		static bool hasSSSE3(void);
+	};
+};
@@ -1,4 +1,7 @@
 #include "RGBImage.h"
+#include "MirrorKernels.h"
+
+#include <string.h>
 
 namespace DirectLook
 {
@@ -22,22 +25,31 @@ namespace DirectLook
 	{
 		if(copy.m_pImagePixels)
 		{
-			m_pImagePixels = new unsigned char[m_PixelSize];
-			for(unsigned int i = 0; i < m_PixelSize; i++)
-			{
-				m_pImagePixels[i] = copy.m_pImagePixels[i];
-			}
+			allocatePixels();
+			memcpy( m_pImagePixels, copy.m_pImagePixels, m_PixelSize );
 		}
 	}
 
+	RGBImage::RGBImage( RGBImage&& other )
+		:
+		m_pImagePixels( 0 ),
+		m_Width( 0 ),
+		m_Height( 0 ),
+		m_PixelSize( 0 ),
+		m_MirrorMode( false )
+	{
+		takeFrom( other );
+	}
+
 	RGBImage::RGBImage( const unsigned short width, const unsigned short height, const bool mirrorMode )
 		:
-		m_pImagePixels( new unsigned char[width * height * 3] ),
+		m_pImagePixels( 0 ),
 		m_Width( width ),
 		m_Height( height ),
 		m_PixelSize( m_Width * m_Height * 3 ),
 		m_MirrorMode( mirrorMode )
 	{
+		allocatePixels();
 	}
 
 	RGBImage::RGBImage(
@@ -57,6 +69,41 @@ namespace DirectLook
 	{
 		clear();
 	}
+
+	RGBImage& RGBImage::operator=( const RGBImage& copy )
+	{
+		if(this != &copy)
+		{
+			if(m_PixelSize != copy.m_PixelSize || !m_pImagePixels)
+			{
+				RGBImage::clear();
+				m_PixelSize = copy.m_PixelSize;
+				if(copy.m_pImagePixels)
+				{
+					allocatePixels();
+				}
+			}
+
+			m_Width = copy.m_Width;
+			m_Height = copy.m_Height;
+			m_MirrorMode = copy.m_MirrorMode;
+			if(copy.m_pImagePixels)
+			{
+				memcpy( m_pImagePixels, copy.m_pImagePixels, m_PixelSize );
+			}
+		}
+		return *this;
+	}
+
+	RGBImage& RGBImage::operator=( RGBImage&& other )
+	{
+		if(this != &other)
+		{
+			RGBImage::clear();
+			takeFrom( other );
+		}
+		return *this;
+	}
 		
 	void RGBImage::setImage( const unsigned char* pImagePixels, const unsigned short width, const unsigned short height )
 	{
@@ -66,7 +113,7 @@ namespace DirectLook
 			m_Width = width;
 			m_Height = height;
 			m_PixelSize = m_Width * m_Height * 3;
-			m_pImagePixels = new unsigned char[m_PixelSize];
+			allocatePixels();
 			updateImage( pImagePixels );
 		}
 	}
@@ -77,24 +124,11 @@ namespace DirectLook
 		{
 			if(m_MirrorMode)
 			{
-				unsigned int index = 0;
-				for(unsigned int y = 0; y < m_Height; y++)
-				{
-					for(unsigned int x = 0; x < (unsigned int)m_Width * 3; x += 3)
-					{
-						m_pImagePixels[index]	  = pImagePixels[(y * m_Width + m_Width - 1) * 3 - x];
-						m_pImagePixels[index + 1] = pImagePixels[(y * m_Width + m_Width - 1) * 3 - x + 1];
-						m_pImagePixels[index + 2] = pImagePixels[(y * m_Width + m_Width - 1) * 3 - x + 2];
-						index += 3;
-					}
-				}
+				MirrorKernels::mirrorImage24( pImagePixels, m_pImagePixels, m_Width, m_Height );
 			}
 			else
 			{
-				for(unsigned int i = 0; i < m_PixelSize; i++)
-				{
-					m_pImagePixels[i] = pImagePixels[i];
-				}
+				memcpy( m_pImagePixels, pImagePixels, m_PixelSize );
 			}
 		}
 	}
@@ -116,7 +150,7 @@ namespace DirectLook
 		m_Width = width;
 		m_Height = height;
 		m_PixelSize = m_Width * m_Height * 3;
-		m_pImagePixels = new unsigned char[m_PixelSize];
+		allocatePixels();
 	}
 
 	const unsigned char RGBImage::pixelRedAt( const unsigned int x, const unsigned int y )
@@ -164,12 +198,10 @@ namespace DirectLook
 	{
 		if(pImagePixels)
 		{
+			clear();
 			m_PixelSize = m_Width * m_Height * 3;
-			m_pImagePixels = new unsigned char[m_PixelSize];
-			for(unsigned int i = 0; i < m_PixelSize; i++)
-			{
-				m_pImagePixels[i] = pImagePixels[i];
-			}
+			allocatePixels();
+			memcpy( m_pImagePixels, pImagePixels, m_PixelSize );
 		}
 	}
 
@@ -182,8 +214,27 @@ namespace DirectLook
 	{
 		if(m_pImagePixels != 0)
 		{
-			delete[] m_pImagePixels;
+			FramePool::instance().release( m_pImagePixels );
 			m_pImagePixels = 0;
 		}
 	}
+
+	void RGBImage::allocatePixels(void)
+	{
+		m_pImagePixels = FramePool::instance().acquireArray<unsigned char>( m_PixelSize );
+	}
+
+	void RGBImage::takeFrom( RGBImage& other )
+	{
+		m_pImagePixels = other.m_pImagePixels;
+		m_Width = other.m_Width;
+		m_Height = other.m_Height;
+		m_PixelSize = other.m_PixelSize;
+		m_MirrorMode = other.m_MirrorMode;
+
+		other.m_pImagePixels = 0;
+		other.m_Width = 0;
+		other.m_Height = 0;
+		other.m_PixelSize = 0;
+	}
 }
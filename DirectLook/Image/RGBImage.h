@@ -1,5 +1,7 @@
 #pragma once
 
+#include "../Core/FramePool.h"
+
 namespace DirectLook
 {
 	/// \brief Die Klasse RGBImage repraesentiert eine einheitliche Datenstruktor der Sensor-Kameradaten.
@@ -24,6 +26,16 @@ namespace DirectLook
 		///
 		////////////////////////////////////////////////////////////
 		RGBImage( const RGBImage& copy );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Move-Konstruktor
+		///
+		/// Uebernimmt die Bilddaten von "other" ohne Kopie, "other" ist danach leer.
+		///
+		/// \param other
+		///
+		////////////////////////////////////////////////////////////
+		RGBImage( RGBImage&& other );
 		
 		////////////////////////////////////////////////////////////
 		/// \brief Konstruktor A
@@ -58,6 +70,26 @@ namespace DirectLook
 		///
 		////////////////////////////////////////////////////////////
 		virtual ~RGBImage(void);
+
+		////////////////////////////////////////////////////////////
+		/// \brief = operator
+		///
+		/// Erzeugt eine tiefe Kopie des uebergebenen Camera-Image Objektes.
+		///
+		/// \param copy
+		///
+		////////////////////////////////////////////////////////////
+		RGBImage& operator=( const RGBImage& copy );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Move = operator
+		///
+		/// Uebernimmt die Bilddaten von "other" ohne Kopie, "other" ist danach leer.
+		///
+		/// \param other
+		///
+		////////////////////////////////////////////////////////////
+		RGBImage& operator=( RGBImage&& other );
 		
 		////////////////////////////////////////////////////////////
 		/// \brief Erzeugt einen neuen Camera-Image Datenzeiger mit der Aufloesung "width" x "height".
@@ -190,6 +222,16 @@ namespace DirectLook
 		////////////////////////////////////////////////////////////
 		virtual void clear(void);
 
+		////////////////////////////////////////////////////////////
+		/// \brief Fordert den Bildpuffer fuer "m_PixelSize" Farbwerte aus dem FramePool an.
+		////////////////////////////////////////////////////////////
+		void allocatePixels(void);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Uebernimmt Bilddaten und Eigenschaften von "other" und hinterlaesst es leer.
+		////////////////////////////////////////////////////////////
+		void takeFrom( RGBImage& other );
+
 		unsigned char* m_pImagePixels;	///< 8 bit RGB-Daten
 		unsigned short m_Width;			///< Bildbreite
 		unsigned short m_Height;		///< Bildhoehe
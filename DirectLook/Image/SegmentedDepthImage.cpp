@@ -1,4 +1,9 @@
 #include "SegmentedDepthImage.h"
+#include "MirrorKernels.h"
+#include "../Core/Clock.h"
+
+#include <string.h>
+#include <utility>
 
 namespace DirectLook
 {
@@ -8,7 +13,12 @@ namespace DirectLook
 		m_MinDistance( 0 ),
 		m_MaxDistance( 0 ),
 		m_NearThreshold( MIN_OPEN_NI_THRESHOLD ),
-		m_FarThreshold( MAX_OPEN_NI_THRESHOLD )
+		m_FarThreshold( MAX_OPEN_NI_THRESHOLD ),
+		m_ForegroundMode( FOREGROUND_ALL ),
+		m_ForegroundPixels( 0 ),
+		m_OpenRadius( 0 ),
+		m_CloseRadius( 0 ),
+		m_MaskMicroseconds( 0 )
 	{
 	}
 
@@ -18,7 +28,27 @@ namespace DirectLook
 		m_MinDistance( copy.m_MinDistance ),
 		m_MaxDistance( copy.m_MaxDistance ),
 		m_NearThreshold( copy.m_NearThreshold ),
-		m_FarThreshold( copy.m_FarThreshold )
+		m_FarThreshold( copy.m_FarThreshold ),
+		m_ForegroundMode( copy.m_ForegroundMode ),
+		m_ForegroundPixels( 0 ),
+		m_OpenRadius( copy.m_OpenRadius ),
+		m_CloseRadius( copy.m_CloseRadius ),
+		m_MaskMicroseconds( 0 )
+	{
+	}
+
+	SegmentedDepthImage::SegmentedDepthImage( SegmentedDepthImage&& other )
+		:
+		DepthImage( std::move( other ) ),
+		m_MinDistance( other.m_MinDistance ),
+		m_MaxDistance( other.m_MaxDistance ),
+		m_NearThreshold( other.m_NearThreshold ),
+		m_FarThreshold( other.m_FarThreshold ),
+		m_ForegroundMode( other.m_ForegroundMode ),
+		m_ForegroundPixels( 0 ),
+		m_OpenRadius( other.m_OpenRadius ),
+		m_CloseRadius( other.m_CloseRadius ),
+		m_MaskMicroseconds( 0 )
 	{
 	}
 
@@ -34,7 +64,12 @@ namespace DirectLook
 		m_MinDistance( 0 ),
 		m_MaxDistance( 0 ),
 		m_NearThreshold( nearThreshold ),
-		m_FarThreshold( farThreshold )
+		m_FarThreshold( farThreshold ),
+		m_ForegroundMode( FOREGROUND_ALL ),
+		m_ForegroundPixels( 0 ),
+		m_OpenRadius( 0 ),
+		m_CloseRadius( 0 ),
+		m_MaskMicroseconds( 0 )
 	{	
 	}
 
@@ -51,7 +86,12 @@ namespace DirectLook
 		m_MinDistance( 0 ),
 		m_MaxDistance( 0 ),
 		m_NearThreshold( nearThreshold ),
-		m_FarThreshold( farThreshold )
+		m_FarThreshold( farThreshold ),
+		m_ForegroundMode( FOREGROUND_ALL ),
+		m_ForegroundPixels( 0 ),
+		m_OpenRadius( 0 ),
+		m_CloseRadius( 0 ),
+		m_MaskMicroseconds( 0 )
 	{
 		setImage( pDepthPixels, width, height );
 	}
@@ -61,6 +101,32 @@ namespace DirectLook
 		clear();
 	}
 
+	SegmentedDepthImage& SegmentedDepthImage::operator=( const SegmentedDepthImage& copy )
+	{
+		DepthImage::operator=( copy );
+		m_MinDistance = copy.m_MinDistance;
+		m_MaxDistance = copy.m_MaxDistance;
+		m_NearThreshold = copy.m_NearThreshold;
+		m_FarThreshold = copy.m_FarThreshold;
+		m_ForegroundMode = copy.m_ForegroundMode;
+		m_OpenRadius = copy.m_OpenRadius;
+		m_CloseRadius = copy.m_CloseRadius;
+		return *this;
+	}
+
+	SegmentedDepthImage& SegmentedDepthImage::operator=( SegmentedDepthImage&& other )
+	{
+		DepthImage::operator=( std::move( other ) );
+		m_MinDistance = other.m_MinDistance;
+		m_MaxDistance = other.m_MaxDistance;
+		m_NearThreshold = other.m_NearThreshold;
+		m_FarThreshold = other.m_FarThreshold;
+		m_ForegroundMode = other.m_ForegroundMode;
+		m_OpenRadius = other.m_OpenRadius;
+		m_CloseRadius = other.m_CloseRadius;
+		return *this;
+	}
+
 	void SegmentedDepthImage::setImage( const unsigned short* pImagePixels, const unsigned short width, const unsigned short height )
 	{
 		if(pImagePixels)
@@ -69,7 +135,7 @@ namespace DirectLook
 			m_Width = width;
 			m_Height = height;
 			m_PixelSize = m_Width * m_Height;
-			m_pImagePixels = new unsigned short[m_PixelSize];
+			allocatePixels();
 			updateImage( pImagePixels );
 		}
 	}
@@ -78,67 +144,62 @@ namespace DirectLook
 	{
 		if(pDepthPixels)
 		{
+			const TileRange fullFrame = { 0, 0, m_Width, m_Height };
+			const BitMask* pMask = buildForegroundMask( pDepthPixels, fullFrame );
+
 			m_MinDistance = m_FarThreshold;
 			m_MaxDistance = m_NearThreshold;
+
+			// In mirror mode each row is reversed into a scratch row first, the segmentation then reads it linearly
+			unsigned short* pMirrorRow = m_MirrorMode ? FramePool::instance().acquireArray<unsigned short>( m_Width ) : 0;
 	
-			if(m_MirrorMode)
+			for(unsigned int y = 0; y < m_Height; y++)
 			{
-				for(int y = 0; y < m_Height; y++)
+				unsigned short* pOut = m_pImagePixels + y * m_Width;
+				if(pMask && pMask->isRowEmpty( y ))
 				{
-					for(int x = 0; x < m_Width; x++)
-					{
-						unsigned short pixelValue = pDepthPixels[y * m_Width + (m_Width - 1) - x];
-						if(m_NearThreshold > pixelValue)
-						{
-							pixelValue = 0;
-						}
-						else if(m_MinDistance > pixelValue)
-						{
-							m_MinDistance = pixelValue;
-						}
-						
-						if(m_FarThreshold  < pixelValue)
-						{
-							pixelValue = 0;
-						}
-						else if(m_MaxDistance < pixelValue)
-						{
-							m_MaxDistance = pixelValue;
-						}			
-						
-						m_pImagePixels[y * m_Width + x] = pixelValue;
-					}
+					memset( pOut, 0, m_Width * sizeof( unsigned short ) );
+					continue;
 				}
-			}
-			else
-			{
-				for(int y = 0; y < m_Height; y++)
+
+				const unsigned short* pRow = pDepthPixels + y * m_Width;
+				if(pMirrorRow)
 				{
-					for(int x = 0; x < m_Width; x++)
+					MirrorKernels::mirrorRow16( pRow, pMirrorRow, m_Width );
+					pRow = pMirrorRow;
+				}
+
+				const unsigned long long* pBits = pMask ? pMask->getRow( y ) : 0;
+				for(unsigned int x = 0; x < m_Width; x++)
+				{
+					unsigned short pixelValue = pRow[x];
+					if(pBits && ((pBits[x / BitMask::WORD_BITS] >> (x % BitMask::WORD_BITS)) & 1) == 0)
 					{
-						unsigned short pixelValue = pDepthPixels[y * m_Width + x];
-						if(m_NearThreshold > pixelValue)
-						{
-							pixelValue = 0;
-						}
-						else if(m_MinDistance > pixelValue)
-						{
-							m_MinDistance = pixelValue;
-						}
-						
-						if(m_FarThreshold  < pixelValue)
-						{
-							pixelValue = 0;
-						}
-						else if(m_MaxDistance < pixelValue)
-						{
-							m_MaxDistance = pixelValue;
-						}			
-						
-						m_pImagePixels[y * m_Width + x] = pixelValue;
+						pixelValue = 0;
 					}
+					if(m_NearThreshold > pixelValue)
+					{
+						pixelValue = 0;
+					}
+					else if(m_MinDistance > pixelValue)
+					{
+						m_MinDistance = pixelValue;
+					}
+					
+					if(m_FarThreshold  < pixelValue)
+					{
+						pixelValue = 0;
+					}
+					else if(m_MaxDistance < pixelValue)
+					{
+						m_MaxDistance = pixelValue;
+					}			
+					
+					pOut[x] = pixelValue;
 				}
 			}
+
+			FramePool::instance().release( pMirrorRow );
 	
 			if(m_MinDistance == m_FarThreshold)  m_MinDistance = m_NearThreshold;
 			if(m_MaxDistance == m_NearThreshold) m_MaxDistance = m_FarThreshold;
@@ -180,4 +241,46 @@ namespace DirectLook
 	{
 		m_FarThreshold = farThreshold;
 	}
+
+	void SegmentedDepthImage::setForegroundMode( const ForegroundMode mode )
+	{
+		m_ForegroundMode = mode;
+		m_ForegroundPixels = 0;
+	}
+
+	void SegmentedDepthImage::setMaskMorphology( const unsigned int openRadius, const unsigned int closeRadius )
+	{
+		m_OpenRadius = (openRadius < MaskMorphology::MAX_RADIUS) ? openRadius : MaskMorphology::MAX_RADIUS;
+		m_CloseRadius = (closeRadius < MaskMorphology::MAX_RADIUS) ? closeRadius : MaskMorphology::MAX_RADIUS;
+		m_MaskMicroseconds = 0;
+	}
+
+	const BitMask* SegmentedDepthImage::buildForegroundMask( const unsigned short* pDepthPixels, const TileRange& region )
+	{
+		if(m_ForegroundMode == FOREGROUND_ALL && m_OpenRadius == 0 && m_CloseRadius == 0)
+		{
+			m_ForegroundPixels = 0;
+			m_MaskMicroseconds = 0;
+			return 0;
+		}
+
+		const unsigned long long start = Clock::microseconds();
+		unsigned int nearestIndex = 0;
+		m_ForegroundMask.threshold( pDepthPixels, m_Width, m_Height, m_NearThreshold, m_FarThreshold, m_MirrorMode, region, &nearestIndex );
+
+		// Clean the edges before labelling, so speckles don't count as components
+		if(m_OpenRadius > 0)
+		{
+			m_Morphology.open( m_ForegroundMask, m_OpenRadius, m_OpenRadius );
+		}
+		if(m_CloseRadius > 0)
+		{
+			// Only joins components: pixels it adds outside the thresholded mask fail the depth test and stay background in the segmentation
+			m_Morphology.close( m_ForegroundMask, m_CloseRadius, m_CloseRadius );
+		}
+
+		m_ForegroundPixels = m_Segmenter.extract( m_ForegroundMask, m_ForegroundMode, nearestIndex % m_Width, nearestIndex / m_Width );
+		m_MaskMicroseconds = Clock::microseconds() - start;
+		return &m_ForegroundMask;
+	}
 }
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "DepthImage.h"
+#include "ForegroundSegmenter.h"
+#include "MaskMorphology.h"
 
 namespace DirectLook
 {
@@ -30,6 +32,16 @@ namespace DirectLook
 		///
 		////////////////////////////////////////////////////////////
 		SegmentedDepthImage( const SegmentedDepthImage& copy );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Move-Konstruktor
+		///
+		/// Uebernimmt die Bilddaten von "other" ohne Kopie, "other" ist danach leer.
+		///
+		/// \param other
+		///
+		////////////////////////////////////////////////////////////
+		SegmentedDepthImage( SegmentedDepthImage&& other );
 		
 		////////////////////////////////////////////////////////////
 		/// \brief Konstruktor A
@@ -69,6 +81,22 @@ namespace DirectLook
 		////////////////////////////////////////////////////////////
 		virtual ~SegmentedDepthImage(void);
 
+		////////////////////////////////////////////////////////////
+		/// \brief = operator
+		///
+		/// \param copy
+		///
+		////////////////////////////////////////////////////////////
+		SegmentedDepthImage& operator=( const SegmentedDepthImage& copy );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Move = operator
+		///
+		/// \param other
+		///
+		////////////////////////////////////////////////////////////
+		SegmentedDepthImage& operator=( SegmentedDepthImage&& other );
+
 		//////////////////////////////////////////
 		// ueberschriebene Sensor-Image Methoden //
 		//////////////////////////////////////////
@@ -153,10 +181,81 @@ namespace DirectLook
 		////////////////////////////////////////////////////////////
 		void setFarThreshold( const unsigned short farThreshold );
 
-	protected:	
+		////////////////////////////////////////////////////////////
+		/// \brief Legt fest, welche Pixel zwischen den Thresholds als Vordergrund segmentiert werden.
+		///
+		/// Mit FOREGROUND_LARGEST bzw. FOREGROUND_NEAREST wird vor der Segmentierung eine Bitmaske der
+		/// gueltigen Pixel erzeugt, deren uebrige Komponenten (Stuhllehnen, Haende, ...) entfernt werden.
+		/// Die Segmentierung ueberspringt danach leere Zeilen und Woerter der Maske.
+		///
+		/// \param mode Vordergrundmodus
+		///
+		////////////////////////////////////////////////////////////
+		void setForegroundMode( const ForegroundMode mode );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert den Vordergrundmodus zurueck.
+		////////////////////////////////////////////////////////////
+		ForegroundMode getForegroundMode(void) const { return m_ForegroundMode; }
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert die Anzahl der Komponenten der letzten Segmentierung zurueck (0 bei FOREGROUND_ALL).
+		////////////////////////////////////////////////////////////
+		unsigned int getComponentCount(void) const { return m_Segmenter.getComponentCount(); }
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert die Anzahl der Vordergrundpixel der letzten Segmentierung zurueck (0 bei FOREGROUND_ALL).
+		////////////////////////////////////////////////////////////
+		unsigned int getForegroundPixels(void) const { return m_ForegroundPixels; }
+
+		////////////////////////////////////////////////////////////
+		/// \brief Glaettet die Vordergrundmaske vor der Zusammenhangsanalyse.
+		///
+		/// Oeffnen entfernt Sprenkel und ausgefranste Raender. Schliessen wirkt nur auf die Zusammenhangsanalyse:
+		/// Teile, die durch schmale Luecken getrennt sind, zaehlen als eine Komponente. Die Pixel, die es ausserhalb der
+		/// Schwellwertmaske hinzufuegt, haben keinen Tiefenwert zwischen den Schwellwerten und bleiben im Modell
+		/// Hintergrund, Loecher werden also nicht gefuellt. Beide arbeiten auf der gepackten Maske (siehe MaskMorphology) mit einem
+		/// quadratischen Strukturelement aus (2 * Radius + 1) x (2 * Radius + 1) Pixeln.
+		///
+		/// \param openRadius  Radius des Oeffnens (0 = aus)
+		/// \param closeRadius Radius des Schliessens (0 = aus)
+		///
+		////////////////////////////////////////////////////////////
+		void setMaskMorphology( const unsigned int openRadius, const unsigned int closeRadius );
+
+		unsigned int getOpenRadius(void) const { return m_OpenRadius; }
+		unsigned int getCloseRadius(void) const { return m_CloseRadius; }
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert die Zeit der letzten Maskenberechnung (Schwellwert, Morphologie, Zusammenhang) in Mikrosekunden zurueck.
+		////////////////////////////////////////////////////////////
+		unsigned long long getMaskMicroseconds(void) const { return m_MaskMicroseconds; }
+
+	protected:
+		////////////////////////////////////////////////////////////
+		/// \brief Erzeugt die Vordergrundmaske der Tiefenwerte im Ausschnitt "region".
+		///
+		/// Die Spalten der Maske sind wie die segmentierten Daten gespiegelt, die Zeilen nicht.
+		///
+		/// \param pDepthPixels Tiefenwerte (Breite x Hoehe)
+		/// \param region       Ausschnitt in Bildkoordinaten der Tiefenwerte
+		///
+		/// \return Vordergrundmaske oder 0 bei FOREGROUND_ALL ohne Morphologie
+		///
+		////////////////////////////////////////////////////////////
+		const BitMask* buildForegroundMask( const unsigned short* pDepthPixels, const TileRange& region );
+
 		unsigned short m_MinDistance;	///< Kleinster Tiefenwert
 		unsigned short m_MaxDistance;	///< Groesster Tiefenwert
 		unsigned short m_NearThreshold;	///< Nearest Threshold
 		unsigned short m_FarThreshold;	///< Farest Threshold
+		ForegroundMode m_ForegroundMode;	///< Welche Pixel zwischen den Thresholds segmentiert werden
+		BitMask m_ForegroundMask;			///< Vordergrundmaske des letzten Bildes (Puffer wird wiederverwendet)
+		ForegroundSegmenter m_Segmenter;	///< Zusammenhangsanalyse der Maske
+		unsigned int m_ForegroundPixels;	///< Vordergrundpixel des letzten Bildes
+		MaskMorphology m_Morphology;		///< Oeffnen und Schliessen der Maske
+		unsigned int m_OpenRadius;			///< Radius des Oeffnens (0 = aus)
+		unsigned int m_CloseRadius;			///< Radius des Schliessens (0 = aus)
+		unsigned long long m_MaskMicroseconds;	///< Dauer der letzten Maskenberechnung
 	};
 }
@@ -64,6 +64,82 @@ namespace DirectLook
 			case Qt::Key_F1:
 				m_pSensorWidget->getGLScene()->reloadShaderProgram();
 				break;
+
+			// Performance overlay:
+			case Qt::Key_F2:
+				m_pSensorWidget->switchHud();
+				m_pSensorWidget->repaint();
+				break;
+
+			// Quality level: automatic or fixed
+			case Qt::Key_F3:
+				m_pSensorWidget->cycleQuality();
+				m_pSensorWidget->repaint();
+				break;
+
+			// Half grid depth filtering with RGB-guided upsampling:
+			case Qt::Key_F4:
+				m_pSensorWidget->getGLScene()->setGuidedUpsampling( !m_pSensorWidget->getGLScene()->getGuidedUpsampling() );
+				m_pSensorWidget->repaint();
+				break;
+
+			// Restrict processing to the region around the head:
+			case Qt::Key_F5:
+				m_pSensorWidget->getGLScene()->setHeadTracking( !m_pSensorWidget->getGLScene()->getHeadTracking() );
+				m_pSensorWidget->repaint();
+				break;
+
+			// Foreground: all pixels, largest component or the component nearest to the sensor
+			case Qt::Key_F6:
+				m_pSensorWidget->getGLScene()->setForegroundMode( (ForegroundMode) ((m_pSensorWidget->getGLScene()->getForegroundMode() + 1) % 3) );
+				m_pSensorWidget->repaint();
+				break;
+
+			// Open and close the foreground mask with a 3x3 kernel:
+			case Qt::Key_F7:
+				if(m_pSensorWidget->getGLScene()->getOpenRadius() > 0 || m_pSensorWidget->getGLScene()->getCloseRadius() > 0)
+				{
+					m_pSensorWidget->getGLScene()->setMaskMorphology( 0, 0 );
+				}
+				else
+				{
+					m_pSensorWidget->getGLScene()->setMaskMorphology( 1, 1 );
+				}
+				m_pSensorWidget->repaint();
+				break;
+
+			// Record the corrected output to DirectLook_<date>_<time>.mkv in the working directory:
+			case Qt::Key_F8:
+				if(m_pSensorWidget->getGLScene()->isRecording())
+				{
+					m_pSensorWidget->getGLScene()->stopRecording();
+				}
+				else
+				{
+					const QString fileName = "DirectLook_" + QDateTime::currentDateTime().toString( "yyyyMMdd_hhmmss" ) + ".mkv";
+					m_pSensorWidget->getGLScene()->startRecording( fileName.toStdString(), VIDEO_CODEC_H264 );
+				}
+				m_pSensorWidget->repaint();
+				break;
+
+			// Publish the corrected output in the shared memory ring "directlook" (see DirectLookRing):
+			case Qt::Key_F9:
+				if(m_pSensorWidget->getGLScene()->getOutputRing().isOpen())
+				{
+					m_pSensorWidget->getGLScene()->stopSharing();
+				}
+				else
+				{
+					m_pSensorWidget->getGLScene()->startSharing( "directlook" );
+				}
+				m_pSensorWidget->repaint();
+				break;
+
+			// Draw the head as point splats instead of the triangle mesh:
+			case Qt::Key_F10:
+				m_pSensorWidget->getGLScene()->setMeshMode( m_pSensorWidget->getGLScene()->getMeshMode() == MESH_POINTS ? MESH_TRIANGLES : MESH_POINTS );
+				m_pSensorWidget->repaint();
+				break;
 		}
 	}
 
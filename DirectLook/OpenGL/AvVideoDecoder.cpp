@@ -1,42 +1,130 @@
 #include "AvVideoDecoder.h"
+#include "../Core/Trace.h"
 
-namespace DirectLook 
+#include <QThread>
+
+#include <algorithm>
+
+namespace DirectLook
 {
+	//number of decoded frames the decoder thread may run ahead of the renderer
+	static const unsigned int QUEUE_FRAMES = 4;
+
+	class AvVideoDecoder::DecodeThread : public QThread
+	{
+
+	public:
+		DecodeThread( AvVideoDecoder& decoder )
+			:
+			m_Decoder( decoder )
+		{
+		}
+
+	protected:
+		void run(void)
+		{
+			m_Decoder.decodeLoop();
+		}
+
+	private:
+		AvVideoDecoder& m_Decoder;
+	};
+
 	AvVideoDecoder::AvVideoDecoder()
-	{	
+		:
+		m_pFormatCtx( 0 ),
+		m_pCodecCtx( 0 ),
+		m_pCodec( 0 ),
+		m_pFrame( 0 ),
+		m_pConvertCtx( 0 ),
+		m_FullRange( false ),
+		m_pFrameFinished( 0 ),
+		m_pVideostream( -1 ),
+		m_pThread( 0 ),
+		m_pQueue( 0 ),
+		m_Stop( 0 ),
+		m_TimeBase( 0.0 ),
+		m_FrameDuration( 0.04 ),
+		m_StartTimestamp( 0 ),
+		m_LoopOffset( 0.0 ),
+		m_LastTime( 0.0 ),
+		m_Draining( false ),
+		m_CacheBudget( 0 ),
+		m_Caching( false ),
+		m_CacheBytes( 0 ),
+		m_CacheDuration( 0 ),
+		m_CacheComplete( false ),
+		m_ClockStarted( false ),
+		m_ClockOffset( 0 ),
+		m_SkippedFrames( 0 ),
+		m_PlayingCache( false ),
+		m_CacheIndex( -1 )
+	{
 	}
 
 	AvVideoDecoder::~AvVideoDecoder()
 	{
-		av_free(m_pBuffer);
-		av_free(m_pFrameRGB);
-
-		av_free(m_pFrame);
+		close();
+	}
 
-		avcodec_close(m_pCodecCtx);
-		av_close_input_file(m_pFormatCtx);
+	void AvVideoDecoder::close()
+	{
+		//the thread owns the ffmpeg contexts while it runs, so stop it before freeing them
+		if(m_pThread)
+		{
+			m_Stop = 1;
+			m_pQueue->close();
+			m_pThread->wait();
+			delete m_pThread;
+			m_pThread = 0;
+		}
+		if(m_pQueue)	{ delete m_pQueue;	m_pQueue = 0; }
+
+		m_CurrentFrame = AvVideoFrame();
+		m_NextFrame = AvVideoFrame();
+
+		//the thread has stopped, so the cache can be reset without the lock
+		m_Cache.clear();
+		m_CacheTimestamps.clear();
+		m_CacheBytes = 0;
+		m_CacheDuration = 0;
+		m_CacheComplete = false;
+		m_Caching = false;
+		m_PlayingCache = false;
+		m_CacheIndex = -1;
+
+		if(m_pConvertCtx)	{ sws_freeContext(m_pConvertCtx);	m_pConvertCtx = 0; }
+		if(m_pFrame)		{ av_free(m_pFrame);				m_pFrame = 0; }
+		if(m_pCodecCtx)		{ avcodec_close(m_pCodecCtx);		m_pCodecCtx = 0; }
+		if(m_pFormatCtx)	{ av_close_input_file(m_pFormatCtx); m_pFormatCtx = 0; }
+		m_pCodec = 0;
+		m_pVideostream = -1;
 	}
 
 	void AvVideoDecoder::init(std::string path)
 	{
+		close();
+
 		av_register_all();	//standard function which has to be called to ensure ffmpeg can be run on the system
 
 		m_pVideostream = -1;	//predeclaring of this variable ensures that no videostream inside the file has been selected yet
 		m_pFormatCtx = avformat_alloc_context();	//allocates memory for the FFMpeg FormatContext
-		m_pFrame = m_pFrameRGB = m_pResultFrame = 0;	//initializes the Frame pointer. this value will be set to zero so 
-												//that frames cannot be seen as falsely initialized
 
 		//this function opens the file using the path. it stores the entire information of the video inside the FormatContext
 		if (avformat_open_input(&m_pFormatCtx, path.c_str(), NULL, NULL) != 0)
 		{
+			//avformat_open_input frees the context on failure
+			m_pFormatCtx = 0;
 			handle_error(1);
+			return;
 		}
 		//Checks if any stream info on the selected media is available
 		if (av_find_stream_info(m_pFormatCtx) < 0)
 		{
 			handle_error(2);
+			return;
 		}
-		
+
 		//loop which runs until the first videostream inside the file is found.
 		for (unsigned int i = 0; i < m_pFormatCtx->nb_streams; i++)
 		{
@@ -48,46 +136,71 @@ namespace DirectLook
 		}
 		//if no video stream is found a error handling is used
 		if (m_pVideostream == -1)
+		{
 			handle_error(3);
+			return;
+		}
 
-		//sets the CodecContext of the specified videostream
-		m_pCodecCtx = m_pFormatCtx->streams[m_pVideostream]->codec;
 		//the next check looks up the ffmpeg database and sees if any codec for the selected videostream is available
-		m_pCodec = avcodec_find_decoder(m_pCodecCtx->codec_id);
+		AVCodecContext *pCodecCtx = m_pFormatCtx->streams[m_pVideostream]->codec;
+		m_pCodec = avcodec_find_decoder(pCodecCtx->codec_id);
 		if (m_pCodec == NULL)
 		{
 			handle_error(4);
+			return;
 		}
 		//checks if the found codec can be opened with the declared codecContext
-		if (avcodec_open(m_pCodecCtx, m_pCodec) < 0)
+		if (avcodec_open(pCodecCtx, m_pCodec) < 0)
 		{
 			handle_error(5);
+			return;
 		}
+		//the CodecContext is only closed by close() once it has been opened
+		m_pCodecCtx = pCodecCtx;
 
-		//some ffmpeg stuff to allocate memory for the frames
+		//frame which receives the decoded picture in the pixel format of the codec
 		m_pFrame = avcodec_alloc_frame();
-		m_pFrameRGB = avcodec_alloc_frame();
-
-		//checks if the frames could be allocated
-		if (m_pFrameRGB == NULL){
+		if (m_pFrame == NULL)
+		{
 			handle_error(6);
+			return;
 		}
-		int numBytes;
-
-		//sets the amount of bytes which is needed for the RGB24 format with the specified height and weight
-		numBytes = avpicture_get_size(PIX_FMT_RGB24, m_pCodecCtx->width, m_pCodecCtx->height);
 
-		//allocates the buffer
-		m_pBuffer = (uint8_t *) av_malloc(numBytes * sizeof(uint8_t));
-
-		//initializes the pFrameRGB with the specified buffer size, ColorFormat, Width and height
-		avpicture_fill( (AVPicture *) m_pFrameRGB, m_pBuffer, PIX_FMT_RGB24, m_pCodecCtx->width, m_pCodecCtx->height );
+		//YUV420P planes are copied as they are, everything else needs a conversion context.
+		//source and target have the same size, so the cheapest filter is good enough (it only affects the chroma)
+		m_FullRange = (m_pCodecCtx->pix_fmt == PIX_FMT_YUVJ420P);
+		const bool planar = (m_pCodecCtx->pix_fmt == PIX_FMT_YUV420P || m_pCodecCtx->pix_fmt == PIX_FMT_YUVJ420P);
+		if (!planar)
+		{
+			m_pConvertCtx = sws_getContext(m_pCodecCtx->width, m_pCodecCtx->height, m_pCodecCtx->pix_fmt,
+											m_pCodecCtx->width, m_pCodecCtx->height, PIX_FMT_YUV420P,
+											SWS_FAST_BILINEAR, NULL, NULL, NULL);
+			if (m_pConvertCtx == NULL)
+			{
+				handle_error(7);
+				return;
+			}
+		}
 
-		m_pResultFrame = 0;
-		run();	
-		//runs until the finished frame has actual some valid data
-		while (getLatestFrame() == 0)
-			run();	
+		//timestamps are counted in units of the stream time base, frames without one advance by one frame duration
+		AVStream *pStream = m_pFormatCtx->streams[m_pVideostream];
+		m_TimeBase = av_q2d(pStream->time_base);
+		m_FrameDuration = (pStream->r_frame_rate.num > 0 && pStream->r_frame_rate.den > 0) ? 1.0 / av_q2d(pStream->r_frame_rate) : 0.04;
+		m_StartTimestamp = (pStream->start_time != (int64_t) AV_NOPTS_VALUE) ? pStream->start_time : 0;
+		m_LoopOffset = 0.0;
+		m_LastTime = -m_FrameDuration;
+		m_Draining = false;
+		m_ClockStarted = false;
+		m_SkippedFrames = 0;
+		m_Caching = (m_CacheBudget > 0);
+
+		m_pQueue = new FrameQueue<AvVideoFrame>( QUEUE_FRAMES, DROP_NONE );
+		m_Stop = 0;
+		m_pThread = new DecodeThread( *this );
+		m_pThread->start();
+
+		//waits for the first frame, so the texture never shows uninitialized data
+		m_pQueue->pop(m_CurrentFrame, 1000);
 	}
 
 	void AvVideoDecoder::handle_error(int i)
@@ -160,103 +273,330 @@ namespace DirectLook
 		fclose(pFile);
 	}
 
-	void AvVideoDecoder::run()
+	void AvVideoDecoder::decodeLoop()
+	{
+		while (m_Stop == 0)
+		{
+			AvVideoFrame frame;
+			if (!decodeFrame(frame))
+			{
+				break;
+			}
+			if (m_Caching)
+			{
+				cacheFrame(frame);
+			}
+			//blocks while the queue is full, returns false after close()
+			if (!m_pQueue->push(frame))
+			{
+				break;
+			}
+		}
+	}
+
+	bool AvVideoDecoder::decodeFrame(AvVideoFrame& frame)
 	{
-		//reads the actual frame depending on the FormatContext and stores the information inside the packet
-		if(av_read_frame(m_pFormatCtx, &m_pPacket) >= 0)
+		DL_TRACE_SCOPE( "AvVideoDecoder::decodeFrame" );
+
+		//a file without a single decodable frame would otherwise be rewound forever
+		unsigned int emptyLoops = 0;
+
+		while (m_Stop == 0)
 		{
-			//checks if the packet actually uses the declared video stream
-			if (m_pPacket.stream_index == m_pVideostream)
+			bool haveFrame = false;
+
+			if (m_Draining)
 			{
-				//the actual decoding is done here. 
-				//-using the CodecContext for the decoding, 
-				//-storing the data inside pFrame, 
-				//-sets the frameFinished variable to mark if the Frame has been completely loaded and decoded.
-				//	if not the frame will be marked as not finished and the function has to be called until the frame
-				//  is actually finished.
-				//-stores the data inside the packet
+				//an empty packet makes the codec return the frames it is still holding back
+				av_init_packet(&m_pPacket);
+				m_pPacket.data = NULL;
+				m_pPacket.size = 0;
 				avcodec_decode_video2(m_pCodecCtx, m_pFrame, &m_pFrameFinished, &m_pPacket);
-				//checks if the frame is completely decoded
-				if (m_pFrameFinished){
-					static struct SwsContext *img_convert_ctx;
-
-					//if the context hasn't been initialized
-					if (img_convert_ctx == NULL){						
-						int w = m_pCodecCtx->width;
-						int h = m_pCodecCtx->height;
-
-						//context will be set with the ffmpeg function sws_getContext
-
-						//parameter for sws:getContext:
-						//width of the source, height of the source,
-						//Pixel format (primarily know by the CodecContext, destination width, destination height
-						//Pixel format of the destination (RGB24 is similar to GL_RGB), some flags for the converting,
-						//source Filter, destination Filter, parameter for the filter
-
-						img_convert_ctx = sws_getContext(w, h,
-														m_pCodecCtx->pix_fmt, w, h, 
-														PIX_FMT_RGB24, SWS_BICUBIC,
-														NULL, NULL, NULL);
-
-						//if the image conversion failed the error handling can do something
-						if (img_convert_ctx == NULL)
-						{
-							handle_error(7);
-						}						
-					}
-					//depending on the context the scale function actually converts the frame
-					//parameter: SWSContext holding the conversion information, data of the source, linesize of the source,
-					//slizeY, slizeH (height), destination data, destination linesize
-					int ret = sws_scale(img_convert_ctx, m_pFrame->data, m_pFrame->linesize, 
-										0, m_pCodecCtx->height, m_pFrameRGB->data, m_pFrameRGB->linesize);
-
-					/*
-					*the result is stored to another pointer to have the possibility to check the ret value and see 
-					*if errors occured without overwriting the last frames data in case something failed
-					*BEWARE: this structure needs to be modified if used in multiple threads
-					*/
-					m_pResultFrame = m_pFrameRGB;
+				if (m_pFrameFinished)
+				{
+					haveFrame = true;
 				}
 				else
 				{
-					//simply runs this function until a full frame has been finished the decoding
-					run();
+					//all frames of this loop are out, start the next one right behind the last frame
+					m_Draining = false;
+					m_LoopOffset = m_LastTime + m_FrameDuration;
+
+					//the whole loop fits into the cache, the renderer doesn't need the decoder anymore
+					if (m_Caching && !m_Cache.empty())
+					{
+						QMutexLocker locker(&m_CacheMutex);
+						m_CacheDuration = (unsigned long long) (m_LoopOffset * 1000000.0);
+						m_CacheComplete = true;
+						return false;
+					}
+					if (!rewind() || ++emptyLoops > 1)
+					{
+						return false;
+					}
+					continue;
+				}
+			}
+			else if (av_read_frame(m_pFormatCtx, &m_pPacket) >= 0)
+			{
+				//checks if the packet actually uses the declared video stream
+				if (m_pPacket.stream_index == m_pVideostream)
+				{
+					//frameFinished stays 0 until the codec has a complete picture, the next packet is read then
+					avcodec_decode_video2(m_pCodecCtx, m_pFrame, &m_pFrameFinished, &m_pPacket);
+					haveFrame = (m_pFrameFinished != 0);
 				}
+				//frees the allocated packet
+				av_free_packet(&m_pPacket);
+			}
+			else
+			{
+				m_Draining = true;
+				continue;
 			}
-			//frees the allocated packet
-			av_free_packet(&m_pPacket);
+
+			if (!haveFrame)
+			{
+				continue;
+			}
+
+			//presentation time of this loop, frames without a timestamp follow the previous one
+			const long long timestamp = m_pFrame->best_effort_timestamp;
+			double time = (timestamp != (long long) AV_NOPTS_VALUE)
+				? m_LoopOffset + (double) (timestamp - m_StartTimestamp) * m_TimeBase
+				: m_LastTime + m_FrameDuration;
+			if (time <= m_LastTime)
+			{
+				time = m_LastTime + m_FrameDuration;
+			}
+			m_LastTime = time;
+
+			if (!storeFrame(frame))
+			{
+				handle_error(8);
+				continue;
+			}
+			frame.m_Planes[0].setTimestamp((unsigned long long) (time * 1000000.0));
+			return true;
 		}
-		else
+		return false;
+	}
+
+	bool AvVideoDecoder::storeFrame(AvVideoFrame& frame)
+	{
+		//the buffers come from the FramePool and return to it once the renderer drops them
+		const int width = m_pCodecCtx->width;
+		const int height = m_pCodecCtx->height;
+		frame.m_Planes[0] = ImageFrame::allocate(width, height);
+		frame.m_Planes[1] = ImageFrame::allocate((width + 1) / 2, (height + 1) / 2);
+		frame.m_Planes[2] = ImageFrame::allocate((width + 1) / 2, (height + 1) / 2);
+
+		uint8_t *pDestination[4] = { NULL, NULL, NULL, NULL };
+		int destinationLinesize[4] = { 0, 0, 0, 0 };
+		for (int i = 0; i < 3; i++)
 		{
-			//this block simply seeks to position 0 (which is defined as the start of the video)
-			//in case the time of the video has reached the end (video has been fully playbacked)
-			int64_t pos = 0;
-			int64_t seek_target = 0;
-		
-			AVRational myAVTIMEBASEQ = {1, AV_TIME_BASE};
+			pDestination[i] = frame.m_Planes[i].getMutableData();
+			destinationLinesize[i] = (int) frame.m_Planes[i].getWidth();
+		}
 
-			seek_target = av_rescale_q(seek_target, (AVRational) myAVTIMEBASEQ, m_pFormatCtx->streams[m_pVideostream]->time_base);
+		if (m_pConvertCtx)
+		{
+			return sws_scale(m_pConvertCtx, m_pFrame->data, m_pFrame->linesize, 0, height, pDestination, destinationLinesize) > 0;
+		}
 
-			if (av_seek_frame(m_pFormatCtx, m_pVideostream, seek_target, AVSEEK_FLAG_ANY))
+		//the decoder delivers YUV420P already, only the row padding of its planes is dropped
+		for (int i = 0; i < 3; i++)
+		{
+			const unsigned int rows = frame.m_Planes[i].getHeight();
+			for (unsigned int y = 0; y < rows; y++)
 			{
-				handle_error(10);
+				memcpy(pDestination[i] + y * destinationLinesize[i], m_pFrame->data[i] + y * m_pFrame->linesize[i], destinationLinesize[i]);
 			}
 		}
-	
+		return true;
+	}
+
+	bool AvVideoDecoder::rewind()
+	{
+		//seeks to the keyframe at or before the start of the stream, so the first frames decode cleanly
+		if (av_seek_frame(m_pFormatCtx, m_pVideostream, m_StartTimestamp, AVSEEK_FLAG_BACKWARD) < 0)
+		{
+			handle_error(10);
+			return false;
+		}
+		avcodec_flush_buffers(m_pCodecCtx);
+		return true;
+	}
+
+	void AvVideoDecoder::cacheFrame(const AvVideoFrame& frame)
+	{
+		unsigned long long bytes = 0;
+		for (int i = 0; i < 3; i++)
+		{
+			bytes += frame.m_Planes[i].getSize();
+		}
+
+		//the loop is too long for the budget, keep decoding it every time
+		if (m_CacheBytes + bytes > m_CacheBudget)
+		{
+			m_Caching = false;
+			m_Cache.clear();
+			m_CacheTimestamps.clear();
+			m_CacheBytes = 0;
+			return;
+		}
+
+		//the frame shares its buffers with the queue, nothing is copied
+		m_Cache.push_back(frame);
+		m_CacheTimestamps.push_back(frame.m_Planes[0].getTimestamp());
+		m_CacheBytes += bytes;
+	}
+
+	bool AvVideoDecoder::updateFromCache(unsigned long long videoTime)
+	{
+		//the timestamps of later loops continue counting, so the position in the loop is the remainder
+		const unsigned long long loopTime = (m_CacheDuration > 0) ? videoTime % m_CacheDuration : 0;
+
+		//last frame which is due at loopTime
+		int index = (int) (std::upper_bound(m_CacheTimestamps.begin(), m_CacheTimestamps.end(), loopTime) - m_CacheTimestamps.begin()) - 1;
+		if (index < 0)
+		{
+			index = 0;
+		}
+		if (index == m_CacheIndex)
+		{
+			return false;
+		}
+		m_CacheIndex = index;
+		m_CurrentFrame = m_Cache[index];
+		return true;
+	}
+
+	bool AvVideoDecoder::update(unsigned long long nowMicroseconds)
+	{
+		if (!m_pQueue)
+		{
+			return false;
+		}
+
+		//once the decoder thread has finished the cache, the queue isn't needed anymore
+		if (m_CacheBudget > 0 && !m_PlayingCache && m_ClockStarted)
+		{
+			QMutexLocker locker(&m_CacheMutex);
+			m_PlayingCache = m_CacheComplete;
+		}
+		if (m_PlayingCache)
+		{
+			return updateFromCache((unsigned long long) ((long long) nowMicroseconds - m_ClockOffset));
+		}
+
+		//the first frame anchors the video clock to the wall clock
+		if (!m_ClockStarted)
+		{
+			if (!m_CurrentFrame.m_Planes[0].isValid() && !m_pQueue->pop(m_CurrentFrame, 0))
+			{
+				return false;
+			}
+			m_ClockOffset = (long long) nowMicroseconds - (long long) m_CurrentFrame.m_Planes[0].getTimestamp();
+			m_ClockStarted = true;
+			return true;
+		}
+
+		const unsigned long long videoTime = (unsigned long long) ((long long) nowMicroseconds - m_ClockOffset);
+		bool changed = false;
+		for (;;)
+		{
+			if (!m_NextFrame.m_Planes[0].isValid() && !m_pQueue->pop(m_NextFrame, 0))
+			{
+				break;
+			}
+			if (m_NextFrame.m_Planes[0].getTimestamp() > videoTime)
+			{
+				break;
+			}
+
+			//a frame that is overtaken by the next due one was never shown
+			if (changed)
+			{
+				m_SkippedFrames++;
+			}
+			m_CurrentFrame = m_NextFrame;
+			m_NextFrame = AvVideoFrame();
+			changed = true;
+		}
+		return changed;
+	}
+
+	bool AvVideoDecoder::isFullRange() const
+	{
+		return m_FullRange;
+	}
+
+	void AvVideoDecoder::setCacheBudget(unsigned long long bytes)
+	{
+		m_CacheBudget = bytes;
+	}
+
+	unsigned long long AvVideoDecoder::getCacheBudget() const
+	{
+		return m_CacheBudget;
+	}
+
+	bool AvVideoDecoder::isPlayingCache() const
+	{
+		return m_PlayingCache;
+	}
+
+	int AvVideoDecoder::getCacheIndex() const
+	{
+		return m_PlayingCache ? m_CacheIndex : -1;
+	}
+
+	unsigned int AvVideoDecoder::getCachedFrameCount() const
+	{
+		return m_PlayingCache ? (unsigned int) m_Cache.size() : 0;
+	}
+
+	unsigned long long AvVideoDecoder::getCacheBytes() const
+	{
+		return m_PlayingCache ? m_CacheBytes : 0;
+	}
+
+	void AvVideoDecoder::releaseCachedFrame(int index)
+	{
+		if (!m_PlayingCache || index < 0 || index >= (int) m_Cache.size())
+		{
+			return;
+		}
+		m_Cache[index] = AvVideoFrame();
+		if (index == m_CacheIndex)
+		{
+			m_CurrentFrame = AvVideoFrame();
+		}
+	}
+
+	const AvVideoFrame& AvVideoDecoder::getCurrentFrame() const
+	{
+		return m_CurrentFrame;
+	}
+
+	unsigned long long AvVideoDecoder::getSkippedFrames() const
+	{
+		return m_SkippedFrames;
 	}
 
-	AVFrame* AvVideoDecoder::getLatestFrame()
+	unsigned int AvVideoDecoder::getQueueDepth() const
 	{
-		return m_pResultFrame;
+		return m_pQueue ? m_pQueue->getDepth() : 0;
 	}
 
 	int AvVideoDecoder::getHeight()
 	{
-		return m_pCodecCtx->height;
+		return m_pCodecCtx ? m_pCodecCtx->height : 0;
 	}
 
 	int AvVideoDecoder::getWidth()
 	{
-		return m_pCodecCtx->width;
+		return m_pCodecCtx ? m_pCodecCtx->width : 0;
 	}
-};
\ No newline at end of file
+};
@@ -1,6 +1,6 @@
 #pragma once
 
-#define _CRT_SECURE_NO_DEPRECATE 
+#define _CRT_SECURE_NO_DEPRECATE
 #define _SCL_SECURE_NO_DEPRECATE
 
 //since the ffmpeg headers are written in c they have to be included as that
@@ -11,46 +11,163 @@ extern "C"
 	#include <swscale.h>
 }
 
+#include <QAtomicInt>
+#include <QMutex>
+
 #include <iostream>
 #include <string.h>
+#include <vector>
+
+#include "../Core/FrameQueue.h"
+#include "../Image/FrameHandle.h"
 
-namespace DirectLook 
+namespace DirectLook
 {
+	/*
+	*	one decoded frame in YUV420P, converted to RGB by the video shader.
+	*	the timestamp of the first plane is the presentation time in microseconds
+	*/
+	struct AvVideoFrame
+	{
+		ImageFrame m_Planes[3];		//Y (width x height), U and V ((width + 1) / 2 x (height + 1) / 2)
+	};
+
 	/*
 	*	The AvVideoDecoder class serves the purpose of loading videos independant of the codec.
 	*	- To keep it simple the only thing the class needs is the file location of the video using the init function.
-	*	- running an update to load and decode next video frame the run function needs to be called when the video frame 
-	*	should update
-	*	- The information of the last loaded frame will be available through the getLatestFrame method.
+	*	- init starts a decoder thread which demuxes and decodes the frames ahead of time (see AvVideoFrame)
+	*	and stores them in a bounded queue. When the queue is full the thread waits for the renderer.
+	*	- The renderer calls update with the current time once per frame. It takes the frame that is due
+	*	according to the timestamps of the video, so playback speed doesn't depend on the render rate.
+	*	- At the end of the file the decoder seeks back to the start and keeps counting the timestamps,
+	*	so looping is seamless.
+	*	- With a cache budget (setCacheBudget) the frames of the first loop are kept. If the whole loop fits,
+	*	the decoder thread stops at its end and update picks the frames from the cache from then on.
 	*/
 	class AvVideoDecoder
 	{
 		private:
+			class DecodeThread;
+
 			AVFormatContext *m_pFormatCtx;
-			AVCodecContext *m_pCodecCtx;	
-			AVCodec *m_pCodec;		
-			AVFrame *m_pFrame, *m_pFrameRGB, *m_pResultFrame;
+			AVCodecContext *m_pCodecCtx;
+			AVCodec *m_pCodec;
+			AVFrame *m_pFrame;
 			AVPacket m_pPacket;
-				
-			uint8_t *m_pBuffer;
+			struct SwsContext *m_pConvertCtx;		//only used if the decoder doesn't deliver YUV420P itself
+			bool m_FullRange;						//luma uses 0-255 instead of 16-235 (JPEG YUV)
+
 			int m_pFrameFinished;
 			int m_pVideostream;
 
+			//state of the decoder thread
+			DecodeThread *m_pThread;
+			FrameQueue<AvVideoFrame> *m_pQueue;		//decoded frames waiting for the renderer
+			QAtomicInt m_Stop;
+			double m_TimeBase;						//seconds per timestamp unit of the video stream
+			double m_FrameDuration;					//seconds per frame, used when a frame has no timestamp
+			long long m_StartTimestamp;				//timestamp of the first frame of the stream
+			double m_LoopOffset;					//presentation time of the current loop in seconds
+			double m_LastTime;						//presentation time of the last decoded frame in seconds
+			bool m_Draining;						//end of file reached, the decoder returns its delayed frames
+
+			//cache of the first loop, filled by the decoder thread and only read by the renderer once it is complete
+			unsigned long long m_CacheBudget;		//bytes, 0 = no cache
+			bool m_Caching;							//still collecting the frames of the first loop
+			std::vector<AvVideoFrame> m_Cache;
+			std::vector<unsigned long long> m_CacheTimestamps;	//presentation time of every cached frame in microseconds
+			unsigned long long m_CacheBytes;
+			unsigned long long m_CacheDuration;		//length of one loop in microseconds
+			QMutex m_CacheMutex;
+			bool m_CacheComplete;					//guarded by m_CacheMutex
+
+			//state of the renderer
+			AvVideoFrame m_CurrentFrame;
+			AvVideoFrame m_NextFrame;
+			bool m_ClockStarted;					//has update anchored the video clock yet?
+			long long m_ClockOffset;				//wall clock minus presentation time in microseconds
+			unsigned long long m_SkippedFrames;
+			bool m_PlayingCache;					//the renderer has switched to the cache
+			int m_CacheIndex;						//cache index of the current frame, -1 before the switch
+
+			/*
+			*	decodes the next complete frame into "frame", rewinds at the end of the file.
+			*	returns false if the decoder has to stop (stop request or no decodable frame in the file)
+			*/
+			bool decodeFrame(AvVideoFrame& frame);
+			/*
+			*	copies or converts the decoded picture into newly allocated planes of "frame"
+			*/
+			bool storeFrame(AvVideoFrame& frame);
+			/*
+			*	seeks to the start of the video stream and flushes the codec
+			*/
+			bool rewind();
+			/*
+			*	adds a decoded frame to the cache of the first loop, gives up the cache when it exceeds the budget
+			*/
+			void cacheFrame(const AvVideoFrame& frame);
+			/*
+			*	picks the cached frame which is due at "videoTime", returns true if it changed
+			*/
+			bool updateFromCache(unsigned long long videoTime);
+			/*
+			*	main loop of the decoder thread
+			*/
+			void decodeLoop();
+
 		public:
 			AvVideoDecoder();
 			/*
-			*	frees all the allocated storage used by this class
+			*	stops the decoder thread and frees all the allocated storage used by this class
 			*/
 			~AvVideoDecoder();
 
 			/*
 			*	initializes the class and takes as parameter the path to the video file.
 			*	this function will be used instead of a constructor to dynamically load
-			*	new videos without recreating the entire class
+			*	new videos without recreating the entire class.
+			*	a running video is stopped first. after the file has been opened the decoder thread is started
+			*	and init waits (at most one second) until the first frame is available.
 			*/
 			void init(std::string path);
 			/*
-			*	old function from the test project. 
+			*	true if the luma of the YUV planes covers 0-255 (JPEG) instead of 16-235 (video)
+			*/
+			bool isFullRange() const;
+			/*
+			*	memory for the decoded frames of one loop in bytes, takes effect with the next init. 0 (default) disables the cache.
+			*	videos that are longer than the budget are decoded all the time as before.
+			*/
+			void setCacheBudget(unsigned long long bytes);
+			unsigned long long getCacheBudget() const;
+			/*
+			*	true once update plays the video from the cache, the decoder thread has stopped then
+			*/
+			bool isPlayingCache() const;
+			/*
+			*	cache index of the current frame while isPlayingCache, -1 otherwise
+			*/
+			int getCacheIndex() const;
+			/*
+			*	number of cached frames while isPlayingCache, 0 otherwise
+			*/
+			unsigned int getCachedFrameCount() const;
+			/*
+			*	bytes of pixel data in the cache while isPlayingCache, 0 otherwise
+			*/
+			unsigned long long getCacheBytes() const;
+			/*
+			*	drops the pixels of a cached frame once the renderer keeps its own copy (e.g. a texture).
+			*	the timing stays, getCurrentFrame returns an empty frame for this index from then on.
+			*/
+			void releaseCachedFrame(int index);
+			/*
+			*	stops the decoder thread and closes the video
+			*/
+			void close();
+			/*
+			*	old function from the test project.
 			*	to determine which error has occured the error handlers can be implemented here
 			*/
 			void handle_error(int i);
@@ -59,15 +176,26 @@ namespace DirectLook
 			*/
 			void SaveFrame(AVFrame *pFrame, int width, int height, int iFrame);
 			/*
-			*	like the name indicates its the main function for updating the frame informations.
-			*	once started the function runs until a frame is found, loaded and decoded completely.
-			*	It doesn't ensure the frame which has been decoded actually stores real data.
-			*	@see getLastestFrame to validate the frame data
-			*	
-			*	this function will also be called by the init function to ensure that a frame as
-			*	been initialized per default.
+			*	picks the frame which is due at the wall clock time "nowMicroseconds" (see Clock::microseconds).
+			*	the first call after init starts the playback. frames which are already late are skipped.
+			*	returns true if getCurrentFrame changed since the last call, only then the texture needs an upload.
+			*	never blocks.
+			*/
+			bool update(unsigned long long nowMicroseconds);
+			/*
+			*	returns the frame picked by the last update (see AvVideoFrame, rows from top to bottom).
+			*	BEWARE: the imagedata isn't flipped around the Y-Axis. to ensure the data will be displayed corretly
+			*	use glScale(1.0f, -1.0f, 1.0f) after texture has been loaded.
+			*/
+			const AvVideoFrame& getCurrentFrame() const;
+			/*
+			*	number of frames that were decoded but skipped because the renderer was too slow
 			*/
-			void run();
+			unsigned long long getSkippedFrames() const;
+			/*
+			*	number of decoded frames waiting in the queue
+			*/
+			unsigned int getQueueDepth() const;
 			/*
 			*	wrapper function which simply returns the height of the video
 			*/
@@ -76,14 +204,5 @@ namespace DirectLook
 			*	wrapper function which simply returns the width of the video
 			*/
 			int getWidth();
-			/*
-			*	returns an AVFrame which holds the rgb information of the video in
-			*	AVFrame->data[0]. 
-			*	
-			*	this data can be used to store them inside an opengl texture.
-			*	BEWARE: the imagedata isn't flipped around the Y-Axis. to ensure the data will be displayed corretly
-			*	use glScale(1.0f, -1.0f, 1.0f) after texture has been loaded.
-			*/
-			AVFrame* getLatestFrame();
 	};
 };
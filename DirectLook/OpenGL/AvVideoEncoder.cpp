@@ -0,0 +1,378 @@
+#define _CRT_SECURE_NO_DEPRECATE
+
+#include "AvVideoEncoder.h"
+#include "../Core/Clock.h"
+#include "../Core/Trace.h"
+
+extern "C"
+{
+	#include <avcodec.h>
+	#include <avformat.h>
+	#include <swscale.h>
+}
+
+#include <QThread>
+
+#include <iostream>
+#include <string.h>
+
+namespace DirectLook
+{
+	class AvVideoEncoder::EncodeThread : public QThread
+	{
+
+	public:
+		EncodeThread( AvVideoEncoder& encoder )
+			:
+			m_Encoder( encoder )
+		{
+		}
+
+	protected:
+		void run(void)
+		{
+			m_Encoder.encodeLoop();
+		}
+
+	private:
+		AvVideoEncoder& m_Encoder;
+	};
+
+	AvVideoEncoder::AvVideoEncoder(void)
+		:
+		m_pThread( 0 ),
+		m_Closing( 0 ),
+		m_pQueue( 0 ),
+		m_pFormatContext( 0 ),
+		m_pStream( 0 ),
+		m_pCodecContext( 0 ),
+		m_pPicture( 0 ),
+		m_pConvertContext( 0 ),
+		m_Width( 0 ),
+		m_Height( 0 ),
+		m_FrameRate( 30 ),
+		m_BottomUp( false ),
+		m_CodecOpen( false ),
+		m_HeaderWritten( false ),
+		m_FirstTimestamp( 0 ),
+		m_LastPts( -1 ),
+		m_OpenTime( 0 ),
+		m_CloseTime( 0 ),
+		m_Encoded( 0 ),
+		m_Bytes( 0 ),
+		m_EncodeMilliseconds( 0.0 )
+	{
+	}
+
+	AvVideoEncoder::~AvVideoEncoder(void)
+	{
+		close();
+		if(m_pQueue) { delete m_pQueue; m_pQueue = 0; }
+	}
+
+	bool AvVideoEncoder::open( const std::string& fileName, const unsigned int width, const unsigned int height, const unsigned int frameRate,
+		const VideoCodec codec, const bool bottomUp, const bool dropFrames )
+	{
+		close();
+		av_register_all();
+
+		m_Width = width;
+		m_Height = height;
+		m_FrameRate = (frameRate > 0) ? frameRate : 30;
+		m_BottomUp = bottomUp;
+
+		// The container follows the file extension, Matroska takes both codecs
+		AVOutputFormat* pFormat = av_guess_format( NULL, fileName.c_str(), NULL );
+		if(!pFormat)
+		{
+			pFormat = av_guess_format( "matroska", NULL, NULL );
+		}
+		AVCodec* pCodec = avcodec_find_encoder( (codec == VIDEO_CODEC_FFV1) ? CODEC_ID_FFV1 : CODEC_ID_H264 );
+		if(!pFormat || !pCodec)
+		{
+			std::cerr << "No " << getCodecName( codec ) << " encoder for " << fileName << std::endl;
+			return false;
+		}
+
+		m_pFormatContext = avformat_alloc_context();
+		m_pFormatContext->oformat = pFormat;
+		strncpy( m_pFormatContext->filename, fileName.c_str(), sizeof( m_pFormatContext->filename ) - 1 );
+
+		m_pStream = av_new_stream( m_pFormatContext, 0 );
+		if(!m_pStream)
+		{
+			release();
+			return false;
+		}
+
+		// Timestamps count frames of the nominal rate, dropped frames leave gaps
+		m_pCodecContext = m_pStream->codec;
+		m_pCodecContext->codec_id = (codec == VIDEO_CODEC_FFV1) ? CODEC_ID_FFV1 : CODEC_ID_H264;
+		m_pCodecContext->codec_type = AVMEDIA_TYPE_VIDEO;
+		m_pCodecContext->width = (int) width;
+		m_pCodecContext->height = (int) height;
+		m_pCodecContext->time_base.num = 1;
+		m_pCodecContext->time_base.den = (int) m_FrameRate;
+		m_pCodecContext->gop_size = (int) m_FrameRate;
+		if(codec == VIDEO_CODEC_FFV1)
+		{
+			// FFV1 codes RGB directly, so the recording is bit exact
+			m_pCodecContext->pix_fmt = PIX_FMT_RGB32;
+		}
+		else
+		{
+			// About 0.25 bit per pixel, no B-frames so every frame leaves the encoder right away
+			m_pCodecContext->pix_fmt = PIX_FMT_YUV420P;
+			m_pCodecContext->bit_rate = (int) (width * height * m_FrameRate / 4);
+			m_pCodecContext->max_b_frames = 0;
+			m_pCodecContext->qmin = 10;
+			m_pCodecContext->qmax = 51;
+			m_pCodecContext->max_qdiff = 4;
+			m_pCodecContext->me_range = 16;
+			m_pCodecContext->qcompress = 0.6f;
+		}
+		if(pFormat->flags & AVFMT_GLOBALHEADER)
+		{
+			m_pCodecContext->flags |= CODEC_FLAG_GLOBAL_HEADER;
+		}
+
+		if(avcodec_open( m_pCodecContext, pCodec ) < 0)
+		{
+			std::cerr << "Couldn't open the " << getCodecName( codec ) << " encoder" << std::endl;
+			release();
+			return false;
+		}
+		m_CodecOpen = true;
+
+		m_pPicture = avcodec_alloc_frame();
+		m_pConvertContext = sws_getContext( (int) width, (int) height, PIX_FMT_RGB24,
+			(int) width, (int) height, m_pCodecContext->pix_fmt, SWS_POINT, NULL, NULL, NULL );
+		if(!m_pPicture || !m_pConvertContext || avpicture_alloc( (AVPicture*) m_pPicture, m_pCodecContext->pix_fmt, (int) width, (int) height ) < 0)
+		{
+			if(m_pPicture) { av_free( m_pPicture ); m_pPicture = 0; }
+			release();
+			return false;
+		}
+
+		if(!(pFormat->flags & AVFMT_NOFILE) && avio_open( &m_pFormatContext->pb, fileName.c_str(), AVIO_FLAG_WRITE ) < 0)
+		{
+			std::cerr << "Couldn't write " << fileName << std::endl;
+			release();
+			return false;
+		}
+		if(avformat_write_header( m_pFormatContext, NULL ) < 0)
+		{
+			release();
+			return false;
+		}
+		m_HeaderWritten = true;
+
+		// FFV1 can exceed the raw size on noise, so the buffer holds more than one RGB32 frame
+		m_Output.resize( width * height * 8 + FF_MIN_BUFFER_SIZE );
+		m_FirstTimestamp = 0;
+		m_LastPts = -1;
+		m_OpenTime = Clock::microseconds();
+		m_CloseTime = 0;
+		m_Encoded = 0;
+		m_Bytes = 0;
+		m_EncodeMilliseconds = 0.0;
+		m_Lag.reset();
+
+		if(m_pQueue) { delete m_pQueue; m_pQueue = 0; }
+		m_pQueue = new FrameQueue<EncoderItem>( QUEUE_FRAMES, dropFrames ? DROP_NEWEST : DROP_NONE );
+		m_Closing = 0;
+		m_pThread = new EncodeThread( *this );
+		m_pThread->start();
+		return true;
+	}
+
+	bool AvVideoEncoder::push( const ImageFrame& frame )
+	{
+		if(!m_pThread || frame.getWidth() != m_Width || frame.getHeight() != m_Height || frame.getChannels() != 3)
+		{
+			return false;
+		}
+
+		EncoderItem item;
+		item.m_Frame = frame;
+		item.m_QueuedAt = Clock::microseconds();
+		return m_pQueue->push( item );
+	}
+
+	void AvVideoEncoder::close(void)
+	{
+		if(m_pThread)
+		{
+			// The thread encodes what is still queued and flushes the codec before it ends
+			m_Closing = 1;
+			m_pQueue->close();
+			m_pThread->wait();
+			delete m_pThread;
+			m_pThread = 0;
+
+			QMutexLocker locker( &m_StatisticsMutex );
+			m_CloseTime = Clock::microseconds();
+		}
+		release();
+	}
+
+	void AvVideoEncoder::release(void)
+	{
+		if(m_HeaderWritten)
+		{
+			av_write_trailer( m_pFormatContext );
+			m_HeaderWritten = false;
+		}
+		if(m_CodecOpen)
+		{
+			avcodec_close( m_pCodecContext );
+			m_CodecOpen = false;
+		}
+		if(m_pPicture)
+		{
+			avpicture_free( (AVPicture*) m_pPicture );
+			av_free( m_pPicture );
+			m_pPicture = 0;
+		}
+		if(m_pConvertContext) { sws_freeContext( m_pConvertContext ); m_pConvertContext = 0; }
+		if(m_pFormatContext)
+		{
+			if(m_pFormatContext->pb && !(m_pFormatContext->oformat->flags & AVFMT_NOFILE))
+			{
+				avio_close( m_pFormatContext->pb );
+			}
+			// Frees the stream and its codec context as well
+			avformat_free_context( m_pFormatContext );
+			m_pFormatContext = 0;
+		}
+		m_pStream = 0;
+		m_pCodecContext = 0;
+	}
+
+	void AvVideoEncoder::encodeLoop(void)
+	{
+		EncoderItem item;
+		for(;;)
+		{
+			if(!m_pQueue->pop( item, 100 ))
+			{
+				// Nothing left after close(), otherwise keep waiting
+				if(m_Closing != 0)
+				{
+					break;
+				}
+				continue;
+			}
+			if(encodeFrame( item ) < 0)
+			{
+				// Closing the queue keeps push() from waiting on a thread that is gone
+				std::cerr << "Encoding failed, the recording stops" << std::endl;
+				m_pQueue->close();
+				break;
+			}
+			item = EncoderItem();
+		}
+
+		// Frames the codec still holds back
+		while(m_HeaderWritten && encodeFrame( EncoderItem() ) > 0)
+		{
+		}
+	}
+
+	int AvVideoEncoder::encodeFrame( const EncoderItem& item )
+	{
+		DL_TRACE_SCOPE( "AvVideoEncoder::encodeFrame" );
+		const unsigned long long startTime = Clock::microseconds();
+
+		AVFrame* pPicture = 0;
+		if(item.m_Frame.isValid())
+		{
+			// Rows of OpenGL textures run bottom up, a negative stride flips them during the conversion
+			const int stride = (int) m_Width * 3;
+			const uint8_t* pSource[4] = { item.m_Frame.getData(), NULL, NULL, NULL };
+			int sourceStride[4] = { stride, 0, 0, 0 };
+			if(m_BottomUp)
+			{
+				pSource[0] += (m_Height - 1) * stride;
+				sourceStride[0] = -stride;
+			}
+			sws_scale( m_pConvertContext, pSource, sourceStride, 0, (int) m_Height, m_pPicture->data, m_pPicture->linesize );
+
+			// Microseconds to frames of the nominal rate, strictly increasing
+			if(m_LastPts < 0)
+			{
+				m_FirstTimestamp = item.m_Frame.getTimestamp();
+			}
+			const unsigned long long elapsed = (item.m_Frame.getTimestamp() > m_FirstTimestamp) ? item.m_Frame.getTimestamp() - m_FirstTimestamp : 0;
+			long long pts = (long long) ((elapsed * m_FrameRate + 500000) / 1000000);
+			if(pts <= m_LastPts)
+			{
+				pts = m_LastPts + 1;
+			}
+			m_pPicture->pts = pts;
+			m_LastPts = pts;
+			pPicture = m_pPicture;
+		}
+
+		const int size = avcodec_encode_video( m_pCodecContext, &m_Output[0], (int) m_Output.size(), pPicture );
+		if(size < 0)
+		{
+			return -1;
+		}
+
+		if(size > 0)
+		{
+			AVPacket packet;
+			av_init_packet( &packet );
+			if(m_pCodecContext->coded_frame && m_pCodecContext->coded_frame->pts != AV_NOPTS_VALUE)
+			{
+				packet.pts = av_rescale_q( m_pCodecContext->coded_frame->pts, m_pCodecContext->time_base, m_pStream->time_base );
+			}
+			if(m_pCodecContext->coded_frame && m_pCodecContext->coded_frame->key_frame)
+			{
+				packet.flags |= AV_PKT_FLAG_KEY;
+			}
+			packet.stream_index = m_pStream->index;
+			packet.data = &m_Output[0];
+			packet.size = size;
+			if(av_interleaved_write_frame( m_pFormatContext, &packet ) != 0)
+			{
+				return -1;
+			}
+		}
+
+		QMutexLocker locker( &m_StatisticsMutex );
+		m_Bytes += (unsigned long long) size;
+		if(pPicture)
+		{
+			m_Encoded++;
+			m_EncodeMilliseconds += Clock::elapsedMilliseconds( startTime );
+			m_Lag.add( Clock::microseconds() - item.m_QueuedAt );
+		}
+		return size;
+	}
+
+	EncoderStatistics AvVideoEncoder::getStatistics(void) const
+	{
+		EncoderStatistics statistics;
+		statistics.m_Queued = m_pQueue ? m_pQueue->getDepth() : 0;
+		statistics.m_Dropped = m_pQueue ? m_pQueue->getDropped() : 0;
+
+		QMutexLocker locker( &m_StatisticsMutex );
+		const unsigned long long endTime = (m_CloseTime != 0) ? m_CloseTime : Clock::microseconds();
+		const double seconds = (double) (endTime - m_OpenTime) / 1000000.0;
+		statistics.m_Encoded = m_Encoded;
+		statistics.m_Bytes = m_Bytes;
+		statistics.m_FramesPerSecond = (seconds > 0.0) ? (double) m_Encoded / seconds : 0.0;
+		statistics.m_EncodeMilliseconds = (m_Encoded > 0) ? m_EncodeMilliseconds / (double) m_Encoded : 0.0;
+		statistics.m_LagMean = m_Lag.getMean();
+		statistics.m_LagP99 = m_Lag.getPercentile( 0.99 );
+		statistics.m_LagMax = m_Lag.getMax();
+		return statistics;
+	}
+
+	const char* AvVideoEncoder::getCodecName( const VideoCodec codec )
+	{
+		return (codec == VIDEO_CODEC_FFV1) ? "ffv1" : "h264";
+	}
+};
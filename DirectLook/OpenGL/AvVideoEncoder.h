@@ -0,0 +1,176 @@
+#pragma once
+
+#include "../NonCopyable.h"
+#include "../Core/FrameQueue.h"
+#include "../Core/Metrics.h"
+#include "../Image/FrameHandle.h"
+
+#include <QAtomicInt>
+#include <QMutex>
+
+#include <string>
+#include <vector>
+
+// ffmpeg is only needed by AvVideoEncoder.cpp
+struct AVFormatContext;
+struct AVStream;
+struct AVCodecContext;
+struct AVFrame;
+struct SwsContext;
+
+namespace DirectLook
+{
+	/// \brief Codec einer Aufnahme von AvVideoEncoder
+	enum VideoCodec
+	{
+		VIDEO_CODEC_FFV1,	///< Verlustfrei (RGB), grosse Dateien, z.B. fuer die Auswertung
+		VIDEO_CODEC_H264	///< Verlustbehaftet (YUV 4:2:0), kleine Dateien zum Archivieren
+	};
+
+	/// \brief Momentaufnahme eines AvVideoEncoder-Objektes, siehe AvVideoEncoder::getStatistics().
+	struct EncoderStatistics
+	{
+		unsigned long long m_Encoded;		///< Kodierte Bilder
+		unsigned long long m_Dropped;		///< Verworfene Bilder (Warteschlange voll)
+		unsigned long long m_Bytes;			///< Geschriebene Byte der kodierten Bilder
+		unsigned int m_Queued;				///< Bilder, die auf den Encoder warten
+		double m_FramesPerSecond;			///< Durchsatz seit open()
+		double m_EncodeMilliseconds;		///< Mittlere Zeit fuer Farbumwandlung und Kodierung eines Bildes
+		double m_LagMean;					///< Mittlere Zeit von push() bis zum kodierten Bild in ms
+		double m_LagP99;					///< 99. Perzentil dieser Zeit in ms
+		double m_LagMax;					///< Groesste dieser Zeiten in ms
+	};
+
+	/// \brief Die Klasse AvVideoEncoder schreibt die korrigierten RGB-Bilder mit libavcodec in eine Videodatei.
+	///
+	/// push() reiht die Bilder nur ein (die Puffer werden geteilt, nicht kopiert). Ein eigener Thread
+	/// wandelt sie mit swscale in das Pixelformat des Codecs um, kodiert sie und schreibt sie mit ihren
+	/// Zeitstempeln in den Container, den die Dateiendung vorgibt (z.B. *.mkv, *.mp4, *.avi).
+	/// Ist die Warteschlange voll, wird das neue Bild verworfen, der Renderer wartet also nie auf den Encoder.
+	/// Tonspuren werden nicht geschrieben, DirectLook hat keine Audioquelle.
+	class AvVideoEncoder : NonCopyable
+	{
+
+	public:
+		static const unsigned int QUEUE_FRAMES = 8;	///< Groesse der Warteschlange in Bildern
+
+		////////////////////////////////////////////////////////////
+		/// \brief Standardkonstruktor
+		////////////////////////////////////////////////////////////
+		AvVideoEncoder(void);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Destruktor
+		///
+		/// Kodiert die noch wartenden Bilder und schliesst die Datei.
+		///
+		////////////////////////////////////////////////////////////
+		~AvVideoEncoder(void);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Legt die Datei an und startet den Encoder-Thread.
+		///
+		/// \param fileName   Zieldatei, die Endung waehlt den Container (unbekannt = Matroska)
+		/// \param width      Bildbreite
+		/// \param height     Bildhoehe
+		/// \param frameRate  Nominale Bildrate, Zeitbasis der Zeitstempel
+		/// \param codec      Codec
+		/// \param bottomUp   Zeilen von unten nach oben (OpenGL-Textur), werden beim Kodieren gespiegelt
+		/// \param dropFrames Bei voller Warteschlange verwerfen (true) oder in push() warten (false, z.B. im Batch-Betrieb)
+		///
+		/// \return True wenn erfolgreich, false wenn fehlgeschlagen
+		///
+		////////////////////////////////////////////////////////////
+		bool open( const std::string& fileName, const unsigned int width, const unsigned int height, const unsigned int frameRate,
+			const VideoCodec codec, const bool bottomUp, const bool dropFrames = true );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Reiht ein Bild zum Kodieren ein.
+		///
+		/// \param frame RGB-Bild (3 Kanaele) in der Groesse aus open(), Zeitstempel in Mikrosekunden
+		///
+		/// \return false, wenn das Bild verworfen wurde oder der Encoder nicht geoeffnet ist
+		///
+		////////////////////////////////////////////////////////////
+		bool push( const ImageFrame& frame );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Kodiert die noch wartenden Bilder, schreibt das Ende der Datei und stoppt den Thread.
+		////////////////////////////////////////////////////////////
+		void close(void);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert true zurueck, solange eine Datei geoeffnet ist.
+		////////////////////////////////////////////////////////////
+		bool isOpen(void) const { return m_pThread != 0; }
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert Durchsatz und Verzoegerung des Encoders zurueck (threadsicher).
+		///
+		/// Nach close() bleibt die Statistik der letzten Aufnahme bis zum naechsten open() erhalten.
+		///
+		////////////////////////////////////////////////////////////
+		EncoderStatistics getStatistics(void) const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert den Namen eines Codecs zurueck (z.B. fuer Kommandozeilen).
+		////////////////////////////////////////////////////////////
+		static const char* getCodecName( const VideoCodec codec );
+
+	private:
+		class EncodeThread;
+
+		/// \brief Eingereihtes Bild mit dem Zeitpunkt von push()
+		struct EncoderItem
+		{
+			ImageFrame m_Frame;				///< RGB-Bild
+			unsigned long long m_QueuedAt;	///< Clock::microseconds() beim Einreihen
+		};
+
+		////////////////////////////////////////////////////////////
+		/// \brief Schleife des Encoder-Threads.
+		////////////////////////////////////////////////////////////
+		void encodeLoop(void);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Wandelt ein Bild um und kodiert es.
+		///
+		/// \param item Bild (ein leeres Bild leert die Verzoegerung des Codecs)
+		///
+		/// \return Anzahl der geschriebenen Byte, 0 wenn der Codec nichts ausgegeben hat, -1 bei Fehlern
+		///
+		////////////////////////////////////////////////////////////
+		int encodeFrame( const EncoderItem& item );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Gibt alle ffmpeg-Objekte frei.
+		////////////////////////////////////////////////////////////
+		void release(void);
+
+		EncodeThread* m_pThread;				///< Encoder-Thread, 0 wenn geschlossen
+		QAtomicInt m_Closing;					///< close() wurde aufgerufen, der Thread leert die Warteschlange und endet
+		FrameQueue<EncoderItem>* m_pQueue;		///< Bilder, die auf den Encoder warten
+		AVFormatContext* m_pFormatContext;		///< Container
+		AVStream* m_pStream;					///< Videospur
+		AVCodecContext* m_pCodecContext;		///< Codec der Videospur (gehoert zu m_pStream)
+		AVFrame* m_pPicture;					///< Bild im Pixelformat des Codecs
+		SwsContext* m_pConvertContext;			///< Umwandlung RGB24 in das Pixelformat des Codecs
+		std::vector<unsigned char> m_Output;	///< Puffer fuer ein kodiertes Bild
+		unsigned int m_Width;					///< Bildbreite
+		unsigned int m_Height;					///< Bildhoehe
+		unsigned int m_FrameRate;				///< Nominale Bildrate
+		bool m_BottomUp;						///< Zeilen von unten nach oben?
+		bool m_CodecOpen;						///< Wurde der Codec geoeffnet?
+		bool m_HeaderWritten;					///< Muss beim Schliessen das Ende der Datei geschrieben werden?
+		unsigned long long m_FirstTimestamp;	///< Zeitstempel des ersten Bildes in Mikrosekunden
+		long long m_LastPts;					///< Zuletzt vergebener Zeitstempel in Einheiten der Zeitbasis
+		unsigned long long m_OpenTime;			///< Clock::microseconds() bei open()
+		unsigned long long m_CloseTime;			///< Clock::microseconds() bei close(), 0 solange geoeffnet
+
+		mutable QMutex m_StatisticsMutex;		///< Schuetzt die folgenden Member
+		unsigned long long m_Encoded;			///< Kodierte Bilder
+		unsigned long long m_Bytes;				///< Geschriebene Byte
+		double m_EncodeMilliseconds;			///< Summe der Kodierzeiten
+		LatencyHistogram m_Lag;					///< Zeit von push() bis zum kodierten Bild
+	};
+};
@@ -52,6 +52,16 @@ namespace DirectLook
 		}
 	}
 
+	void ElementBufferObject::updateSubBuffer( const void* pBufferData, const GLsizei firstElement, const GLsizei elementCount )
+	{
+		if(pBufferData && m_ID > 0 && elementCount > 0 && firstElement + elementCount <= m_Size)
+		{
+			const GLsizeiptr offset = sizeof( GLuint ) * firstElement;
+			glBindBuffer( m_Target, m_ID );
+			glBufferSubData( m_Target, offset, sizeof( GLuint ) * elementCount, static_cast<const GLubyte*>( pBufferData ) + offset );
+		}
+	}
+
 	void ElementBufferObject::deleteBuffer(void)
 	{
 		if(m_ID > 0)
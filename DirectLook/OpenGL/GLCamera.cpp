@@ -12,7 +12,8 @@ namespace DirectLook
 		m_FieldOfView( (GLfloat) HALF_PI ),
 		m_AspectRatio( 4.0f / 3.0f ),
 		m_NearClipPlane( 0.5f ),
-		m_FarClipPlane( 5000.0f )
+		m_FarClipPlane( 5000.0f ),
+		m_ViewHeight( 480.0f )
 	{
 		update();
 	}
@@ -28,6 +29,7 @@ namespace DirectLook
 		m_AspectRatio( copy.m_AspectRatio ),
 		m_NearClipPlane( copy.m_NearClipPlane ),
 		m_FarClipPlane( copy.m_FarClipPlane ),
+		m_ViewHeight( copy.m_ViewHeight ),
 
 		m_MatView( copy.m_MatView ),
 		m_MatProjection( copy.m_MatProjection ),
@@ -46,7 +48,8 @@ namespace DirectLook
 		m_FieldOfView( fieldOfView ),
 		m_AspectRatio( aspectRatio ),
 		m_NearClipPlane( nearClipPlane ),
-		m_FarClipPlane( farClipPlane )
+		m_FarClipPlane( farClipPlane ),
+		m_ViewHeight( 480.0f )
 	{
 		update();
 	}
@@ -62,9 +65,18 @@ namespace DirectLook
 
 		lookAtRightHand( &m_MatView, &m_Position, &m_LookAt, &m_WorldUp );
 		//perspectiveFovRightHand( &m_MatProjection, m_FieldOfView, m_AspectRatio, m_NearClipPlane, m_FarClipPlane );
-		orthoRightHand( &m_MatProjection, 640.f, 480.0f, m_NearClipPlane, m_FarClipPlane );
+		orthoRightHand( &m_MatProjection, m_ViewHeight * m_AspectRatio, m_ViewHeight, m_NearClipPlane, m_FarClipPlane );
 		m_MatViewProjection = m_MatView * m_MatProjection;
 	}
+
+	void GLCamera::setAspectRatio( const GLfloat aspectRatio )
+	{
+		if(aspectRatio > 0.0f)
+		{
+			m_AspectRatio = aspectRatio;
+			update();
+		}
+	}
 	
 	void GLCamera::addToCamera( float strafe, float upDown, float forBack )
 	{
@@ -24,6 +24,7 @@ namespace DirectLook
 		GLfloat m_AspectRatio;		///< Seitenverhaeltnis
 		GLfloat m_NearClipPlane;	///< Near-Clipping-Plane
 		GLfloat m_FarClipPlane;		///< Far-Clipping-Plane
+		GLfloat m_ViewHeight;		///< Hoehe des orthografischen Ausschnittes, die Breite folgt aus dem Seitenverhaeltnis
 
 		Matrix m_MatView;			///< View-Matrix
 		Matrix m_MatProjection;		///< Projektionsmatrix
@@ -82,6 +83,17 @@ namespace DirectLook
 		///////////////////////////////////////////////////////////
 		void update(void);
 
+		///////////////////////////////////////////////////////////
+		/// \brief Setzt das Seitenverhaeltnis der Ausgabe (Breite / Hoehe) und aktualisiert die Projektion.
+		///
+		/// Die Hoehe des sichtbaren Ausschnittes bleibt gleich, breitere Ausgaben zeigen links und
+		/// rechts mehr von der Szene, schmalere weniger. Der Kopf wird also nie verzerrt.
+		///
+		/// \param aspectRatio Seitenverhaeltnis, z.B. 16.0f / 9.0f
+		///
+		///////////////////////////////////////////////////////////
+		void setAspectRatio( const GLfloat aspectRatio );
+
 		///////////////////////////////////////////////////////////
 		/// \brief Setzt die Translationen der Kamera in X-, Y- und Z-Richtung.
 		/// 
@@ -1,7 +1,23 @@
 #include "GLScene.h"
+#include "../Core/Trace.h"
+#include "../Core/Clock.h"
+
+#include <string.h>
 
 namespace DirectLook 
 {
+	// Splats are this much larger than the grid spacing, so a grid rotated by 45 degrees stays closed
+	static const GLfloat SPLAT_OVERLAP = 1.5f;
+
+	// Ordered from full quality to cheapest; each step removes the largest remaining cost first
+	static const SceneQuality QUALITY_TABLE[GLScene::QUALITY_LEVELS] =
+	{
+		{ 1, HOLE_FILL_WIDE,   1, "full"    },
+		{ 1, HOLE_FILL_NARROW, 2, "high"    },
+		{ 2, HOLE_FILL_NARROW, 1, "medium"  },
+		{ 2, HOLE_FILL_NARROW, 2, "low"     },
+		{ 4, HOLE_FILL_OFF,    1, "minimal" }
+	};
 	
 #pragma region Constructors
 	GLScene::GLScene( const unsigned short nearThreshold, const unsigned short farThreshold, const unsigned int cameraWidth, const unsigned int cameraHeight, const unsigned int depthWidth, const unsigned int depthHeight, Shader* pShader, GLCamera* pCamera )
@@ -14,12 +30,38 @@ namespace DirectLook
 		m_CameraHeight( cameraHeight ),
 		m_DepthWidth( depthWidth ),
 		m_DepthHeight( depthHeight ),
+		m_OutputWidth( cameraWidth ),
+		m_OutputHeight( cameraHeight ),
+		m_OutputLevels( 1 ),
 		m_pRenderTarget( 0 ),
-		m_SimpleTexture( m_CameraWidth, m_CameraHeight ),
+		m_SimpleTexture( m_OutputWidth, m_OutputHeight ),
 		m_TextureMode( true ),
-		m_Background( true )
+		m_Background( true ),
+		m_BackgroundTimer( "background" ),
+		m_SceneTimer( "scene" ),
+		m_PresentTimer( "present" ),
+		m_UploadBytes( 0.0 ),
+		m_Quality( QUALITY_TABLE[0] ),
+		m_GridWidth( depthWidth ),
+		m_GridHeight( depthHeight ),
+		m_GuidedUpsampling( false ),
+		m_EdgePixels( 0 ),
+		m_HeadTracking( false ),
+		m_MeshMode( MESH_TRIANGLES ),
+		m_pPointBuffer( 0 ),
+		m_PointCount( 0 ),
+		m_pIsVideoPathSet( false ),
+		m_pVideoShader( 0 ),
+		m_pVideoVertexBuffer( 0 )
 		
 	{
+		m_pVideoTextures[0] = m_pVideoTextures[1] = m_pVideoTextures[2] = 0;
+		setVideoCacheBudget( DEFAULT_VIDEO_CACHE_MB );
+		m_HeadRegion.m_X0 = 0;
+		m_HeadRegion.m_Y0 = 0;
+		m_HeadRegion.m_X1 = m_GridWidth;
+		m_HeadRegion.m_Y1 = m_GridHeight;
+
 		m_IsInitialized = false;
 		setShader( pShader );
 		setCamera( pCamera );
@@ -35,180 +77,613 @@ namespace DirectLook
 #pragma region GLScene::updateData
 	void GLScene::updateData( const void* pImagePixels, const unsigned short* pDepthPixels )
 	{
-		// Update camera texture object
-		m_pCameraTexture->updateTexture( pImagePixels );	
+		updateData(
+			ImageFrame::wrap( static_cast<const unsigned char*>( pImagePixels ), m_CameraWidth, m_CameraHeight, 3 ),
+			DepthFrame::wrap( pDepthPixels, m_DepthWidth, m_DepthHeight )
+		);
+	}
+
+	void GLScene::updateData( const ImageFrame& imageFrame, const DepthFrame& depthFrame )
+	{
+		DL_TRACE_SCOPE( "GLScene::updateData" );
+		if(!imageFrame.isValid() || !depthFrame.isValid())
+		{
+			return;
+		}
+
+		if(m_HeadTracking)
+		{
+			updateHeadRegion( imageFrame, depthFrame );
+			return;
+		}
 
 		// smooth the depthmap and fill holes in it
-		const unsigned short* pSmoothPixels = SmoothFilter(pDepthPixels);
-		m_pHeightMap->updateImage( pSmoothPixels );
+		filterDepth( depthFrame, imageFrame, m_SmoothFrame );
+
+		const unsigned long long meshStart = Clock::microseconds();
+		m_pHeightMap->updateImage( m_SmoothFrame.getData() );
+		m_MeshTime.add( Clock::elapsedMilliseconds( meshStart ) );
+
+		// Upload straight from the sensor buffer and the height map's own arrays
+		uploadMesh(
+			imageFrame,
+			ImageFrame::wrap( m_pHeightMap->getTextureHeightMap(), m_GridWidth, m_GridHeight ),
+			VertexFrame::wrap( m_pHeightMap->getVertexHeightMap(), m_GridWidth, m_GridHeight, 3 )
+		);
+	}
+
+	void GLScene::filterDepth( const DepthFrame& depthFrame, DepthFrame& smoothFrame )
+	{
+		filterDepth( depthFrame, ImageFrame(), smoothFrame );
+	}
+
+	void GLScene::filterDepth( const DepthFrame& depthFrame, const ImageFrame& imageFrame, DepthFrame& smoothFrame )
+	{
+		if(!depthFrame.isValid())
+		{
+			return;
+		}
+
+		const unsigned int step = m_Quality.m_DepthStep;
+		const unsigned int gridWidth = m_DepthWidth / step;
+		const unsigned int gridHeight = m_DepthHeight / step;
+		if(!smoothFrame.isOwned() || smoothFrame.getSize() != gridWidth * gridHeight)
+		{
+			smoothFrame = DepthFrame::allocate( gridWidth, gridHeight );
+		}
+
+		const unsigned long long startTime = Clock::microseconds();
+		if(m_GuidedUpsampling && gridWidth % 2 == 0 && gridHeight % 2 == 0)
+		{
+			// Holes are filled on a quarter of the pixels, the upsampler restores the edges from the camera image
+			const unsigned int lowWidth = gridWidth / 2;
+			const unsigned int lowHeight = gridHeight / 2;
+			DepthFrame lowFrame = DepthFrame::allocate( lowWidth, lowHeight );
+			DepthFrame lowSmoothFrame = DepthFrame::allocate( lowWidth, lowHeight );
+			const TileRange lowRange = { 0, 0, lowWidth, lowHeight };
+			decimateDepth( depthFrame.getData(), lowFrame.getMutableData(), step * 2, lowRange );
+			SmoothFilter( lowFrame.getData(), lowSmoothFrame.getMutableData(), lowWidth, lowHeight, m_Quality.m_HoleFill );
+
+			const bool hasGuide = imageFrame.isValid() && imageFrame.getChannels() == 3;
+			m_EdgePixels = m_Upsampler.upsample(
+				lowSmoothFrame.getData(),
+				hasGuide ? imageFrame.getData() : 0, imageFrame.getWidth(), imageFrame.getHeight(),
+				smoothFrame.getMutableData(), gridWidth, gridHeight
+			);
+		}
+		else if(step > 1)
+		{
+			// Filter on the coarse grid, the full resolution map is never touched again
+			DepthFrame gridFrame = DepthFrame::allocate( gridWidth, gridHeight );
+			const TileRange gridRange = { 0, 0, gridWidth, gridHeight };
+			decimateDepth( depthFrame.getData(), gridFrame.getMutableData(), step, gridRange );
+			SmoothFilter( gridFrame.getData(), smoothFrame.getMutableData(), gridWidth, gridHeight, m_Quality.m_HoleFill );
+		}
+		else
+		{
+			SmoothFilter( depthFrame.getData(), smoothFrame.getMutableData(), gridWidth, gridHeight, m_Quality.m_HoleFill );
+		}
+		smoothFrame.setTimestamp( depthFrame.getTimestamp() );
+		m_FilterTime.add( Clock::elapsedMilliseconds( startTime ) );
+	}
+
+	void GLScene::buildMesh( const DepthFrame& smoothFrame, ImageFrame& textureHeightMap, VertexFrame& vertexHeightMap )
+	{
+		if(!smoothFrame.isValid())
+		{
+			return;
+		}
+
+		const unsigned int pixelSize = m_GridWidth * m_GridHeight;
+		if(smoothFrame.getSize() != pixelSize)
+		{
+			// Filtered before the last setQuality()
+			return;
+		}
+		if(!textureHeightMap.isOwned() || textureHeightMap.getSize() != pixelSize)
+		{
+			textureHeightMap = ImageFrame::allocate( m_GridWidth, m_GridHeight );
+		}
+		if(!vertexHeightMap.isOwned() || vertexHeightMap.getSize() != pixelSize * 3)
+		{
+			vertexHeightMap = VertexFrame::allocate( m_GridWidth, m_GridHeight, 3 );
+		}
+
+		const unsigned long long startTime = Clock::microseconds();
+		m_pHeightMap->segment( smoothFrame.getData(), 0, textureHeightMap.getMutableData(), vertexHeightMap.getMutableData() );
+		m_MeshTime.add( Clock::elapsedMilliseconds( startTime ) );
+	}
+
+	void GLScene::uploadMesh( const ImageFrame& imageFrame, const ImageFrame& textureHeightMap, const VertexFrame& vertexHeightMap )
+	{
+		DL_TRACE_SCOPE( "GLScene::uploadMesh" );
+		if(!imageFrame.isValid() || !textureHeightMap.isValid() || !vertexHeightMap.isValid())
+		{
+			return;
+		}
+
+		const unsigned long long startTime = Clock::microseconds();
+
+		// Update camera texture object
+		m_pCameraTexture->updateTexture( imageFrame.getData() );
+
+		// Meshes built before the last setQuality() don't fit the buffers any more
+		const unsigned int pixelSize = m_GridWidth * m_GridHeight;
+		if(textureHeightMap.getSize() != pixelSize || vertexHeightMap.getSize() != pixelSize * 3)
+		{
+			m_UploadTime.add( Clock::elapsedMilliseconds( startTime ) );
+			m_UploadBytes = (double) imageFrame.getSize();
+			return;
+		}
 
-		if(pSmoothPixels)	{ delete[] pSmoothPixels; pSmoothPixels = 0; }		
-				
 		// Update depth texture object
-		m_pDepthTexture->updateTexture( m_pHeightMap->getTextureHeightMap() );
+		m_pDepthTexture->updateTexture( textureHeightMap.getData() );
 
 		// Update vertex buffer
-		m_pVertexBuffer->updateBuffer( m_pHeightMap->getVertexHeightMap() );
+		m_pVertexBuffer->updateBuffer( vertexHeightMap.getData() );
+		if(m_MeshMode == MESH_POINTS)
+		{
+			updatePointList( vertexHeightMap.getData() );
+		}
+
+		m_UploadTime.add( Clock::elapsedMilliseconds( startTime ) );
+		m_UploadBytes = (double) imageFrame.getSize() + (double) textureHeightMap.getSize() + (double) vertexHeightMap.getSize() * sizeof( GLfloat )
+			+ (double) m_PointCount * sizeof( GLuint );
+	}
+#pragma endregion
+
+#pragma region GLScene head region
+	void GLScene::setForegroundMode( const ForegroundMode mode )
+	{
+		m_pHeightMap->setForegroundMode( mode );
+	}
+
+	ForegroundMode GLScene::getForegroundMode(void) const
+	{
+		return m_pHeightMap->getForegroundMode();
+	}
+
+	void GLScene::setMaskMorphology( const unsigned int openRadius, const unsigned int closeRadius )
+	{
+		m_pHeightMap->setMaskMorphology( openRadius, closeRadius );
+	}
+
+	unsigned int GLScene::getOpenRadius(void) const
+	{
+		return m_pHeightMap->getOpenRadius();
+	}
+
+	unsigned int GLScene::getCloseRadius(void) const
+	{
+		return m_pHeightMap->getCloseRadius();
+	}
+
+	void GLScene::setHeadTracking( const bool enabled )
+	{
+		m_HeadTracking = enabled;
+		m_HeadTracker.reset();
+		m_RegionCounts.clear();
+		m_RegionOffsets.clear();
+
+		// The first tracked frame clears everything the full frame path left behind
+		m_HeadRegion.m_X0 = 0;
+		m_HeadRegion.m_Y0 = 0;
+		m_HeadRegion.m_X1 = m_GridWidth;
+		m_HeadRegion.m_Y1 = m_GridHeight;
+	}
+
+	void GLScene::updateHeadRegion( const ImageFrame& imageFrame, const DepthFrame& depthFrame )
+	{
+		DL_TRACE_SCOPE( "GLScene::updateHeadRegion" );
+		const unsigned int step = m_Quality.m_DepthStep;
+
+		// Head region in sensor pixels, rounded outwards onto the depth grid
+		const TileRange& sensorRegion = m_HeadTracker.track( depthFrame.getData(), m_DepthWidth, m_DepthHeight, m_pHeightMap->getNearThreshold(), m_pHeightMap->getFarThreshold() );
+		TileRange region;
+		region.m_X0 = sensorRegion.m_X0 / step;
+		region.m_Y0 = sensorRegion.m_Y0 / step;
+		region.m_X1 = ((sensorRegion.m_X1 + step - 1) / step < m_GridWidth)  ? (sensorRegion.m_X1 + step - 1) / step : m_GridWidth;
+		region.m_Y1 = ((sensorRegion.m_Y1 + step - 1) / step < m_GridHeight) ? (sensorRegion.m_Y1 + step - 1) / step : m_GridHeight;
+		if(region.m_X1 <= region.m_X0 || region.m_Y1 <= region.m_Y0)
+		{
+			return;
+		}
+		const unsigned int regionWidth = region.m_X1 - region.m_X0;
+		const unsigned int regionHeight = region.m_Y1 - region.m_Y0;
+
+		// Filter only the region, the tracker's margin keeps its border away from the head
+		const unsigned long long filterStart = Clock::microseconds();
+		if(!m_SmoothFrame.isOwned() || m_SmoothFrame.getSize() != m_GridWidth * m_GridHeight)
+		{
+			m_SmoothFrame = DepthFrame::allocate( m_GridWidth, m_GridHeight );
+		}
+		DepthFrame regionFrame = DepthFrame::allocate( regionWidth, regionHeight );
+		DepthFrame regionSmoothFrame = DepthFrame::allocate( regionWidth, regionHeight );
+		decimateDepth( depthFrame.getData(), regionFrame.getMutableData(), step, region );
+		SmoothFilter( regionFrame.getData(), regionSmoothFrame.getMutableData(), regionWidth, regionHeight, m_Quality.m_HoleFill );
+		for(unsigned int y = 0; y < regionHeight; y++)
+		{
+			memcpy(
+				m_SmoothFrame.getMutableData() + (region.m_Y0 + y) * m_GridWidth + region.m_X0,
+				regionSmoothFrame.getData() + y * regionWidth,
+				regionWidth * sizeof( unsigned short )
+			);
+		}
+		m_FilterTime.add( Clock::elapsedMilliseconds( filterStart ) );
+
+		// Reset what the last frame segmented, then segment the new region over it
+		const unsigned long long meshStart = Clock::microseconds();
+		const TileRange previous = m_HeadRegion;
+		m_pHeightMap->clearRegion( previous );
+		const TileRange gridRegion = m_pHeightMap->segmentRegion( m_SmoothFrame.getData(), region );
+		m_MeshTime.add( Clock::elapsedMilliseconds( meshStart ) );
+
+		// The cleared part of the last region has to reach the GPU as well
+		TileRange dirty = gridRegion;
+		if(previous.m_X1 > previous.m_X0 && previous.m_Y1 > previous.m_Y0)
+		{
+			dirty.m_X0 = (previous.m_X0 < dirty.m_X0) ? previous.m_X0 : dirty.m_X0;
+			dirty.m_Y0 = (previous.m_Y0 < dirty.m_Y0) ? previous.m_Y0 : dirty.m_Y0;
+			dirty.m_X1 = (previous.m_X1 > dirty.m_X1) ? previous.m_X1 : dirty.m_X1;
+			dirty.m_Y1 = (previous.m_Y1 > dirty.m_Y1) ? previous.m_Y1 : dirty.m_Y1;
+		}
+		const unsigned int dirtyWidth = dirty.m_X1 - dirty.m_X0;
+		const unsigned int dirtyHeight = dirty.m_Y1 - dirty.m_Y0;
+
+		const unsigned long long uploadStart = Clock::microseconds();
+
+		// Only the head is textured with the camera image, the texture keeps the sensor's row order
+		const unsigned int cameraX0 = sensorRegion.m_X0 * m_CameraWidth / m_DepthWidth;
+		const unsigned int cameraY0 = sensorRegion.m_Y0 * m_CameraHeight / m_DepthHeight;
+		const unsigned int cameraX1 = sensorRegion.m_X1 * m_CameraWidth / m_DepthWidth;
+		const unsigned int cameraY1 = sensorRegion.m_Y1 * m_CameraHeight / m_DepthHeight;
+		m_pCameraTexture->updateSubTexture( imageFrame.getData(), cameraX0, cameraY0, cameraX1 - cameraX0, cameraY1 - cameraY0 );
+
+		// Height map texture and vertices are in grid layout; the vertex buffer is updated in whole rows
+		m_pDepthTexture->updateSubTexture( m_pHeightMap->getTextureHeightMap(), dirty.m_X0, dirty.m_Y0, dirtyWidth, dirtyHeight );
+		m_pVertexBuffer->updateSubBuffer( m_pHeightMap->getVertexHeightMap(), dirty.m_Y0 * m_GridWidth, dirtyHeight * m_GridWidth );
+		if(m_MeshMode == MESH_POINTS)
+		{
+			updatePointList( m_pHeightMap->getVertexHeightMap() );
+		}
+
+		m_UploadTime.add( Clock::elapsedMilliseconds( uploadStart ) );
+		m_UploadBytes =
+			(double) (cameraX1 - cameraX0) * (double) (cameraY1 - cameraY0) * 3.0 +
+			(double) dirtyWidth * (double) dirtyHeight +
+			(double) dirtyHeight * (double) m_GridWidth * 3.0 * sizeof( GLfloat ) +
+			(double) m_PointCount * sizeof( GLuint );
+
+		m_HeadRegion = gridRegion;
+		updateDrawRegion( gridRegion );
+	}
+
+	void GLScene::updateDrawRegion( const TileRange& gridRegion )
+	{
+		m_RegionCounts.clear();
+		m_RegionOffsets.clear();
+
+		const unsigned int step = m_Quality.m_MeshStep;
+		const unsigned int cellsX = (m_GridWidth - 1) / step;
+		const unsigned int cellsY = (m_GridHeight - 1) / step;
+		if(gridRegion.m_X1 <= gridRegion.m_X0 || gridRegion.m_Y1 <= gridRegion.m_Y0)
+		{
+			return;
+		}
+
+		// Cells touching the region; initElementBuffer() stores the cells column by column
+		const unsigned int cellX0 = gridRegion.m_X0 / step;
+		const unsigned int cellY0 = gridRegion.m_Y0 / step;
+		const unsigned int cellX1 = ((gridRegion.m_X1 - 1) / step + 1 < cellsX) ? (gridRegion.m_X1 - 1) / step + 1 : cellsX;
+		const unsigned int cellY1 = ((gridRegion.m_Y1 - 1) / step + 1 < cellsY) ? (gridRegion.m_Y1 - 1) / step + 1 : cellsY;
+		if(cellX1 <= cellX0 || cellY1 <= cellY0)
+		{
+			return;
+		}
+
+		for(unsigned int cellX = cellX0; cellX < cellX1; cellX++)
+		{
+			m_RegionCounts.push_back( (GLsizei) ((cellY1 - cellY0) * 6) );
+			m_RegionOffsets.push_back( (const GLvoid*) (size_t) (sizeof( GLuint ) * (cellX * cellsY + cellY0) * 6) );
+		}
 	}
 #pragma endregion
 	
 
 #pragma region GLScene::SmoothFilter
-	unsigned short* GLScene::SmoothFilter(const unsigned short* pDepthPixels)
+	void GLScene::SmoothFilter( const unsigned short* pDepthPixels, unsigned short* smoothDepthArray, const unsigned int depthWidth, const unsigned int depthHeight, const HoleFillMode holeFill )
 	{
-		unsigned short* smoothDepthArray = new unsigned short[ m_pHeightMap->getPixelSize() ];
+		DL_TRACE_SCOPE( "GLScene::SmoothFilter" );
+		if(holeFill == HOLE_FILL_OFF)
+		{
+			memcpy( smoothDepthArray, pDepthPixels, depthWidth * depthHeight * sizeof( unsigned short ) );
+			return;
+		}
 
-		for(unsigned int i = 0; i < m_pHeightMap->getPixelSize(); i++)
-			smoothDepthArray[i] = pDepthPixels[i];
+		const int width = (int) depthWidth;
 
 		// We will be using these numbers for constraints on indexes
-		int widthBound = 640 - 1;
-		int heightBound = 480 - 1;
+		int widthBound = (int) depthWidth - 1;
+		int heightBound = (int) depthHeight - 1;
 
-		// We process each row
-#ifdef _WIN32
-		Concurrency::parallel_for(size_t(0),size_t(480* 640),[&](size_t depthArrayIndex)
-		{
-#else
-		for(int depthArrayIndex = 0; depthArrayIndex < (480* 640); depthArrayIndex++)
-		{
-#endif
-			int depthIndex = depthArrayIndex;
+		// The wide filter searches a 5 X 5 matrix, the narrow one only the inner band
+		const int radius = (holeFill == HOLE_FILL_WIDE) ? 2 : 1;
 
-			// We are only concerned with eliminating 'white' noise from the data.
-			// We consider any pixel with a depth of 0 as a possible candidate for filtering.
-			if (pDepthPixels[depthIndex] == 0)
+		// Every pixel only reads the input, so bands of rows can be filtered in parallel on the task pool
+		TaskPool::instance().parallelFor2D( depthWidth, depthHeight, depthWidth, 16, [&]( const TileRange& tile, ScratchArena& )
+		{
+			for(int y = (int) tile.m_Y0; y < (int) tile.m_Y1; y++)
 			{
-				// From the depth index, we can determine the X and Y coordinates that the index
-				// will appear in the image. We use this to help us define our filter matrix.
-				int x = depthIndex % 640;
-				int y = (depthIndex - x) / 640;
-
-				// The filter collection is used to count the frequency of each
-				// depth value in the filter array. This is used later to determine
-				// the statistical mode for possible assignment to the candidate.
-				unsigned short filterCollection [24][2];
-
-				for(int i = 0; i < 24; i++)
-				for(int j = 0; j < 2; j++)
-				filterCollection[i][j] = 0;
-
-				// The inner and outer band counts are used later to compare against the threshold 
-				// values set in the UI to identify a positive filter result.
-				int innerBandCount = 0;
-				int outerBandCount = 0;
-
-				// The following loops will loop through a 5 X 5 matrix of pixels surrounding the 
-				// candidate pixel. This defines 2 distinct 'bands' around the candidate pixel.
-				// If any of the pixels in this matrix are non-0, we will accumulate them and count
-				// how many non-0 pixels are in each band. If the number of non-0 pixels breaks the
-				// threshold in either band, then the average of all non-0 pixels in the matrix is applied
-				// to the candidate pixel.
-				for (int yi = -2; yi < 3; yi++)
+				for(int x = (int) tile.m_X0; x < (int) tile.m_X1; x++)
 				{
-					for (int xi = -2; xi < 3; xi++)
+					int depthIndex = y * width + x;
+
+					// We are only concerned with eliminating 'white' noise from the data.
+					// We consider any pixel with a depth of 0 as a possible candidate for filtering.
+					if (pDepthPixels[depthIndex] == 0)
 					{
-						// yi and xi are modifiers that will be subtracted from and added to the
-						// candidate pixel's x and y coordinates that we calculated earlier. From the
-						// resulting coordinates, we can calculate the index to be addressed for processing.
-
-						// We do not want to consider the candidate
-						// pixel (xi = 0, yi = 0) in our process at this point.
-						// We already know that it's 0
-						if (xi != 0 || yi != 0)
+						// The filter collection is used to count the frequency of each
+						// depth value in the filter array. This is used later to determine
+						// the statistical mode for possible assignment to the candidate.
+						unsigned short filterCollection [24][2];
+
+						for(int i = 0; i < 24; i++)
+						for(int j = 0; j < 2; j++)
+						filterCollection[i][j] = 0;
+
+						// The inner and outer band counts are used later to compare against the threshold 
+						// values set in the UI to identify a positive filter result.
+						int innerBandCount = 0;
+						int outerBandCount = 0;
+
+						// The following loops will loop through a 5 X 5 matrix of pixels surrounding the 
+						// candidate pixel. This defines 2 distinct 'bands' around the candidate pixel.
+						// If any of the pixels in this matrix are non-0, we will accumulate them and count
+						// how many non-0 pixels are in each band. If the number of non-0 pixels breaks the
+						// threshold in either band, then the average of all non-0 pixels in the matrix is applied
+						// to the candidate pixel.
+						for (int yi = -radius; yi <= radius; yi++)
 						{
-							// We then create our modified coordinates for each pass
-							int xSearch = x + xi;
-							int ySearch = y + yi;
-
-							// While the modified coordinates may in fact calculate out to an actual index, it 
-							// might not be the one we want. Be sure to check
-							// to make sure that the modified coordinates
-							// match up with our image bounds.
-							if (xSearch >= 0 && xSearch <= widthBound && 
-								ySearch >= 0 && ySearch <= heightBound)
+							for (int xi = -radius; xi <= radius; xi++)
 							{
-								int index = xSearch + (ySearch * 640);
-								// We only want to look for non-0 values
-								if (pDepthPixels[index] != 0)
+								// yi and xi are modifiers that will be subtracted from and added to the
+								// candidate pixel's x and y coordinates that we calculated earlier. From the
+								// resulting coordinates, we can calculate the index to be addressed for processing.
+
+								// We do not want to consider the candidate
+								// pixel (xi = 0, yi = 0) in our process at this point.
+								// We already know that it's 0
+								if (xi != 0 || yi != 0)
 								{
-									// We want to find count the frequency of each depth
-									for (int i = 0; i < 24; i++)
+									// We then create our modified coordinates for each pass
+									int xSearch = x + xi;
+									int ySearch = y + yi;
+
+									// While the modified coordinates may in fact calculate out to an actual index, it 
+									// might not be the one we want. Be sure to check
+									// to make sure that the modified coordinates
+									// match up with our image bounds.
+									if (xSearch >= 0 && xSearch <= widthBound && 
+										ySearch >= 0 && ySearch <= heightBound)
 									{
-										if (filterCollection[i][0] == pDepthPixels[index])
-										{
-											// When the depth is already in the filter collection
-											// we will just increment the frequency.
-											filterCollection[i][1]++;
-											break;
-										}
-										else if (filterCollection[i][0] == 0)
+										int index = xSearch + (ySearch * width);
+										// We only want to look for non-0 values
+										if (pDepthPixels[index] != 0)
 										{
-											// When we encounter a 0 depth in the filter collection
-											// this means we have reached the end of values already counted.
-											// We will then add the new depth and start it's frequency at 1.
-											filterCollection[i][0] = pDepthPixels[index];
-											filterCollection[i][1]++;
-											break;
+											// We want to find count the frequency of each depth
+											for (int i = 0; i < 24; i++)
+											{
+												if (filterCollection[i][0] == pDepthPixels[index])
+												{
+													// When the depth is already in the filter collection
+													// we will just increment the frequency.
+													filterCollection[i][1]++;
+													break;
+												}
+												else if (filterCollection[i][0] == 0)
+												{
+													// When we encounter a 0 depth in the filter collection
+													// this means we have reached the end of values already counted.
+													// We will then add the new depth and start it's frequency at 1.
+													filterCollection[i][0] = pDepthPixels[index];
+													filterCollection[i][1]++;
+													break;
+												}
+											}
+
+											// We will then determine which band the non-0 pixel
+											// was found in, and increment the band counters.
+											if (yi != 2 && yi != -2 && xi != 2 && xi != -2)
+											innerBandCount++;
+											else
+											outerBandCount++;
 										}
 									}
+								}
+							}
+						}
+
+						int innerBandThreshold = 1;
+						int outerBandThreshold = 1;
+
+						// Once we have determined our inner and outer band non-zero counts, and 
+						// accumulated all of those values, we can compare it against the threshold
+						// to determine if our candidate pixel will be changed to the
+						// statistical mode of the non-zero surrounding pixels.
+						if (innerBandCount >= innerBandThreshold || outerBandCount >= outerBandThreshold)
+						{
+							short frequency = 0;
+							short depth = 0;
+							// This loop will determine the statistical mode
+							// of the surrounding pixels for assignment to
+							// the candidate.
+							for (int i = 0; i < 24; i++)
+							{
+								// This means we have reached the end of our
+								// frequency distribution and can break out of the
+								// loop to save time.
+								if (filterCollection[i][0] == 0)
+									break;
 
-									// We will then determine which band the non-0 pixel
-									// was found in, and increment the band counters.
-									if (yi != 2 && yi != -2 && xi != 2 && xi != -2)
-									innerBandCount++;
-									else
-									outerBandCount++;
+								if (filterCollection[i][1] > frequency)
+								{
+									depth = filterCollection[i][0];
+									frequency = filterCollection[i][1];
 								}
 							}
+ 
+							smoothDepthArray[depthIndex] = depth;
+						}
+						else
+						{
+							// No valid neighbours, the hole stays a hole
+							smoothDepthArray[depthIndex] = 0;
 						}
 					}
+					else
+					{
+						// If the pixel is not zero, we will keep the original depth.
+						smoothDepthArray[depthIndex] = pDepthPixels[depthIndex];
+					}
 				}
+			}
+		} );
+	}
 
-				int innerBandThreshold = 1;
-				int outerBandThreshold = 1;
+	void GLScene::decimateDepth( const unsigned short* pDepthPixels, unsigned short* pGridPixels, const unsigned int step, const TileRange& region ) const
+	{
+		const unsigned int regionWidth = region.m_X1 - region.m_X0;
 
-				// Once we have determined our inner and outer band non-zero counts, and 
-				// accumulated all of those values, we can compare it against the threshold
-				// to determine if our candidate pixel will be changed to the
-				// statistical mode of the non-zero surrounding pixels.
-				if (innerBandCount >= innerBandThreshold || outerBandCount >= outerBandThreshold)
+		for(unsigned int gy = region.m_Y0; gy < region.m_Y1; gy++)
+		{
+			unsigned short* pGridRow = pGridPixels + (gy - region.m_Y0) * regionWidth - region.m_X0;
+			for(unsigned int gx = region.m_X0; gx < region.m_X1; gx++)
+			{
+				unsigned short value = 0;
+				for(unsigned int y = gy * step; y < (gy + 1) * step && value == 0; y++)
 				{
-					short frequency = 0;
-					short depth = 0;
-					// This loop will determine the statistical mode
-					// of the surrounding pixels for assignment to
-					// the candidate.
-					for (int i = 0; i < 24; i++)
+					const unsigned short* pRow = pDepthPixels + y * m_DepthWidth + gx * step;
+					for(unsigned int x = 0; x < step && value == 0; x++)
 					{
-						// This means we have reached the end of our
-						// frequency distribution and can break out of the
-						// loop to save time.
-						if (filterCollection[i][0] == 0)
-							break;
-
-						if (filterCollection[i][1] > frequency)
-						{
-							depth = filterCollection[i][0];
-							frequency = filterCollection[i][1];
-						}
+						value = pRow[x];
 					}
- 
-					smoothDepthArray[depthIndex] = depth;
 				}
+				pGridRow[gx] = value;
 			}
-			else
+		}
+	}
+#pragma endregion
+
+#pragma region GLScene quality
+	SceneQuality GLScene::getQualityLevel( const unsigned int level )
+	{
+		return QUALITY_TABLE[(level < QUALITY_LEVELS) ? level : QUALITY_LEVELS - 1];
+	}
+
+	void GLScene::setGuidedUpsampling( const bool enabled )
+	{
+		m_GuidedUpsampling = enabled;
+		m_EdgePixels = 0;
+	}
+
+	void GLScene::setQuality( const SceneQuality& quality )
+	{
+		SceneQuality newQuality = quality;
+		if(newQuality.m_DepthStep != 2 && newQuality.m_DepthStep != 4)
+		{
+			newQuality.m_DepthStep = 1;
+		}
+		if(newQuality.m_MeshStep == 0)
+		{
+			newQuality.m_MeshStep = 1;
+		}
+
+		const bool gridChanged = newQuality.m_DepthStep != m_Quality.m_DepthStep;
+		const bool meshChanged = gridChanged || newQuality.m_MeshStep != m_Quality.m_MeshStep;
+		m_Quality = newQuality;
+
+		if(gridChanged)
+		{
+			m_GridWidth = m_DepthWidth / m_Quality.m_DepthStep;
+			m_GridHeight = m_DepthHeight / m_Quality.m_DepthStep;
+
+			// Keep the model at sensor scale so texture coordinates stay valid
+			m_pHeightMap->setResolution( m_GridWidth, m_GridHeight );
+			m_pHeightMap->setGridSpacing( (GLfloat) m_Quality.m_DepthStep );
+
+			if(m_pVertexBuffer){ delete m_pVertexBuffer; m_pVertexBuffer = 0; }
+			initVertexBuffer();
+
+			if(m_pDepthTexture){ delete m_pDepthTexture; m_pDepthTexture = 0; }
+			initDepthTexture();
+
+			// The new height map starts empty, the next tracked frame redraws the whole grid
+			m_HeadRegion.m_X0 = 0;
+			m_HeadRegion.m_Y0 = 0;
+			m_HeadRegion.m_X1 = m_GridWidth;
+			m_HeadRegion.m_Y1 = m_GridHeight;
+		}
+
+		if(meshChanged)
+		{
+			if(m_pElementBuffer){ delete m_pElementBuffer; m_pElementBuffer = 0; }
+			initElementBuffer();
+
+			// Offsets into the old element buffer, draw everything until the next frame
+			m_RegionCounts.clear();
+			m_RegionOffsets.clear();
+
+			// Indices of the old grid, rebuilt with the next upload
+			if(m_pPointBuffer){ delete m_pPointBuffer; m_pPointBuffer = 0; }
+			m_PointCount = 0;
+		}
+	}
+
+	void GLScene::setMeshMode( const MeshMode mode )
+	{
+		m_MeshMode = mode;
+		if(m_MeshMode == MESH_POINTS)
+		{
+			// Points from the last upload until the next frame arrives
+			updatePointList( m_pHeightMap->getVertexHeightMap() );
+		}
+	}
+
+	void GLScene::updatePointList( const GLfloat* pVertices )
+	{
+		DL_TRACE_SCOPE( "GLScene::updatePointList" );
+		if(!pVertices)
+		{
+			return;
+		}
+
+		const unsigned int gridSize = m_GridWidth * m_GridHeight;
+		if(!m_pPointBuffer)
+		{
+			m_PointIndices.assign( gridSize, 0 );
+			m_pPointBuffer = new ElementBufferObject( &m_PointIndices[0], (GLsizei) gridSize );
+		}
+
+		// Decimated meshes draw every "step"th grid point; without the background plane only pixels with a depth are drawn
+		const unsigned int step = m_Quality.m_MeshStep;
+		const bool allPoints = m_Background;
+		GLuint* pIndices = &m_PointIndices[0];
+		GLsizei count = 0;
+		for(unsigned int y = 0; y < m_GridHeight; y += step)
+		{
+			const GLuint rowIndex = y * m_GridWidth;
+			for(unsigned int x = 0; x < m_GridWidth; x += step)
 			{
-				// If the pixel is not zero, we will keep the original depth.
-				smoothDepthArray[depthIndex] = pDepthPixels[depthIndex];
+				const GLuint index = rowIndex + x;
+				if(allPoints || pVertices[index * 3 + 2] != 0.0f)
+				{
+					pIndices[count++] = index;
+				}
 			}
 		}
 
-#ifdef _WIN32		
-		); //PPL closing
-#endif
-
-		return smoothDepthArray;
+		m_PointCount = count;
+		m_pPointBuffer->updateSubBuffer( pIndices, 0, count );
 	}
 #pragma endregion
 
@@ -266,10 +741,43 @@ namespace DirectLook
 				std::cout << "Shader Program reloaded : OK" << std::endl;
 			}
 		}
+		if(m_pVideoShader)
+		{
+			m_pVideoShader->reload();
+		}
 	}
 
 	void GLScene::initBackgroundVideo(void){
 		//z = -50;
+
+		//the video shader converts the YUV planes of the decoder and draws the full-screen quad
+		if (!m_pVideoShader)
+		{
+			m_pVideoShader = new Shader( "..//data//shader//vertexVideo.glsl", "..//data//shader//fragmentVideoYUV.glsl" );
+			if (!m_pVideoShader->compile())
+			{
+				std::cout << "Video Shader failed, the background video is disabled" << std::endl;
+				delete m_pVideoShader;
+				m_pVideoShader = 0;
+			}
+		}
+		if (!m_pVideoShader)
+		{
+			//nothing would draw the frames, so the decoder thread and its cache aren't started
+			return;
+		}
+		if (!m_pVideoVertexBuffer)
+		{
+			//triangle strip covering the viewport
+			GLfloat vertices[8] =
+			{
+				-1.0f,  1.0f,
+				-1.0f, -1.0f,
+				 1.0f,  1.0f,
+				 1.0f, -1.0f
+			};
+			m_pVideoVertexBuffer = new VertexBufferObject( vertices, 4, 2 );
+		}
 		m_pAvVidDecoder.init(m_pVideoPath);
 
 		m_pRatioW = m_pRatioH = 1.0f;
@@ -284,14 +792,42 @@ namespace DirectLook
 		//scaleX = 50 * tan(22.5);
 		//scaleY = 50 * tan(22.5) * ratioH;
 
-		glGenTextures(1, &m_pVidTexture[0]);
-		glBindTexture(GL_TEXTURE_2D, m_pVidTexture[0]);
-	
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, m_pAvVidDecoder.getWidth(), m_pAvVidDecoder.getHeight(),
-																0, GL_RGB, GL_UNSIGNED_BYTE, NULL);	
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		//the textures of a previous video are replaced, the new ones are created with the first frame
+		deleteVideoTextures();
+	}
+
+	void GLScene::createVideoTextures( TextureObject** ppTextures, const AvVideoFrame& frame )
+	{
+		// The planes are tightly packed, so the rows mustn't be padded to 4 bytes
+		glPixelStorei( GL_UNPACK_ALIGNMENT, 1 );
+		for(int i = 0; i < 3; i++)
+		{
+			const ImageFrame& plane = frame.m_Planes[i];
+			ppTextures[i] = new TextureObject( plane.getWidth(), plane.getHeight(), 0,
+				GL_LUMINANCE,	// External texture color format
+				GL_LUMINANCE,	// Internal texture color format
+				0, GL_TEXTURE_2D, GL_UNSIGNED_BYTE
+			);
+			ppTextures[i]->generateTexture( plane.getData() );
+
+			// The chroma of the last column mustn't blend with the first one
+			glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE );
+			glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE );
+		}
+		glPixelStorei( GL_UNPACK_ALIGNMENT, 4 );
+	}
 
+	void GLScene::deleteVideoTextures(void)
+	{
+		for(int i = 0; i < 3; i++)
+		{
+			if(m_pVideoTextures[i]) { delete m_pVideoTextures[i]; m_pVideoTextures[i] = 0; }
+		}
+		for(size_t i = 0; i < m_VideoCacheTextures.size(); i++)
+		{
+			delete m_VideoCacheTextures[i];
+		}
+		m_VideoCacheTextures.clear();
 	}
 
 	void GLScene::initialize(void)
@@ -315,6 +851,12 @@ namespace DirectLook
 			// Create and initialize the camera- and depth texture object
 			initTextures();
 
+			// Scratch buffer of the smooth filter, reused every frame
+			m_SmoothFrame = DepthFrame::allocate( m_DepthWidth, m_DepthHeight );
+
+			// Only the texture and vertex data of the height map are uploaded, skip the extra depth copy
+			m_pHeightMap->setRetainPixels( false );
+
 			// Create and initialize the simple texture object
 			std::string vFilename = "..//data//shader//vertexTexture.glsl";
 			std::string fFilename = "..//data//shader//fragmentTexture.glsl";
@@ -322,7 +864,7 @@ namespace DirectLook
 
 			// Create and initialize the render target object
 
-			m_pRenderTarget = new RenderTarget( m_CameraWidth, m_CameraHeight );
+			m_pRenderTarget = new RenderTarget( m_OutputWidth, m_OutputHeight, m_OutputLevels );
 
 			// Create and initialize the shader object
 			if(!m_pShader->compile())
@@ -338,53 +880,161 @@ namespace DirectLook
 		}
 	}
 
-	void GLScene::drawBackgroundVideo(void){
-		
-		glDepthMask(false);		
-		glEnable(GL_TEXTURE_2D);
-
-		glLoadIdentity();									// Reset The Current Modelview Matrix	
-		glScalef	(1.0f,	 -1.0f,  1.0f);					//For flipping the texture
-		glBindTexture(GL_TEXTURE_2D, m_pVidTexture[0]);
-
-		m_pAvVidDecoder.run();
-
-		if(m_pAvVidDecoder.getLatestFrame()->data != 0)
-			glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, m_pAvVidDecoder.getWidth(), m_pAvVidDecoder.getHeight(), 
-									GL_RGB, GL_UNSIGNED_BYTE, m_pAvVidDecoder.getLatestFrame()->data[0]);	
-
-		glBegin(GL_QUADS);
-			// Front Face
-			glTexCoord2f(0.0f, 0.0f); glVertex3f(-1.0f, -1.0f,  -1.0f);
-			glTexCoord2f(1.0f, 0.0f); glVertex3f( 1.0f, -1.0f,  -1.0f);
-			glTexCoord2f(1.0f, 1.0f); glVertex3f( 1.0f,  1.0f,  -1.0f);
-			glTexCoord2f(0.0f, 1.0f); glVertex3f(-1.0f,  1.0f,  -1.0f);		
-		glEnd();
-		
-		glDisable(GL_TEXTURE_2D);		
-		glDepthMask(true);		
+	bool GLScene::drawBackgroundVideo( const std::vector<RenderTarget*>& targets ){
+		if(!m_pVideoShader || targets.empty())
+		{
+			return false;
+		}
+
+		// The decoder thread keeps frames ready, only a new due frame is uploaded
+		const bool changed = m_pAvVidDecoder.update( Clock::microseconds() );
+		const AvVideoFrame& videoFrame = m_pAvVidDecoder.getCurrentFrame();
+		TextureObject** ppTextures = m_pVideoTextures;
+
+		// A cached loop keeps one set of textures per frame, every frame is uploaded only once
+		const int cacheIndex = m_pAvVidDecoder.getCacheIndex();
+		if(cacheIndex >= 0)
+		{
+			if(m_VideoCacheTextures.empty())
+			{
+				m_VideoCacheTextures.assign( m_pAvVidDecoder.getCachedFrameCount() * 3, (TextureObject*) 0 );
+			}
+			ppTextures = &m_VideoCacheTextures[cacheIndex * 3];
+			if(!ppTextures[0])
+			{
+				createVideoTextures( ppTextures, videoFrame );
+				m_pAvVidDecoder.releaseCachedFrame( cacheIndex );
+			}
+		}
+		else if(!ppTextures[0])
+		{
+			if(!videoFrame.m_Planes[0].isValid())
+			{
+				return false;
+			}
+			createVideoTextures( ppTextures, videoFrame );
+		}
+		else if(changed)
+		{
+			// Streams the new frame into the existing textures
+			for(int i = 0; i < 3; i++)
+			{
+				const ImageFrame& plane = videoFrame.m_Planes[i];
+				ppTextures[i]->updateSubTexture( plane.getData(), 0, 0, plane.getWidth(), plane.getHeight() );
+			}
+		}
+
+		// YUV420P (1.5 bytes per pixel) is converted to RGB per fragment
+		m_pVideoShader->enable();
+		m_pVideoShader->setTexture( ppTextures[0], GL_TEXTURE0, 0, "textureY" );
+		m_pVideoShader->setTexture( ppTextures[1], GL_TEXTURE1, 1, "textureU" );
+		m_pVideoShader->setTexture( ppTextures[2], GL_TEXTURE2, 2, "textureV" );
+		m_pVideoShader->setFloatValue( m_pAvVidDecoder.isFullRange() ? 1.0f : 0.0f, "fullRange" );
+		m_pVideoShader->setVertexAttribute( m_pVideoVertexBuffer, "position" );
+
+		// A single draw without element buffer per target, the scene pass draws on top without clearing
+		for(size_t i = 0; i < targets.size(); i++)
+		{
+			targets[i]->enable();
+			glDepthMask( false );
+			glDrawArrays( GL_TRIANGLE_STRIP, 0, 4 );
+			glDepthMask( true );
+			targets[i]->disable( false );
+		}
+
+		m_pVideoShader->resetVertexAttribute( "position" );
+		m_pVideoShader->disable();
+		glActiveTexture( GL_TEXTURE0 );
+		return true;
 	}
 
 	void GLScene::draw(void)
+	{
+		DL_TRACE_SCOPE( "GLScene::draw" );
+		const unsigned long long startTime = Clock::microseconds();
+
+		// Render the scene into the frame buffer texture
+		drawOffscreen();
+
+		// Read raw pixels from frame buffer texture
+		const GLubyte* pPixels = m_pRenderTarget->getPixels();
+
+		m_PresentTimer.begin();
+		m_SimpleTexture.update( pPixels );
+		m_SimpleTexture.draw();
+		m_PresentTimer.end();
+
+		// The pixels belong to the render target, the encoder thread gets a copy
+		if(m_VideoRecorder.isOpen())
+		{
+			ImageFrame frame = ImageFrame::allocate( m_OutputWidth, m_OutputHeight, 3 );
+			memcpy( frame.getMutableData(), pPixels, frame.getSize() );
+			frame.setTimestamp( Clock::microseconds() );
+			m_VideoRecorder.push( frame );
+		}
+		m_OutputRing.publish( pPixels, Clock::microseconds() );
+
+		m_DrawTime.add( Clock::elapsedMilliseconds( startTime ) );
+	}
+
+	void GLScene::drawOffscreen(void)
 	{
 		// Clear color and depth buffer
 		glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
-		
-		// Enable render to texture
-		m_pRenderTarget->enable();
-				
+
+		// Background pass: the video textures are bound once for every target that shows the video
+		std::vector<RenderTarget*> videoTargets;
+		bool hasVideo = false;
 		if (m_pIsVideoPathSet)
-			drawBackgroundVideo();
+		{
+			videoTargets.push_back( m_pRenderTarget );
+			for(size_t i = 0; i < m_Views.size(); i++)
+			{
+				if(m_Views[i].m_Background)
+				{
+					videoTargets.push_back( m_Views[i].m_pRenderTarget );
+				}
+			}
 
-		// Draw GLScene
-		drawScene();
-		
-		// Disable render to texture
-		m_pRenderTarget->disable();
+			m_BackgroundTimer.begin();
+			hasVideo = drawBackgroundVideo( videoTargets );
+			m_BackgroundTimer.end();
+		}
 
-		// Read raw pixels from frame buffer texture
-		m_SimpleTexture.update( m_pRenderTarget->getPixels() );
-		m_SimpleTexture.draw();
+		// Scene pass: mesh, textures and uniforms are bound once, each view only adds its matrix and the draw call
+		m_SceneTimer.begin();
+		beginScene();
+		m_pRenderTarget->enable( !hasVideo );
+		drawSceneMesh( m_pCamera, m_pRenderTarget->getHeight() );
+		m_pRenderTarget->disable( false );
+		for(size_t i = 0; i < m_Views.size(); i++)
+		{
+			m_Views[i].m_pRenderTarget->enable( !(hasVideo && m_Views[i].m_Background) );
+			drawSceneMesh( m_Views[i].m_pCamera, m_Views[i].m_pRenderTarget->getHeight() );
+			m_Views[i].m_pRenderTarget->disable( false );
+		}
+		endScene();
+		m_SceneTimer.end();
+
+		// Binding the targets for the mip chain would disturb the texture units of the scene pass
+		m_pRenderTarget->buildLevels();
+		for(size_t i = 0; i < m_Views.size(); i++)
+		{
+			m_Views[i].m_pRenderTarget->buildLevels();
+		}
+	}
+
+	void GLScene::renderCpu( CpuRenderer& renderer, const ImageFrame& imageFrame, const VertexFrame& vertexHeightMap, const GLCamera* pCamera ) const
+	{
+		// Same inputs as the uniforms of beginScene() and drawSceneMesh()
+		CpuRenderParameters parameters;
+		parameters.m_World = m_MatWorld;
+		parameters.m_ViewProjection = (pCamera ? pCamera : m_pCamera)->m_MatViewProjection;
+		parameters.m_NearThreshold = (float) m_pHeightMap->getNearThreshold();
+		parameters.m_FarThreshold = (float) m_pHeightMap->getFarThreshold();
+		parameters.m_GridSpacing = m_pHeightMap->getGridSpacing();
+		parameters.m_Background = m_Background;
+		renderer.render( imageFrame, vertexHeightMap, parameters );
 	}
 
 	void GLScene::deleteResources(void)
@@ -397,6 +1047,11 @@ namespace DirectLook
 		if(m_pBackgroundTexture) { delete m_pBackgroundTexture; m_pBackgroundTexture = 0; }
 		if(m_pHeightMap)	{ delete m_pHeightMap;		m_pHeightMap	 = 0; }
 		if(m_pRenderTarget)	{ delete m_pRenderTarget;	m_pRenderTarget	 = 0; }
+		if(m_pPointBuffer)	{ delete m_pPointBuffer;	m_pPointBuffer	 = 0; }
+		removeViews();
+		if(m_pVideoShader)	{ delete m_pVideoShader;	m_pVideoShader	 = 0; }
+		if(m_pVideoVertexBuffer) { delete m_pVideoVertexBuffer; m_pVideoVertexBuffer = 0; }
+		deleteVideoTextures();
 		
 	}
 
@@ -420,6 +1075,52 @@ namespace DirectLook
 		return m_DepthHeight;
 	}
 
+	bool GLScene::setOutputSize( const unsigned int width, const unsigned int height, const unsigned int levels )
+	{
+		if(width == 0 || height == 0)
+		{
+			return false;
+		}
+
+		// Recorder and ring were created for the old frame size
+		stopRecording();
+		stopSharing();
+
+		m_OutputWidth = width;
+		m_OutputHeight = height;
+		m_OutputLevels = levels;
+		if(m_pRenderTarget)
+		{
+			delete m_pRenderTarget;
+			m_pRenderTarget = new RenderTarget( m_OutputWidth, m_OutputHeight, m_OutputLevels );
+		}
+		m_SimpleTexture.resize( (unsigned short) m_OutputWidth, (unsigned short) m_OutputHeight );
+
+		// Same visible height, a wider output shows more of the scene instead of stretching it
+		if(m_pCamera)
+		{
+			m_pCamera->setAspectRatio( (GLfloat) m_OutputWidth / (GLfloat) m_OutputHeight );
+		}
+		return true;
+	}
+
+	unsigned int GLScene::getOutputWidth( const unsigned int level ) const
+	{
+		const unsigned int width = m_OutputWidth >> level;
+		return width > 0 ? width : 1;
+	}
+
+	unsigned int GLScene::getOutputHeight( const unsigned int level ) const
+	{
+		const unsigned int height = m_OutputHeight >> level;
+		return height > 0 ? height : 1;
+	}
+
+	unsigned int GLScene::getOutputLevels(void) const
+	{
+		return m_pRenderTarget ? m_pRenderTarget->getLevelCount() : m_OutputLevels;
+	}
+
 	unsigned short GLScene::getNearThreshold(void) const
 	{
 		return m_pHeightMap->getNearThreshold();
@@ -435,14 +1136,107 @@ namespace DirectLook
 		return m_pRenderTarget->getPixels();
 	}
 
-	bool GLScene::getRGBPixels(GLubyte* pBuffer, const unsigned int size) const
+	bool GLScene::getRGBPixels(GLubyte* pBuffer, const unsigned int size, const unsigned int level) const
+	{
+		return m_pRenderTarget->getPixels(pBuffer, size, GL_RGB, level);
+	}
+
+	bool GLScene::getBGRPixels(GLubyte* pBuffer, const unsigned int size, const unsigned int level) const
+	{
+		return m_pRenderTarget->getPixels(pBuffer, size, GL_BGR, level);
+	}
+
+	unsigned int GLScene::addView( GLCamera* pCamera, const unsigned int width, const unsigned int height, const bool background )
+	{
+		SceneView view;
+		view.m_pCamera = pCamera;
+		view.m_pRenderTarget = new RenderTarget( width, height );
+		view.m_Background = background;
+		pCamera->setAspectRatio( (GLfloat) width / (GLfloat) height );
+
+		m_Views.push_back( view );
+		return (unsigned int) m_Views.size() - 1;
+	}
+
+	void GLScene::removeViews(void)
+	{
+		for(size_t i = 0; i < m_Views.size(); i++)
+		{
+			delete m_Views[i].m_pRenderTarget;
+		}
+		m_Views.clear();
+	}
+
+	bool GLScene::getViewPixels( const unsigned int view, GLubyte* pBuffer, const unsigned int size, const GLint format ) const
+	{
+		if(view >= m_Views.size())
+		{
+			return false;
+		}
+		return m_Views[view].m_pRenderTarget->getPixels( pBuffer, size, format );
+	}
+
+	std::vector<GpuPassStatistics> GLScene::getGpuStatistics(void)
 	{
-		return m_pRenderTarget->getPixels(pBuffer, size, GL_RGB);
+		std::vector<GpuTimer*> timers;
+		if(m_pIsVideoPathSet)
+		{
+			timers.push_back( &m_BackgroundTimer );
+		}
+		timers.push_back( &m_SceneTimer );
+		if(m_pRenderTarget)
+		{
+			timers.push_back( &m_pRenderTarget->getReadbackTimer() );
+		}
+		timers.push_back( &m_PresentTimer );
+
+		std::vector<GpuPassStatistics> statistics;
+		if(GpuTimer::isSupported())
+		{
+			for(size_t i = 0; i < timers.size(); i++)
+			{
+				timers[i]->collect();
+				statistics.push_back( timers[i]->getStatistics() );
+			}
+		}
+		return statistics;
 	}
 
-	bool GLScene::getBGRPixels(GLubyte* pBuffer, const unsigned int size) const
+	SceneStatistics GLScene::getSceneStatistics(void) const
 	{
-		return m_pRenderTarget->getPixels(pBuffer, size, GL_BGR);
+		SceneStatistics statistics;
+		statistics.m_FilterMilliseconds = m_FilterTime.getMean();
+		statistics.m_MeshMilliseconds = m_MeshTime.getMean();
+		statistics.m_UploadMilliseconds = m_UploadTime.getMean();
+		statistics.m_DrawMilliseconds = m_DrawTime.getMean();
+		statistics.m_UploadBytes = m_UploadBytes;
+		statistics.m_Triangles = m_pElementBuffer ? m_pElementBuffer->getSize() / 3 : 0;
+		statistics.m_Points = 0;
+		statistics.m_EdgePixels = m_GuidedUpsampling ? m_EdgePixels : 0;
+		statistics.m_RegionCoverage = 1.0;
+		statistics.m_Components = m_pHeightMap->getComponentCount();
+		statistics.m_ForegroundPixels = m_pHeightMap->getForegroundPixels();
+		statistics.m_MaskMicroseconds = (double) m_pHeightMap->getMaskMicroseconds();
+		statistics.m_VideoQueued = m_pIsVideoPathSet ? m_pAvVidDecoder.getQueueDepth() : 0;
+		statistics.m_VideoSkipped = m_pIsVideoPathSet ? m_pAvVidDecoder.getSkippedFrames() : 0;
+		statistics.m_VideoCachedFrames = m_pIsVideoPathSet ? m_pAvVidDecoder.getCachedFrameCount() : 0;
+		statistics.m_VideoCacheBytes = m_pIsVideoPathSet ? m_pAvVidDecoder.getCacheBytes() : 0;
+		if(m_HeadTracking && !m_RegionCounts.empty())
+		{
+			unsigned int indices = 0;
+			for(size_t i = 0; i < m_RegionCounts.size(); i++)
+			{
+				indices += (unsigned int) m_RegionCounts[i];
+			}
+			statistics.m_Triangles = indices / 3;
+			statistics.m_RegionCoverage = (double) ((m_HeadRegion.m_X1 - m_HeadRegion.m_X0) * (m_HeadRegion.m_Y1 - m_HeadRegion.m_Y0)) / (double) (m_GridWidth * m_GridHeight);
+		}
+		if(m_MeshMode == MESH_POINTS)
+		{
+			statistics.m_Triangles = 0;
+			statistics.m_Points = (unsigned int) m_PointCount;
+		}
+		return statistics;
 	}
 
 	void GLScene::switchBackround(void)
@@ -465,6 +1259,37 @@ namespace DirectLook
 		}
 	}
 
+	void GLScene::setVideoCacheBudget( const unsigned int megabytes )
+	{
+		m_pAvVidDecoder.setCacheBudget( (unsigned long long) megabytes << 20 );
+	}
+
+	unsigned int GLScene::getVideoCacheBudget(void) const
+	{
+		return (unsigned int) (m_pAvVidDecoder.getCacheBudget() >> 20);
+	}
+
+	bool GLScene::startRecording( const std::string& fileName, const VideoCodec codec )
+	{
+		// Frames are stamped with the wall clock, so the video keeps real time at any render rate
+		return m_VideoRecorder.open( fileName, m_OutputWidth, m_OutputHeight, 30, codec, true );
+	}
+
+	void GLScene::stopRecording(void)
+	{
+		m_VideoRecorder.close();
+	}
+
+	bool GLScene::startSharing( const std::string& name )
+	{
+		return m_OutputRing.create( name, m_OutputWidth, m_OutputHeight, false, true );
+	}
+
+	void GLScene::stopSharing(void)
+	{
+		m_OutputRing.destroy();
+	}
+
 	void GLScene::setNearThreshold( const unsigned short nearThreshold )
 	{
 		float deltaOld = (float) m_pHeightMap->getFarThreshold() - (float) m_pHeightMap->getNearThreshold();
@@ -502,23 +1327,28 @@ namespace DirectLook
 
 	void GLScene::initElementBuffer(void)
 	{
-		// (Width - 1) * (Height - 1) cells, 2 triangles per cell, 3 indices per triangle
-		unsigned int nIndices = (m_DepthWidth - 1) * (m_DepthHeight - 1) * 6;
+		// Cells span "step" grid points, so decimated meshes keep using the full vertex buffer
+		const unsigned int step = m_Quality.m_MeshStep;
+		const unsigned int cellsX = (m_GridWidth - 1) / step;
+		const unsigned int cellsY = (m_GridHeight - 1) / step;
+
+		// cellsX * cellsY cells, 2 triangles per cell, 3 indices per triangle
+		unsigned int nIndices = cellsX * cellsY * 6;
 
 		// Neuen Element Buffer erzeugen
 		GLuint* pBuffer = new GLuint[nIndices];
 		unsigned int index = 0;
 
 		// For each cell
-		for(unsigned int x = 0; x < m_DepthWidth - 1; x++)
+		for(unsigned int x = 0; x < cellsX * step; x += step)
 		{
-			for(unsigned int y = 0; y < m_DepthHeight - 1; y++)
+			for(unsigned int y = 0; y < cellsY * step; y += step)
 			{
 				// Find the indices of the corners
-				GLuint upperLeft  = y * m_DepthWidth + x;
-				GLuint upperRight = upperLeft + 1;
-				GLuint lowerLeft  = upperLeft + m_DepthWidth;
-				GLuint lowerRight = lowerLeft + 1;
+				GLuint upperLeft  = y * m_GridWidth + x;
+				GLuint upperRight = upperLeft + step;
+				GLuint lowerLeft  = upperLeft + step * m_GridWidth;
+				GLuint lowerRight = lowerLeft + step;
 				
 				// Specify upper triangle
 				pBuffer[index++] = upperLeft;
@@ -547,7 +1377,7 @@ namespace DirectLook
 			if(m_pHeightMap->getVertexHeightMap())
 			{
 				// Neues Vertex-Buffer-Object erzeugen
-				m_pVertexBuffer = new VertexBufferObject( m_pHeightMap->getVertexHeightMap(), m_DepthWidth * m_DepthHeight, 3 );
+				m_pVertexBuffer = new VertexBufferObject( m_pHeightMap->getVertexHeightMap(), m_GridWidth * m_GridHeight, 3 );
 			}
 		}
 	}
@@ -578,14 +1408,19 @@ namespace DirectLook
 		m_pBackgroundTexture->generateTexture( pCameraData );
 		delete[] pCameraData;
 	
+		initDepthTexture();
+	}
+
+	void GLScene::initDepthTexture(void)
+	{
 		// Create and initialize the depth texture object
-		const unsigned int depthBufferSize = m_DepthWidth * m_DepthHeight;
+		const unsigned int depthBufferSize = m_GridWidth * m_GridHeight;
 		GLubyte* pDepthData = new GLubyte[depthBufferSize];
 		for(unsigned int i = 0; i < depthBufferSize; i++)
 		{
 			pDepthData[i] = 0;	// Black
 		}
-		m_pDepthTexture = new TextureObject( m_DepthWidth, m_DepthHeight, 0,
+		m_pDepthTexture = new TextureObject( m_GridWidth, m_GridHeight, 0,
 			GL_RED,	// External texture color format
 			1,		// Internal texture color format : 1 for RED color channel only
 			0, GL_TEXTURE_2D, GL_UNSIGNED_BYTE
@@ -594,14 +1429,11 @@ namespace DirectLook
 		delete[] pDepthData;
 	}
 
-	void GLScene::drawScene(void)
+	void GLScene::beginScene(void)
 	{
 		// Activating the shader program and assigning uniforms
 		m_pShader->enable();
 
-		// Activating the camera view projection matrix uniform variable
-		m_pShader->setMatrix( &m_pCamera->m_MatViewProjection, "matVP" );
-
 		// Activating the GLScene world matrix uniform variable
 		m_pShader->setMatrix( &m_MatWorld, "matW" );
 
@@ -647,16 +1479,67 @@ namespace DirectLook
 		// Enable and setting up the vertex buffer object
 		m_pShader->setVertexAttribute( m_pVertexBuffer, "position" );
 		
+		// The element buffer stays bound for every view
+		if(m_MeshMode == MESH_POINTS && m_pPointBuffer)
+		{
+			glEnable( GL_VERTEX_PROGRAM_POINT_SIZE );
+			glBindBuffer( m_pPointBuffer->getTarget(), m_pPointBuffer->getID() );
+		}
+		else
+		{
+			m_pShader->setFloatValue( 0.0f, "pointSize" );
+			glBindBuffer( m_pElementBuffer->getTarget(), m_pElementBuffer->getID() );
+		}
+	}
+
+	void GLScene::drawSceneMesh( const GLCamera* pCamera, const unsigned int targetHeight )
+	{
+		// Activating the camera view projection matrix uniform variable
+		m_pShader->setMatrix( &pCamera->m_MatViewProjection, "matVP" );
+
+		if(m_MeshMode == MESH_POINTS && m_pPointBuffer)
+		{
+			// One splat covers "step" grid cells of the view; the overlap closes the gaps of a rotated grid
+			const GLfloat pixelsPerUnit = (GLfloat) targetHeight / pCamera->m_ViewHeight;
+			const GLfloat gridSpacing = (GLfloat) (m_Quality.m_DepthStep * m_Quality.m_MeshStep);
+			m_pShader->setFloatValue( gridSpacing * pixelsPerUnit * SPLAT_OVERLAP, "pointSize" );
+
+			glDrawElements(
+				GL_POINTS,						// mode
+				m_PointCount,					// count
+				GL_UNSIGNED_INT,				// type
+				(void*) 0						// element array buffer offset
+			);
+			return;
+		}
+
 		// Submitting the rendering job with an element buffer object
-		glBindBuffer( m_pElementBuffer->getTarget(), m_pElementBuffer->getID() );
-		glDrawElements(
-			GL_TRIANGLES,					// mode 
-			m_pElementBuffer->getSize(),	// count
-			GL_UNSIGNED_INT,				// type
-			(void*) 0						// element array buffer offset
-		);
+		if(m_HeadTracking && !m_RegionCounts.empty())
+		{
+			// Only the cell columns covering the head region
+			glMultiDrawElements(
+				GL_TRIANGLES,						// mode
+				&m_RegionCounts[0],					// count per column
+				GL_UNSIGNED_INT,					// type
+				&m_RegionOffsets[0],				// element array buffer offset per column
+				(GLsizei) m_RegionCounts.size()		// number of columns
+			);
+		}
+		else
+		{
+			glDrawElements(
+				GL_TRIANGLES,					// mode 
+				m_pElementBuffer->getSize(),	// count
+				GL_UNSIGNED_INT,				// type
+				(void*) 0						// element array buffer offset
+			);
+		}
+	}
 
+	void GLScene::endScene(void)
+	{
 		// Cleaning up after ourselves
+		glDisable( GL_VERTEX_PROGRAM_POINT_SIZE );
 		m_pShader->resetVertexAttribute( "position" );
 
 		// Disable shader program
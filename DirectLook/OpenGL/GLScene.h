@@ -1,10 +1,5 @@
 #pragma once
 
-#ifdef _WIN32
-//#include <Windows.h>
-#include <ppl.h>
-#endif
-
 #include <iostream>
 #include <string>
 #include <deque>
@@ -12,12 +7,74 @@
 #include "GLMesh.h"
 #include "TextureObject.h"
 #include "../Image/GLSegmentedDepthImage.h"
+#include "../Image/FrameHandle.h"
+#include "../Image/DepthUpsampler.h"
+#include "../Image/HeadTracker.h"
+#include "../Core/TaskPool.h"
 #include "RenderTarget.h"
+#include "GpuTimer.h"
+#include "../Core/Metrics.h"
+#include "../Core/OutputRing.h"
 #include "SimpleTexture.h"
 #include "AvVideoDecoder.h"
+#include "AvVideoEncoder.h"
+#include "../Image/CpuRenderer.h"
 
 namespace DirectLook
 {
+	/// \brief Art der Lochfuellung in GLScene::SmoothFilter()
+	enum HoleFillMode
+	{
+		HOLE_FILL_WIDE,		///< Haeufigster Tiefenwert der 5x5 Nachbarschaft
+		HOLE_FILL_NARROW,	///< Haeufigster Tiefenwert der 3x3 Nachbarschaft
+		HOLE_FILL_OFF		///< Loecher bleiben erhalten, die Tiefenwerte werden nur kopiert
+	};
+
+	/// \brief Darstellung des 3D-Kopfes, siehe GLScene::setMeshMode()
+	enum MeshMode
+	{
+		MESH_TRIANGLES,		///< Indiziertes Dreiecksnetz ueber das ganze Gitter
+		MESH_POINTS			///< Gueltige Tiefenpixel als Punkte, die den Gitterabstand auf dem Bildschirm abdecken
+	};
+
+	/// \brief Qualitaetsstufe der Tiefenverarbeitung und Darstellung, siehe GLScene::setQuality().
+	struct SceneQuality
+	{
+		unsigned int m_DepthStep;			///< Abstand der verarbeiteten Tiefenpixel (1 = volle Aufloesung, 2 oder 4)
+		HoleFillMode m_HoleFill;			///< Lochfuellung von SmoothFilter
+		unsigned int m_MeshStep;			///< Abstand der triangulierten Gitterpunkte (1 = alle)
+		const char* m_pName;				///< Kurzer Name fuer Ausgaben
+	};
+
+	/// \brief Momentaufnahme der CPU-Zeiten und Datenmengen eines GLScene-Objektes, siehe GLScene::getSceneStatistics().
+	struct SceneStatistics
+	{
+		double m_FilterMilliseconds;		///< Mittlere Zeit von SmoothFilter
+		double m_MeshMilliseconds;			///< Mittlere Zeit der Segmentierung und des Mesh-Aufbaus
+		double m_UploadMilliseconds;		///< Mittlere Zeit des Texture- und Vertex-Uploads
+		double m_DrawMilliseconds;			///< Mittlere CPU-Zeit von draw()
+		double m_UploadBytes;				///< Hochgeladene Byte pro Bild
+		unsigned int m_Triangles;			///< Anzahl der Dreiecke des Meshes (0 bei MESH_POINTS)
+		unsigned int m_Points;				///< Anzahl der gezeichneten Punkte (0 bei MESH_TRIANGLES)
+		unsigned int m_EdgePixels;			///< Pixel des letzten Bildes, die der Joint-Bilateral-Filter berechnet hat
+		double m_RegionCoverage;			///< Anteil des Tiefengitters, den das letzte Bild verarbeitet hat (1 = alles)
+		unsigned int m_Components;			///< Zusammenhaengende Komponenten des letzten Bildes (0 = FOREGROUND_ALL)
+		unsigned int m_ForegroundPixels;	///< Verbliebene Vordergrundpixel des letzten Bildes (0 = ohne Maske)
+		double m_MaskMicroseconds;			///< Dauer der letzten Maskenberechnung in Mikrosekunden (0 = ohne Maske)
+		unsigned int m_VideoQueued;			///< Dekodierte Bilder des Hintergrundvideos, die auf die Anzeige warten
+		unsigned long long m_VideoSkipped;	///< Bilder des Hintergrundvideos, die zu spaet kamen und uebersprungen wurden
+		unsigned int m_VideoCachedFrames;	///< Bilder der zwischengespeicherten Videoschleife (0 = Video wird dekodiert)
+		unsigned long long m_VideoCacheBytes;	///< Groesse der zwischengespeicherten Videoschleife in Byte
+	};
+
+	/// \brief Zusaetzliche Ansicht der Szene mit eigener virtueller Kamera, siehe GLScene::addView().
+	struct SceneView
+	{
+		GLCamera* m_pCamera;				///< Virtuelle Kamera der Ansicht (gehoert dem Aufrufer)
+		RenderTarget* m_pRenderTarget;		///< Ziel der Ansicht (gehoert der Szene)
+		bool m_Background;					///< Hintergrundvideo auch in diese Ansicht zeichnen?
+	};
+
 	/// \brief Die Klasse GLScene repraesentiert einen 3D-Kopf der mithilfe der Tiefenwerte des Sensors erzeugt wird.
 	class GLScene : public GLMesh 
 	{
@@ -27,24 +84,66 @@ namespace DirectLook
 		TextureObject* m_pDepthTexture;			///< Depth-Map Textur
 		TextureObject* m_pBackgroundTexture;	///< Hintergrund Textur
 		GLSegmentedDepthImage* m_pHeightMap;				///< Ist fuer die 3D-Rekonstruktion der Depth-Map Daten zustaendig
+		DepthFrame m_SmoothFrame;				///< Geglaettete Tiefenkarte (wird einmalig angelegt und jedes Bild wiederverwendet)
 		
 		unsigned int m_CameraWidth;				///< Breite der Kameratextur
 		unsigned int m_CameraHeight;			///< Hoehe der Kameratextur
 		unsigned int m_DepthWidth;				///< Breite der Depth-Map Textur
 		unsigned int m_DepthHeight;				///< Hoehe der Depth-Map Textur
+		unsigned int m_OutputWidth;				///< Breite des Render-Targets (Voreinstellung: Kamerabreite)
+		unsigned int m_OutputHeight;			///< Hoehe des Render-Targets (Voreinstellung: Kamerahoehe)
+		unsigned int m_OutputLevels;			///< Stufen der Verkleinerungskette des Render-Targets
 		
 		RenderTarget* m_pRenderTarget;			///< Dient zum rendern der 3D-Szene in eine 2D-Textur
 		SimpleTexture m_SimpleTexture;			///< Dient zum Anzeigen der gerenderten Szene
 		bool m_TextureMode;						///< Kamera- oder Depth-Map Textur auf dem 3D-Model anzeigen?
 		bool m_Background;						///< Hintergrundebene ein- oder ausblenden
+
+		GpuTimer m_BackgroundTimer;				///< GPU-Zeit des Hintergrundvideos
+		GpuTimer m_SceneTimer;					///< GPU-Zeit der 3D-Szene
+		GpuTimer m_PresentTimer;				///< GPU-Zeit der Anzeige ueber SimpleTexture
+
+		RollingStatistic m_FilterTime;			///< CPU-Zeiten von SmoothFilter in ms
+		RollingStatistic m_MeshTime;			///< CPU-Zeiten des Mesh-Aufbaus in ms
+		RollingStatistic m_UploadTime;			///< CPU-Zeiten des Uploads in ms
+		RollingStatistic m_DrawTime;			///< CPU-Zeiten von draw() in ms
+		double m_UploadBytes;					///< Hochgeladene Byte des letzten Bildes
+
+		SceneQuality m_Quality;					///< Aktuelle Qualitaetsstufe
+		unsigned int m_GridWidth;				///< Breite des verarbeiteten Tiefengitters (m_DepthWidth / m_DepthStep)
+		unsigned int m_GridHeight;				///< Hoehe des verarbeiteten Tiefengitters
+		bool m_GuidedUpsampling;				///< SmoothFilter auf halbem Gitter, danach RGB-gefuehrt vergroessern?
+		DepthUpsampler m_Upsampler;				///< Vergroessert die gefilterte Tiefenkarte auf das Gitter
+		unsigned int m_EdgePixels;				///< Kantenpixel des letzten Bildes, siehe DepthUpsampler::upsample()
+
+		bool m_HeadTracking;					///< Verarbeitung auf den Ausschnitt um den Kopf beschraenken?
+		HeadTracker m_HeadTracker;				///< Findet den Kopf in den Tiefenwerten des Sensors
+		TileRange m_HeadRegion;					///< Ausschnitt des letzten Bildes im 3D-Grid (Zeilen fuer OpenGL umgedreht)
+		std::vector<GLsizei> m_RegionCounts;	///< Indexanzahl je Zellenspalte des Ausschnitts fuer glMultiDrawElements
+		std::vector<const GLvoid*> m_RegionOffsets;	///< Byte-Offset je Zellenspalte im Element-Buffer
+
+		MeshMode m_MeshMode;					///< Dreiecksnetz oder Punkte
+		ElementBufferObject* m_pPointBuffer;	///< Kompakte Indexliste der gezeichneten Punkte, 0 bis zum ersten Bild mit MESH_POINTS
+		std::vector<GLuint> m_PointIndices;		///< CPU-Kopie dieser Liste (Platz fuer das ganze Gitter)
+		GLsizei m_PointCount;					///< Gueltige Eintraege der Liste
 		
 		AvVideoDecoder m_pAvVidDecoder;
 		string m_pVideoPath;
 		bool m_pIsVideoPathSet;
 		float m_pRatioW, m_pRatioH, m_pScaleX, m_pScaleY;
-		GLuint m_pVidTexture[1];
+		TextureObject* m_pVideoTextures[3];		//Y, U and V plane of the current video frame, 0 before the first frame
+		Shader* m_pVideoShader;					//converts the YUV planes to RGB, 0 if it couldn't be compiled
+		VertexBufferObject* m_pVideoVertexBuffer;	//full-screen quad of the background video
+		std::vector<TextureObject*> m_VideoCacheTextures;	//3 planes of every frame of a cached loop, 0 = not uploaded yet
+
+		AvVideoEncoder m_VideoRecorder;			///< Schreibt die angezeigten Bilder waehrend einer Aufnahme in eine Videodatei
+		OutputRing m_OutputRing;				///< Stellt die angezeigten Bilder anderen Prozessen im Shared Memory bereit
+		std::vector<SceneView> m_Views;			///< Zusaetzliche Ansichten, die drawOffscreen() mit demselben Mesh zeichnet
 
 	public:
+		static const unsigned int QUALITY_LEVELS = 5;	///< Anzahl der vordefinierten Qualitaetsstufen, siehe getQualityLevel()
+		static const unsigned int DEFAULT_VIDEO_CACHE_MB = 128;	///< Voreinstellung fuer setVideoCacheBudget()
+
 		////////////////////////////////////////////////////////////
 		/// \brief Konstruktor
 		///
@@ -89,6 +188,177 @@ namespace DirectLook
 		////////////////////////////////////////////////////////////
 		void updateData( const void* pImagePixels, const unsigned short* pDepthPixels );
 
+		////////////////////////////////////////////////////////////
+		/// \brief Aktualisiert die Height-Map, die Kamera- und die Depth-Map Textur.
+		///
+		/// Die Bilddaten werden ohne Kopie bis zum Upload in den Videospeicher gelesen.
+		///
+		/// \param imageFrame RGB-Werte des Sensors
+		/// \param depthFrame Tiefenwerte des Sensors
+		///
+		////////////////////////////////////////////////////////////
+		void updateData( const ImageFrame& imageFrame, const DepthFrame& depthFrame );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Glaettet eine Tiefenkarte und fuellt Loecher (erster Schritt von updateData()).
+		///
+		/// Benutzt keinen Zustand der Szene und darf auf jedem Thread laufen.
+		///
+		/// \param depthFrame  Tiefenwerte des Sensors
+		/// \param smoothFrame Ziel, wird bei Bedarf aus dem FramePool angelegt
+		///
+		////////////////////////////////////////////////////////////
+		void filterDepth( const DepthFrame& depthFrame, DepthFrame& smoothFrame );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Glaettet eine Tiefenkarte, das Kamerabild fuehrt dabei die Vergroesserung (siehe setGuidedUpsampling()).
+		///
+		/// \param depthFrame  Tiefenwerte des Sensors
+		/// \param imageFrame  RGB-Werte des Sensors (leer = Vergroesserung ohne Fuehrung)
+		/// \param smoothFrame Ziel, wird bei Bedarf aus dem FramePool angelegt
+		///
+		////////////////////////////////////////////////////////////
+		void filterDepth( const DepthFrame& depthFrame, const ImageFrame& imageFrame, DepthFrame& smoothFrame );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Segmentiert eine geglaettete Tiefenkarte zu Height-Map Textur und Vertices (zweiter Schritt).
+		///
+		/// Benoetigt keinen OpenGL-Kontext, darf aber nur von einem Thread gleichzeitig aufgerufen werden.
+		///
+		/// \param smoothFrame      Geglaettete Tiefenwerte
+		/// \param textureHeightMap Ziel fuer die Grauwert-Textur, wird bei Bedarf angelegt
+		/// \param vertexHeightMap  Ziel fuer die Vertices, wird bei Bedarf angelegt
+		///
+		////////////////////////////////////////////////////////////
+		void buildMesh( const DepthFrame& smoothFrame, ImageFrame& textureHeightMap, VertexFrame& vertexHeightMap );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Laedt Kamerabild, Height-Map Textur und Vertices in den Videospeicher (dritter Schritt).
+		///
+		/// Muss auf dem Thread mit dem OpenGL-Kontext aufgerufen werden.
+		///
+		/// \param imageFrame       RGB-Werte des Sensors
+		/// \param textureHeightMap Grauwert-Textur aus buildMesh()
+		/// \param vertexHeightMap  Vertices aus buildMesh()
+		///
+		////////////////////////////////////////////////////////////
+		void uploadMesh( const ImageFrame& imageFrame, const ImageFrame& textureHeightMap, const VertexFrame& vertexHeightMap );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert eine der vordefinierten Qualitaetsstufen zurueck.
+		///
+		/// Stufe 0 ist die volle Qualitaet, jede weitere Stufe ist guenstiger als die vorherige.
+		///
+		/// \param level Stufe zwischen 0 und QUALITY_LEVELS - 1 (groessere Werte liefern die letzte Stufe)
+		///
+		////////////////////////////////////////////////////////////
+		static SceneQuality getQualityLevel( const unsigned int level );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Setzt die Qualitaetsstufe der Tiefenverarbeitung und Darstellung.
+		///
+		/// Aendert sich die Aufloesung des Tiefengitters oder die Triangulierung, werden Height-Map,
+		/// Vertex-, Element-Buffer und Depth-Map Textur neu angelegt. Muss auf dem Thread mit dem
+		/// OpenGL-Kontext aufgerufen werden, waehrend kein anderer Thread filterDepth() oder buildMesh() ausfuehrt.
+		/// Bilder, die noch mit der alten Aufloesung unterwegs sind, verwirft uploadMesh().
+		///
+		/// \param quality Neue Qualitaetsstufe
+		///
+		////////////////////////////////////////////////////////////
+		void setQuality( const SceneQuality& quality );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert die aktuelle Qualitaetsstufe zurueck.
+		////////////////////////////////////////////////////////////
+		const SceneQuality& getQuality(void) const { return m_Quality; }
+
+		////////////////////////////////////////////////////////////
+		/// \brief Schaltet die Filterung auf halber Gitteraufloesung mit RGB-gefuehrter Vergroesserung ein oder aus.
+		///
+		/// SmoothFilter laeuft dann auf einem Viertel der Pixel, DepthUpsampler bringt das Ergebnis zurueck
+		/// auf das Tiefengitter und stellt dabei die Kanten anhand des Kamerabildes wieder her. Segmentierung
+		/// und Mesh arbeiten weiter auf dem Tiefengitter der aktuellen Qualitaetsstufe.
+		///
+		/// \param enabled Vergroesserung an / aus
+		///
+		////////////////////////////////////////////////////////////
+		void setGuidedUpsampling( const bool enabled );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert true zurueck, wenn die RGB-gefuehrte Vergroesserung eingeschaltet ist.
+		////////////////////////////////////////////////////////////
+		bool getGuidedUpsampling(void) const { return m_GuidedUpsampling; }
+
+		////////////////////////////////////////////////////////////
+		/// \brief Beschraenkt die Verarbeitung in updateData() auf den Ausschnitt um den Kopf des Benutzers.
+		///
+		/// HeadTracker sucht den Kopf in jedem Bild. Filter, Segmentierung, Texturen, Vertex-Buffer und
+		/// Zeichnen beruecksichtigen danach nur den Ausschnitt, alles ausserhalb gilt als Hintergrund.
+		/// Hochgeladen werden nur die geaenderten Rechtecke. Die Pipeline-Methoden filterDepth(),
+		/// buildMesh() und uploadMesh() verarbeiten weiterhin das ganze Bild.
+		///
+		/// \param enabled Kopfverfolgung an / aus
+		///
+		////////////////////////////////////////////////////////////
+		void setHeadTracking( const bool enabled );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert true zurueck, wenn die Verarbeitung auf den Kopf beschraenkt ist.
+		////////////////////////////////////////////////////////////
+		bool getHeadTracking(void) const { return m_HeadTracking; }
+
+		////////////////////////////////////////////////////////////
+		/// \brief Waehlt zwischen Dreiecksnetz und Punkten (Splats).
+		///
+		/// Punkte verwenden denselben Vertex-Buffer und dieselben Shader. Nach jedem Upload wird eine
+		/// kompakte Indexliste der Gitterpunkte mit gueltiger Tiefe aufgebaut (mit Hintergrundebene alle
+		/// Gitterpunkte), gezeichnet wird sie mit GL_POINTS. Die Punktgroesse deckt den Gitterabstand
+		/// in der Ausgabe ab. Das spart das Dreiecksnetz mit sechs Indizes pro Gitterzelle, die Kanten
+		/// werden dafuer etwas blockiger.
+		///
+		/// \param mode Neue Darstellung
+		///
+		////////////////////////////////////////////////////////////
+		void setMeshMode( const MeshMode mode );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert die aktuelle Darstellung zurueck.
+		////////////////////////////////////////////////////////////
+		MeshMode getMeshMode(void) const { return m_MeshMode; }
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert den HeadTracker zurueck (z.B. fuer dessen Zustand im HUD).
+		////////////////////////////////////////////////////////////
+		const HeadTracker& getHeadTracker(void) const { return m_HeadTracker; }
+
+		////////////////////////////////////////////////////////////
+		/// \brief Legt fest, welche Pixel zwischen den Thresholds zum Kopf gehoeren.
+		///
+		/// Mit FOREGROUND_LARGEST bzw. FOREGROUND_NEAREST bleibt nur eine zusammenhaengende Komponente
+		/// erhalten, z.B. ohne Stuhllehne und Haende. Siehe SegmentedDepthImage::setForegroundMode().
+		///
+		/// \param mode Vordergrundmodus
+		///
+		////////////////////////////////////////////////////////////
+		void setForegroundMode( const ForegroundMode mode );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert den Vordergrundmodus zurueck.
+		////////////////////////////////////////////////////////////
+		ForegroundMode getForegroundMode(void) const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Oeffnet und schliesst die Vordergrundmaske vor dem Mesh-Aufbau, siehe SegmentedDepthImage::setMaskMorphology().
+		///
+		/// \param openRadius  Radius des Oeffnens (0 = aus)
+		/// \param closeRadius Radius des Schliessens (0 = aus)
+		///
+		////////////////////////////////////////////////////////////
+		void setMaskMorphology( const unsigned int openRadius, const unsigned int closeRadius );
+
+		unsigned int getOpenRadius(void) const;
+		unsigned int getCloseRadius(void) const;
+
 		////////////////////////////////////////////////////////////
 		/// \brief Wechselt zwischen der Kamera- und der Depth-Map Textur.
 		////////////////////////////////////////////////////////////
@@ -130,6 +400,31 @@ namespace DirectLook
 		/// \brief Zeichnet die 3D-Szene in eine RGB-Textur und zeigt diese an.
 		////////////////////////////////////////////////////////////
 		void draw(void);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Zeichnet die 3D-Szene nur in die Render-Target Textur, ohne sie anzuzeigen.
+		///
+		/// Wird im Batch-Betrieb ohne sichtbares Fenster verwendet. Das Ergebnis kann
+		/// anschliessend mit getRGBPixels() bzw. getBGRPixels() ausgelesen werden.
+		/// Zusaetzliche Ansichten (siehe addView()) werden im selben Durchgang gezeichnet.
+		///
+		////////////////////////////////////////////////////////////
+		void drawOffscreen(void);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Zeichnet den 3D-Kopf ohne OpenGL mit einem CpuRenderer.
+		///
+		/// Uebergibt Weltmatrix, View-Projection-Matrix, Thresholds, Gitterabstand und Hintergrundebene
+		/// wie beginScene() an den Shader. Vorher muss update() aufgerufen werden. Das Hintergrundvideo
+		/// und weitere Ansichten zeichnet nur drawOffscreen().
+		///
+		/// \param renderer        Ziel, die Groesse wird mit CpuRenderer::setSize() festgelegt
+		/// \param imageFrame      RGB-Werte des Sensors
+		/// \param vertexHeightMap Vertices aus buildMesh()
+		/// \param pCamera         Kamera der Ansicht, 0 fuer die Kamera der Szene
+		///
+		////////////////////////////////////////////////////////////
+		void renderCpu( CpuRenderer& renderer, const ImageFrame& imageFrame, const VertexFrame& vertexHeightMap, const GLCamera* pCamera = 0 ) const;
 		
 		////////////////////////////////////////////////////////////
 		/// \brief Loescht die GLScene-Daten aus dem Videospeicher der Grafikkarte.
@@ -173,6 +468,40 @@ namespace DirectLook
 		///
 		////////////////////////////////////////////////////////////
 		unsigned int getDepthHeight(void) const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Legt die Aufloesung fest, in der die Szene gerendert und ausgelesen wird.
+		///
+		/// Die Ausgabe ist unabhaengig von der Sensoraufloesung, skaliert wird beim Rendern auf der GPU.
+		/// Das Seitenverhaeltnis der Kamera wird angepasst: die sichtbare Hoehe bleibt, breitere Ausgaben
+		/// zeigen mehr von der Szene. Mit levels > 1 entstehen aus demselben Rendering zusaetzlich
+		/// verkleinerte Stufen (halbe Breite und Hoehe je Stufe), siehe getRGBPixels().
+		/// Laufende Aufnahme und Shared-Memory-Ausgabe werden beendet, ihre Bildgroesse passt nicht mehr.
+		/// Muss auf dem Thread mit dem OpenGL-Kontext aufgerufen werden.
+		///
+		/// \param width  Breite der Ausgabe
+		/// \param height Hoehe der Ausgabe
+		/// \param levels Anzahl der Stufen (1 = nur volle Aufloesung)
+		///
+		/// \return False bei ungueltiger Groesse
+		///
+		////////////////////////////////////////////////////////////
+		bool setOutputSize( const unsigned int width, const unsigned int height, const unsigned int levels = 1 );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert die Breite der Ausgabe bzw. einer ihrer Stufen zurueck.
+		////////////////////////////////////////////////////////////
+		unsigned int getOutputWidth( const unsigned int level = 0 ) const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert die Hoehe der Ausgabe bzw. einer ihrer Stufen zurueck.
+		////////////////////////////////////////////////////////////
+		unsigned int getOutputHeight( const unsigned int level = 0 ) const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert die tatsaechliche Anzahl der Stufen der Ausgabe zurueck.
+		////////////////////////////////////////////////////////////
+		unsigned int getOutputLevels(void) const;
 		
 		////////////////////////////////////////////////////////////
 		/// \brief Liefert den aktuellen Near-Threshold der Tiefensegmentierung zurueck.
@@ -203,20 +532,68 @@ namespace DirectLook
 		///
 		/// \param buffer  Zeiger auf den zu beschreibenden Puffer
 		/// \param size    Groesse des zu beschreibenden Puffer
+		/// \param level   Stufe der Ausgabe (0 = volle Aufloesung), siehe setOutputSize()
 		/// \return        True wenn erfolgreich, false wenn fehlgeschlagen
 		///
 		////////////////////////////////////////////////////////////
-		bool getRGBPixels(GLubyte* pBuffer, const unsigned int size) const;
+		bool getRGBPixels(GLubyte* pBuffer, const unsigned int size, const unsigned int level = 0) const;
 
 		////////////////////////////////////////////////////////////
 		/// \brief Liefert die Render-Target Textur im BGR-Format zurueck (performant).
 		///
 		/// \param buffer  Zeiger auf den zu beschreibenden Puffer
 		/// \param size    Groesse des zu beschreibenden Puffer
+		/// \param level   Stufe der Ausgabe (0 = volle Aufloesung), siehe setOutputSize()
 		/// \return        True wenn erfolgreich, false wenn fehlgeschlagen
 		///
 		////////////////////////////////////////////////////////////
-		bool getBGRPixels(GLubyte* pBuffer, const unsigned int size) const;
+		bool getBGRPixels(GLubyte* pBuffer, const unsigned int size, const unsigned int level = 0) const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Fuegt eine Ansicht mit eigener virtueller Kamera und eigenem Render-Target hinzu.
+		///
+		/// Mesh und Texturen werden nur einmal pro Bild hochgeladen und fuer alle Ansichten nur einmal
+		/// gebunden, jede weitere Ansicht kostet einen Framebuffer-Wechsel, eine Matrix und den
+		/// Zeichenaufruf. Das Seitenverhaeltnis der Kamera wird an width / height angepasst.
+		/// Muss auf dem Thread mit dem OpenGL-Kontext aufgerufen werden.
+		///
+		/// \param pCamera    Virtuelle Kamera der Ansicht, muss bis removeViews() gueltig bleiben
+		/// \param width      Breite der Ansicht
+		/// \param height     Hoehe der Ansicht
+		/// \param background Hintergrundvideo auch in diese Ansicht zeichnen?
+		///
+		/// \return Nummer der Ansicht fuer getViewPixels()
+		///
+		////////////////////////////////////////////////////////////
+		unsigned int addView( GLCamera* pCamera, const unsigned int width, const unsigned int height, const bool background = true );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Entfernt alle zusaetzlichen Ansichten und ihre Render-Targets.
+		////////////////////////////////////////////////////////////
+		void removeViews(void);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert die Anzahl der zusaetzlichen Ansichten zurueck.
+		////////////////////////////////////////////////////////////
+		unsigned int getViewCount(void) const { return (unsigned int) m_Views.size(); }
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liest das Bild einer zusaetzlichen Ansicht aus.
+		///
+		/// \param view    Nummer der Ansicht aus addView()
+		/// \param pBuffer Zeiger auf den zu beschreibenden Puffer
+		/// \param size    Groesse des Puffers, mindestens Breite * Hoehe * 3 Byte der Ansicht
+		/// \param format  GL_RGB oder GL_BGR
+		///
+		/// \return True wenn erfolgreich, false wenn fehlgeschlagen
+		///
+		////////////////////////////////////////////////////////////
+		bool getViewPixels( const unsigned int view, GLubyte* pBuffer, const unsigned int size, const GLint format = GL_RGB ) const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert das Render-Target einer zusaetzlichen Ansicht zurueck (Groesse, Auslesezeit).
+		////////////////////////////////////////////////////////////
+		const RenderTarget* getViewTarget( const unsigned int view ) const { return m_Views[view].m_pRenderTarget; }
 
 		////////////////////////////////////////////////////////////
 		/// \brief Liefert die Render-Target Textur im YUV-Format zurueck (langsam).
@@ -226,6 +603,23 @@ namespace DirectLook
 		////////////////////////////////////////////////////////////
 		const GLubyte* getYUVPixels(void) const;
 
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert die GPU-Zeiten der Render-Durchgaenge zurueck (Hintergrund, Szene, Auslesen, Anzeige).
+		///
+		/// Holt vorher alle fertigen Ergebnisse ab. Leer, wenn der Kontext keine Timer-Queries unterstuetzt.
+		///
+		////////////////////////////////////////////////////////////
+		std::vector<GpuPassStatistics> getGpuStatistics(void);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert die CPU-Zeiten der letzten Bilder, die Upload-Menge und die Anzahl der Dreiecke zurueck.
+		///
+		/// Jede Zeit wird nur von dem Thread geschrieben, der die Methode aufruft. Lesen ist nur
+		/// auf dem Render-Thread im seriellen Betrieb (SensorGLWidget) zuverlaessig.
+		///
+		////////////////////////////////////////////////////////////
+		SceneStatistics getSceneStatistics(void) const;
+
 		////////////////////////////////////////////////////////////
 		/// \brief Liefert true zurÃ¼ck wenn die Texure angezeigt wird und false wenn die Tiefenkarte angezeigt wird.
 		///
@@ -266,6 +660,77 @@ namespace DirectLook
 		void setBackgroundTexture( const unsigned int width, const unsigned int height, const GLubyte* pPixels );
 
 		void setVideoPath(string path);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Setzt den Speicher fuer eine kurze, sich wiederholende Videoschleife.
+		///
+		/// Passt die erste Schleife des Hintergrundvideos in das Budget, wird der Decoder danach angehalten.
+		/// Jedes Bild wird einmal in eine eigene Textur geladen, danach kostet die Wiedergabe nur noch
+		/// das Binden der Textur. Wirkt ab dem naechsten setVideoPath().
+		///
+		/// \param megabytes Budget in MB (0 = Video wird immer dekodiert)
+		///
+		////////////////////////////////////////////////////////////
+		void setVideoCacheBudget( const unsigned int megabytes );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert das Budget der Videoschleife in MB zurueck.
+		////////////////////////////////////////////////////////////
+		unsigned int getVideoCacheBudget(void) const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert true zurueck, wenn ein Hintergrundvideo abgespielt wird.
+		////////////////////////////////////////////////////////////
+		bool hasBackgroundVideo(void) const { return m_pIsVideoPathSet; }
+
+		////////////////////////////////////////////////////////////
+		/// \brief Startet die Aufnahme der korrigierten Bilder, die draw() anzeigt.
+		///
+		/// Kodiert wird auf einem eigenen Thread. Kommt der Encoder nicht nach, werden Bilder
+		/// verworfen, draw() wartet nie auf ihn. Eine laufende Aufnahme wird vorher beendet.
+		///
+		/// \param fileName Zieldatei, die Endung waehlt den Container (z.B. *.mkv)
+		/// \param codec    Codec der Aufnahme
+		///
+		/// \return True wenn erfolgreich, false wenn fehlgeschlagen
+		///
+		////////////////////////////////////////////////////////////
+		bool startRecording( const std::string& fileName, const VideoCodec codec );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Kodiert die noch wartenden Bilder und schliesst die Aufnahme.
+		////////////////////////////////////////////////////////////
+		void stopRecording(void);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert true zurueck, solange aufgenommen wird.
+		////////////////////////////////////////////////////////////
+		bool isRecording(void) const { return m_VideoRecorder.isOpen(); }
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert Durchsatz, verworfene Bilder und Verzoegerung der (letzten) Aufnahme zurueck.
+		////////////////////////////////////////////////////////////
+		EncoderStatistics getRecordingStatistics(void) const { return m_VideoRecorder.getStatistics(); }
+
+		////////////////////////////////////////////////////////////
+		/// \brief Stellt die Bilder, die draw() anzeigt, unter einem Namen im Shared Memory bereit (siehe OutputRing).
+		///
+		/// \param name Name des Ringes, Leser oeffnen ihn mit dlRingOpen()
+		///
+		/// \return True wenn erfolgreich, false wenn fehlgeschlagen
+		///
+		////////////////////////////////////////////////////////////
+		bool startSharing( const std::string& name );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Schliesst den Ring, wartende Leser erfahren das aus dlRingWait().
+		////////////////////////////////////////////////////////////
+		void stopSharing(void);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert den Ring zurueck (Name, Anzahl der bereitgestellten Bilder).
+		////////////////////////////////////////////////////////////
+		const OutputRing& getOutputRing(void) const { return m_OutputRing; }
 		
 	private:
 		////////////////////////////////////////////////////////////
@@ -283,25 +748,100 @@ namespace DirectLook
 		////////////////////////////////////////////////////////////
 		void initTextures(void);
 
+		////////////////////////////////////////////////////////////
+		/// \brief Erzeugt und initialisiert die Depth-Map Textur in der Groesse des Tiefengitters.
+		////////////////////////////////////////////////////////////
+		void initDepthTexture(void);
+
 		/*
 		*	initializes the Background Video
 		*/
 		void initBackgroundVideo(void);
 
 		/*
-		*	draws the video onto a sky plane
+		*	creates the textures of the 3 planes of "frame" in "ppTextures"
+		*/
+		void createVideoTextures( TextureObject** ppTextures, const AvVideoFrame& frame );
+
+		/*
+		*	deletes the textures of the current video frame and of a cached loop
+		*/
+		void deleteVideoTextures(void);
+
+		/*
+		*	draws the video onto a sky plane of every target, the due frame is uploaded only once.
+		*	returns false if there was no frame yet, the targets haven't been cleared then
 		*/
-		void drawBackgroundVideo(void);
+		bool drawBackgroundVideo( const std::vector<RenderTarget*>& targets );
 
 		////////////////////////////////////////////////////////////
-		/// \brief Zeichnet den 3D-Kopf.
+		/// \brief Aktiviert den Shader und bindet Uniforms, Texturen und Buffer des 3D-Kopfes.
 		////////////////////////////////////////////////////////////
-		void drawScene(void);
+		void beginScene(void);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Zeichnet den 3D-Kopf mit der View-Projection-Matrix einer Kamera (nach beginScene()).
+		///
+		/// \param pCamera      Kamera der Ansicht
+		/// \param targetHeight Hoehe des Render-Targets in Pixeln, bestimmt die Punktgroesse bei MESH_POINTS
+		///
+		////////////////////////////////////////////////////////////
+		void drawSceneMesh( const GLCamera* pCamera, const unsigned int targetHeight );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Baut die kompakte Punktliste aus den Vertices des Gitters auf und laedt sie hoch.
+		////////////////////////////////////////////////////////////
+		void updatePointList( const GLfloat* pVertices );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Deaktiviert Vertex-Attribut und Shader wieder.
+		////////////////////////////////////////////////////////////
+		void endScene(void);
 
 		////////////////////////////////////////////////////////////
 		/// \brief Glättet die Tiefenkarte.
+		///
+		/// Schreibt jeden Tiefenwert genau einmal in "smoothDepthArray", eine Vorab-Kopie ist nicht noetig.
+		///
+		/// \param pDepthPixels     Tiefenwerte des Sensors
+		/// \param smoothDepthArray Zielpuffer fuer die geglaetteten Tiefenwerte
+		/// \param width            Breite der Tiefenkarte
+		/// \param height           Hoehe der Tiefenkarte
+		/// \param holeFill         Groesse der Nachbarschaft, aus der Loecher gefuellt werden
+		///
+		////////////////////////////////////////////////////////////
+		void SmoothFilter( const unsigned short* pDepthPixels, unsigned short* smoothDepthArray, const unsigned int width, const unsigned int height, const HoleFillMode holeFill );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Verkleinert die Tiefenkarte auf das Tiefengitter.
+		///
+		/// Jeder Gitterpunkt uebernimmt den ersten gueltigen Tiefenwert seines step x step Blocks,
+		/// damit Loecher nicht mit gueltigen Werten zu falschen Tiefen gemittelt werden.
+		///
+		/// \param pDepthPixels Tiefenwerte des Sensors (m_DepthWidth x m_DepthHeight)
+		/// \param pGridPixels  Zielpuffer in der Groesse des Ausschnitts
+		/// \param step         Abstand der Gitterpunkte
+		/// \param region       Ausschnitt des Tiefengitters ((m_DepthWidth / step) x (m_DepthHeight / step))
+		///
+		////////////////////////////////////////////////////////////
+		void decimateDepth( const unsigned short* pDepthPixels, unsigned short* pGridPixels, const unsigned int step, const TileRange& region ) const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief updateData() mit Kopfverfolgung: verarbeitet und laedt nur den Ausschnitt um den Kopf.
+		///
+		/// \param imageFrame RGB-Werte des Sensors
+		/// \param depthFrame Tiefenwerte des Sensors
+		///
+		////////////////////////////////////////////////////////////
+		void updateHeadRegion( const ImageFrame& imageFrame, const DepthFrame& depthFrame );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Bestimmt die Zellenspalten des Element-Buffers, die den Ausschnitt im 3D-Grid abdecken.
+		///
+		/// \param gridRegion Ausschnitt im 3D-Grid
+		///
 		////////////////////////////////////////////////////////////
-		unsigned short* SmoothFilter(const unsigned short*);
+		void updateDrawRegion( const TileRange& gridRegion );
 
 		
 	};
@@ -0,0 +1,138 @@
+#include "GpuTimer.h"
+
+#include <iomanip>
+
+namespace DirectLook
+{
+	GpuTimer::GpuTimer( const std::string& name, const unsigned int windowSize )
+		:
+		m_Name( name ),
+		m_Read( 0 ),
+		m_Pending( 0 ),
+		m_Created( false ),
+		m_Active( false ),
+		m_Skipped( 0 ),
+		m_Milliseconds( windowSize )
+	{
+		for(unsigned int i = 0; i < QUERY_COUNT; i++)
+		{
+			m_Queries[i] = 0;
+		}
+	}
+
+	GpuTimer::~GpuTimer(void)
+	{
+		if(m_Created)
+		{
+			glDeleteQueries( QUERY_COUNT, m_Queries );
+		}
+	}
+
+	bool GpuTimer::isSupported(void)
+	{
+		return GLEW_ARB_timer_query || GLEW_EXT_timer_query;
+	}
+
+	void GpuTimer::begin(void)
+	{
+		if(m_Active || !isSupported())
+		{
+			return;
+		}
+
+		if(!m_Created)
+		{
+			glGenQueries( QUERY_COUNT, m_Queries );
+			m_Created = true;
+		}
+
+		collect();
+
+		// Never wait for the GPU, rather leave this frame out
+		if(m_Pending == QUERY_COUNT)
+		{
+			m_Skipped++;
+			return;
+		}
+
+		glBeginQuery( GL_TIME_ELAPSED, m_Queries[(m_Read + m_Pending) % QUERY_COUNT] );
+		m_Active = true;
+	}
+
+	void GpuTimer::end(void)
+	{
+		if(m_Active)
+		{
+			glEndQuery( GL_TIME_ELAPSED );
+			m_Pending++;
+			m_Active = false;
+		}
+	}
+
+	void GpuTimer::collect(void)
+	{
+		while(m_Pending > 0)
+		{
+			const GLuint query = m_Queries[m_Read];
+
+			GLint available = 0;
+			glGetQueryObjectiv( query, GL_QUERY_RESULT_AVAILABLE, &available );
+			if(!available)
+			{
+				break;
+			}
+
+			GLuint64 nanoseconds = 0;
+			if(GLEW_ARB_timer_query)
+			{
+				glGetQueryObjectui64v( query, GL_QUERY_RESULT, &nanoseconds );
+			}
+			else
+			{
+				glGetQueryObjectui64vEXT( query, GL_QUERY_RESULT, &nanoseconds );
+			}
+
+			m_Milliseconds.add( (double) nanoseconds / 1000000.0 );
+			m_Read = (m_Read + 1) % QUERY_COUNT;
+			m_Pending--;
+		}
+	}
+
+	GpuPassStatistics GpuTimer::getStatistics(void) const
+	{
+		GpuPassStatistics statistics;
+		statistics.m_Name = m_Name;
+		statistics.m_Frames = m_Milliseconds.getCount();
+		statistics.m_Skipped = m_Skipped;
+		statistics.m_MeanMilliseconds = m_Milliseconds.getMean();
+		statistics.m_P50Milliseconds = m_Milliseconds.getPercentile( 0.5 );
+		statistics.m_P95Milliseconds = m_Milliseconds.getPercentile( 0.95 );
+		statistics.m_MaxMilliseconds = m_Milliseconds.getMax();
+		return statistics;
+	}
+
+	void GpuTimer::printStatistics( std::ostream& stream, const std::vector<GpuPassStatistics>& statistics )
+	{
+		stream << std::left << std::setw( 12 ) << "GPU pass" << std::right
+			<< std::setw( 10 ) << "Frames"
+			<< std::setw( 10 ) << "Skipped"
+			<< std::setw( 12 ) << "Mean ms"
+			<< std::setw( 12 ) << "p50 ms"
+			<< std::setw( 12 ) << "p95 ms"
+			<< std::setw( 12 ) << "Max ms" << std::endl;
+
+		for(size_t i = 0; i < statistics.size(); i++)
+		{
+			const GpuPassStatistics& pass = statistics[i];
+			stream << std::left << std::setw( 12 ) << pass.m_Name << std::right
+				<< std::setw( 10 ) << pass.m_Frames
+				<< std::setw( 10 ) << pass.m_Skipped
+				<< std::setw( 12 ) << std::fixed << std::setprecision( 2 ) << pass.m_MeanMilliseconds
+				<< std::setw( 12 ) << pass.m_P50Milliseconds
+				<< std::setw( 12 ) << pass.m_P95Milliseconds
+				<< std::setw( 12 ) << pass.m_MaxMilliseconds << std::endl;
+		}
+		stream.unsetf( std::ios::fixed );
+		stream << std::setprecision( 6 );
+	}
+};
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "../NonCopyable.h"
+#include "../Core/Metrics.h"
+
+#include <GL/glew.h>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace DirectLook
+{
+	/// \brief Momentaufnahme der GPU-Zeiten eines Render-Durchgangs, siehe GpuTimer::getStatistics().
+	struct GpuPassStatistics
+	{
+		std::string m_Name;					///< Name des Durchgangs
+		unsigned long long m_Frames;		///< Anzahl der gemessenen Bilder
+		unsigned long long m_Skipped;		///< Nicht gemessene Bilder, weil alle Queries noch unterwegs waren
+		double m_MeanMilliseconds;			///< Mittlere GPU-Zeit der letzten Bilder
+		double m_P50Milliseconds;			///< Median der GPU-Zeit der letzten Bilder
+		double m_P95Milliseconds;			///< 95. Perzentil der GPU-Zeit der letzten Bilder
+		double m_MaxMilliseconds;			///< Laengste GPU-Zeit der letzten Bilder
+	};
+
+	/// \brief Die Klasse GpuTimer misst die GPU-Zeit eines Render-Durchgangs mit GL_TIME_ELAPSED Queries.
+	///
+	/// Die Queries liegen in einem Ring: begin() holt zuerst alle fertigen Ergebnisse ab, ohne auf die
+	/// Grafikkarte zu warten, und misst das aktuelle Bild nur, wenn ein Query frei ist. Die Ergebnisse
+	/// kommen daher einige Bilder verzoegert an. GL_TIME_ELAPSED Queries duerfen nicht verschachtelt werden,
+	/// zwei GpuTimer muessen also nacheinander laufen. Ohne ARB_timer_query oder EXT_timer_query tun
+	/// begin() und end() nichts.
+	class GpuTimer : public NonCopyable
+	{
+
+	public:
+		static const unsigned int QUERY_COUNT = 4;	///< Groesse des Query-Rings (maximale Verzoegerung in Bildern)
+
+		////////////////////////////////////////////////////////////
+		/// \brief Konstruktor
+		///
+		/// Die Query-Objekte werden erst beim ersten begin() angelegt, wenn der OpenGL-Kontext sicher aktiv ist.
+		///
+		/// \param name			Name des Durchgangs fuer die Statistik
+		/// \param windowSize	Anzahl der beruecksichtigten Messwerte
+		///
+		////////////////////////////////////////////////////////////
+		explicit GpuTimer( const std::string& name, const unsigned int windowSize = 120 );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Destruktor
+		///
+		/// Loescht die Query-Objekte, der OpenGL-Kontext muss dafuer aktiv sein.
+		///
+		////////////////////////////////////////////////////////////
+		~GpuTimer(void);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert true zurueck wenn der aktive Kontext Timer-Queries unterstuetzt.
+		////////////////////////////////////////////////////////////
+		static bool isSupported(void);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Beginnt die Messung des Durchgangs.
+		////////////////////////////////////////////////////////////
+		void begin(void);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Beendet die Messung des Durchgangs.
+		////////////////////////////////////////////////////////////
+		void end(void);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Holt alle fertigen Ergebnisse ab, ohne zu warten.
+		////////////////////////////////////////////////////////////
+		void collect(void);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert die Kennzahlen des Durchgangs zurueck.
+		////////////////////////////////////////////////////////////
+		GpuPassStatistics getStatistics(void) const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Gibt die Kennzahlen mehrerer Durchgaenge als Tabelle aus.
+		////////////////////////////////////////////////////////////
+		static void printStatistics( std::ostream& stream, const std::vector<GpuPassStatistics>& statistics );
+
+	private:
+		std::string m_Name;						///< Name des Durchgangs
+		GLuint m_Queries[QUERY_COUNT];			///< Ring der Query-Objekte
+		unsigned int m_Read;					///< Aeltestes ausstehendes Query im Ring
+		unsigned int m_Pending;					///< Anzahl ausstehender Queries
+		bool m_Created;							///< Wurden die Query-Objekte angelegt?
+		bool m_Active;							///< Laeuft gerade eine Messung?
+		unsigned long long m_Skipped;			///< Nicht gemessene Bilder
+		RollingStatistic m_Milliseconds;		///< GPU-Zeiten der letzten Bilder
+	};
+};
@@ -0,0 +1,249 @@
+#include "HudOverlay.h"
+
+namespace DirectLook
+{
+	// Classic 5x7 font for ASCII 0x20 to 0x5F, one byte per column, bit 0 is the top row
+	static const unsigned char FONT_5X7[64][5] =
+	{
+		{ 0x00, 0x00, 0x00, 0x00, 0x00 }, { 0x00, 0x00, 0x5F, 0x00, 0x00 }, { 0x00, 0x07, 0x00, 0x07, 0x00 }, { 0x14, 0x7F, 0x14, 0x7F, 0x14 },
+		{ 0x24, 0x2A, 0x7F, 0x2A, 0x12 }, { 0x23, 0x13, 0x08, 0x64, 0x62 }, { 0x36, 0x49, 0x55, 0x22, 0x50 }, { 0x00, 0x05, 0x03, 0x00, 0x00 },
+		{ 0x00, 0x1C, 0x22, 0x41, 0x00 }, { 0x00, 0x41, 0x22, 0x1C, 0x00 }, { 0x08, 0x2A, 0x1C, 0x2A, 0x08 }, { 0x08, 0x08, 0x3E, 0x08, 0x08 },
+		{ 0x00, 0x50, 0x30, 0x00, 0x00 }, { 0x08, 0x08, 0x08, 0x08, 0x08 }, { 0x00, 0x60, 0x60, 0x00, 0x00 }, { 0x20, 0x10, 0x08, 0x04, 0x02 },
+		{ 0x3E, 0x51, 0x49, 0x45, 0x3E }, { 0x00, 0x42, 0x7F, 0x40, 0x00 }, { 0x42, 0x61, 0x51, 0x49, 0x46 }, { 0x21, 0x41, 0x45, 0x4B, 0x31 },
+		{ 0x18, 0x14, 0x12, 0x7F, 0x10 }, { 0x27, 0x45, 0x45, 0x45, 0x39 }, { 0x3C, 0x4A, 0x49, 0x49, 0x30 }, { 0x01, 0x71, 0x09, 0x05, 0x03 },
+		{ 0x36, 0x49, 0x49, 0x49, 0x36 }, { 0x06, 0x49, 0x49, 0x29, 0x1E }, { 0x00, 0x36, 0x36, 0x00, 0x00 }, { 0x00, 0x56, 0x36, 0x00, 0x00 },
+		{ 0x00, 0x08, 0x14, 0x22, 0x41 }, { 0x14, 0x14, 0x14, 0x14, 0x14 }, { 0x41, 0x22, 0x14, 0x08, 0x00 }, { 0x02, 0x01, 0x51, 0x09, 0x06 },
+		{ 0x32, 0x49, 0x79, 0x41, 0x3E }, { 0x7E, 0x11, 0x11, 0x11, 0x7E }, { 0x7F, 0x49, 0x49, 0x49, 0x36 }, { 0x3E, 0x41, 0x41, 0x41, 0x22 },
+		{ 0x7F, 0x41, 0x41, 0x22, 0x1C }, { 0x7F, 0x49, 0x49, 0x49, 0x41 }, { 0x7F, 0x09, 0x09, 0x01, 0x01 }, { 0x3E, 0x41, 0x41, 0x51, 0x32 },
+		{ 0x7F, 0x08, 0x08, 0x08, 0x7F }, { 0x00, 0x41, 0x7F, 0x41, 0x00 }, { 0x20, 0x40, 0x41, 0x3F, 0x01 }, { 0x7F, 0x08, 0x14, 0x22, 0x41 },
+		{ 0x7F, 0x40, 0x40, 0x40, 0x40 }, { 0x7F, 0x02, 0x04, 0x02, 0x7F }, { 0x7F, 0x04, 0x08, 0x10, 0x7F }, { 0x3E, 0x41, 0x41, 0x41, 0x3E },
+		{ 0x7F, 0x09, 0x09, 0x09, 0x06 }, { 0x3E, 0x41, 0x51, 0x21, 0x5E }, { 0x7F, 0x09, 0x19, 0x29, 0x46 }, { 0x46, 0x49, 0x49, 0x49, 0x31 },
+		{ 0x01, 0x01, 0x7F, 0x01, 0x01 }, { 0x3F, 0x40, 0x40, 0x40, 0x3F }, { 0x1F, 0x20, 0x40, 0x20, 0x1F }, { 0x7F, 0x20, 0x18, 0x20, 0x7F },
+		{ 0x63, 0x14, 0x08, 0x14, 0x63 }, { 0x03, 0x04, 0x78, 0x04, 0x03 }, { 0x61, 0x51, 0x49, 0x45, 0x43 }, { 0x00, 0x00, 0x7F, 0x41, 0x41 },
+		{ 0x02, 0x04, 0x08, 0x10, 0x20 }, { 0x41, 0x41, 0x7F, 0x00, 0x00 }, { 0x04, 0x02, 0x01, 0x02, 0x04 }, { 0x40, 0x40, 0x40, 0x40, 0x40 }
+	};
+
+	// Atlas layout: 16 x 5 cells of 8 x 8 texels, slots 0 to 63 hold the glyphs, slot 64 is solid for the background
+	static const unsigned int ATLAS_WIDTH  = 128;
+	static const unsigned int ATLAS_HEIGHT = 64;
+	static const unsigned int CELL_SIZE    = 8;
+	static const unsigned int SOLID_SLOT   = 64;
+	static const unsigned int GLYPH_WIDTH  = 6;	// 5 columns plus spacing
+	static const unsigned int GLYPH_HEIGHT = 8;	// 7 rows plus spacing
+	static const unsigned int MARGIN       = 4;
+
+	static const GLubyte TEXT_COLOR[4]       = { 255, 255, 255, 255 };
+	static const GLubyte WARNING_COLOR[4]    = { 255,  80,  64, 255 };
+	static const GLubyte BACKGROUND_COLOR[4] = {   0,   0,   0, 160 };
+
+	HudOverlay::HudOverlay( const unsigned int scale )
+		:
+		m_Scale( (scale > 0) ? scale : 1 ),
+		m_AtlasID( 0 ),
+		m_IsDirty( true )
+	{
+	}
+
+	HudOverlay::~HudOverlay(void)
+	{
+		if(m_AtlasID > 0)
+		{
+			glDeleteTextures( 1, &m_AtlasID );
+			m_AtlasID = 0;
+		}
+	}
+
+	void HudOverlay::setText( const std::string& text )
+	{
+		if(text != m_Text)
+		{
+			m_Text = text;
+			m_IsDirty = true;
+		}
+	}
+
+	void HudOverlay::draw( const unsigned int viewportWidth, const unsigned int viewportHeight )
+	{
+		if(m_Text.empty() || viewportWidth == 0 || viewportHeight == 0)
+		{
+			return;
+		}
+
+		if(m_AtlasID == 0)
+		{
+			createAtlas();
+		}
+		if(m_IsDirty)
+		{
+			buildVertices();
+		}
+
+		glPushAttrib( GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT | GL_TEXTURE_BIT | GL_DEPTH_BUFFER_BIT | GL_VIEWPORT_BIT );
+		glPushClientAttrib( GL_CLIENT_VERTEX_ARRAY_BIT );
+
+		// Fixed function state in pixel coordinates, origin in the upper left corner
+		glUseProgram( 0 );
+		glBindBuffer( GL_ARRAY_BUFFER, 0 );
+		glViewport( 0, 0, viewportWidth, viewportHeight );
+		glMatrixMode( GL_PROJECTION );
+		glPushMatrix();
+		glLoadIdentity();
+		glOrtho( 0.0, (GLdouble) viewportWidth, (GLdouble) viewportHeight, 0.0, -1.0, 1.0 );
+		glMatrixMode( GL_MODELVIEW );
+		glPushMatrix();
+		glLoadIdentity();
+
+		glDisable( GL_DEPTH_TEST );
+		glDisable( GL_CULL_FACE );
+		glEnable( GL_BLEND );
+		glBlendFunc( GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA );
+		glActiveTexture( GL_TEXTURE0 );
+		glEnable( GL_TEXTURE_2D );
+		glBindTexture( GL_TEXTURE_2D, m_AtlasID );
+		glTexEnvi( GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE );
+
+		// Background and every glyph in one draw call
+		glInterleavedArrays( GL_T2F_C4UB_V3F, 0, &m_Vertices[0] );
+		glDrawArrays( GL_QUADS, 0, (GLsizei) m_Vertices.size() );
+
+		glMatrixMode( GL_PROJECTION );
+		glPopMatrix();
+		glMatrixMode( GL_MODELVIEW );
+		glPopMatrix();
+
+		glPopClientAttrib();
+		glPopAttrib();
+	}
+
+	void HudOverlay::createAtlas(void)
+	{
+		std::vector<GLubyte> texels( ATLAS_WIDTH * ATLAS_HEIGHT, 0 );
+
+		for(unsigned int slot = 0; slot < 64; slot++)
+		{
+			const unsigned int cellX = (slot % 16) * CELL_SIZE;
+			const unsigned int cellY = (slot / 16) * CELL_SIZE;
+			for(unsigned int column = 0; column < 5; column++)
+			{
+				for(unsigned int row = 0; row < 7; row++)
+				{
+					if(FONT_5X7[slot][column] & (1 << row))
+					{
+						texels[(cellY + row) * ATLAS_WIDTH + cellX + column] = 255;
+					}
+				}
+			}
+		}
+
+		const unsigned int solidX = (SOLID_SLOT % 16) * CELL_SIZE;
+		const unsigned int solidY = (SOLID_SLOT / 16) * CELL_SIZE;
+		for(unsigned int row = 0; row < CELL_SIZE; row++)
+		{
+			for(unsigned int column = 0; column < CELL_SIZE; column++)
+			{
+				texels[(solidY + row) * ATLAS_WIDTH + solidX + column] = 255;
+			}
+		}
+
+		glGenTextures( 1, &m_AtlasID );
+		glBindTexture( GL_TEXTURE_2D, m_AtlasID );
+		glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST );
+		glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST );
+		glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE );
+		glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE );
+		glPixelStorei( GL_UNPACK_ALIGNMENT, 1 );
+		glTexImage2D( GL_TEXTURE_2D, 0, GL_ALPHA, ATLAS_WIDTH, ATLAS_HEIGHT, 0, GL_ALPHA, GL_UNSIGNED_BYTE, &texels[0] );
+		glPixelStorei( GL_UNPACK_ALIGNMENT, 4 );
+		glBindTexture( GL_TEXTURE_2D, 0 );
+	}
+
+	void HudOverlay::buildVertices(void)
+	{
+		m_Vertices.clear();
+		m_IsDirty = false;
+
+		// Measure the text for the background panel
+		unsigned int lines = 1, columns = 0, column = 0;
+		for(size_t i = 0; i < m_Text.size(); i++)
+		{
+			if(m_Text[i] == '\n')
+			{
+				lines++;
+				column = 0;
+			}
+			else if(++column > columns)
+			{
+				columns = column;
+			}
+		}
+
+		const float glyphWidth = (float) (GLYPH_WIDTH * m_Scale);
+		const float glyphHeight = (float) (GLYPH_HEIGHT * m_Scale);
+		addQuad( 0.0f, 0.0f, columns * glyphWidth + 2 * MARGIN, lines * glyphHeight + 2 * MARGIN, SOLID_SLOT, BACKGROUND_COLOR );
+
+		float x = (float) MARGIN, y = (float) MARGIN;
+		const GLubyte* pColor = TEXT_COLOR;
+		bool lineStart = true;
+
+		for(size_t i = 0; i < m_Text.size(); i++)
+		{
+			char character = m_Text[i];
+			if(character == '\n')
+			{
+				x = (float) MARGIN;
+				y += glyphHeight;
+				pColor = TEXT_COLOR;
+				lineStart = true;
+				continue;
+			}
+			if(lineStart && character == '!')
+			{
+				pColor = WARNING_COLOR;
+				lineStart = false;
+				continue;
+			}
+			lineStart = false;
+
+			if(character >= 'a' && character <= 'z')
+			{
+				character = character - 'a' + 'A';
+			}
+			if(character > ' ' && character <= '_')
+			{
+				addQuad( x, y, glyphWidth, glyphHeight, (unsigned int) (character - ' '), pColor );
+			}
+			x += glyphWidth;
+		}
+	}
+
+	void HudOverlay::addQuad( const float x, const float y, const float width, const float height, const unsigned int slot, const GLubyte* pColor )
+	{
+		const float u0 = (float) ((slot % 16) * CELL_SIZE) / (float) ATLAS_WIDTH;
+		const float v0 = (float) ((slot / 16) * CELL_SIZE) / (float) ATLAS_HEIGHT;
+		const float u1 = u0 + (float) GLYPH_WIDTH / (float) ATLAS_WIDTH;
+		const float v1 = v0 + (float) GLYPH_HEIGHT / (float) ATLAS_HEIGHT;
+
+		const float corners[4][4] =
+		{
+			{ x,         y,          u0, v0 },
+			{ x + width, y,          u1, v0 },
+			{ x + width, y + height, u1, v1 },
+			{ x,         y + height, u0, v1 }
+		};
+
+		for(unsigned int i = 0; i < 4; i++)
+		{
+			Vertex vertex;
+			vertex.m_U = corners[i][2];
+			vertex.m_V = corners[i][3];
+			vertex.m_Color[0] = pColor[0];
+			vertex.m_Color[1] = pColor[1];
+			vertex.m_Color[2] = pColor[2];
+			vertex.m_Color[3] = pColor[3];
+			vertex.m_X = corners[i][0];
+			vertex.m_Y = corners[i][1];
+			vertex.m_Z = 0.0f;
+			m_Vertices.push_back( vertex );
+		}
+	}
+};
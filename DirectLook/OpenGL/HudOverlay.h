@@ -0,0 +1,74 @@
+#pragma once
+
+#include "../NonCopyable.h"
+
+#include <GL/glew.h>
+#include <string>
+#include <vector>
+
+namespace DirectLook
+{
+	/// \brief Die Klasse HudOverlay blendet mehrzeiligen Text (z.B. Leistungswerte) ueber der Szene ein.
+	///
+	/// Die Zeichen stammen aus einem eingebauten 5x7 Pixel Font, der einmalig als Textur-Atlas
+	/// hochgeladen wird. Hintergrund und alle Zeichen liegen in einem gemeinsamen Vertex-Array und werden
+	/// mit einem einzigen Draw-Call gezeichnet; das Array wird nur neu aufgebaut, wenn sich der Text aendert.
+	/// Kleinbuchstaben werden als Grossbuchstaben dargestellt, Zeilen mit '!' am Anfang erscheinen rot.
+	class HudOverlay : public NonCopyable
+	{
+
+	public:
+		////////////////////////////////////////////////////////////
+		/// \brief Konstruktor
+		///
+		/// Die Atlas-Textur wird erst beim ersten draw() angelegt, wenn der OpenGL-Kontext aktiv ist.
+		///
+		/// \param scale Vergroesserung der Zeichen (1 = 6 x 8 Pixel pro Zeichen)
+		///
+		////////////////////////////////////////////////////////////
+		explicit HudOverlay( const unsigned int scale = 2 );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Destruktor
+		///
+		/// Loescht die Atlas-Textur, der OpenGL-Kontext muss dafuer aktiv sein.
+		///
+		////////////////////////////////////////////////////////////
+		~HudOverlay(void);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Setzt den angezeigten Text, Zeilen werden durch '\n' getrennt.
+		////////////////////////////////////////////////////////////
+		void setText( const std::string& text );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Zeichnet den Text in die linke obere Ecke des aktuellen Framebuffers.
+		///
+		/// \param viewportWidth  Breite des Framebuffers in Pixel
+		/// \param viewportHeight Hoehe des Framebuffers in Pixel
+		///
+		////////////////////////////////////////////////////////////
+		void draw( const unsigned int viewportWidth, const unsigned int viewportHeight );
+
+	private:
+		/// \brief Ein Eckpunkt im Format GL_T2F_C4UB_V3F
+		struct Vertex
+		{
+			GLfloat m_U, m_V;
+			GLubyte m_Color[4];
+			GLfloat m_X, m_Y, m_Z;
+		};
+
+		void createAtlas(void);
+
+		void buildVertices(void);
+
+		void addQuad( const float x, const float y, const float width, const float height, const unsigned int slot, const GLubyte* pColor );
+
+		unsigned int m_Scale;				///< Vergroesserung der Zeichen
+		GLuint m_AtlasID;					///< Textur-ID des Font-Atlas
+		std::string m_Text;					///< Angezeigter Text
+		bool m_IsDirty;						///< Muss das Vertex-Array neu aufgebaut werden?
+		std::vector<Vertex> m_Vertices;		///< Hintergrund und Zeichen als Quads
+	};
+};
@@ -0,0 +1,259 @@
+#include "OffscreenContext.h"
+
+namespace DirectLook
+{
+	OffscreenContext::OffscreenContext( const unsigned int width, const unsigned int height )
+		:
+		m_Width( width ),
+		m_Height( height ),
+		m_IsInitialized( false ),
+#ifdef _WIN32
+		m_Window( 0 ),
+		m_DeviceContext( 0 ),
+		m_RenderContext( 0 )
+#elif defined(DIRECTLOOK_OSMESA)
+		m_Context( 0 ),
+		m_pBuffer( 0 )
+#else
+		m_Display( EGL_NO_DISPLAY ),
+		m_Surface( EGL_NO_SURFACE ),
+		m_Context( EGL_NO_CONTEXT )
+#endif
+	{
+	}
+
+	OffscreenContext::~OffscreenContext(void)
+	{
+		destroy();
+	}
+
+#ifdef _WIN32
+#pragma region WGL
+	bool OffscreenContext::create(void)
+	{
+		if(m_IsInitialized)
+		{
+			return true;
+		}
+
+		// A pixel format can only be chosen for a window, so create one that is never shown
+		WNDCLASS windowClass;
+		ZeroMemory( &windowClass, sizeof( windowClass ) );
+		windowClass.style = CS_OWNDC;
+		windowClass.lpfnWndProc = DefWindowProc;
+		windowClass.hInstance = GetModuleHandle( 0 );
+		windowClass.lpszClassName = TEXT( "DirectLookOffscreen" );
+		RegisterClass( &windowClass );
+
+		m_Window = CreateWindow( TEXT( "DirectLookOffscreen" ), TEXT( "DirectLook" ), WS_OVERLAPPEDWINDOW,
+			0, 0, m_Width, m_Height, 0, 0, windowClass.hInstance, 0 );
+		if(!m_Window)
+		{
+			std::cerr << "Offscreen context: CreateWindow failed" << std::endl;
+			return false;
+		}
+
+		m_DeviceContext = GetDC( m_Window );
+
+		PIXELFORMATDESCRIPTOR pfd;
+		ZeroMemory( &pfd, sizeof( pfd ) );
+		pfd.nSize = sizeof( pfd );
+		pfd.nVersion = 1;
+		pfd.dwFlags = PFD_DRAW_TO_WINDOW | PFD_SUPPORT_OPENGL;
+		pfd.iPixelType = PFD_TYPE_RGBA;
+		pfd.cColorBits = 24;
+		pfd.cDepthBits = 24;
+		pfd.iLayerType = PFD_MAIN_PLANE;
+
+		int pixelFormat = ChoosePixelFormat( m_DeviceContext, &pfd );
+		if(pixelFormat == 0 || !SetPixelFormat( m_DeviceContext, pixelFormat, &pfd ))
+		{
+			std::cerr << "Offscreen context: no suitable pixel format" << std::endl;
+			destroy();
+			return false;
+		}
+
+		m_RenderContext = wglCreateContext( m_DeviceContext );
+		if(!m_RenderContext)
+		{
+			std::cerr << "Offscreen context: wglCreateContext failed" << std::endl;
+			destroy();
+			return false;
+		}
+
+		m_IsInitialized = true;
+		return makeCurrent();
+	}
+
+	bool OffscreenContext::makeCurrent(void)
+	{
+		return m_IsInitialized && wglMakeCurrent( m_DeviceContext, m_RenderContext ) == TRUE;
+	}
+
+	void OffscreenContext::destroy(void)
+	{
+		if(m_RenderContext)
+		{
+			wglMakeCurrent( 0, 0 );
+			wglDeleteContext( m_RenderContext );
+			m_RenderContext = 0;
+		}
+
+		if(m_DeviceContext)
+		{
+			ReleaseDC( m_Window, m_DeviceContext );
+			m_DeviceContext = 0;
+		}
+
+		if(m_Window)
+		{
+			DestroyWindow( m_Window );
+			m_Window = 0;
+		}
+
+		m_IsInitialized = false;
+	}
+#pragma endregion
+#elif defined(DIRECTLOOK_OSMESA)
+#pragma region OSMesa
+	bool OffscreenContext::create(void)
+	{
+		if(m_IsInitialized)
+		{
+			return true;
+		}
+
+		m_Context = OSMesaCreateContextExt( OSMESA_RGBA, 24, 0, 0, 0 );
+		if(!m_Context)
+		{
+			std::cerr << "Offscreen context: OSMesaCreateContextExt failed" << std::endl;
+			return false;
+		}
+
+		m_pBuffer = new unsigned char[m_Width * m_Height * 4];
+		m_IsInitialized = true;
+
+		if(!makeCurrent())
+		{
+			std::cerr << "Offscreen context: OSMesaMakeCurrent failed" << std::endl;
+			destroy();
+			return false;
+		}
+		return true;
+	}
+
+	bool OffscreenContext::makeCurrent(void)
+	{
+		return m_IsInitialized && OSMesaMakeCurrent( m_Context, m_pBuffer, GL_UNSIGNED_BYTE, m_Width, m_Height ) == GL_TRUE;
+	}
+
+	void OffscreenContext::destroy(void)
+	{
+		if(m_Context)
+		{
+			OSMesaDestroyContext( m_Context );
+			m_Context = 0;
+		}
+
+		if(m_pBuffer)
+		{
+			delete[] m_pBuffer;
+			m_pBuffer = 0;
+		}
+
+		m_IsInitialized = false;
+	}
+#pragma endregion
+#else
+#pragma region EGL
+	bool OffscreenContext::create(void)
+	{
+		if(m_IsInitialized)
+		{
+			return true;
+		}
+
+		m_Display = eglGetDisplay( EGL_DEFAULT_DISPLAY );
+		if(m_Display == EGL_NO_DISPLAY || !eglInitialize( m_Display, 0, 0 ))
+		{
+			std::cerr << "Offscreen context: no EGL display" << std::endl;
+			m_Display = EGL_NO_DISPLAY;
+			return false;
+		}
+
+		const EGLint configAttributes[] =
+		{
+			EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+			EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+			EGL_RED_SIZE, 8,
+			EGL_GREEN_SIZE, 8,
+			EGL_BLUE_SIZE, 8,
+			EGL_DEPTH_SIZE, 24,
+			EGL_NONE
+		};
+
+		EGLConfig config;
+		EGLint nConfigs = 0;
+		if(!eglChooseConfig( m_Display, configAttributes, &config, 1, &nConfigs ) || nConfigs == 0)
+		{
+			std::cerr << "Offscreen context: no suitable EGL config" << std::endl;
+			destroy();
+			return false;
+		}
+
+		const EGLint surfaceAttributes[] =
+		{
+			EGL_WIDTH, (EGLint) m_Width,
+			EGL_HEIGHT, (EGLint) m_Height,
+			EGL_NONE
+		};
+
+		m_Surface = eglCreatePbufferSurface( m_Display, config, surfaceAttributes );
+
+		// The scene uses desktop GL 2.0, not GLES
+		eglBindAPI( EGL_OPENGL_API );
+		m_Context = eglCreateContext( m_Display, config, EGL_NO_CONTEXT, 0 );
+
+		if(m_Surface == EGL_NO_SURFACE || m_Context == EGL_NO_CONTEXT)
+		{
+			std::cerr << "Offscreen context: eglCreateContext failed (0x" << std::hex << eglGetError() << std::dec << ")" << std::endl;
+			destroy();
+			return false;
+		}
+
+		m_IsInitialized = true;
+		return makeCurrent();
+	}
+
+	bool OffscreenContext::makeCurrent(void)
+	{
+		return m_IsInitialized && eglMakeCurrent( m_Display, m_Surface, m_Surface, m_Context ) == EGL_TRUE;
+	}
+
+	void OffscreenContext::destroy(void)
+	{
+		if(m_Display != EGL_NO_DISPLAY)
+		{
+			eglMakeCurrent( m_Display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT );
+
+			if(m_Context != EGL_NO_CONTEXT)
+			{
+				eglDestroyContext( m_Display, m_Context );
+				m_Context = EGL_NO_CONTEXT;
+			}
+
+			if(m_Surface != EGL_NO_SURFACE)
+			{
+				eglDestroySurface( m_Display, m_Surface );
+				m_Surface = EGL_NO_SURFACE;
+			}
+
+			eglTerminate( m_Display );
+			m_Display = EGL_NO_DISPLAY;
+		}
+
+		m_IsInitialized = false;
+	}
+#pragma endregion
+#endif
+};
@@ -0,0 +1,91 @@
+#pragma once
+
+#ifdef _WIN32
+#include <Windows.h>
+#elif defined(DIRECTLOOK_OSMESA)
+#include <GL/osmesa.h>
+#else
+#include <EGL/egl.h>
+#endif
+
+#include <iostream>
+
+#include "../NonCopyable.h"
+
+namespace DirectLook
+{
+	/// \brief Die Klasse OffscreenContext erzeugt einen OpenGL-Kontext ohne sichtbares Fenster.
+	///
+	/// Gerendert wird ausschliesslich in Frame-Buffer-Objects (siehe RenderTarget), der Standard-Framebuffer
+	/// des Kontextes wird daher nur minimal angelegt. Backends:
+	/// - Windows: verstecktes Fenster mit WGL-Kontext
+	/// - DIRECTLOOK_OSMESA definiert: OSMesa Software-Renderer
+	/// - sonst: EGL Pbuffer-Surface
+	class OffscreenContext : public NonCopyable
+	{
+
+	private:
+		unsigned int m_Width;			///< Breite des Standard-Framebuffers
+		unsigned int m_Height;			///< Hoehe des Standard-Framebuffers
+		bool m_IsInitialized;			///< Wurde der Kontext erfolgreich erzeugt?
+
+#ifdef _WIN32
+		HWND m_Window;					///< Verstecktes Fenster
+		HDC m_DeviceContext;			///< Device-Context des Fensters
+		HGLRC m_RenderContext;			///< WGL-Kontext
+#elif defined(DIRECTLOOK_OSMESA)
+		OSMesaContext m_Context;		///< OSMesa-Kontext
+		unsigned char* m_pBuffer;		///< Farbpuffer des Standard-Framebuffers
+#else
+		EGLDisplay m_Display;			///< EGL-Display
+		EGLSurface m_Surface;			///< Pbuffer-Surface
+		EGLContext m_Context;			///< EGL-Kontext
+#endif
+
+	public:
+		////////////////////////////////////////////////////////////
+		/// \brief Konstruktor
+		///
+		/// Erzeugt ein noch nicht initialisiertes OffscreenContext-Objekt.
+		///
+		/// \param width  Breite des Standard-Framebuffers
+		/// \param height Hoehe des Standard-Framebuffers
+		///
+		////////////////////////////////////////////////////////////
+		OffscreenContext( const unsigned int width = 1, const unsigned int height = 1 );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Destruktor
+		///
+		/// Gibt den OpenGL-Kontext wieder frei.
+		///
+		////////////////////////////////////////////////////////////
+		~OffscreenContext(void);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Erzeugt den OpenGL-Kontext und macht ihn zum aktuellen Kontext des Threads.
+		///
+		/// \return True wenn erfolgreich, false wenn fehlgeschlagen
+		///
+		////////////////////////////////////////////////////////////
+		bool create(void);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Macht den OpenGL-Kontext zum aktuellen Kontext des Threads.
+		///
+		/// \return True wenn erfolgreich, false wenn fehlgeschlagen
+		///
+		////////////////////////////////////////////////////////////
+		bool makeCurrent(void);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Gibt den OpenGL-Kontext frei.
+		////////////////////////////////////////////////////////////
+		void destroy(void);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert true zurueck wenn der Kontext erfolgreich erzeugt wurde.
+		////////////////////////////////////////////////////////////
+		bool isInitialized(void) const { return m_IsInitialized; }
+	};
+};
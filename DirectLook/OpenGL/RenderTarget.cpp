@@ -1,16 +1,22 @@
 #include "RenderTarget.h"
+#include "../Core/Trace.h"
 
 namespace DirectLook
 {
-	RenderTarget::RenderTarget( unsigned int width, unsigned int height )
+	// Smallest edge of the last level, smaller thumbnails aren't worth a readback
+	static const unsigned int MIN_LEVEL_SIZE = 16;
+
+	RenderTarget::RenderTarget( unsigned int width, unsigned int height, unsigned int levels )
 		:
 		m_FrameBufferID( 0 ),
 		m_RenderBufferID( 0 ),
 		m_TextureID( 0 ),
 		m_Width( width ),
 		m_Height( height ),
+		m_Levels( levels < 1 ? 1 : (levels > getMaxLevels( width, height ) ? getMaxLevels( width, height ) : levels) ),
 		m_IsInitialized( false ),
-		m_pPixels( new GLubyte[width * height * 3] )
+		m_pPixels( new GLubyte[width * height * 3] ),
+		m_ReadbackTimer( "readback" )
 	{
 		initialize();
 	}
@@ -23,47 +29,100 @@ namespace DirectLook
 			m_pPixels = 0;
 		}
 
-		glDeleteFramebuffersEXT( GL_FRAMEBUFFER_EXT, &m_FrameBufferID );
+		glDeleteFramebuffersEXT( 1, &m_FrameBufferID );
+		glDeleteRenderbuffersEXT( 1, &m_RenderBufferID );
+		glDeleteTextures( 1, &m_TextureID );
+	}
+
+	unsigned int RenderTarget::getWidth( const unsigned int level ) const
+	{
+		const unsigned int width = m_Width >> level;
+		return width > 0 ? width : 1;
+	}
+
+	unsigned int RenderTarget::getHeight( const unsigned int level ) const
+	{
+		const unsigned int height = m_Height >> level;
+		return height > 0 ? height : 1;
+	}
+
+	unsigned int RenderTarget::getMaxLevels( const unsigned int width, const unsigned int height )
+	{
+		unsigned int levels = 1;
+		while((width >> levels) >= MIN_LEVEL_SIZE && (height >> levels) >= MIN_LEVEL_SIZE)
+		{
+			levels++;
+		}
+		return levels;
 	}
 
-	void RenderTarget::enable(void)
+	void RenderTarget::enable( const bool clear )
 	{
 		glBindFramebufferEXT( GL_FRAMEBUFFER_EXT, m_FrameBufferID );
 		glPushAttrib( GL_VIEWPORT_BIT );
 		glViewport( 0, 0, m_Width, m_Height );
-		glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
+		if(clear)
+		{
+			glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
+		}
 	}
 
-	void RenderTarget::disable(void)
+	void RenderTarget::disable( const bool buildLevels )
 	{
 		glPopAttrib();
 		glBindFramebufferEXT( GL_FRAMEBUFFER_EXT, 0 );
+
+		if(buildLevels)
+		{
+			this->buildLevels();
+		}
+	}
+
+	void RenderTarget::buildLevels(void)
+	{
+		// Box-filter every level from the one above, entirely on the GPU
+		if(m_Levels > 1)
+		{
+			glBindTexture( GL_TEXTURE_2D, m_TextureID );
+			glGenerateMipmapEXT( GL_TEXTURE_2D );
+			glBindTexture( GL_TEXTURE_2D, 0 );
+		}
 	}
 
 	GLubyte* RenderTarget::getPixels(void)
 	{
+		DL_TRACE_SCOPE( "RenderTarget::getPixels" );
 		if(!m_pPixels)
 		{
 			m_pPixels = new GLubyte[m_Width * m_Height * 3];
 		}
 
-		// Read texture raw data from frame buffer object and save it in pPixels
-		glBindTexture( GL_TEXTURE_2D, m_TextureID );
-		glGetTexImage( GL_TEXTURE_2D, 0, GL_RGB, GL_UNSIGNED_BYTE, m_pPixels );
-
+		readPixels( m_pPixels, GL_RGB, 0 );
 		return m_pPixels;
 	}
 
-	bool RenderTarget::getPixels(GLubyte* pBuffer, const unsigned int size, GLint format)
+	bool RenderTarget::getPixels(GLubyte* pBuffer, const unsigned int size, GLint format, const unsigned int level)
 	{
-		if(size < m_Width * m_Height * (24 / 8))
-			return false; //Too small buffer
+		DL_TRACE_SCOPE( "RenderTarget::getPixels" );
+		if(level >= m_Levels || size < getWidth( level ) * getHeight( level ) * (24 / 8))
+			return false; //Too small buffer or no such level
+
+		readPixels( pBuffer, format, level );
+		return true;
+	}
 
-		// Read texture raw data from frame buffer object and save it in pPixels
+	void RenderTarget::readPixels( GLubyte* pTarget, const GLenum format, const unsigned int level )
+	{
 		glBindTexture( GL_TEXTURE_2D, m_TextureID );
-		glGetTexImage( GL_TEXTURE_2D, 0, format, GL_UNSIGNED_BYTE, pBuffer );
 
-		return true;
+		// Rows are packed, widths that aren't a multiple of 4 bytes would be padded otherwise
+		glPixelStorei( GL_PACK_ALIGNMENT, 1 );
+
+		// Read texture raw data from frame buffer object and save it in pTarget
+		m_ReadbackTimer.begin();
+		glGetTexImage( GL_TEXTURE_2D, (GLint) level, format, GL_UNSIGNED_BYTE, pTarget );
+		m_ReadbackTimer.end();
+		glPixelStorei( GL_PACK_ALIGNMENT, 4 );
 	}
 
 	void RenderTarget::initialize(void)
@@ -86,6 +145,11 @@ namespace DirectLook
 			glTexParameteri( GL_TEXTURE_2D,GL_TEXTURE_MAG_FILTER, GL_NEAREST );
 			glTexParameteri( GL_TEXTURE_2D,GL_TEXTURE_MIN_FILTER, GL_NEAREST );
 			glTexImage2D( GL_TEXTURE_2D, 0, GL_RGB,  m_Width, m_Height, 0, GL_RGB, GL_UNSIGNED_BYTE, 0 );
+			if(m_Levels > 1)
+			{
+				// glGenerateMipmapEXT only builds the levels that are read back
+				glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, m_Levels - 1 );
+			}
 			glFramebufferTexture2DEXT( GL_FRAMEBUFFER_EXT, GL_COLOR_ATTACHMENT0_EXT, GL_TEXTURE_2D, m_TextureID, 0 );
 		
 			// Check frame buffer object
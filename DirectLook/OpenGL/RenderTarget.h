@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../NonCopyable.h"
+#include "GpuTimer.h"
 
 #include <GL/glew.h>
 #include <iostream>
@@ -8,6 +9,10 @@
 namespace DirectLook
 {
 	/// \brief Die Klasse Render-Target dient zum rendern einer 3D-Szene in eine RGB-Textur. 
+	///
+	/// Mit mehr als einer Stufe wird nach jedem Rendern eine Verkleinerungskette (Mipmaps) auf der GPU
+	/// erzeugt. Jede Stufe hat die halbe Breite und Hoehe der vorigen und kann einzeln ausgelesen werden,
+	/// so entstehen z.B. Vorschaubilder aus demselben Rendering ohne Skalierung auf der CPU.
 	class RenderTarget : NonCopyable
 	{
 
@@ -17,8 +22,10 @@ namespace DirectLook
 		GLuint m_TextureID;			///< Render-Target OpenGL Textur ID
 		unsigned int m_Width;		///< Breite des Render-Targets
 		unsigned int m_Height;		///< Hoehe des Render-Targets
+		unsigned int m_Levels;		///< Stufen der Verkleinerungskette (1 = nur volle Aufloesung)
 		bool m_IsInitialized;		///< Wurde das Render-Target ?
 		GLubyte* m_pPixels;			///< Die RGB-Textur-Buffer des Render-Target
+		GpuTimer m_ReadbackTimer;	///< GPU-Zeit des Auslesens
 
 	public:
 		////////////////////////////////////////////////////////////
@@ -28,9 +35,10 @@ namespace DirectLook
 		///
 		/// \param width  Breite des Render-Targets
 		/// \param height Hoehe des Render-Targets
+		/// \param levels Stufen der Verkleinerungskette (1 = keine, wird auf getMaxLevels() begrenzt)
 		///
 		////////////////////////////////////////////////////////////
-		RenderTarget( unsigned int width, unsigned int height );
+		RenderTarget( unsigned int width, unsigned int height, unsigned int levels = 1 );
 
 		////////////////////////////////////////////////////////////
 		/// \brief Destruktor
@@ -42,13 +50,48 @@ namespace DirectLook
 
 		////////////////////////////////////////////////////////////
 		/// \brief Aktiviert das Render-Target-Objekt.
+		///
+		/// \param clear Farb- und Tiefenpuffer loeschen? False fuer einen weiteren Durchgang in dasselbe Bild.
+		///
 		////////////////////////////////////////////////////////////
-		void enable(void);
+		void enable( const bool clear = true );
 
 		////////////////////////////////////////////////////////////
 		/// \brief Deaktiviert das Render-Target-Objekt.
+		///
+		/// \param buildLevels Verkleinerungskette erzeugen? False, wenn noch ein Durchgang folgt oder
+		///                    Texturen gebunden bleiben muessen, dann spaeter buildLevels() aufrufen.
+		///
+		////////////////////////////////////////////////////////////
+		void disable( const bool buildLevels = true );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Erzeugt die Verkleinerungskette aus Stufe 0 (ohne Wirkung bei nur einer Stufe).
+		///
+		/// Bindet dazu die Textur an die aktive Textureinheit und loest sie danach wieder.
+		///
 		////////////////////////////////////////////////////////////
-		void disable(void);
+		void buildLevels(void);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert die Anzahl der Stufen der Verkleinerungskette zurueck.
+		////////////////////////////////////////////////////////////
+		unsigned int getLevelCount(void) const { return m_Levels; }
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert die Breite einer Stufe zurueck (Stufe 0 = volle Aufloesung).
+		////////////////////////////////////////////////////////////
+		unsigned int getWidth( const unsigned int level = 0 ) const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert die Hoehe einer Stufe zurueck (Stufe 0 = volle Aufloesung).
+		////////////////////////////////////////////////////////////
+		unsigned int getHeight( const unsigned int level = 0 ) const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert die groesste sinnvolle Anzahl Stufen fuer eine Groesse zurueck (kleinste Stufe mindestens 16 Pixel).
+		////////////////////////////////////////////////////////////
+		static unsigned int getMaxLevels( const unsigned int width, const unsigned int height );
 
 		////////////////////////////////////////////////////////////
 		/// \brief Liefert einen RGB-Textur-Buffer mit der Groesse des Render-Targets zurueck.
@@ -66,10 +109,16 @@ namespace DirectLook
 		/// \param buffer  Zeiger auf den zu beschreibenden Puffer
 		/// \param size    Groesse des zu beschreibenden Puffer
 		/// \param format  Zu schreibendes Pixelformat. GL_RGB und GL_BGR sind moegliche Parameter.
+		/// \param level   Stufe der Verkleinerungskette, der Puffer braucht getWidth( level ) * getHeight( level ) * 3 Byte
 		/// \return        True wenn erfolgreich, false wenn fehlgeschlagen
 		///
 		////////////////////////////////////////////////////////////
-		bool getPixels(GLubyte* pBuffer, const unsigned int size, GLint format);
+		bool getPixels(GLubyte* pBuffer, const unsigned int size, GLint format, const unsigned int level = 0);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert den GpuTimer des Auslesens zurueck.
+		////////////////////////////////////////////////////////////
+		GpuTimer& getReadbackTimer(void) { return m_ReadbackTimer; }
 
 	private:
 		////////////////////////////////////////////////////////////
@@ -81,5 +130,10 @@ namespace DirectLook
 		/// \brief ueberprueft das OpenGL Frame-Buffer-Objekt bei der Initialisierung auf Fehler.
 		////////////////////////////////////////////////////////////
 		void checkFrameBufferObject(void);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liest die Textur im eingestellten Format aus und schreibt sie als RGB bzw. BGR nach "pTarget".
+		////////////////////////////////////////////////////////////
+		void readPixels( GLubyte* pTarget, const GLenum format, const unsigned int level );
 	};
 };
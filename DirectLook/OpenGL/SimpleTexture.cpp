@@ -46,21 +46,7 @@ namespace DirectLook
 		if(!m_IsInitialized)
 		{
 			// Create and initialize the texture object
-			const unsigned int bufferSize = m_Width * m_Height * 3;
-			GLubyte* pData = new GLubyte[bufferSize];
-			for(unsigned int i = 0; i < bufferSize; i += 3)
-			{
-				pData[i]	 = 0;
-				pData[i + 1] = 0;
-				pData[i + 2] = 0;
-			}
-			m_pTexture = new TextureObject( m_Width, m_Height, 0,
-				GL_RGB,	// External texture color format
-				GL_RGB,	// Internal texture color format
-				0, GL_TEXTURE_2D, GL_UNSIGNED_BYTE
-			);
-			m_pTexture->generateTexture( pData );
-			delete[] pData;
+			createTexture();
 
 			// Create and initialize the vertex buffer object
 			GLfloat vertices[8] =
@@ -109,8 +95,51 @@ namespace DirectLook
 	
 	void SimpleTexture::update( const GLubyte* pPixels )
 	{
+		// Rows of the render target are packed, any output width is allowed
+		glPixelStorei( GL_UNPACK_ALIGNMENT, 1 );
+
 		// Update texture object
 		m_pTexture->updateTexture( pPixels );
+
+		glPixelStorei( GL_UNPACK_ALIGNMENT, 4 );
+	}
+
+	void SimpleTexture::resize( const unsigned short width, const unsigned short height )
+	{
+		if(width == m_Width && height == m_Height)
+		{
+			return;
+		}
+
+		m_Width = width;
+		m_Height = height;
+		if(m_IsInitialized)
+		{
+			if(m_pTexture){ delete m_pTexture; m_pTexture = 0; }
+			createTexture();
+		}
+	}
+
+	void SimpleTexture::createTexture(void)
+	{
+		const unsigned int bufferSize = m_Width * m_Height * 3;
+		GLubyte* pData = new GLubyte[bufferSize];
+		for(unsigned int i = 0; i < bufferSize; i += 3)
+		{
+			pData[i]	 = 0;
+			pData[i + 1] = 0;
+			pData[i + 2] = 0;
+		}
+		m_pTexture = new TextureObject( m_Width, m_Height, 0,
+			GL_RGB,	// External texture color format
+			GL_RGB,	// Internal texture color format
+			0, GL_TEXTURE_2D, GL_UNSIGNED_BYTE
+		);
+
+		glPixelStorei( GL_UNPACK_ALIGNMENT, 1 );
+		m_pTexture->generateTexture( pData );
+		glPixelStorei( GL_UNPACK_ALIGNMENT, 4 );
+		delete[] pData;
 	}
 	
 	void SimpleTexture::draw(void)
@@ -67,9 +67,27 @@ namespace DirectLook
 		////////////////////////////////////////////////////////////
 		void update( const GLubyte* pPixels );
 
+		////////////////////////////////////////////////////////////
+		/// \brief Aendert die Texturgroesse, z.B. nach GLScene::setOutputSize().
+		///
+		/// Die Textur wird mit der neuen Groesse neu angelegt. Gezeichnet wird immer fensterfuellend,
+		/// die Skalierung auf die Fenstergroesse uebernimmt die GPU.
+		///
+		/// \param width  Texturbreite
+		/// \param height Texturhoehe
+		///
+		////////////////////////////////////////////////////////////
+		void resize( const unsigned short width, const unsigned short height );
+
 		////////////////////////////////////////////////////////////
 		/// \brief Zeichnet das SimpleTexture-Objekt.
 		////////////////////////////////////////////////////////////
 		void draw(void);
+
+	private:
+		////////////////////////////////////////////////////////////
+		/// \brief Legt die schwarze Textur in der aktuellen Groesse an.
+		////////////////////////////////////////////////////////////
+		void createTexture(void);
 	};
 }
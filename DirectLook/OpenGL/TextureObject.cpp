@@ -1,4 +1,5 @@
 #include "TextureObject.h"
+#include "../Core/Trace.h"
 
 namespace DirectLook
 {
@@ -278,6 +279,7 @@ namespace DirectLook
 
 	void TextureObject::updateTexture( const void* pPixels )
 	{
+		DL_TRACE_SCOPE( "TextureObject::updateTexture" );
 		if(pPixels && m_ID > 0)
 		{
 			glBindTexture( m_Target, m_ID );
@@ -303,6 +305,33 @@ namespace DirectLook
 		}
 	}
 
+	void TextureObject::updateSubTexture( const void* pPixels, const GLint x, const GLint y, const GLsizei width, const GLsizei height )
+	{
+		DL_TRACE_SCOPE( "TextureObject::updateSubTexture" );
+		if(pPixels && m_ID > 0 && width > 0 && height > 0)
+		{
+			glBindTexture( m_Target, m_ID );
+
+			// Let the driver pick the rectangle out of the full image instead of packing it first
+			glPixelStorei( GL_UNPACK_ALIGNMENT, 1 );
+			glPixelStorei( GL_UNPACK_ROW_LENGTH, m_Width );
+			glPixelStorei( GL_UNPACK_SKIP_PIXELS, x );
+			glPixelStorei( GL_UNPACK_SKIP_ROWS, y );
+
+			glTexSubImage2D(
+				m_Target, m_Level,				/* target, level */
+				x, y, width, height,			/* offset and size of the rectangle */
+				m_ExternalFormat, m_Type,		/* external format, type */
+				pPixels							/* pixels */
+			);
+
+			glPixelStorei( GL_UNPACK_SKIP_ROWS, 0 );
+			glPixelStorei( GL_UNPACK_SKIP_PIXELS, 0 );
+			glPixelStorei( GL_UNPACK_ROW_LENGTH, 0 );
+			glPixelStorei( GL_UNPACK_ALIGNMENT, 4 );
+		}
+	}
+
 	void TextureObject::deleteTexture(void)
 	{
 		if(m_ID > 0)
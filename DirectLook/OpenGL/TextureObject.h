@@ -236,6 +236,18 @@ namespace DirectLook
 		///
 		////////////////////////////////////////////////////////////
 		void updateTexture( const void* pPixels );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Aktualisiert nur einen rechteckigen Ausschnitt der Texturdaten im Videospeicher.
+		///
+		/// \param pPixels Texturdaten der ganzen Textur (Breite x Hoehe), gelesen wird nur der Ausschnitt
+		/// \param x       Erste Spalte des Ausschnitts
+		/// \param y       Erste Zeile des Ausschnitts
+		/// \param width   Breite des Ausschnitts
+		/// \param height  Hoehe des Ausschnitts
+		///
+		////////////////////////////////////////////////////////////
+		void updateSubTexture( const void* pPixels, const GLint x, const GLint y, const GLsizei width, const GLsizei height );
 		
 		////////////////////////////////////////////////////////////
 		/// \brief Loescht die Texturdaten aus dem Videospeicher der Grafikkarte.
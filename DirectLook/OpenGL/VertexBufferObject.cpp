@@ -52,6 +52,16 @@ namespace DirectLook
 		}
 	}
 
+	void VertexBufferObject::updateSubBuffer( const void* pBufferData, const GLsizei firstElement, const GLsizei elementCount )
+	{
+		if(pBufferData && m_ID > 0 && elementCount > 0 && (firstElement + elementCount) * m_Length <= m_Size)
+		{
+			const GLsizeiptr offset = sizeof( GLfloat ) * firstElement * m_Length;
+			glBindBuffer( m_Target, m_ID );
+			glBufferSubData( m_Target, offset, sizeof( GLfloat ) * elementCount * m_Length, static_cast<const GLubyte*>( pBufferData ) + offset );
+		}
+	}
+
 	void VertexBufferObject::deleteBuffer(void)
 	{
 		if(m_ID > 0)
@@ -80,6 +80,16 @@ namespace DirectLook
 		////////////////////////////////////////////////////////////
 		void updateBuffer( const void* pBufferData );
 
+		////////////////////////////////////////////////////////////
+		/// \brief Aktualisiert nur die Bufferelemente "firstElement" bis "firstElement + elementCount - 1".
+		///
+		/// \param pBufferData  Daten des ganzen Vertex-Buffers, gelesen wird nur der Bereich
+		/// \param firstElement Erstes zu aktualisierendes Bufferelement
+		/// \param elementCount Anzahl der Bufferelemente
+		///
+		////////////////////////////////////////////////////////////
+		void updateSubBuffer( const void* pBufferData, const GLsizei firstElement, const GLsizei elementCount );
+
 		////////////////////////////////////////////////////////////
 		/// \brief Loescht die Vertex-Buffer-Daten aus dem Videospeicher der Grafikkarte.
 		/// Die Methode wird im Destruktor aufgerufen.
@@ -3,15 +3,25 @@
 #include "../NonCopyable.h"
 #include "../Image/DepthImage.h"
 #include "../Image/RGBImage.h"
+#include "../Image/FrameHandle.h"
 #include "AudioStream.h"
 
 namespace DirectLook
 {
+	class GLScene;
+
 	/// \brief Die Schnittstelle Sensor-Interface repraesentiert eine abstrakte Treiberschnittstelle zur Sensor-Hardware.
 	class ISensorInterface : public NonCopyable 
 	{
 
 	public:
+		////////////////////////////////////////////////////////////
+		/// \brief Virtueller Destruktor
+		////////////////////////////////////////////////////////////
+		virtual ~ISensorInterface(void)
+		{
+		}
+
 		////////////////////////////////////////////////////////////
 		/// \brief Stellt eine Verbindung zur Sensor-Hardware her.
 		////////////////////////////////////////////////////////////
@@ -57,6 +67,67 @@ namespace DirectLook
 		/// 
 		////////////////////////////////////////////////////////////
 		virtual void controlMotor( const double angle ) = 0;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Wartet auf das naechste Bildpaar (RGB-Bild und Tiefenkarte) der Sensor-Hardware.
+		///
+		/// Die Bilddaten sind danach ueber getImageFrame() und getDepthFrame() erreichbar.
+		///
+		/// \return True wenn ein neues Bildpaar vorliegt, false am Ende einer Aufnahme oder bei einem Fehler
+		///
+		////////////////////////////////////////////////////////////
+		virtual bool grabFrame(void) = 0;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert die RGB-Werte des zuletzt mit grabFrame() gelesenen Bildpaares ohne Kopie zurueck.
+		///
+		/// Das Handle kann auf den Puffer des Treibers verweisen und ist dann nur bis zum naechsten
+		/// grabFrame() gueltig (siehe FrameHandle::detach()).
+		///
+		/// \return RGB-Werte (Breite x Hoehe x 3)
+		///
+		////////////////////////////////////////////////////////////
+		virtual ImageFrame getImageFrame(void) = 0;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert die Tiefenwerte des zuletzt mit grabFrame() gelesenen Bildpaares ohne Kopie zurueck.
+		///
+		/// Es gelten dieselben Regeln wie fuer getImageFrame().
+		///
+		/// \return Tiefenwerte in der Einheit Millimeter (Breite x Hoehe)
+		///
+		////////////////////////////////////////////////////////////
+		virtual DepthFrame getDepthFrame(void) = 0;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liest das naechste Bildpaar und aktualisiert damit die Kamera- und Tiefenwerte des GLScene-Objektes.
+		///
+		/// \param GLScene 3D-Kopf
+		///
+		/// \return True wenn das GLScene-Objekt aktualisiert wurde, false am Ende einer Aufnahme oder bei einem Fehler
+		///
+		////////////////////////////////////////////////////////////
+		virtual bool getSensorData( GLScene& GLScene ) = 0;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert die Breite der RGB-Kamera Bilder zurueck.
+		////////////////////////////////////////////////////////////
+		virtual unsigned int getCameraWidth(void) const = 0;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert die Hoehe der RGB-Kamera Bilder zurueck.
+		////////////////////////////////////////////////////////////
+		virtual unsigned int getCameraHeight(void) const = 0;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert die Breite der Tiefensensor Bilder zurueck.
+		////////////////////////////////////////////////////////////
+		virtual unsigned int getDepthWidth(void) const = 0;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert die Hoehe der Tiefensensor Bilder zurueck.
+		////////////////////////////////////////////////////////////
+		virtual unsigned int getDepthHeight(void) const = 0;
 	};
 };
 
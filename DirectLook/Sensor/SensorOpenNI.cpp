@@ -1,4 +1,5 @@
 #include "SensorOpenNI.h"
+#include "../Core/Trace.h"
 #include <QMessageBox>
 
 namespace DirectLook 
@@ -8,6 +9,8 @@ namespace DirectLook
 		m_ConfigFlag( false ),
 		m_VideoFlag( true ),
 		m_MirrorMode( false ),
+		m_Repeat( true ),
+		m_PlaybackSpeed( 1.0 ),
 		m_VideoFileName( videoFileName ),
 		m_CameraWidth( 0 ),
 		m_CameraHeight( 0 ),
@@ -15,7 +18,9 @@ namespace DirectLook
 		m_DepthHeight( 0 ),
 		m_ImageMapPixelSize( 0 ),
 		m_DepthMapPixelSize( 0 ),
-		m_Status( 0 )
+		m_Status( 0 ),
+		m_LastDepthFrameID( 0 ),
+		m_DroppedFrames( 0 )
 	{
 	}
 
@@ -24,6 +29,8 @@ namespace DirectLook
 		m_ConfigFlag( true ),
 		m_VideoFlag( false ),
 		m_MirrorMode( mirrorMode ),
+		m_Repeat( true ),
+		m_PlaybackSpeed( 1.0 ),
 		m_ConfigFileName( configFileName ),
 		m_CameraWidth( 0 ),
 		m_CameraHeight( 0 ),
@@ -31,7 +38,9 @@ namespace DirectLook
 		m_DepthHeight( 0 ),
 		m_ImageMapPixelSize( 0 ),
 		m_DepthMapPixelSize( 0 ),
-		m_Status( 0 )
+		m_Status( 0 ),
+		m_LastDepthFrameID( 0 ),
+		m_DroppedFrames( 0 )
 	{
 	}
 
@@ -40,13 +49,17 @@ namespace DirectLook
 		m_ConfigFlag( false ),
 		m_VideoFlag( false ),
 		m_MirrorMode( mirrorMode ),
+		m_Repeat( true ),
+		m_PlaybackSpeed( 1.0 ),
 		m_CameraWidth( width ),
 		m_CameraHeight( height ),
 		m_DepthWidth( width ),
 		m_DepthHeight( height ),
 		m_ImageMapPixelSize( m_CameraWidth * m_CameraHeight * 3 ),
 		m_DepthMapPixelSize( m_DepthWidth * m_DepthHeight ),
-		m_Status( 0 )
+		m_Status( 0 ),
+		m_LastDepthFrameID( 0 ),
+		m_DroppedFrames( 0 )
 	{
 	}
 
@@ -55,13 +68,17 @@ namespace DirectLook
 		m_ConfigFlag( false ),
 		m_VideoFlag( false ),
 		m_MirrorMode( mirrorMode ),
+		m_Repeat( true ),
+		m_PlaybackSpeed( 1.0 ),
 		m_CameraWidth( widthCamera ),
 		m_CameraHeight( heightCamera ),
 		m_DepthWidth( widthDepth ),
 		m_DepthHeight( heightDepth ),
 		m_ImageMapPixelSize( m_CameraWidth * m_CameraHeight * 3 ),
 		m_DepthMapPixelSize( m_DepthWidth * m_DepthHeight ),
-		m_Status( 0 )
+		m_Status( 0 ),
+		m_LastDepthFrameID( 0 ),
+		m_DroppedFrames( 0 )
 	{
 	}
 
@@ -107,6 +124,14 @@ namespace DirectLook
 			}
 			std::cout << std::endl;
 
+			// Apply the playback options of the oni file
+			m_Status = m_Context.FindExistingNode( XN_NODE_TYPE_PLAYER, m_Player );
+			if(printStatus( "Found Player Node in Oni", "Couldn't find Player Node in Oni File" ))
+			{
+				m_Player.SetRepeat( m_Repeat );
+				m_Player.SetPlaybackSpeed( m_PlaybackSpeed );
+			}
+
 			m_Status = m_Context.FindExistingNode( XN_NODE_TYPE_DEPTH, m_DepthGenerator );
 			if(!printStatus( "Found Depth Node in Oni", "Couldn't find Depth Node in Oni File" ))
 			{
@@ -441,8 +466,35 @@ namespace DirectLook
 		return m_DepthMapPixelSize;
 	}
 
-	void SensorOpenNI::getSensorData( GLScene& GLScene )
+	XnUInt32 SensorOpenNI::getFramesPerSecond(void) const
+	{
+		if(!m_DepthGenerator.IsValid())
+		{
+			return 0;
+		}
+
+		XnMapOutputMode depthMapMode;
+		if(m_DepthGenerator.GetMapOutputMode( depthMapMode ) != XN_STATUS_OK)
+		{
+			return 0;
+		}
+		return depthMapMode.nFPS;
+	}
+
+	void SensorOpenNI::setPlayback( const bool repeat, const double speed )
 	{
+		m_Repeat = repeat;
+		m_PlaybackSpeed = (speed < 0.0) ? 0.0 : speed;
+	}
+
+	bool SensorOpenNI::grabFrame(void)
+	{
+		// End of a non repeating oni file reached?
+		if(m_VideoFlag && m_Player.IsValid() && m_Player.IsEOF())
+		{
+			return false;
+		}
+
 		// Offset zwischen den Tiefen- und RGB-Werten korrigieren:
 		m_DepthGenerator.GetAlternativeViewPointCap().SetViewPoint( m_ImageGenerator );
 		//m_ImageGenerator.GetAlternativeViewPointCap().SetViewPoint( m_DepthGenerator );
@@ -450,16 +502,54 @@ namespace DirectLook
 		// Update to next frame
 		m_Status = m_Context.WaitOneUpdateAll( m_ImageGenerator );
 		m_Status = m_Context.WaitOneUpdateAll( m_DepthGenerator );
+		if(m_Status != XN_STATUS_OK)
+		{
+			return false;
+		}
 	
 		// Process the image data
 		m_ImageGenerator.GetMetaData( m_ImageMetaData );
-		const XnUInt8* pImagePixels = m_ImageMetaData.Data();
 		
 		// Process the depth map data
 		m_DepthGenerator.GetMetaData( m_DepthMetaData );
-		const XnDepthPixel* pDepthPixels = m_DepthMetaData.Data();
 
-		// Copy image and depth map raw data to GLScene object
-		GLScene.updateData( pImagePixels, pDepthPixels );
+		// Gaps in the frame IDs are frames the driver produced while we were busy
+		const XnUInt32 frameID = m_DepthMetaData.FrameID();
+		if(m_LastDepthFrameID != 0 && frameID > m_LastDepthFrameID + 1)
+		{
+			m_DroppedFrames += frameID - m_LastDepthFrameID - 1;
+		}
+		m_LastDepthFrameID = frameID;
+
+		return true;
+	}
+
+	ImageFrame SensorOpenNI::getImageFrame(void)
+	{
+		// Wrap the driver buffer, it stays valid until the next update
+		return ImageFrame::wrap( m_ImageMetaData.Data(), m_ImageMetaData.XRes(), m_ImageMetaData.YRes(), 3, m_ImageMetaData.Timestamp() );
+	}
+
+	DepthFrame SensorOpenNI::getDepthFrame(void)
+	{
+		return DepthFrame::wrap( m_DepthMetaData.Data(), m_DepthMetaData.XRes(), m_DepthMetaData.YRes(), 1, m_DepthMetaData.Timestamp() );
+	}
+
+	unsigned long long SensorOpenNI::getDroppedFrames(void) const
+	{
+		return m_DroppedFrames;
+	}
+
+	bool SensorOpenNI::getSensorData( GLScene& GLScene )
+	{
+		DL_TRACE_SCOPE( "SensorOpenNI::getSensorData" );
+		if(!grabFrame())
+		{
+			return false;
+		}
+
+		// Hand the driver buffers to the GLScene object without copying
+		GLScene.updateData( getImageFrame(), getDepthFrame() );
+		return true;
 	}
 }
@@ -119,9 +119,57 @@ namespace DirectLook
 		/// 
 		////////////////////////////////////////////////////////////
 		virtual void controlMotor( const double angle );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Wartet auf das naechste Bildpaar (RGB-Bild und Tiefenkarte) der Sensor-Hardware.
+		///
+		/// \return True wenn ein neues Bildpaar vorliegt, false am Ende einer Oni-Datei ohne Wiederholung oder bei einem Fehler
+		///
+		////////////////////////////////////////////////////////////
+		virtual bool grabFrame(void);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert die RGB-Werte des zuletzt mit grabFrame() gelesenen Bildpaares zurueck.
+		///
+		/// \return Handle auf den Puffer des OpenNI-Treibers (gueltig bis zum naechsten grabFrame())
+		///
+		////////////////////////////////////////////////////////////
+		virtual ImageFrame getImageFrame(void);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert die Tiefenwerte des zuletzt mit grabFrame() gelesenen Bildpaares zurueck.
+		///
+		/// \return Handle auf den Puffer des OpenNI-Treibers (gueltig bis zum naechsten grabFrame())
+		///
+		////////////////////////////////////////////////////////////
+		virtual DepthFrame getDepthFrame(void);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Aktualisiert die Kamera- und Tiefenwerte des GLScene-Objektes.
+		///
+		/// \param GLScene 3D-Kopf
+		///
+		/// \return True wenn das GLScene-Objekt aktualisiert wurde, false am Ende einer Oni-Datei oder bei einem Fehler
+		///
+		////////////////////////////////////////////////////////////
+		virtual bool getSensorData( GLScene& GLScene );
 	
 	
 		/***** SensorOpenNI methods *****/	
+
+		////////////////////////////////////////////////////////////
+		/// \brief Setzt die Wiedergabeoptionen fuer Oni-Dateien. Muss vor connect() aufgerufen werden.
+		///
+		/// \param repeat Soll die Oni-Datei am Ende wieder von vorne abgespielt werden?
+		/// \param speed  Wiedergabegeschwindigkeit (1.0 = Echtzeit, 0.0 = so schnell wie moeglich)
+		///
+		////////////////////////////////////////////////////////////
+		void setPlayback( const bool repeat, const double speed );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert die Anzahl der Tiefenbilder zurueck, die zwischen zwei grabFrame() verloren gingen.
+		////////////////////////////////////////////////////////////
+		unsigned long long getDroppedFrames(void) const;
 	
 		////////////////////////////////////////////////////////////
 		/// \brief Liefert die Breite der RGB-Kamera Bilder zurueck.
@@ -129,7 +177,7 @@ namespace DirectLook
 		/// \return Breite der RGB-Kamera Bilder
 		///
 		////////////////////////////////////////////////////////////
-		XnUInt32 getCameraWidth(void) const;
+		virtual XnUInt32 getCameraWidth(void) const;
 		
 		////////////////////////////////////////////////////////////
 		/// \brief Liefert die Hoehe der RGB-Kamera Bilder zurueck.
@@ -137,7 +185,7 @@ namespace DirectLook
 		/// \return Hoehe der RGB-Kamera Bilder
 		///
 		////////////////////////////////////////////////////////////
-		XnUInt32 getCameraHeight(void) const;
+		virtual XnUInt32 getCameraHeight(void) const;
 		
 		////////////////////////////////////////////////////////////
 		/// \brief Liefert die Breite der Tiefensensor Bilder zurueck.
@@ -145,7 +193,7 @@ namespace DirectLook
 		/// \return Breite der Tiefensensor Bilder
 		///
 		////////////////////////////////////////////////////////////
-		XnUInt32 getDepthWidth(void) const;
+		virtual XnUInt32 getDepthWidth(void) const;
 		
 		////////////////////////////////////////////////////////////
 		/// \brief Liefert die Hoehe der Tiefensensor Bilder zurueck.
@@ -153,7 +201,7 @@ namespace DirectLook
 		/// \return Hoehe der Tiefensensor Bilder
 		///
 		////////////////////////////////////////////////////////////
-		XnUInt32 getDepthHeight(void) const;
+		virtual XnUInt32 getDepthHeight(void) const;
 
 		////////////////////////////////////////////////////////////
 		/// \brief Liefert die Anzahl der RGB-Kamera Pixel zurueck (m_CameraWidth * m_CameraHeight * 3).
@@ -170,15 +218,15 @@ namespace DirectLook
 		///
 		////////////////////////////////////////////////////////////
 		XnUInt32 getDepthMapPixelSize(void) const;
-				
+
 		////////////////////////////////////////////////////////////
-		/// \brief Aktualisiert die Kamera- und Tiefenwerte des GLScene-Objektes.
+		/// \brief Liefert die Bildrate des Tiefensensors zurueck.
 		///
-		/// \param GLScene 3D-Kopf
+		/// \return Bilder pro Sekunde (0, solange keine Verbindung besteht)
 		///
 		////////////////////////////////////////////////////////////
-		void getSensorData(	GLScene& GLScene );
-		
+		XnUInt32 getFramesPerSecond(void) const;
+
 	private:
 		////////////////////////////////////////////////////////////
 		/// \brief Zeigt den aktuellen Treiberstatus in der Konsole an.
@@ -203,6 +251,8 @@ namespace DirectLook
 		const bool m_ConfigFlag;				///< Laedt die Treiber-Einstellungen ueber eine XML-Datei
 		const bool m_VideoFlag;					///< Laedt die OpenNI-Daten ueber eine Oni-Datei
 		const bool m_MirrorMode;				///< Sollen die Bilddaten der RGB-Kamera und des Tiefensensors gespiegelt werden?
+		bool m_Repeat;							///< Oni-Datei am Ende wiederholen?
+		double m_PlaybackSpeed;					///< Wiedergabegeschwindigkeit der Oni-Datei (0.0 = so schnell wie moeglich)
 		std::string m_ConfigFileName;			///< Dateipfad zur XML-Konfigurationsdatei
 		std::string m_VideoFileName;			///< Dateipfad zur OpenNI Videodatei (Oni-Datei)
 	
@@ -213,6 +263,8 @@ namespace DirectLook
 		XnUInt32 m_ImageMapPixelSize;			///< Anzahl der RGB-Kamera Pixel (m_CameraWidth * m_CameraHeight * 3)
 		XnUInt32 m_DepthMapPixelSize;			///< Anzahl der Depth-Map Pixel (m_DepthWidth * m_DepthHeight)
 		XnStatus m_Status;						///< Aktuelle Statusmeldungen
+		XnUInt32 m_LastDepthFrameID;			///< Frame-ID des letzten Tiefenbildes (0 = noch keines)
+		unsigned long long m_DroppedFrames;		///< Verlorene Tiefenbilder, siehe getDroppedFrames()
 	
 		xn::Context m_Context;					///< Kontext-Objekt des OpenNI-Treibers
 		xn::DepthGenerator m_DepthGenerator;	///< Depth-Generator
@@ -221,6 +273,7 @@ namespace DirectLook
 		xn::ImageMetaData m_ImageMetaData;		///< Metadaten der RGB-Kamera
 		xn::AudioGenerator m_AudioGenerator;	///< Audio-Generator
 		xn::AudioMetaData m_AudioMetaData;		///< Metadaten des Audio-Streams
+		xn::Player m_Player;					///< Player der Oni-Datei
 		KinectMotor m_Motor;					///< Ist fuer die Steuerung des Kinect-Motors ueber den OpenNI-Treiber verantwortlich
 	};
 }
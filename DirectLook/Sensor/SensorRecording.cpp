@@ -0,0 +1,290 @@
+#include "SensorRecording.h"
+
+#include <string.h>
+
+namespace DirectLook
+{
+	static unsigned long long getFileSize( FILE* pFile )
+	{
+		// Recordings grow beyond 2 GB quickly, ftell() is 32 bit on Windows
+#ifdef _WIN32
+		_fseeki64( pFile, 0, SEEK_END );
+		const long long size = _ftelli64( pFile );
+#else
+		fseeko( pFile, 0, SEEK_END );
+		const long long size = (long long) ftello( pFile );
+#endif
+		return (size > 0) ? (unsigned long long) size : 0;
+	}
+
+	SensorRecording::SensorRecording( const std::string& fileName, const bool repeat )
+		:
+		m_FileName( fileName ),
+		m_Repeat( repeat ),
+		m_pFile( 0 ),
+		m_FirstFrameOffset( 0 ),
+		m_Timestamp( 0 )
+	{
+		memset( &m_Header, 0, sizeof( m_Header ) );
+	}
+
+	SensorRecording::~SensorRecording(void)
+	{
+		close();
+	}
+
+	bool SensorRecording::connect(void)
+	{
+		close();
+
+		std::cout << "Loading recording: " << m_FileName << std::endl;
+		m_pFile = fopen( m_FileName.c_str(), "rb" );
+		if(!m_pFile)
+		{
+			std::cerr << "Couldn't open recording " << m_FileName << std::endl;
+			return false;
+		}
+
+		if(fread( &m_Header, sizeof( m_Header ), 1, m_pFile ) != 1
+			|| strncmp( m_Header.m_Magic, "DLRC", 4 ) != 0
+			|| m_Header.m_Version != FORMAT_VERSION)
+		{
+			std::cerr << "Not a DirectLook recording: " << m_FileName << std::endl;
+			close();
+			return false;
+		}
+
+		// A corrupt header must not reach the FramePool: sizes of zero or a first frame beyond the end of the file
+		m_FirstFrameOffset = ftell( m_pFile );
+		const unsigned long long frameSize = sizeof( m_Timestamp )
+			+ (unsigned long long) m_Header.m_CameraWidth * m_Header.m_CameraHeight * 3
+			+ (unsigned long long) m_Header.m_DepthWidth * m_Header.m_DepthHeight * sizeof( unsigned short );
+		const unsigned long long fileSize = getFileSize( m_pFile );
+		if(m_Header.m_CameraWidth == 0 || m_Header.m_CameraHeight == 0 || m_Header.m_DepthWidth == 0 || m_Header.m_DepthHeight == 0
+			|| fileSize < (unsigned long long) m_FirstFrameOffset || frameSize > fileSize - (unsigned long long) m_FirstFrameOffset)
+		{
+			std::cerr << "Invalid frame size in recording " << m_FileName << std::endl;
+			close();
+			return false;
+		}
+		fseek( m_pFile, m_FirstFrameOffset, SEEK_SET );
+
+		m_ImageFrame = ImageFrame::allocate( m_Header.m_CameraWidth, m_Header.m_CameraHeight, 3 );
+		m_DepthFrame = DepthFrame::allocate( m_Header.m_DepthWidth, m_Header.m_DepthHeight );
+		if(!m_ImageFrame.getData() || !m_DepthFrame.getData())
+		{
+			std::cerr << "Couldn't allocate the frames of recording " << m_FileName << std::endl;
+			close();
+			return false;
+		}
+		memset( m_ImageFrame.getMutableData(), 0, m_ImageFrame.getSize() );
+		memset( m_DepthFrame.getMutableData(), 0, m_DepthFrame.getSize() * sizeof( unsigned short ) );
+
+		std::cout << "Camera width  : " << m_Header.m_CameraWidth << std::endl;
+		std::cout << "Camera height : " << m_Header.m_CameraHeight << std::endl;
+		std::cout << "Depth width   : " << m_Header.m_DepthWidth << std::endl;
+		std::cout << "Depth height  : " << m_Header.m_DepthHeight << std::endl;
+		std::cout << "FPS           : " << m_Header.m_FramesPerSecond << std::endl;
+		std::cout << std::endl;
+		return true;
+	}
+
+	void SensorRecording::close(void)
+	{
+		if(m_pFile)
+		{
+			fclose( m_pFile );
+			m_pFile = 0;
+		}
+		m_ImageFrame.release();
+		m_DepthFrame.release();
+	}
+
+	void SensorRecording::getSegmentedDepthImage( DepthImage* DepthImage )
+	{
+		// Both images come from the current pair, only grabFrame() advances
+		if(m_DepthFrame.getData())
+		{
+			DepthImage->updateImage( m_DepthFrame.getData() );
+		}
+	}
+
+	void SensorRecording::getRgbMapImage( RGBImage* RGBImage )
+	{
+		if(m_ImageFrame.getData())
+		{
+			RGBImage->updateImage( m_ImageFrame.getData() );
+		}
+	}
+
+	void SensorRecording::getAudioStream( AudioStream* audioStream )
+	{
+	}
+
+	void SensorRecording::controlMotor( const double angle )
+	{
+	}
+
+	bool SensorRecording::grabFrame(void)
+	{
+		if(!m_pFile)
+		{
+			return false;
+		}
+
+		// Frames still referenced elsewhere must not be overwritten, read into new buffers instead
+		if(!m_ImageFrame.isUnique())
+		{
+			m_ImageFrame = ImageFrame::allocate( m_Header.m_CameraWidth, m_Header.m_CameraHeight, 3 );
+		}
+		if(!m_DepthFrame.isUnique())
+		{
+			m_DepthFrame = DepthFrame::allocate( m_Header.m_DepthWidth, m_Header.m_DepthHeight );
+		}
+		if(!m_ImageFrame.getData() || !m_DepthFrame.getData())
+		{
+			return false;
+		}
+
+		const size_t imageSize = m_ImageFrame.getSize();
+		const size_t depthSize = m_DepthFrame.getSize();
+
+		for(int attempt = 0; attempt < 2; attempt++)
+		{
+			if(fread( &m_Timestamp, sizeof( m_Timestamp ), 1, m_pFile ) == 1
+				&& fread( m_ImageFrame.getMutableData(), 1, imageSize, m_pFile ) == imageSize
+				&& fread( m_DepthFrame.getMutableData(), sizeof( unsigned short ), depthSize, m_pFile ) == depthSize)
+			{
+				m_ImageFrame.setTimestamp( m_Timestamp );
+				m_DepthFrame.setTimestamp( m_Timestamp );
+				return true;
+			}
+
+			// End of recording: start again from the first frame or stop
+			if(!m_Repeat)
+			{
+				return false;
+			}
+			fseek( m_pFile, m_FirstFrameOffset, SEEK_SET );
+		}
+
+		// Recording without a single complete frame
+		return false;
+	}
+
+	ImageFrame SensorRecording::getImageFrame(void)
+	{
+		return m_ImageFrame;
+	}
+
+	DepthFrame SensorRecording::getDepthFrame(void)
+	{
+		return m_DepthFrame;
+	}
+
+	bool SensorRecording::getSensorData( GLScene& GLScene )
+	{
+		if(!grabFrame())
+		{
+			return false;
+		}
+
+		GLScene.updateData( m_ImageFrame, m_DepthFrame );
+		return true;
+	}
+
+	unsigned int SensorRecording::getCameraWidth(void) const
+	{
+		return m_Header.m_CameraWidth;
+	}
+
+	unsigned int SensorRecording::getCameraHeight(void) const
+	{
+		return m_Header.m_CameraHeight;
+	}
+
+	unsigned int SensorRecording::getDepthWidth(void) const
+	{
+		return m_Header.m_DepthWidth;
+	}
+
+	unsigned int SensorRecording::getDepthHeight(void) const
+	{
+		return m_Header.m_DepthHeight;
+	}
+
+	unsigned long long SensorRecording::getTimestamp(void) const
+	{
+		return m_Timestamp;
+	}
+
+	unsigned int SensorRecording::getFramesPerSecond(void) const
+	{
+		return m_Header.m_FramesPerSecond;
+	}
+
+	RecordingWriter::RecordingWriter(void)
+		:
+		m_pFile( 0 )
+	{
+		memset( &m_Header, 0, sizeof( m_Header ) );
+	}
+
+	RecordingWriter::~RecordingWriter(void)
+	{
+		close();
+	}
+
+	bool RecordingWriter::open( const std::string& fileName, const unsigned int cameraWidth, const unsigned int cameraHeight, const unsigned int depthWidth, const unsigned int depthHeight, const unsigned int framesPerSecond )
+	{
+		close();
+
+		m_pFile = fopen( fileName.c_str(), "wb" );
+		if(!m_pFile)
+		{
+			std::cerr << "Couldn't create recording " << fileName << std::endl;
+			return false;
+		}
+
+		memcpy( m_Header.m_Magic, "DLRC", 4 );
+		m_Header.m_Version = SensorRecording::FORMAT_VERSION;
+		m_Header.m_CameraWidth = cameraWidth;
+		m_Header.m_CameraHeight = cameraHeight;
+		m_Header.m_DepthWidth = depthWidth;
+		m_Header.m_DepthHeight = depthHeight;
+		m_Header.m_FramesPerSecond = framesPerSecond;
+		m_Header.m_Reserved = 0;
+
+		if(fwrite( &m_Header, sizeof( m_Header ), 1, m_pFile ) != 1)
+		{
+			std::cerr << "Couldn't write recording header " << fileName << std::endl;
+			close();
+			return false;
+		}
+		return true;
+	}
+
+	bool RecordingWriter::writeFrame( const unsigned long long timestamp, const unsigned char* pImagePixels, const unsigned short* pDepthPixels )
+	{
+		if(!m_pFile || !pImagePixels || !pDepthPixels)
+		{
+			return false;
+		}
+
+		const size_t imageSize = m_Header.m_CameraWidth * m_Header.m_CameraHeight * 3;
+		const size_t depthSize = m_Header.m_DepthWidth * m_Header.m_DepthHeight;
+
+		return fwrite( &timestamp, sizeof( timestamp ), 1, m_pFile ) == 1
+			&& fwrite( pImagePixels, 1, imageSize, m_pFile ) == imageSize
+			&& fwrite( pDepthPixels, sizeof( unsigned short ), depthSize, m_pFile ) == depthSize;
+	}
+
+	void RecordingWriter::close(void)
+	{
+		if(m_pFile)
+		{
+			fclose( m_pFile );
+			m_pFile = 0;
+		}
+	}
+}
@@ -0,0 +1,221 @@
+#pragma once
+
+#include "../OpenGL/GLScene.h"
+#include "ISensorInterface.h"
+#include "../NonCopyable.h"
+
+#include <stdio.h>
+#include <string>
+
+namespace DirectLook
+{
+	/// \brief Dateikopf einer DirectLook-Aufnahme (*.dlr).
+	///
+	/// Auf den Dateikopf folgen beliebig viele Bildpaare. Jedes Bildpaar besteht aus einem
+	/// 64 bit Zeitstempel in Mikrosekunden, den RGB-Werten (cameraWidth x cameraHeight x 3 Byte)
+	/// und den Tiefenwerten (depthWidth x depthHeight x 16 bit, Einheit Millimeter).
+	/// Alle Werte werden im Little-Endian-Format gespeichert.
+	struct RecordingHeader
+	{
+		char m_Magic[4];				///< Kennung "DLRC"
+		unsigned int m_Version;			///< Version des Dateiformates
+		unsigned int m_CameraWidth;		///< Breite der RGB-Kamera Bilder
+		unsigned int m_CameraHeight;	///< Hoehe der RGB-Kamera Bilder
+		unsigned int m_DepthWidth;		///< Breite der Tiefensensor Bilder
+		unsigned int m_DepthHeight;		///< Hoehe der Tiefensensor Bilder
+		unsigned int m_FramesPerSecond;	///< Bildrate der Aufnahme
+		unsigned int m_Reserved;		///< Reserviert (0)
+	};
+
+	/// \brief Die Klasse SensorRecording spielt eine DirectLook-Aufnahme (*.dlr) ueber die Sensor-Schnittstelle ab.
+	///
+	/// Damit lassen sich aufgenommene Sitzungen ohne OpenNI-Treiber verarbeiten, z.B. im Batch-Betrieb.
+	class SensorRecording : public ISensorInterface
+	{
+
+	public:
+		static const unsigned int FORMAT_VERSION = 1;	///< Aktuelle Version des Dateiformates
+
+		////////////////////////////////////////////////////////////
+		/// \brief Konstruktor
+		///
+		/// Erzeugt ein neues SensorRecording-Objekt. Die Datei wird erst mit connect() geoeffnet.
+		///
+		/// \param fileName Dateipfad zur DirectLook-Aufnahme
+		/// \param repeat   Soll die Aufnahme am Ende wieder von vorne abgespielt werden?
+		///
+		////////////////////////////////////////////////////////////
+		SensorRecording( const std::string& fileName, const bool repeat = false );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Destruktor
+		////////////////////////////////////////////////////////////
+		virtual ~SensorRecording(void);
+
+		/***** SensorInterface methods *****/
+
+		////////////////////////////////////////////////////////////
+		/// \brief Oeffnet die Aufnahme und liest den Dateikopf.
+		///
+		/// \return True wenn die Datei eine gueltige DirectLook-Aufnahme ist
+		///
+		////////////////////////////////////////////////////////////
+		virtual bool connect(void);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Schliesst die Aufnahme.
+		////////////////////////////////////////////////////////////
+		virtual void close(void);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Kopiert die Tiefenwerte des aktuellen Bildpaares in das Sensor-Image-Objekt (weiter mit grabFrame()).
+		///
+		/// \param DepthImage Sensor-Image-Objekt
+		///
+		////////////////////////////////////////////////////////////
+		virtual void getSegmentedDepthImage( DepthImage* DepthImage );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Kopiert die RGB-Werte des aktuellen Bildpaares in das Camera-Image-Objekt (weiter mit grabFrame()).
+		///
+		/// \param RGBImage Camera-Image-Objekt
+		///
+		////////////////////////////////////////////////////////////
+		virtual void getRgbMapImage( RGBImage* RGBImage );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Aufnahmen enthalten keinen Audio-Stream. Das Audio-Stream-Objekt bleibt unveraendert.
+		///
+		/// \param audioStream Audio-Stream-Objekt
+		///
+		////////////////////////////////////////////////////////////
+		virtual void getAudioStream( AudioStream* audioStream );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Aufnahmen besitzen keinen Motor. Der Aufruf wird ignoriert.
+		///
+		/// \param angle Winkel in der Einheit Grad
+		///
+		////////////////////////////////////////////////////////////
+		virtual void controlMotor( const double angle );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liest das naechste Bildpaar aus der Aufnahme.
+		///
+		/// \return True wenn ein neues Bildpaar vorliegt, false am Ende der Aufnahme ohne Wiederholung oder bei einem Lesefehler
+		///
+		////////////////////////////////////////////////////////////
+		virtual bool grabFrame(void);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert die RGB-Werte des zuletzt gelesenen Bildpaares zurueck.
+		///
+		/// Haelt der Aufrufer das Handle ueber das naechste grabFrame() hinaus, liest die Aufnahme
+		/// in einen neuen Puffer; die Daten des Handles bleiben also gueltig.
+		///
+		////////////////////////////////////////////////////////////
+		virtual ImageFrame getImageFrame(void);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert die Tiefenwerte des zuletzt gelesenen Bildpaares zurueck.
+		////////////////////////////////////////////////////////////
+		virtual DepthFrame getDepthFrame(void);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liest das naechste Bildpaar und aktualisiert damit das GLScene-Objekt.
+		///
+		/// \param GLScene 3D-Kopf
+		///
+		/// \return True wenn das GLScene-Objekt aktualisiert wurde, false am Ende der Aufnahme
+		///
+		////////////////////////////////////////////////////////////
+		virtual bool getSensorData( GLScene& GLScene );
+
+		virtual unsigned int getCameraWidth(void) const;
+
+		virtual unsigned int getCameraHeight(void) const;
+
+		virtual unsigned int getDepthWidth(void) const;
+
+		virtual unsigned int getDepthHeight(void) const;
+
+		/***** SensorRecording methods *****/
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert den Zeitstempel des zuletzt gelesenen Bildpaares in Mikrosekunden zurueck.
+		////////////////////////////////////////////////////////////
+		unsigned long long getTimestamp(void) const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert die Bildrate der Aufnahme zurueck.
+		////////////////////////////////////////////////////////////
+		unsigned int getFramesPerSecond(void) const;
+
+	private:
+		std::string m_FileName;				///< Dateipfad zur Aufnahme
+		bool m_Repeat;						///< Aufnahme am Ende wiederholen?
+		FILE* m_pFile;						///< Geoeffnete Aufnahme
+		long m_FirstFrameOffset;			///< Dateiposition des ersten Bildpaares
+		RecordingHeader m_Header;			///< Dateikopf der Aufnahme
+		unsigned long long m_Timestamp;		///< Zeitstempel des aktuellen Bildpaares
+		ImageFrame m_ImageFrame;			///< RGB-Werte des aktuellen Bildpaares
+		DepthFrame m_DepthFrame;			///< Tiefenwerte des aktuellen Bildpaares
+	};
+
+	/// \brief Die Klasse RecordingWriter schreibt Bildpaare eines Sensors in eine DirectLook-Aufnahme (*.dlr).
+	///
+	/// Die erzeugte Datei kann mit SensorRecording wieder abgespielt werden.
+	class RecordingWriter : public NonCopyable
+	{
+
+	public:
+		////////////////////////////////////////////////////////////
+		/// \brief Konstruktor
+		////////////////////////////////////////////////////////////
+		RecordingWriter(void);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Destruktor
+		///
+		/// Schliesst die Aufnahme.
+		///
+		////////////////////////////////////////////////////////////
+		~RecordingWriter(void);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Legt eine neue Aufnahme an und schreibt den Dateikopf.
+		///
+		/// \param fileName        Dateipfad der Aufnahme
+		/// \param cameraWidth     Breite der RGB-Kamera Bilder
+		/// \param cameraHeight    Hoehe der RGB-Kamera Bilder
+		/// \param depthWidth      Breite der Tiefensensor Bilder
+		/// \param depthHeight     Hoehe der Tiefensensor Bilder
+		/// \param framesPerSecond Bildrate der Aufnahme
+		///
+		/// \return True wenn erfolgreich, false wenn fehlgeschlagen
+		///
+		////////////////////////////////////////////////////////////
+		bool open( const std::string& fileName, const unsigned int cameraWidth, const unsigned int cameraHeight, const unsigned int depthWidth, const unsigned int depthHeight, const unsigned int framesPerSecond );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Haengt ein Bildpaar an die Aufnahme an.
+		///
+		/// \param timestamp    Zeitstempel in Mikrosekunden
+		/// \param pImagePixels RGB-Werte des Sensors
+		/// \param pDepthPixels Tiefenwerte des Sensors
+		///
+		/// \return True wenn erfolgreich, false wenn fehlgeschlagen
+		///
+		////////////////////////////////////////////////////////////
+		bool writeFrame( const unsigned long long timestamp, const unsigned char* pImagePixels, const unsigned short* pDepthPixels );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Schliesst die Aufnahme.
+		////////////////////////////////////////////////////////////
+		void close(void);
+
+	private:
+		FILE* m_pFile;						///< Geoeffnete Aufnahme
+		RecordingHeader m_Header;			///< Dateikopf der Aufnahme
+	};
+}
@@ -0,0 +1,208 @@
+#include "SensorSynthetic.h"
+#include "../Core/Clock.h"
+
+#include <math.h>
+#include <string.h>
+
+namespace DirectLook
+{
+	SensorSynthetic::SensorSynthetic( const unsigned int framesPerSecond, const unsigned int frameCount, const unsigned int width, const unsigned int height )
+		:
+		m_FramesPerSecond( framesPerSecond ),
+		m_FrameCount( frameCount ),
+		m_Width( width ),
+		m_Height( height ),
+		m_StartTime( 0 ),
+		m_NextFrame( 0 ),
+		m_Delivered( 0 ),
+		m_Skipped( 0 )
+	{
+	}
+
+	SensorSynthetic::~SensorSynthetic(void)
+	{
+		close();
+	}
+
+	bool SensorSynthetic::connect(void)
+	{
+		m_ImageFrame = ImageFrame::allocate( m_Width, m_Height, 3 );
+		m_DepthFrame = DepthFrame::allocate( m_Width, m_Height );
+		if(!m_ImageFrame.getData() || !m_DepthFrame.getData())
+		{
+			std::cerr << "Invalid synthetic sensor size " << m_Width << " x " << m_Height << std::endl;
+			close();
+			return false;
+		}
+		memset( m_ImageFrame.getMutableData(), 0, m_ImageFrame.getSize() );
+		memset( m_DepthFrame.getMutableData(), 0, m_DepthFrame.getSize() * sizeof( unsigned short ) );
+		m_StartTime = Clock::microseconds();
+		m_NextFrame = 0;
+		m_Delivered = 0;
+		m_Skipped = 0;
+
+		std::cout << "Synthetic sensor: " << m_Width << " x " << m_Height << ", " << m_FramesPerSecond << " fps" << std::endl;
+		std::cout << std::endl;
+		return true;
+	}
+
+	void SensorSynthetic::close(void)
+	{
+		m_ImageFrame.release();
+		m_DepthFrame.release();
+	}
+
+	void SensorSynthetic::getSegmentedDepthImage( DepthImage* DepthImage )
+	{
+		// Both images come from the current pair, only grabFrame() advances
+		if(m_DepthFrame.getData())
+		{
+			DepthImage->updateImage( m_DepthFrame.getData() );
+		}
+	}
+
+	void SensorSynthetic::getRgbMapImage( RGBImage* RGBImage )
+	{
+		if(m_ImageFrame.getData())
+		{
+			RGBImage->updateImage( m_ImageFrame.getData() );
+		}
+	}
+
+	void SensorSynthetic::getAudioStream( AudioStream* audioStream )
+	{
+	}
+
+	void SensorSynthetic::controlMotor( const double angle )
+	{
+	}
+
+	bool SensorSynthetic::grabFrame(void)
+	{
+		if(!m_DepthFrame.isValid() || (m_FrameCount != 0 && m_Delivered >= m_FrameCount))
+		{
+			return false;
+		}
+
+		unsigned long long timestamp = Clock::microseconds();
+		if(m_FramesPerSecond > 0)
+		{
+			const unsigned long long period = 1000000ULL / m_FramesPerSecond;
+
+			// A real sensor doesn't queue old frames: when we are late, hand out the newest one
+			const unsigned long long due = (timestamp - m_StartTime) / period;
+			if(due > m_NextFrame)
+			{
+				m_Skipped += due - m_NextFrame;
+				m_NextFrame = due;
+			}
+
+			timestamp = m_StartTime + m_NextFrame * period;
+			Clock::sleepUntil( timestamp );
+		}
+
+		// Frames still referenced elsewhere must not be overwritten, render into new buffers instead
+		if(!m_ImageFrame.isUnique())
+		{
+			m_ImageFrame = ImageFrame::allocate( m_Width, m_Height, 3 );
+		}
+		if(!m_DepthFrame.isUnique())
+		{
+			m_DepthFrame = DepthFrame::allocate( m_Width, m_Height );
+		}
+
+		render( m_NextFrame );
+		m_ImageFrame.setTimestamp( timestamp );
+		m_DepthFrame.setTimestamp( timestamp );
+
+		m_NextFrame++;
+		m_Delivered++;
+		return true;
+	}
+
+	void SensorSynthetic::render( const unsigned long long frameIndex )
+	{
+		unsigned char* pImage = m_ImageFrame.getMutableData();
+		unsigned short* pDepth = m_DepthFrame.getMutableData();
+
+		// An ellipsoid "head" swaying left and right once every two seconds, in front of an empty background
+		const double phase = (double) frameIndex / 60.0 * 6.283185307;
+		const double centerX = m_Width * (0.5 + 0.15 * sin( phase ));
+		const double centerY = m_Height * 0.45;
+		const double radiusX = m_Width * 0.16;
+		const double radiusY = m_Height * 0.3;
+
+		for(unsigned int y = 0; y < m_Height; y++)
+		{
+			const double dy = ((double) y - centerY) / radiusY;
+			for(unsigned int x = 0; x < m_Width; x++)
+			{
+				const double dx = ((double) x - centerX) / radiusX;
+				const double r2 = dx * dx + dy * dy;
+				const unsigned int index = y * m_Width + x;
+
+				if(r2 < 1.0)
+				{
+					// Nose in front at 600 mm, the outline 80 mm further back
+					pDepth[index] = (unsigned short) (600.0 + 80.0 * r2);
+					pImage[index * 3]     = 224;
+					pImage[index * 3 + 1] = (unsigned char) (172 + 30.0 * r2);
+					pImage[index * 3 + 2] = 140;
+				}
+				else
+				{
+					pDepth[index] = 0;
+					pImage[index * 3]     = (unsigned char) (x * 255 / m_Width);
+					pImage[index * 3 + 1] = (unsigned char) (y * 255 / m_Height);
+					pImage[index * 3 + 2] = 96;
+				}
+			}
+		}
+	}
+
+	ImageFrame SensorSynthetic::getImageFrame(void)
+	{
+		return m_ImageFrame;
+	}
+
+	DepthFrame SensorSynthetic::getDepthFrame(void)
+	{
+		return m_DepthFrame;
+	}
+
+	bool SensorSynthetic::getSensorData( GLScene& GLScene )
+	{
+		if(!grabFrame())
+		{
+			return false;
+		}
+
+		GLScene.updateData( m_ImageFrame, m_DepthFrame );
+		return true;
+	}
+
+	unsigned int SensorSynthetic::getCameraWidth(void) const
+	{
+		return m_Width;
+	}
+
+	unsigned int SensorSynthetic::getCameraHeight(void) const
+	{
+		return m_Height;
+	}
+
+	unsigned int SensorSynthetic::getDepthWidth(void) const
+	{
+		return m_Width;
+	}
+
+	unsigned int SensorSynthetic::getDepthHeight(void) const
+	{
+		return m_Height;
+	}
+
+	unsigned long long SensorSynthetic::getSkippedFrames(void) const
+	{
+		return m_Skipped;
+	}
+};
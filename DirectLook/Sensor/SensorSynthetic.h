@@ -0,0 +1,105 @@
+#pragma once
+
+#include "../OpenGL/GLScene.h"
+#include "ISensorInterface.h"
+
+#include <string>
+
+namespace DirectLook
+{
+	/// \brief Die Klasse SensorSynthetic erzeugt kuenstliche Bildpaare mit einem bewegten Kopf.
+	///
+	/// Der Sensor liefert wie eine echte Kamera im festen Takt: grabFrame() wartet auf das naechste Bild
+	/// und ueberspringt verpasste Bilder. Die Zeitstempel stammen von der Systemuhr (Clock::microseconds())
+	/// und markieren den Zeitpunkt der "Belichtung", damit laesst sich die Latenz vom Sensor bis zur
+	/// Ausgabe ohne Hardware exakt messen.
+	class SensorSynthetic : public ISensorInterface
+	{
+
+	public:
+		////////////////////////////////////////////////////////////
+		/// \brief Konstruktor
+		///
+		/// \param framesPerSecond Bildrate (0 = so schnell wie moeglich)
+		/// \param frameCount      Anzahl der Bildpaare (0 = endlos)
+		/// \param width           Breite der RGB- und Tiefenbilder
+		/// \param height          Hoehe der RGB- und Tiefenbilder
+		///
+		////////////////////////////////////////////////////////////
+		SensorSynthetic( const unsigned int framesPerSecond = 30, const unsigned int frameCount = 0, const unsigned int width = 640, const unsigned int height = 480 );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Destruktor
+		////////////////////////////////////////////////////////////
+		virtual ~SensorSynthetic(void);
+
+		/***** SensorInterface methods *****/
+
+		////////////////////////////////////////////////////////////
+		/// \brief Legt die Bildpuffer an und startet den Takt.
+		////////////////////////////////////////////////////////////
+		virtual bool connect(void);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Gibt die Bildpuffer frei.
+		////////////////////////////////////////////////////////////
+		virtual void close(void);
+
+		virtual void getSegmentedDepthImage( DepthImage* DepthImage );
+
+		virtual void getRgbMapImage( RGBImage* RGBImage );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Es gibt keinen Audio-Stream. Das Audio-Stream-Objekt bleibt unveraendert.
+		////////////////////////////////////////////////////////////
+		virtual void getAudioStream( AudioStream* audioStream );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Es gibt keinen Motor. Der Aufruf wird ignoriert.
+		////////////////////////////////////////////////////////////
+		virtual void controlMotor( const double angle );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Wartet auf das naechste Bild im Takt und erzeugt es.
+		///
+		/// \return True wenn ein neues Bildpaar vorliegt, false nach "frameCount" Bildern
+		///
+		////////////////////////////////////////////////////////////
+		virtual bool grabFrame(void);
+
+		virtual ImageFrame getImageFrame(void);
+
+		virtual DepthFrame getDepthFrame(void);
+
+		virtual bool getSensorData( GLScene& GLScene );
+
+		virtual unsigned int getCameraWidth(void) const;
+
+		virtual unsigned int getCameraHeight(void) const;
+
+		virtual unsigned int getDepthWidth(void) const;
+
+		virtual unsigned int getDepthHeight(void) const;
+
+		/***** SensorSynthetic methods *****/
+
+		////////////////////////////////////////////////////////////
+		/// \brief Liefert die Anzahl der Bilder zurueck, die verpasst wurden, weil grabFrame() zu spaet kam.
+		////////////////////////////////////////////////////////////
+		unsigned long long getSkippedFrames(void) const;
+
+	private:
+		void render( const unsigned long long frameIndex );
+
+		unsigned int m_FramesPerSecond;		///< Bildrate (0 = ungebremst)
+		unsigned int m_FrameCount;			///< Anzahl der Bildpaare (0 = endlos)
+		unsigned int m_Width;				///< Bildbreite
+		unsigned int m_Height;				///< Bildhoehe
+		unsigned long long m_StartTime;		///< Zeitpunkt des ersten Bildes
+		unsigned long long m_NextFrame;		///< Index des naechsten Bildes im Takt
+		unsigned long long m_Delivered;		///< Anzahl ausgelieferter Bildpaare
+		unsigned long long m_Skipped;		///< Verpasste Bilder
+		ImageFrame m_ImageFrame;			///< RGB-Werte des aktuellen Bildpaares
+		DepthFrame m_DepthFrame;			///< Tiefenwerte des aktuellen Bildpaares
+	};
+};
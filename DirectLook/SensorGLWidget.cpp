@@ -1,11 +1,25 @@
 #include "SensorGLWidget.h"
+#include "Core/Clock.h"
+
+#include <iomanip>
+#include <sstream>
 
 namespace DirectLook
 {
 	SensorGLWidget::SensorGLWidget( unsigned int width, unsigned int height, QWidget* parent )
-		: QGLWidget( parent )
+		: QGLWidget( parent ),
+		m_Governor( GLScene::QUALITY_LEVELS, 1000.0 / 30.0 )
 	{
 		m_pSensorDevice = 0;
+		m_pGLScene = 0;
+		m_pCamera = 0;
+		m_pShader = 0;
+		m_pHud = 0;
+		m_ShowHud = false;
+		m_LastPaintTime = 0;
+		m_LastHudUpdate = 0;
+		m_PaintMilliseconds = 0.0;
+		m_UpdateMilliseconds = 0.0;
 		setFixedSize( width, height );
 		m_SensorUpdate = true;
 		
@@ -16,6 +30,7 @@ namespace DirectLook
 
 	SensorGLWidget::~SensorGLWidget(void)
 	{
+		if(m_pHud){ delete m_pHud;			m_pHud = 0; }
 		if(m_pGLScene){ delete m_pGLScene;	m_pGLScene = 0; }
 		if(m_pCamera){ delete m_pCamera;	m_pCamera = 0; }
 		if(m_pShader){ delete m_pShader;	m_pShader = 0; }
@@ -32,6 +47,10 @@ namespace DirectLook
 			// Konvert fps to milliseconds:
 			double ms = 1000.0 / (double) fps;
 
+			// The timer only polls, the sensor sets the pace and with it the time left for each frame
+			const unsigned int sensorFps = m_pSensorDevice->getFramesPerSecond();
+			m_Governor.setBudget( 1000.0 / (double) (sensorFps > 0 ? sensorFps : 30) );
+
 			// QTimer controls the render process:
 			m_pTimer->start( (int) ms );
 			return true;
@@ -69,6 +88,37 @@ namespace DirectLook
 		return m_SensorUpdate;
 	}
 
+	bool SensorGLWidget::getHud(void) const
+	{
+		return m_ShowHud;
+	}
+
+	void SensorGLWidget::cycleQuality(void)
+	{
+		if(!m_Governor.isFixed())
+		{
+			m_Governor.setFixedLevel( 0 );
+		}
+		else if(m_Governor.getLevel() + 1 < m_Governor.getLevelCount())
+		{
+			m_Governor.setFixedLevel( m_Governor.getLevel() + 1 );
+		}
+		else
+		{
+			// Back to automatic, starting again from the current level
+			m_Governor.setAutomatic();
+		}
+
+		makeCurrent();
+		applyQuality();
+		m_LastHudUpdate = 0;
+	}
+
+	const QualityGovernor& SensorGLWidget::getGovernor(void) const
+	{
+		return m_Governor;
+	}
+
 	void SensorGLWidget::setSensorDevice( SensorOpenNI* pSensorDevice )
 	{
 		m_pSensorDevice = pSensorDevice;
@@ -100,6 +150,12 @@ namespace DirectLook
 		}
 	}
 
+	void SensorGLWidget::switchHud(void)
+	{
+		m_ShowHud = !m_ShowHud;
+		m_LastHudUpdate = 0;
+	}
+
 	void SensorGLWidget::initializeGL(void)
 	{
 		makeCurrent();
@@ -158,8 +214,28 @@ namespace DirectLook
 		// Update and draw the 3D-Model
 		//glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
 		//m_pBackgroundVideo->drawBackgroundVideo();
+		const unsigned long long paintStart = Clock::microseconds();
 		m_pGLScene->update();
 		m_pGLScene->draw();
+		m_PaintMilliseconds = Clock::elapsedMilliseconds( paintStart );
+
+		const unsigned long long now = Clock::microseconds();
+		if(m_LastPaintTime != 0)
+		{
+			m_FrameTime.add( (double) (now - m_LastPaintTime) / 1000.0 );
+		}
+		m_LastPaintTime = now;
+
+		if(m_ShowHud)
+		{
+			// Rebuilding the text every frame would make the numbers unreadable
+			if(now - m_LastHudUpdate > 250000)
+			{
+				updateHudText();
+				m_LastHudUpdate = now;
+			}
+			m_pHud->draw( width(), height() );
+		}
 	}
 
 	void SensorGLWidget::mousePressEvent( QMouseEvent* event )
@@ -195,17 +271,144 @@ namespace DirectLook
 			m_pShader, m_pCamera
 
 		);
+
+		m_pHud = new HudOverlay();
+	}
+
+	void SensorGLWidget::applyQuality(void)
+	{
+		if(m_pGLScene)
+		{
+			m_pGLScene->setQuality( GLScene::getQualityLevel( m_Governor.getLevel() ) );
+		}
+	}
+
+	void SensorGLWidget::updateHudText(void)
+	{
+		const SceneStatistics scene = m_pGLScene->getSceneStatistics();
+		const double frameMs = m_FrameTime.getMean();
+		const double uploadMBytes = scene.m_UploadBytes / (1024.0 * 1024.0);
+
+		std::ostringstream text;
+		text << std::fixed << std::setprecision( 1 );
+		text << "FPS      " << (frameMs > 0.0 ? 1000.0 / frameMs : 0.0) << "  " << frameMs << " MS\n";
+		text << "SENSOR   " << m_SensorTime.getMean() << " MS\n";
+		text << "FILTER   " << scene.m_FilterMilliseconds << " MS\n";
+		text << "MESH     " << scene.m_MeshMilliseconds << " MS\n";
+		text << "UPLOAD   " << scene.m_UploadMilliseconds << " MS  " << std::setprecision( 2 ) << uploadMBytes << " MB  "
+			<< (frameMs > 0.0 ? uploadMBytes * 1000.0 / frameMs : 0.0) << " MB/S\n" << std::setprecision( 1 );
+		text << "DRAW     " << scene.m_DrawMilliseconds << " MS\n";
+
+		const std::vector<GpuPassStatistics> gpu = m_pGLScene->getGpuStatistics();
+		for(unsigned int i = 0; i < gpu.size(); i++)
+		{
+			text << "GPU " << std::left << std::setw( 11 ) << gpu[i].m_Name << std::right << gpu[i].m_MeanMilliseconds << " MS\n";
+		}
+
+		const unsigned long long dropped = m_pSensorDevice ? m_pSensorDevice->getDroppedFrames() : 0;
+		if(dropped > 0)
+		{
+			text << "!DROPPED  " << dropped << "\n";
+		}
+		if(m_pGLScene->getMeshMode() == MESH_POINTS)
+		{
+			text << "POINTS    " << scene.m_Points << "\n";
+		}
+		else
+		{
+			text << "TRIANGLES " << scene.m_Triangles << "\n";
+		}
+		text << "QUALITY   " << m_Governor.getLevel() << " " << m_pGLScene->getQuality().m_pName << (m_Governor.isFixed() ? " FIXED" : " AUTO") << "\n";
+		text << "UPSAMPLE  " << (m_pGLScene->getGuidedUpsampling() ? "GUIDED" : "OFF");
+		if(m_pGLScene->getGuidedUpsampling())
+		{
+			text << " " << scene.m_EdgePixels << " EDGE PX";
+		}
+		text << "\nHEAD      ";
+		if(!m_pGLScene->getHeadTracking())
+		{
+			text << "OFF";
+		}
+		else if(m_pGLScene->getHeadTracker().isLocked())
+		{
+			text << "TRACKED " << (int) (scene.m_RegionCoverage * 100.0 + 0.5) << "% OF GRID";
+		}
+		else
+		{
+			text << "SEARCHING";
+		}
+
+		static const char* FOREGROUND_NAMES[] = { "ALL", "LARGEST", "NEAREST" };
+		text << "\nFOREGROUND " << FOREGROUND_NAMES[m_pGLScene->getForegroundMode()];
+		if(m_pGLScene->getForegroundMode() != FOREGROUND_ALL)
+		{
+			text << " " << scene.m_ForegroundPixels << " PX OF " << scene.m_Components << " COMPONENTS";
+		}
+		if(m_pGLScene->hasBackgroundVideo())
+		{
+			if(scene.m_VideoCachedFrames > 0)
+			{
+				text << "\nVIDEO     " << scene.m_VideoCachedFrames << " CACHED  " << (scene.m_VideoCacheBytes >> 20) << " MB";
+			}
+			else
+			{
+				text << "\nVIDEO     " << scene.m_VideoQueued << " QUEUED  " << scene.m_VideoSkipped << " SKIPPED";
+			}
+		}
+		if(m_pGLScene->isRecording())
+		{
+			const EncoderStatistics recording = m_pGLScene->getRecordingStatistics();
+			text << "\nREC       " << recording.m_Encoded << " FRAMES  " << recording.m_Dropped << " DROPPED  LAG " << recording.m_LagP99 << " MS";
+		}
+		if(m_pGLScene->getOutputRing().isOpen())
+		{
+			text << "\nSHARE     " << m_pGLScene->getOutputRing().getName() << "  " << m_pGLScene->getOutputRing().getPublished() << " FRAMES";
+		}
+		text << "\nMASK      ";
+		if(m_pGLScene->getOpenRadius() == 0 && m_pGLScene->getCloseRadius() == 0)
+		{
+			text << "RAW";
+		}
+		else
+		{
+			text << "OPEN " << m_pGLScene->getOpenRadius() << " CLOSE " << m_pGLScene->getCloseRadius() << " (LABELS ONLY)";
+		}
+		if(scene.m_MaskMicroseconds > 0.0)
+		{
+			text << "  " << (int) scene.m_MaskMicroseconds << " US";
+		}
+
+		m_pHud->setText( text.str() );
 	}
 
 	void SensorGLWidget::sensorUpdate(void)
 	{
+		bool newFrame = false;
 		if(m_SensorUpdate)
 		{
-					// Read RGB- and DepthMap-Image from Sensor
-					m_pSensorDevice->getSensorData( *m_pGLScene );	
+					// Read RGB- and DepthMap-Image from Sensor, like getSensorData but with the capture timed on its own
+					const unsigned long long start = Clock::microseconds();
+					newFrame = m_pSensorDevice->grabFrame();
+					if(newFrame)
+					{
+						m_SensorTime.add( Clock::elapsedMilliseconds( start ) );
+						const unsigned long long updateStart = Clock::microseconds();
+						m_pGLScene->updateData( m_pSensorDevice->getImageFrame(), m_pSensorDevice->getDepthFrame() );
+						m_UpdateMilliseconds = Clock::elapsedMilliseconds( updateStart );
+					}
 		}
 
 		// Update and draw the 3D-Model
 		repaint();
+
+		if(newFrame)
+		{
+			// grabFrame mostly waits for the sensor, so only filtering, meshing, upload and rendering count as work
+			if(m_Governor.addFrameTime( m_UpdateMilliseconds + m_PaintMilliseconds ))
+			{
+				makeCurrent();
+				applyQuality();
+			}
+		}
 	}
 }
@@ -13,6 +13,9 @@
 #include "OpenGL/GLScene.h"
 #include "OpenGL/GLCamera.h"
 #include "OpenGL/Shader.h"
+#include "OpenGL/HudOverlay.h"
+#include "Core/Metrics.h"
+#include "Core/QualityGovernor.h"
 
 
 namespace DirectLook
@@ -29,6 +32,15 @@ namespace DirectLook
 		bool m_SensorUpdate;			///< Sensor update on or off
 		QPoint m_LastMousePosition;		///< Last mouse position
 		QTimer* m_pTimer;				///< Timer for render and Sensor update process
+		HudOverlay* m_pHud;				///< Performance overlay
+		bool m_ShowHud;					///< Performance overlay on or off
+		RollingStatistic m_FrameTime;	///< Time between two paintGL calls in ms
+		RollingStatistic m_SensorTime;	///< Time of grabFrame in ms (includes waiting for the next sensor frame)
+		unsigned long long m_LastPaintTime;	///< Start of the last paintGL call (Clock::microseconds)
+		unsigned long long m_LastHudUpdate;	///< Last time the overlay text was rebuilt
+		QualityGovernor m_Governor;		///< Chooses the GLScene quality level from the work per frame, the budget is the sensor frame period
+		double m_PaintMilliseconds;		///< Work time of the last paintGL call (without swapping buffers)
+		double m_UpdateMilliseconds;	///< Filtering, meshing and upload of the last frame in ms (without waiting in grabFrame)
 
 	public:
 		// Constructor
@@ -37,7 +49,7 @@ namespace DirectLook
 		// Destructor
 		~SensorGLWidget(void);
 
-		// Start the render and Sensor update process
+		// Start the render and Sensor update process, fps is the polling rate (the quality budget follows the sensor)
 		bool start( unsigned int fps );
 
 		// Stop the render and Sensor update process
@@ -55,6 +67,18 @@ namespace DirectLook
 		// Get the status if the Sensor update process on or off
 		bool getSensorUpdate(void) const;
 
+		// Set the performance overlay on or off
+		void switchHud(void);
+
+		// Get the status if the performance overlay is shown
+		bool getHud(void) const;
+
+		// Cycle the quality level: automatic, then every fixed level, then automatic again
+		void cycleQuality(void);
+
+		// Get the quality governor of the GLScene
+		const QualityGovernor& getGovernor(void) const;
+
 		// Set a new Sensor device
 		void setSensorDevice( SensorOpenNI* pSensorDevice );
 
@@ -68,6 +92,8 @@ namespace DirectLook
 
 	private:
 		void initialize(void);
+		void updateHudText(void);
+		void applyQuality(void);
 
 	private slots:
 		void sensorUpdate(void);
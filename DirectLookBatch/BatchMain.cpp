@@ -0,0 +1,253 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <iostream>
+#include <qapplication.h>
+
+#include "BatchProcessor.h"
+#include "../DirectLook/Core/TaskPool.h"
+#include "../DirectLook/Core/Trace.h"
+
+using namespace DirectLook;
+
+static void printUsage(void)
+{
+	std::cout << "Usage: DirectLookBatch <input.oni|input.dlr|synthetic> [output directory] [options]" << std::endl;
+	std::cout << "  --near <mm>        Near threshold (default 500)" << std::endl;
+	std::cout << "  --far <mm>         Far threshold (default 800)" << std::endl;
+	std::cout << "  --max-frames <n>   Stop after n frames (default all)" << std::endl;
+	std::cout << "  --no-write         Don't write frames, measure throughput only" << std::endl;
+	std::cout << "  --record <file>    Save the input frames as DirectLook recording (*.dlr)" << std::endl;
+	std::cout << "  --encode <file>    Save the corrected frames as video (*.mkv, *.mp4, *.avi)" << std::endl;
+	std::cout << "  --codec <name>     Codec of --encode: ffv1 (lossless, default) or h264" << std::endl;
+	std::cout << "  --share <name>     Publish the corrected frames in the shared memory ring <name>" << std::endl;
+	std::cout << "  --output-size <WxH>    Render and write the frames at this size instead of the camera size" << std::endl;
+	std::cout << "  --output-levels <n>    Also write n-1 smaller levels (half size each) of every frame" << std::endl;
+	std::cout << "  --view-height <units>  Also render a view with the camera moved up by <units> (repeatable)" << std::endl;
+	std::cout << "  --serial           Run the stages one after another instead of pipelined" << std::endl;
+	std::cout << "  --threads <n>      Worker threads of the task pool (default: logical cores)" << std::endl;
+	std::cout << "  --pin              Bind every worker thread to its own core" << std::endl;
+	std::cout << "  --trace <file>     Save a Chrome trace of the run (needs DIRECTLOOK_TRACE)" << std::endl;
+	std::cout << "  --latency-budget <ms>  Fail if the p99 latency up to readback exceeds the budget" << std::endl;
+	std::cout << "  --quality <0-" << GLScene::QUALITY_LEVELS - 1 << ">      Fixed quality level, 0 = full (default 0)" << std::endl;
+	std::cout << "  --frame-budget <ms>    Lower the quality while a frame takes longer (with --serial)" << std::endl;
+	std::cout << "  --guided-upsampling    Filter depth on a half grid and upsample it guided by the camera image" << std::endl;
+	std::cout << "  --benchmark-upsampling Compare full and half grid filtering instead of rendering" << std::endl;
+	std::cout << "  --points               Draw the head as point splats instead of the triangle mesh" << std::endl;
+	std::cout << "  --benchmark-points     Compare point splats with the triangle mesh (time and image) instead of writing frames" << std::endl;
+	std::cout << "  --cpu-render           Render on the CPU (forward warping of the depth grid) instead of OpenGL" << std::endl;
+	std::cout << "  --head-roi             Track the head and only process the region around it (with --serial)" << std::endl;
+	std::cout << "  --foreground <mode>    Keep only the largest or the nearest connected component (largest, nearest)" << std::endl;
+	std::cout << "  --mask-open <r>        Open the foreground mask with a (2r+1)x(2r+1) kernel to remove speckles" << std::endl;
+	std::cout << "  --mask-close <r>       Close the foreground mask with a (2r+1)x(2r+1) kernel, only joins components" << std::endl;
+}
+
+int main( int argc, char* argv[] )
+{
+	// The shared sensor code reports errors with message boxes in release builds
+	QApplication app( argc, argv );
+
+	BatchOptions options;
+	unsigned int positional = 0;
+	unsigned int threadCount = 0;
+	bool pinThreads = false;
+	std::string traceFile;
+
+	for(int i = 1; i < argc; i++)
+	{
+		const bool hasValue = (i + 1 < argc);
+
+		if(strcmp( argv[i], "--near" ) == 0 && hasValue)
+		{
+			options.m_NearThreshold = (unsigned short) atoi( argv[++i] );
+		}
+		else if(strcmp( argv[i], "--far" ) == 0 && hasValue)
+		{
+			options.m_FarThreshold = (unsigned short) atoi( argv[++i] );
+		}
+		else if(strcmp( argv[i], "--max-frames" ) == 0 && hasValue)
+		{
+			options.m_MaxFrames = (unsigned int) atoi( argv[++i] );
+		}
+		else if(strcmp( argv[i], "--record" ) == 0 && hasValue)
+		{
+			options.m_RecordFile = argv[++i];
+		}
+		else if(strcmp( argv[i], "--encode" ) == 0 && hasValue)
+		{
+			options.m_EncodeFile = argv[++i];
+		}
+		else if(strcmp( argv[i], "--share" ) == 0 && hasValue)
+		{
+			options.m_ShareName = argv[++i];
+		}
+		else if(strcmp( argv[i], "--codec" ) == 0 && hasValue)
+		{
+			i++;
+			if(strcmp( argv[i], "ffv1" ) == 0)
+			{
+				options.m_EncodeCodec = VIDEO_CODEC_FFV1;
+			}
+			else if(strcmp( argv[i], "h264" ) == 0)
+			{
+				options.m_EncodeCodec = VIDEO_CODEC_H264;
+			}
+			else
+			{
+				printUsage();
+				return 1;
+			}
+		}
+		else if(strcmp( argv[i], "--output-size" ) == 0 && hasValue)
+		{
+			if(sscanf( argv[++i], "%ux%u", &options.m_OutputWidth, &options.m_OutputHeight ) != 2
+				|| options.m_OutputWidth == 0 || options.m_OutputHeight == 0)
+			{
+				printUsage();
+				return 1;
+			}
+		}
+		else if(strcmp( argv[i], "--output-levels" ) == 0 && hasValue)
+		{
+			options.m_OutputLevels = (unsigned int) atoi( argv[++i] );
+		}
+		else if(strcmp( argv[i], "--view-height" ) == 0 && hasValue)
+		{
+			options.m_ViewHeights.push_back( (float) atof( argv[++i] ) );
+		}
+		else if(strcmp( argv[i], "--threads" ) == 0 && hasValue)
+		{
+			threadCount = (unsigned int) atoi( argv[++i] );
+		}
+		else if(strcmp( argv[i], "--trace" ) == 0 && hasValue)
+		{
+			traceFile = argv[++i];
+		}
+		else if(strcmp( argv[i], "--latency-budget" ) == 0 && hasValue)
+		{
+			options.m_LatencyBudget = atof( argv[++i] );
+		}
+		else if(strcmp( argv[i], "--quality" ) == 0 && hasValue)
+		{
+			options.m_QualityLevel = atoi( argv[++i] );
+		}
+		else if(strcmp( argv[i], "--frame-budget" ) == 0 && hasValue)
+		{
+			options.m_FrameBudget = atof( argv[++i] );
+		}
+		else if(strcmp( argv[i], "--guided-upsampling" ) == 0)
+		{
+			options.m_GuidedUpsampling = true;
+		}
+		else if(strcmp( argv[i], "--benchmark-upsampling" ) == 0)
+		{
+			options.m_UpsamplingBenchmark = true;
+		}
+		else if(strcmp( argv[i], "--points" ) == 0)
+		{
+			options.m_MeshMode = MESH_POINTS;
+		}
+		else if(strcmp( argv[i], "--benchmark-points" ) == 0)
+		{
+			options.m_PointBenchmark = true;
+		}
+		else if(strcmp( argv[i], "--cpu-render" ) == 0)
+		{
+			options.m_CpuRender = true;
+		}
+		else if(strcmp( argv[i], "--head-roi" ) == 0)
+		{
+			options.m_HeadTracking = true;
+		}
+		else if(strcmp( argv[i], "--mask-open" ) == 0 && hasValue)
+		{
+			options.m_OpenRadius = (unsigned int) atoi( argv[++i] );
+		}
+		else if(strcmp( argv[i], "--mask-close" ) == 0 && hasValue)
+		{
+			options.m_CloseRadius = (unsigned int) atoi( argv[++i] );
+		}
+		else if(strcmp( argv[i], "--foreground" ) == 0 && hasValue)
+		{
+			i++;
+			if(strcmp( argv[i], "largest" ) == 0)
+			{
+				options.m_ForegroundMode = FOREGROUND_LARGEST;
+			}
+			else if(strcmp( argv[i], "nearest" ) == 0)
+			{
+				options.m_ForegroundMode = FOREGROUND_NEAREST;
+			}
+			else
+			{
+				printUsage();
+				return 1;
+			}
+		}
+		else if(strcmp( argv[i], "--serial" ) == 0)
+		{
+			options.m_Pipelined = false;
+		}
+		else if(strcmp( argv[i], "--pin" ) == 0)
+		{
+			pinThreads = true;
+		}
+		else if(strcmp( argv[i], "--no-write" ) == 0)
+		{
+			options.m_WriteFrames = false;
+		}
+		else if(argv[i][0] != '-' && positional == 0)
+		{
+			options.m_InputFile = argv[i];
+			positional++;
+		}
+		else if(argv[i][0] != '-' && positional == 1)
+		{
+			options.m_OutputDirectory = argv[i];
+			positional++;
+		}
+		else
+		{
+			printUsage();
+			return 1;
+		}
+	}
+
+	if(options.m_InputFile.empty())
+	{
+		printUsage();
+		return 1;
+	}
+
+	if(!traceFile.empty())
+	{
+		if(!Trace::isCompiledIn())
+		{
+			std::cerr << "--trace ignored, DirectLookBatch was built without DIRECTLOOK_TRACE" << std::endl;
+			traceFile.clear();
+		}
+		Trace::setEnabled( !traceFile.empty() );
+	}
+
+	TaskPool::configure( threadCount, pinThreads );
+
+	BatchProcessor processor( options );
+	if(!processor.initialize())
+	{
+		return 1;
+	}
+
+	const unsigned int frames = processor.run();
+
+	if(!traceFile.empty())
+	{
+		Trace::setEnabled( false );
+		Trace::dump( traceFile );
+	}
+
+	if(frames == 0)
+	{
+		return 1;
+	}
+	return processor.checkLatencyBudget() ? 0 : 2;
+}
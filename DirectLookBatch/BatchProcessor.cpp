@@ -0,0 +1,1025 @@
+#include "BatchProcessor.h"
+#include "../DirectLook/Sensor/SensorOpenNI.h"
+#include "../DirectLook/Sensor/SensorSynthetic.h"
+
+#include <QDir>
+
+#include <ctype.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace DirectLook
+{
+	static const unsigned int ENCODE_FRAME_RATE = 30;	// Nominal rate of the recordings, timestamps of the encoded video count frames
+
+	BatchProcessor::BatchProcessor( const BatchOptions& options )
+		:
+		m_Options( options ),
+		m_pSensorDevice( 0 ),
+		m_pCamera( 0 ),
+		m_pShader( 0 ),
+		m_pGLScene( 0 ),
+		m_pFrameBuffer( 0 ),
+		m_FrameBufferSize( 0 ),
+		m_HostTimestamps( false ),
+		m_Governor( GLScene::QUALITY_LEVELS, options.m_FrameBudget )
+	{
+		if(m_Options.m_QualityLevel >= 0)
+		{
+			m_Governor.setFixedLevel( (unsigned int) m_Options.m_QualityLevel );
+		}
+	}
+
+	BatchProcessor::~BatchProcessor(void)
+	{
+		m_Recorder.close();
+		m_Encoder.close();
+		m_OutputRing.destroy();
+
+		if(m_pSensorDevice)
+		{
+			m_pSensorDevice->close();
+			delete m_pSensorDevice;
+			m_pSensorDevice = 0;
+		}
+
+		// GL objects have to be deleted while the context is still alive
+		if(m_pGLScene){ delete m_pGLScene;	m_pGLScene = 0; }
+		if(m_pShader){ delete m_pShader;	m_pShader = 0; }
+		if(m_pCamera){ delete m_pCamera;	m_pCamera = 0; }
+		for(size_t i = 0; i < m_ViewCameras.size(); i++)
+		{
+			delete m_ViewCameras[i];
+		}
+		m_ViewCameras.clear();
+		if(m_pFrameBuffer){ delete[] m_pFrameBuffer; m_pFrameBuffer = 0; }
+
+		m_Context.destroy();
+	}
+
+	bool BatchProcessor::initialize(void)
+	{
+		if(!m_Context.create() || !initializeGL())
+		{
+			return false;
+		}
+
+		m_pSensorDevice = createSensor( m_Options.m_InputFile );
+		m_HostTimestamps = (m_Options.m_InputFile == "synthetic");
+		if(!m_pSensorDevice || !m_pSensorDevice->connect())
+		{
+			std::cerr << "Couldn't open input " << m_Options.m_InputFile << std::endl;
+			return false;
+		}
+
+		if(!m_Options.m_RecordFile.empty())
+		{
+			if(!m_Recorder.open( m_Options.m_RecordFile,
+				m_pSensorDevice->getCameraWidth(), m_pSensorDevice->getCameraHeight(),
+				m_pSensorDevice->getDepthWidth(), m_pSensorDevice->getDepthHeight(), 30 ))
+			{
+				return false;
+			}
+		}
+
+		if(m_Options.m_WriteFrames && !QDir().mkpath( QString::fromStdString( m_Options.m_OutputDirectory ) ))
+		{
+			std::cerr << "Couldn't create output directory " << m_Options.m_OutputDirectory << std::endl;
+			return false;
+		}
+
+		// Create a camera, shader and GLScene object like SensorGLWidget::initialize()
+		m_pCamera = new GLCamera();
+		m_pShader = new Shader( "..//data//shader//vertex.glsl", "..//data//shader//fragment.glsl" );
+		m_pGLScene = new GLScene(
+			m_Options.m_NearThreshold,
+			m_Options.m_FarThreshold,
+			m_pSensorDevice->getCameraWidth(), m_pSensorDevice->getCameraHeight(),
+			m_pSensorDevice->getDepthWidth(), m_pSensorDevice->getDepthHeight(),
+			m_pShader, m_pCamera
+		);
+
+		m_pGLScene->setQuality( GLScene::getQualityLevel( m_Governor.getLevel() ) );
+		m_pGLScene->setGuidedUpsampling( m_Options.m_GuidedUpsampling );
+		m_pGLScene->setHeadTracking( m_Options.m_HeadTracking );
+		m_pGLScene->setForegroundMode( m_Options.m_ForegroundMode );
+		m_pGLScene->setMaskMorphology( m_Options.m_OpenRadius, m_Options.m_CloseRadius );
+		m_pGLScene->setMeshMode( m_Options.m_MeshMode );
+
+		// Scaling happens while rendering, everything after the readback sees the output size only
+		if(m_Options.m_OutputWidth > 0 || m_Options.m_OutputHeight > 0 || m_Options.m_OutputLevels > 1)
+		{
+			const unsigned int width  = (m_Options.m_OutputWidth > 0)  ? m_Options.m_OutputWidth  : m_pGLScene->getCameraWidth();
+			const unsigned int height = (m_Options.m_OutputHeight > 0) ? m_Options.m_OutputHeight : m_pGLScene->getCameraHeight();
+			if(!m_pGLScene->setOutputSize( width, height, m_Options.m_OutputLevels ))
+			{
+				std::cerr << "Invalid output size " << width << "x" << height << std::endl;
+				return false;
+			}
+			std::cout << "Output size : " << width << "x" << height << ", " << m_pGLScene->getOutputLevels() << " levels" << std::endl;
+		}
+
+		// Extra views share the mesh upload of the main view, each one only costs a draw call and its readback
+		for(size_t i = 0; i < m_Options.m_ViewHeights.size(); i++)
+		{
+			GLCamera* pCamera = new GLCamera( *m_pCamera );
+			pCamera->addToCamera( 0.0f, m_Options.m_ViewHeights[i], 0.0f );
+			m_ViewCameras.push_back( pCamera );
+			m_pGLScene->addView( pCamera, m_pGLScene->getOutputWidth(), m_pGLScene->getOutputHeight() );
+		}
+		if(!m_ViewCameras.empty())
+		{
+			std::cout << "Views       : " << m_ViewCameras.size() + 1 << " per frame" << std::endl;
+		}
+
+		m_FrameBufferSize = m_pGLScene->getOutputWidth() * m_pGLScene->getOutputHeight() * 3;
+		m_pFrameBuffer = new GLubyte[m_FrameBufferSize];
+
+		// Format, size and clear color match the render target, the image itself differs: squares and hole
+		// filling instead of triangles, the camera image instead of the background texture on the plane
+		if(m_Options.m_CpuRender)
+		{
+			m_CpuRenderer.setSize( m_pGLScene->getOutputWidth(), m_pGLScene->getOutputHeight() );
+			m_CpuRenderer.setClearColor( 100, 149, 255 );
+		}
+
+		// Every frame counts in a batch run, so push() waits for the encoder instead of dropping
+		if(!m_Options.m_EncodeFile.empty())
+		{
+			if(!m_Encoder.open( m_Options.m_EncodeFile, m_pGLScene->getOutputWidth(), m_pGLScene->getOutputHeight(), ENCODE_FRAME_RATE,
+				m_Options.m_EncodeCodec, true, false ))
+			{
+				return false;
+			}
+		}
+
+		if(!m_Options.m_ShareName.empty())
+		{
+			if(!m_OutputRing.create( m_Options.m_ShareName, m_pGLScene->getOutputWidth(), m_pGLScene->getOutputHeight(), false, true ))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	unsigned int BatchProcessor::run(void)
+	{
+		m_OutputLatency.reset();
+		m_SensorSkew.reset();
+		if(m_Options.m_UpsamplingBenchmark)
+		{
+			return runUpsamplingBenchmark();
+		}
+		if(m_Options.m_PointBenchmark)
+		{
+			return runPointBenchmark();
+		}
+		if(m_Options.m_CpuRender)
+		{
+			return runCpu();
+		}
+		return m_Options.m_Pipelined ? runPipelined() : runSerial();
+	}
+
+	bool BatchProcessor::checkLatencyBudget(void) const
+	{
+		if(m_Options.m_LatencyBudget <= 0.0)
+		{
+			return true;
+		}
+
+		const double p99 = m_OutputLatency.getPercentile( 0.99 );
+		if(m_OutputLatency.getCount() == 0 || p99 > m_Options.m_LatencyBudget)
+		{
+			std::cerr << "Latency budget exceeded: p99 " << p99 << " ms > " << m_Options.m_LatencyBudget << " ms" << std::endl;
+			return false;
+		}
+
+		std::cout << "Latency budget met: p99 " << p99 << " ms <= " << m_Options.m_LatencyBudget << " ms" << std::endl;
+		return true;
+	}
+
+	unsigned long long BatchProcessor::tagCapture( const ImageFrame& imageFrame, const DepthFrame& depthFrame )
+	{
+		const unsigned long long imageTime = imageFrame.getTimestamp();
+		const unsigned long long depthTime = depthFrame.getTimestamp();
+		m_SensorSkew.add( (imageTime > depthTime) ? imageTime - depthTime : depthTime - imageTime );
+
+		// Timestamps of real sensors run on their own clock, so only the grab time is comparable
+		return (m_HostTimestamps && depthTime != 0) ? depthTime : Clock::microseconds();
+	}
+
+	void BatchProcessor::printLatency(void) const
+	{
+		const char* pStart = m_HostTimestamps ? "sensor to readback" : "capture to readback";
+		std::cout << pStart << " : p50 " << m_OutputLatency.getPercentile( 0.5 )
+			<< " ms, p95 " << m_OutputLatency.getPercentile( 0.95 )
+			<< " ms, p99 " << m_OutputLatency.getPercentile( 0.99 )
+			<< " ms, max " << m_OutputLatency.getMax() << " ms" << std::endl;
+		std::cout << "RGB/depth skew      : p50 " << m_SensorSkew.getPercentile( 0.5 )
+			<< " ms, p99 " << m_SensorSkew.getPercentile( 0.99 )
+			<< " ms, max " << m_SensorSkew.getMax() << " ms" << std::endl;
+		std::cout << std::endl;
+	}
+
+	void BatchProcessor::printEncoder(void)
+	{
+		if(!m_Encoder.isOpen())
+		{
+			return;
+		}
+
+		// Closing flushes the frames the codec still holds back, so they count as well
+		m_Encoder.close();
+		const EncoderStatistics statistics = m_Encoder.getStatistics();
+		std::cout << "Encoder     : " << statistics.m_Encoded << " frames (" << AvVideoEncoder::getCodecName( m_Options.m_EncodeCodec )
+			<< "), " << statistics.m_Dropped << " dropped, " << statistics.m_FramesPerSecond << " frames/s, "
+			<< statistics.m_EncodeMilliseconds << " ms/frame, lag p99 " << statistics.m_LagP99 << " ms, "
+			<< (double) statistics.m_Bytes / (1024.0 * 1024.0) << " MB" << std::endl;
+	}
+
+	void BatchProcessor::printOutputRing(void) const
+	{
+		if(m_OutputRing.isOpen())
+		{
+			std::cout << "Shared ring : " << m_OutputRing.getPublished() << " frames published as \"" << m_OutputRing.getName() << "\"" << std::endl;
+		}
+	}
+
+	void BatchProcessor::printQuality(void) const
+	{
+		std::cout << "Quality     : level " << m_Governor.getLevel() << " (" << m_pGLScene->getQuality().m_pName << ")";
+		if(m_Governor.isFixed())
+		{
+			std::cout << ", fixed";
+		}
+		else if(m_Options.m_FrameBudget > 0.0)
+		{
+			std::cout << ", " << m_Governor.getLevelChanges() << " changes for a budget of " << m_Options.m_FrameBudget << " ms";
+		}
+		std::cout << std::endl;
+	}
+
+	unsigned int BatchProcessor::runSerial(void)
+	{
+		double grabTime = 0.0, updateTime = 0.0, renderTime = 0.0, readTime = 0.0, writeTime = 0.0;
+		double regionCoverage = 0.0;
+		double foregroundPixels = 0.0, components = 0.0, maskTime = 0.0;
+		unsigned int frame = 0;
+		const unsigned int levels = m_Options.m_WriteFrames ? m_pGLScene->getOutputLevels() : 1;
+
+		const unsigned long long startTime = Clock::microseconds();
+		while(m_Options.m_MaxFrames == 0 || frame < m_Options.m_MaxFrames)
+		{
+			double frameWork = 0.0;
+			unsigned long long phaseStart = Clock::microseconds();
+			if(!m_pSensorDevice->grabFrame())
+			{
+				break;
+			}
+			grabTime += Clock::elapsedMilliseconds( phaseStart );
+
+			const ImageFrame imageFrame = m_pSensorDevice->getImageFrame();
+			const DepthFrame depthFrame = m_pSensorDevice->getDepthFrame();
+			const unsigned long long captureTime = tagCapture( imageFrame, depthFrame );
+			m_Recorder.writeFrame( Clock::microseconds() - startTime, imageFrame.getData(), depthFrame.getData() );
+
+			phaseStart = Clock::microseconds();
+			m_pGLScene->updateData( imageFrame, depthFrame );
+			frameWork += Clock::elapsedMilliseconds( phaseStart );
+			updateTime += Clock::elapsedMilliseconds( phaseStart );
+			const SceneStatistics sceneStatistics = m_pGLScene->getSceneStatistics();
+			regionCoverage += sceneStatistics.m_RegionCoverage;
+			foregroundPixels += sceneStatistics.m_ForegroundPixels;
+			components += sceneStatistics.m_Components;
+			maskTime += sceneStatistics.m_MaskMicroseconds;
+
+			phaseStart = Clock::microseconds();
+			m_pGLScene->update();
+			m_pGLScene->drawOffscreen();
+			glFinish();
+			frameWork += Clock::elapsedMilliseconds( phaseStart );
+			renderTime += Clock::elapsedMilliseconds( phaseStart );
+
+			phaseStart = Clock::microseconds();
+			m_pGLScene->getRGBPixels( m_pFrameBuffer, m_FrameBufferSize );
+			frameWork += Clock::elapsedMilliseconds( phaseStart );
+			readTime += Clock::elapsedMilliseconds( phaseStart );
+			m_OutputLatency.add( Clock::microseconds() - captureTime );
+			m_OutputRing.publish( m_pFrameBuffer, Clock::microseconds() );
+
+			// Grab and write wait on the input and the disk, quality can't buy those back
+			if(m_Governor.addFrameTime( frameWork ))
+			{
+				m_pGLScene->setQuality( GLScene::getQualityLevel( m_Governor.getLevel() ) );
+			}
+
+			if(m_Options.m_WriteFrames)
+			{
+				phaseStart = Clock::microseconds();
+				if(!writeFrame( frame, m_pFrameBuffer ))
+				{
+					break;
+				}
+				writeTime += Clock::elapsedMilliseconds( phaseStart );
+			}
+
+			// m_pFrameBuffer is reused for the next frame, the encoder gets its own copy
+			if(m_Encoder.isOpen())
+			{
+				ImageFrame output = ImageFrame::allocate( m_pGLScene->getOutputWidth(), m_pGLScene->getOutputHeight(), 3 );
+				memcpy( output.getMutableData(), m_pFrameBuffer, m_FrameBufferSize );
+				output.setTimestamp( (unsigned long long) frame * 1000000ULL / ENCODE_FRAME_RATE );
+				m_Encoder.push( output );
+			}
+
+			// The smaller levels were filtered on the GPU from the same render, they only cost a small readback
+			bool success = true;
+			for(unsigned int level = 1; level < levels && success; level++)
+			{
+				phaseStart = Clock::microseconds();
+				m_pGLScene->getRGBPixels( m_pFrameBuffer, m_FrameBufferSize, level );
+				readTime += Clock::elapsedMilliseconds( phaseStart );
+
+				phaseStart = Clock::microseconds();
+				success = writeFrame( frame, m_pFrameBuffer, level );
+				writeTime += Clock::elapsedMilliseconds( phaseStart );
+			}
+
+			// Views are written only, the encoder and the ring carry the main view
+			for(unsigned int view = 0; view < m_pGLScene->getViewCount() && success && m_Options.m_WriteFrames; view++)
+			{
+				phaseStart = Clock::microseconds();
+				m_pGLScene->getViewPixels( view, m_pFrameBuffer, m_FrameBufferSize );
+				readTime += Clock::elapsedMilliseconds( phaseStart );
+
+				phaseStart = Clock::microseconds();
+				success = writeFrame( frame, m_pFrameBuffer, 0, view + 1 );
+				writeTime += Clock::elapsedMilliseconds( phaseStart );
+			}
+			if(!success)
+			{
+				break;
+			}
+
+			frame++;
+		}
+		const double totalTime = Clock::elapsedMilliseconds( startTime );
+
+		// Show throughput and average time per phase
+		const double frames = (frame > 0) ? (double) frame : 1.0;
+		std::cout << std::endl;
+		std::cout << "Frames      : " << frame << std::endl;
+		std::cout << "Total time  : " << totalTime << " ms" << std::endl;
+		std::cout << "Throughput  : " << ((totalTime > 0.0) ? (double) frame * 1000.0 / totalTime : 0.0) << " frames/s" << std::endl;
+		std::cout << "Grab        : " << grabTime / frames << " ms/frame" << std::endl;
+		std::cout << "Update      : " << updateTime / frames << " ms/frame" << std::endl;
+		std::cout << "Render      : " << renderTime / frames << " ms/frame" << std::endl;
+		std::cout << "Readback    : " << readTime / frames << " ms/frame" << std::endl;
+		std::cout << "Write       : " << writeTime / frames << " ms/frame" << std::endl;
+		printQuality();
+		printEncoder();
+		printOutputRing();
+		if(m_Options.m_HeadTracking)
+		{
+			std::cout << "Head region : " << 100.0 * regionCoverage / frames << " % of the depth grid per frame" << std::endl;
+		}
+		if(m_Options.m_ForegroundMode != FOREGROUND_ALL)
+		{
+			std::cout << "Foreground  : " << foregroundPixels / frames << " pixels of " << components / frames << " components per frame" << std::endl;
+		}
+		if(m_Options.m_ForegroundMode != FOREGROUND_ALL || m_Options.m_OpenRadius > 0 || m_Options.m_CloseRadius > 0)
+		{
+			std::cout << "Mask        : " << maskTime / frames << " us/frame" << std::endl;
+		}
+		std::cout << std::endl;
+		printLatency();
+		printGpuStatistics();
+
+		return frame;
+	}
+
+	unsigned int BatchProcessor::runPipelined(void)
+	{
+		GLScene* pScene = m_pGLScene;
+		ISensorInterface* pSensor = m_pSensorDevice;
+		RecordingWriter* pRecorder = &m_Recorder;
+		AvVideoEncoder* pEncoder = m_Encoder.isOpen() ? &m_Encoder : 0;
+		OutputRing* pOutputRing = &m_OutputRing;
+		const unsigned int maxFrames = m_Options.m_MaxFrames;
+		const unsigned int outputSize = m_FrameBufferSize;
+		const unsigned int outputLevels = m_Options.m_WriteFrames ? m_pGLScene->getOutputLevels() : 1;
+		const unsigned int outputViews = m_Options.m_WriteFrames ? m_pGLScene->getViewCount() : 0;
+		const unsigned long long startTime = Clock::microseconds();
+
+		// Filter and mesh run on other threads, so the quality can't change while frames are in flight
+		if(m_Options.m_FrameBudget > 0.0 && !m_Governor.isFixed())
+		{
+			std::cout << "--frame-budget only applies to --serial, the pipeline keeps quality level " << m_Governor.getLevel() << std::endl;
+		}
+
+		// The tracker needs the frames in order and the previous region, the pipeline stages have neither
+		if(m_Options.m_HeadTracking)
+		{
+			std::cout << "--head-roi only applies to --serial, the pipeline processes the full frame" << std::endl;
+		}
+
+		Pipeline pipeline;
+
+		pipeline.addStage( "capture", [=]( PipelineFrame& frame ) -> bool
+		{
+			if((maxFrames != 0 && frame.m_Sequence >= maxFrames) || !pSensor->grabFrame())
+			{
+				return false;
+			}
+
+			frame.m_Image = pSensor->getImageFrame();
+			frame.m_Depth = pSensor->getDepthFrame();
+			frame.m_SensorTimestamp = frame.m_Depth.getTimestamp();
+			frame.m_CaptureTime = tagCapture( frame.m_Image, frame.m_Depth );
+
+			// Driver buffers are only valid until the next grabFrame()
+			if(!frame.m_Image.isOwned()) frame.m_Image.detach();
+			if(!frame.m_Depth.isOwned()) frame.m_Depth.detach();
+
+			pRecorder->writeFrame( frame.m_CaptureTime - startTime, frame.m_Image.getData(), frame.m_Depth.getData() );
+			return true;
+		} );
+
+		pipeline.addStage( "filter", [=]( PipelineFrame& frame ) -> bool
+		{
+			pScene->filterDepth( frame.m_Depth, frame.m_Image, frame.m_SmoothDepth );
+			frame.m_Depth.release();
+			return true;
+		} );
+
+		pipeline.addStage( "mesh", [=]( PipelineFrame& frame ) -> bool
+		{
+			pScene->buildMesh( frame.m_SmoothDepth, frame.m_TextureHeightMap, frame.m_VertexHeightMap );
+			frame.m_SmoothDepth.release();
+			return true;
+		} );
+
+		// Everything touching OpenGL runs on this thread, the one owning the offscreen context
+		pipeline.addStage( "upload", [=]( PipelineFrame& frame ) -> bool
+		{
+			pScene->uploadMesh( frame.m_Image, frame.m_TextureHeightMap, frame.m_VertexHeightMap );
+			frame.m_Image.release();
+			frame.m_TextureHeightMap.release();
+			frame.m_VertexHeightMap.release();
+			return true;
+		}, STAGE_CALLER );
+
+		pipeline.addStage( "render", [=]( PipelineFrame& frame ) -> bool
+		{
+			pScene->update();
+			pScene->drawOffscreen();
+			return true;
+		}, STAGE_CALLER );
+
+		pipeline.addStage( "readback", [=]( PipelineFrame& frame ) -> bool
+		{
+			frame.m_Output = ImageFrame::allocate( pScene->getOutputWidth(), pScene->getOutputHeight(), 3 );
+			if(!pScene->getRGBPixels( frame.m_Output.getMutableData(), outputSize ))
+			{
+				return false;
+			}
+
+			// Smaller levels of the same render, only "write" needs them
+			frame.m_OutputLevels.resize( outputLevels - 1 );
+			for(unsigned int level = 1; level < outputLevels; level++)
+			{
+				ImageFrame& output = frame.m_OutputLevels[level - 1];
+				output = ImageFrame::allocate( pScene->getOutputWidth( level ), pScene->getOutputHeight( level ), 3 );
+				if(!pScene->getRGBPixels( output.getMutableData(), output.getSize(), level ))
+				{
+					return false;
+				}
+			}
+
+			frame.m_ViewOutputs.resize( outputViews );
+			for(unsigned int view = 0; view < outputViews; view++)
+			{
+				const RenderTarget* pTarget = pScene->getViewTarget( view );
+				ImageFrame& output = frame.m_ViewOutputs[view];
+				output = ImageFrame::allocate( pTarget->getWidth(), pTarget->getHeight(), 3 );
+				if(!pScene->getViewPixels( view, output.getMutableData(), output.getSize() ))
+				{
+					return false;
+				}
+			}
+
+			// Sequence numbers keep the nominal rate even where the input has gaps, the buffer is shared with "write"
+			if(pEncoder)
+			{
+				frame.m_Output.setTimestamp( frame.m_Sequence * 1000000ULL / ENCODE_FRAME_RATE );
+				pEncoder->push( frame.m_Output );
+			}
+			pOutputRing->publish( frame.m_Output.getData(), Clock::microseconds() );
+			return true;
+		}, STAGE_CALLER );
+
+		if(m_Options.m_WriteFrames)
+		{
+			pipeline.addStage( "write", [this]( PipelineFrame& frame ) -> bool
+			{
+				bool success = writeFrame( (unsigned int) frame.m_Sequence, frame.m_Output.getData() );
+				for(size_t i = 0; i < frame.m_OutputLevels.size() && success; i++)
+				{
+					success = writeFrame( (unsigned int) frame.m_Sequence, frame.m_OutputLevels[i].getData(), (unsigned int) i + 1 );
+				}
+				for(size_t i = 0; i < frame.m_ViewOutputs.size() && success; i++)
+				{
+					success = writeFrame( (unsigned int) frame.m_Sequence, frame.m_ViewOutputs[i].getData(), 0, (unsigned int) i + 1 );
+				}
+				frame.m_OutputLevels.clear();
+				frame.m_ViewOutputs.clear();
+				return success;
+			}, STAGE_WORKER, 4 );
+		}
+
+		pipeline.setOutputStage( "readback" );
+		pipeline.start();
+		while(!pipeline.isFinished())
+		{
+			pipeline.pump( 100 );
+		}
+		const double totalTime = Clock::elapsedMilliseconds( startTime );
+
+		const std::vector<PipelineStageStatistics> statistics = pipeline.getStatistics();
+		const unsigned int frame = statistics.empty() ? 0 : (unsigned int) statistics.back().m_Processed;
+
+		std::cout << std::endl;
+		std::cout << "Frames      : " << frame << std::endl;
+		std::cout << "Total time  : " << totalTime << " ms" << std::endl;
+		std::cout << "Throughput  : " << ((totalTime > 0.0) ? (double) frame * 1000.0 / totalTime : 0.0) << " frames/s" << std::endl;
+		printQuality();
+		printEncoder();
+		printOutputRing();
+		std::cout << std::endl;
+		pipeline.printStatistics( std::cout );
+		std::cout << std::endl;
+		m_OutputLatency = pipeline.getOutputLatency();
+		printLatency();
+		printGpuStatistics();
+
+		return frame;
+	}
+
+	/// \brief Abweichungen einer Tiefenkarte von der Referenz, siehe BatchProcessor::runUpsamplingBenchmark().
+	struct DepthError
+	{
+		double m_Milliseconds;				///< Summe der Filterzeiten
+		double m_AbsoluteError;				///< Summe der Abweichungen in mm (Pixel, die in beiden Karten gueltig sind)
+		unsigned long long m_Compared;		///< Anzahl dieser Pixel
+		double m_EdgeError;					///< Summe der Abweichungen an Tiefenkanten der Referenz
+		unsigned long long m_EdgeCompared;	///< Anzahl der verglichenen Kantenpixel
+		unsigned long long m_BadPixels;		///< Pixel mit mehr als BAD_PIXEL_MM Abweichung oder falschem Loch
+		unsigned long long m_Pixels;		///< Anzahl aller Pixel
+		unsigned long long m_EdgePixels;	///< Vom Joint-Bilateral-Filter berechnete Pixel
+
+		DepthError(void)
+			:
+			m_Milliseconds( 0.0 ),
+			m_AbsoluteError( 0.0 ),
+			m_Compared( 0 ),
+			m_EdgeError( 0.0 ),
+			m_EdgeCompared( 0 ),
+			m_BadPixels( 0 ),
+			m_Pixels( 0 ),
+			m_EdgePixels( 0 )
+		{
+		}
+	};
+
+	static const int BAD_PIXEL_MM = 20;		// Deviation that counts as a wrong pixel
+	static const int EDGE_MM = 40;			// Depth step between neighbours that marks an edge of the reference
+
+	static void compareDepth( const DepthFrame& reference, const DepthFrame& test, DepthError& error )
+	{
+		const unsigned int width = reference.getWidth();
+		const unsigned int height = reference.getHeight();
+		if(test.getWidth() != width || test.getHeight() != height)
+		{
+			return;
+		}
+
+		const unsigned short* pReference = reference.getData();
+		const unsigned short* pTest = test.getData();
+		for(unsigned int y = 0; y < height; y++)
+		{
+			for(unsigned int x = 0; x < width; x++)
+			{
+				const unsigned int index = y * width + x;
+				const int expected = pReference[index];
+				const int actual = pTest[index];
+				error.m_Pixels++;
+
+				if(expected == 0 || actual == 0)
+				{
+					if(expected != actual)
+					{
+						error.m_BadPixels++;
+					}
+					continue;
+				}
+
+				const int difference = abs( actual - expected );
+				error.m_AbsoluteError += difference;
+				error.m_Compared++;
+				if(difference > BAD_PIXEL_MM)
+				{
+					error.m_BadPixels++;
+				}
+
+				// Edge of the reference: a right or lower neighbour on another surface
+				const bool edge =
+					(x + 1 < width  && pReference[index + 1] != 0     && abs( (int) pReference[index + 1] - expected ) > EDGE_MM) ||
+					(y + 1 < height && pReference[index + width] != 0 && abs( (int) pReference[index + width] - expected ) > EDGE_MM);
+				if(edge)
+				{
+					error.m_EdgeError += difference;
+					error.m_EdgeCompared++;
+				}
+			}
+		}
+	}
+
+	unsigned int BatchProcessor::runUpsamplingBenchmark(void)
+	{
+		DepthFrame reference, guided, unguided;
+		DepthError full, guidedError, unguidedError;
+		unsigned int frame = 0;
+
+		while(m_Options.m_MaxFrames == 0 || frame < m_Options.m_MaxFrames)
+		{
+			if(!m_pSensorDevice->grabFrame())
+			{
+				break;
+			}
+
+			const ImageFrame imageFrame = m_pSensorDevice->getImageFrame();
+			const DepthFrame depthFrame = m_pSensorDevice->getDepthFrame();
+
+			m_pGLScene->setGuidedUpsampling( false );
+			unsigned long long startTime = Clock::microseconds();
+			m_pGLScene->filterDepth( depthFrame, imageFrame, reference );
+			full.m_Milliseconds += Clock::elapsedMilliseconds( startTime );
+
+			m_pGLScene->setGuidedUpsampling( true );
+			startTime = Clock::microseconds();
+			m_pGLScene->filterDepth( depthFrame, imageFrame, guided );
+			guidedError.m_Milliseconds += Clock::elapsedMilliseconds( startTime );
+			guidedError.m_EdgePixels += m_pGLScene->getSceneStatistics().m_EdgePixels;
+
+			startTime = Clock::microseconds();
+			m_pGLScene->filterDepth( depthFrame, ImageFrame(), unguided );
+			unguidedError.m_Milliseconds += Clock::elapsedMilliseconds( startTime );
+			unguidedError.m_EdgePixels += m_pGLScene->getSceneStatistics().m_EdgePixels;
+
+			compareDepth( reference, guided, guidedError );
+			compareDepth( reference, unguided, unguidedError );
+			frame++;
+		}
+		m_pGLScene->setGuidedUpsampling( m_Options.m_GuidedUpsampling );
+
+		const double frames = (frame > 0) ? (double) frame : 1.0;
+		const double fullMilliseconds = full.m_Milliseconds / frames;
+		const DepthError* pErrors[3] = { &full, &guidedError, &unguidedError };
+		const char* pNames[3] = { "full grid", "half, RGB guided", "half, unguided" };
+
+		std::cout << std::endl;
+		std::cout << "Frames      : " << frame << std::endl;
+		std::cout << "Grid        : " << reference.getWidth() << " x " << reference.getHeight() << " (quality " << m_pGLScene->getQuality().m_pName << ")" << std::endl;
+		std::cout << std::endl;
+		printf( "%-18s %10s %10s %12s %10s %10s\n", "filter", "ms/frame", "speedup", "mean err mm", "edge err", "bad px %" );
+		for(unsigned int i = 0; i < 3; i++)
+		{
+			const DepthError& error = *pErrors[i];
+			const double milliseconds = error.m_Milliseconds / frames;
+			printf( "%-18s %10.2f %9.2fx %12.2f %10.2f %10.2f\n",
+				pNames[i], milliseconds,
+				(milliseconds > 0.0) ? fullMilliseconds / milliseconds : 0.0,
+				(error.m_Compared > 0) ? error.m_AbsoluteError / (double) error.m_Compared : 0.0,
+				(error.m_EdgeCompared > 0) ? error.m_EdgeError / (double) error.m_EdgeCompared : 0.0,
+				(error.m_Pixels > 0) ? 100.0 * (double) error.m_BadPixels / (double) error.m_Pixels : 0.0 );
+		}
+
+		const double gridPixels = (double) reference.getSize() * frames;
+		std::cout << std::endl;
+		std::cout << "Bilateral   : " << ((gridPixels > 0.0) ? 100.0 * (double) guidedError.m_EdgePixels / gridPixels : 0.0)
+			<< " % of the pixels needed the joint bilateral step" << std::endl;
+		std::cout << std::endl;
+
+		return frame;
+	}
+
+	static const int SPLAT_BAD_PIXEL = 32;	// Channel difference that counts as a visibly different pixel
+
+	unsigned int BatchProcessor::runPointBenchmark(void)
+	{
+		const MeshMode modes[2] = { MESH_TRIANGLES, MESH_POINTS };
+		const char* pNames[2] = { "triangles", "points" };
+		double renderTime[2] = { 0.0, 0.0 };
+		double primitives[2] = { 0.0, 0.0 };
+		GLubyte* pReference = new GLubyte[m_FrameBufferSize];
+		double squaredError = 0.0;
+		unsigned long long badPixels = 0;
+		unsigned int frame = 0;
+
+		while(m_Options.m_MaxFrames == 0 || frame < m_Options.m_MaxFrames)
+		{
+			if(!m_pSensorDevice->grabFrame())
+			{
+				break;
+			}
+
+			// One upload, both modes draw the same height map
+			m_pGLScene->setMeshMode( MESH_TRIANGLES );
+			m_pGLScene->updateData( m_pSensorDevice->getImageFrame(), m_pSensorDevice->getDepthFrame() );
+
+			for(unsigned int i = 0; i < 2; i++)
+			{
+				// The point list is built per upload, so it counts towards the points
+				const unsigned long long startTime = Clock::microseconds();
+				m_pGLScene->setMeshMode( modes[i] );
+				m_pGLScene->update();
+				m_pGLScene->drawOffscreen();
+				glFinish();
+				renderTime[i] += Clock::elapsedMilliseconds( startTime );
+
+				const SceneStatistics statistics = m_pGLScene->getSceneStatistics();
+				primitives[i] += (modes[i] == MESH_POINTS) ? statistics.m_Points : statistics.m_Triangles;
+				m_pGLScene->getRGBPixels( (i == 0) ? pReference : m_pFrameBuffer, m_FrameBufferSize );
+			}
+
+			for(unsigned int j = 0; j < m_FrameBufferSize; j += 3)
+			{
+				int maxDifference = 0;
+				for(unsigned int k = 0; k < 3; k++)
+				{
+					const int difference = abs( (int) m_pFrameBuffer[j + k] - (int) pReference[j + k] );
+					squaredError += (double) (difference * difference);
+					maxDifference = (difference > maxDifference) ? difference : maxDifference;
+				}
+				if(maxDifference > SPLAT_BAD_PIXEL)
+				{
+					badPixels++;
+				}
+			}
+			frame++;
+		}
+		m_pGLScene->setMeshMode( m_Options.m_MeshMode );
+		delete[] pReference;
+
+		const double frames = (frame > 0) ? (double) frame : 1.0;
+		const double meanSquaredError = squaredError / ((double) m_FrameBufferSize * frames);
+		const double psnr = (meanSquaredError > 0.0) ? 10.0 * log10( 255.0 * 255.0 / meanSquaredError ) : 99.0;
+
+		std::cout << std::endl;
+		std::cout << "Frames      : " << frame << std::endl;
+		std::cout << "Output      : " << m_pGLScene->getOutputWidth() << " x " << m_pGLScene->getOutputHeight() << " (quality " << m_pGLScene->getQuality().m_pName << ")" << std::endl;
+		std::cout << std::endl;
+		printf( "%-12s %12s %12s %10s\n", "mesh", "primitives", "ms/frame", "frames/s" );
+		for(unsigned int i = 0; i < 2; i++)
+		{
+			const double milliseconds = renderTime[i] / frames;
+			printf( "%-12s %12.0f %12.2f %10.1f\n", pNames[i], primitives[i] / frames, milliseconds, (milliseconds > 0.0) ? 1000.0 / milliseconds : 0.0 );
+		}
+		std::cout << std::endl;
+		std::cout << "Points vs triangles: PSNR " << psnr << " dB, " << 100.0 * (double) badPixels / ((double) (m_FrameBufferSize / 3) * frames)
+			<< " % of the pixels differ by more than " << SPLAT_BAD_PIXEL << std::endl;
+		std::cout << std::endl;
+		printGpuStatistics();
+
+		return frame;
+	}
+
+	unsigned int BatchProcessor::runCpu(void)
+	{
+		double grabTime = 0.0, filterTime = 0.0, meshTime = 0.0, projectTime = 0.0, splatTime = 0.0, fillTime = 0.0, writeTime = 0.0;
+		double points = 0.0, filledPixels = 0.0;
+		DepthFrame smoothFrame;
+		ImageFrame textureHeightMap;
+		VertexFrame vertexHeightMap;
+		unsigned int frame = 0;
+
+		// The image must not depend on the thread count, see CpuRenderer::checkProjection()
+		const unsigned int mismatches = CpuRenderer::checkProjection();
+		if(mismatches > 0)
+		{
+			std::cerr << "CPU render  : SSE2 and scalar projection differ for " << mismatches << " points" << std::endl;
+			return 0;
+		}
+
+		if(m_pGLScene->getOutputLevels() > 1 || m_pGLScene->getViewCount() > 0 || m_Options.m_HeadTracking)
+		{
+			std::cout << "CPU render  : levels, views and head-roi are ignored" << std::endl;
+		}
+
+		const unsigned long long startTime = Clock::microseconds();
+		while(m_Options.m_MaxFrames == 0 || frame < m_Options.m_MaxFrames)
+		{
+			double frameWork = 0.0;
+			unsigned long long phaseStart = Clock::microseconds();
+			if(!m_pSensorDevice->grabFrame())
+			{
+				break;
+			}
+			grabTime += Clock::elapsedMilliseconds( phaseStart );
+
+			const ImageFrame imageFrame = m_pSensorDevice->getImageFrame();
+			const DepthFrame depthFrame = m_pSensorDevice->getDepthFrame();
+			const unsigned long long captureTime = tagCapture( imageFrame, depthFrame );
+			m_Recorder.writeFrame( Clock::microseconds() - startTime, imageFrame.getData(), depthFrame.getData() );
+
+			// The same two CPU steps as the pipeline, only the upload and the draw call are replaced
+			phaseStart = Clock::microseconds();
+			m_pGLScene->filterDepth( depthFrame, imageFrame, smoothFrame );
+			frameWork += Clock::elapsedMilliseconds( phaseStart );
+			filterTime += Clock::elapsedMilliseconds( phaseStart );
+
+			phaseStart = Clock::microseconds();
+			m_pGLScene->buildMesh( smoothFrame, textureHeightMap, vertexHeightMap );
+			frameWork += Clock::elapsedMilliseconds( phaseStart );
+			meshTime += Clock::elapsedMilliseconds( phaseStart );
+
+			m_pGLScene->update();
+			m_pGLScene->renderCpu( m_CpuRenderer, imageFrame, vertexHeightMap );
+			const CpuRenderStatistics& statistics = m_CpuRenderer.getStatistics();
+			frameWork += statistics.m_ProjectMilliseconds + statistics.m_SplatMilliseconds + statistics.m_FillMilliseconds;
+			projectTime += statistics.m_ProjectMilliseconds;
+			splatTime += statistics.m_SplatMilliseconds;
+			fillTime += statistics.m_FillMilliseconds;
+			points += statistics.m_Points;
+			filledPixels += statistics.m_FilledPixels;
+
+			m_CpuRenderer.getRGBPixels( m_pFrameBuffer, m_FrameBufferSize );
+			m_OutputLatency.add( Clock::microseconds() - captureTime );
+			m_OutputRing.publish( m_pFrameBuffer, Clock::microseconds() );
+
+			if(m_Governor.addFrameTime( frameWork ))
+			{
+				m_pGLScene->setQuality( GLScene::getQualityLevel( m_Governor.getLevel() ) );
+			}
+
+			if(m_Options.m_WriteFrames)
+			{
+				phaseStart = Clock::microseconds();
+				if(!writeFrame( frame, m_pFrameBuffer ))
+				{
+					break;
+				}
+				writeTime += Clock::elapsedMilliseconds( phaseStart );
+			}
+
+			if(m_Encoder.isOpen())
+			{
+				ImageFrame output = ImageFrame::allocate( m_CpuRenderer.getWidth(), m_CpuRenderer.getHeight(), 3 );
+				memcpy( output.getMutableData(), m_pFrameBuffer, m_FrameBufferSize );
+				output.setTimestamp( (unsigned long long) frame * 1000000ULL / ENCODE_FRAME_RATE );
+				m_Encoder.push( output );
+			}
+
+			frame++;
+		}
+		const double totalTime = Clock::elapsedMilliseconds( startTime );
+
+		const double frames = (frame > 0) ? (double) frame : 1.0;
+		const double outputPixels = (double) m_CpuRenderer.getWidth() * (double) m_CpuRenderer.getHeight();
+		std::cout << std::endl;
+		std::cout << "Frames      : " << frame << std::endl;
+		std::cout << "Total time  : " << totalTime << " ms" << std::endl;
+		std::cout << "Throughput  : " << ((totalTime > 0.0) ? (double) frame * 1000.0 / totalTime : 0.0) << " frames/s" << std::endl;
+		std::cout << "Threads     : " << TaskPool::instance().getThreadCount() << std::endl;
+		std::cout << "Grab        : " << grabTime / frames << " ms/frame" << std::endl;
+		std::cout << "Filter      : " << filterTime / frames << " ms/frame" << std::endl;
+		std::cout << "Mesh        : " << meshTime / frames << " ms/frame" << std::endl;
+		std::cout << "Project     : " << projectTime / frames << " ms/frame" << std::endl;
+		std::cout << "Splat       : " << splatTime / frames << " ms/frame" << std::endl;
+		std::cout << "Fill        : " << fillTime / frames << " ms/frame" << std::endl;
+		std::cout << "Write       : " << writeTime / frames << " ms/frame" << std::endl;
+		std::cout << "Points      : " << points / frames << " per frame, " << m_CpuRenderer.getStatistics().m_SplatSize << " px splats, "
+			<< 100.0 * filledPixels / (outputPixels * frames) << " % of the pixels filled" << std::endl;
+		printQuality();
+		printEncoder();
+		printOutputRing();
+		std::cout << std::endl;
+		printLatency();
+
+		return frame;
+	}
+
+	void BatchProcessor::printGpuStatistics(void)
+	{
+		const std::vector<GpuPassStatistics> statistics = m_pGLScene->getGpuStatistics();
+		if(!statistics.empty())
+		{
+			GpuTimer::printStatistics( std::cout, statistics );
+			std::cout << std::endl;
+		}
+	}
+
+	bool BatchProcessor::initializeGL(void)
+	{
+		std::cout << "Initializes OpenGL:" << std::endl;
+		GLenum errorCode = glewInit();
+		if(GLEW_OK != errorCode)
+		{
+			std::cerr << "GlEW-Initialization gave error: " << glewGetErrorString( errorCode ) << std::endl;
+			return false;
+		}
+		std::cout << "Using GLEW" << std::endl;
+
+		if(!GLEW_VERSION_2_0)
+		{
+			std::cerr << "GL 2.0 is not supported." << std::endl;
+			return false;
+		}
+		std::cout << "Using GL 2.0\n" << std::endl;
+
+		// Set color and depth clear value
+		glClearDepth( 1.0f );
+		glClearColor( 100.0f / 255.0f, 149.0f / 255.0f, 1.0f, 1.0f );
+
+		// Enable Z-buffer read and write
+		glEnable( GL_DEPTH_TEST );
+		glDepthMask( GL_TRUE );
+		return true;
+	}
+
+	ISensorInterface* BatchProcessor::createSensor( const std::string& fileName ) const
+	{
+		const std::string::size_type dot = fileName.find_last_of( '.' );
+		std::string extension = (dot == std::string::npos) ? "" : fileName.substr( dot + 1 );
+		for(std::string::size_type i = 0; i < extension.size(); i++)
+		{
+			extension[i] = (char) tolower( extension[i] );
+		}
+
+		if(fileName == "synthetic")
+		{
+			// Paced like a Kinect, so latency is measured under realistic load
+			return new SensorSynthetic( 30, (m_Options.m_MaxFrames > 0) ? m_Options.m_MaxFrames : 300 );
+		}
+
+		if(extension == "dlr")
+		{
+			return new SensorRecording( fileName, false );
+		}
+
+		if(extension == "oni")
+		{
+			// Play the oni file once and as fast as possible
+			SensorOpenNI* pSensor = new SensorOpenNI( fileName.c_str() );
+			pSensor->setPlayback( false, 0.0 );
+			return pSensor;
+		}
+
+		std::cerr << "Unknown input format: " << fileName << std::endl;
+		return 0;
+	}
+
+	bool BatchProcessor::writeFrame( const unsigned int frame, const GLubyte* pPixels, const unsigned int level, const unsigned int view ) const
+	{
+		const unsigned int width  = (view == 0) ? m_pGLScene->getOutputWidth( level )  : m_pGLScene->getViewTarget( view - 1 )->getWidth( level );
+		const unsigned int height = (view == 0) ? m_pGLScene->getOutputHeight( level ) : m_pGLScene->getViewTarget( view - 1 )->getHeight( level );
+
+		char fileName[48];
+		if(view > 0)
+		{
+			sprintf( fileName, "frame%06u_v%u.ppm", frame, view );
+		}
+		else if(level == 0)
+		{
+			sprintf( fileName, "frame%06u.ppm", frame );
+		}
+		else
+		{
+			sprintf( fileName, "frame%06u_%u.ppm", frame, level );
+		}
+		const std::string path = m_Options.m_OutputDirectory + "/" + fileName;
+
+		FILE* pFile = fopen( path.c_str(), "wb" );
+		if(!pFile)
+		{
+			std::cerr << "Couldn't write " << path << std::endl;
+			return false;
+		}
+
+		fprintf( pFile, "P6\n%u %u\n255\n", width, height );
+
+		// OpenGL textures are stored bottom up, images top down
+		bool success = true;
+		for(unsigned int y = height; y > 0 && success; y--)
+		{
+			success = fwrite( pPixels + (y - 1) * width * 3, 1, width * 3, pFile ) == width * 3;
+		}
+
+		fclose( pFile );
+		return success;
+	}
+};
@@ -0,0 +1,247 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../DirectLook/NonCopyable.h"
+#include "../DirectLook/Core/Clock.h"
+#include "../DirectLook/Core/OutputRing.h"
+#include "../DirectLook/Core/Pipeline.h"
+#include "../DirectLook/Core/QualityGovernor.h"
+#include "../DirectLook/OpenGL/AvVideoEncoder.h"
+#include "../DirectLook/OpenGL/OffscreenContext.h"
+#include "../DirectLook/OpenGL/GLScene.h"
+#include "../DirectLook/OpenGL/GLCamera.h"
+#include "../DirectLook/OpenGL/Shader.h"
+#include "../DirectLook/Sensor/ISensorInterface.h"
+#include "../DirectLook/Sensor/SensorRecording.h"
+
+namespace DirectLook
+{
+	/// \brief Optionen fuer einen Batch-Durchlauf.
+	struct BatchOptions
+	{
+		std::string m_InputFile;			///< Oni-Datei, DirectLook-Aufnahme (*.dlr) oder "synthetic"
+		std::string m_OutputDirectory;		///< Zielverzeichnis fuer die korrigierten Bilder
+		std::string m_RecordFile;			///< Optional: Eingangsdaten zusaetzlich als DirectLook-Aufnahme speichern
+		std::string m_EncodeFile;			///< Optional: Korrigierte Bilder zusaetzlich als Video speichern
+		VideoCodec m_EncodeCodec;			///< Codec dieses Videos
+		std::string m_ShareName;			///< Optional: Korrigierte Bilder unter diesem Namen im Shared Memory bereitstellen
+		unsigned int m_OutputWidth;			///< Breite der Ausgabe (0 = Kamerabreite), siehe GLScene::setOutputSize()
+		unsigned int m_OutputHeight;		///< Hoehe der Ausgabe (0 = Kamerahoehe)
+		unsigned int m_OutputLevels;		///< Stufen der Ausgabe, jede weitere wird mit halber Groesse zusaetzlich geschrieben
+		std::vector<float> m_ViewHeights;	///< Je eine zusaetzliche Ansicht, deren Kamera um diesen Wert nach oben verschoben ist
+		unsigned short m_NearThreshold;		///< Near-Threshold der Tiefensegmentierung
+		unsigned short m_FarThreshold;		///< Far-Threshold der Tiefensegmentierung
+		unsigned int m_MaxFrames;			///< Maximale Anzahl Bilder (0 = alle)
+		bool m_WriteFrames;					///< Korrigierte Bilder auf die Festplatte schreiben?
+		bool m_Pipelined;					///< Stufen ueberlappend in einer Pipeline ausfuehren (false = nacheinander)
+		double m_LatencyBudget;				///< Obergrenze fuer das 99. Perzentil der Latenz bis zum Auslesen in ms (0 = keine)
+		int m_QualityLevel;					///< Feste Qualitaetsstufe, siehe GLScene::getQualityLevel() (-1 = automatisch)
+		double m_FrameBudget;				///< Zeitbudget pro Bild fuer die automatische Qualitaetsstufe in ms (0 = aus)
+		bool m_GuidedUpsampling;			///< SmoothFilter auf halbem Gitter mit RGB-gefuehrter Vergroesserung, siehe GLScene::setGuidedUpsampling()
+		bool m_UpsamplingBenchmark;			///< Statt eines Durchlaufes volle und halbe Filterung vergleichen
+		MeshMode m_MeshMode;				///< Dreiecksnetz oder Punkte, siehe GLScene::setMeshMode()
+		bool m_PointBenchmark;				///< Statt eines Durchlaufes Dreiecksnetz und Punkte vergleichen
+		bool m_CpuRender;					///< Ohne OpenGL mit CpuRenderer zeichnen, siehe GLScene::renderCpu()
+		bool m_HeadTracking;				///< Verarbeitung auf den Kopf beschraenken, siehe GLScene::setHeadTracking() (nur seriell)
+		ForegroundMode m_ForegroundMode;	///< Welche Komponente als Vordergrund gilt, siehe GLScene::setForegroundMode()
+		unsigned int m_OpenRadius;			///< Radius des Oeffnens der Vordergrundmaske (0 = aus)
+		unsigned int m_CloseRadius;			///< Radius des Schliessens der Vordergrundmaske (0 = aus)
+
+		BatchOptions(void)
+			:
+			m_OutputDirectory( "." ),
+			m_EncodeCodec( VIDEO_CODEC_FFV1 ),
+			m_OutputWidth( 0 ),
+			m_OutputHeight( 0 ),
+			m_OutputLevels( 1 ),
+			m_NearThreshold( 500 ),
+			m_FarThreshold( 800 ),
+			m_MaxFrames( 0 ),
+			m_WriteFrames( true ),
+			m_Pipelined( true ),
+			m_LatencyBudget( 0.0 ),
+			m_QualityLevel( -1 ),
+			m_FrameBudget( 0.0 ),
+			m_GuidedUpsampling( false ),
+			m_UpsamplingBenchmark( false ),
+			m_MeshMode( MESH_TRIANGLES ),
+			m_PointBenchmark( false ),
+			m_CpuRender( false ),
+			m_HeadTracking( false ),
+			m_ForegroundMode( FOREGROUND_ALL ),
+			m_OpenRadius( 0 ),
+			m_CloseRadius( 0 )
+		{
+		}
+	};
+
+	/// \brief Die Klasse BatchProcessor verarbeitet eine Aufnahme ohne Fenster so schnell wie moeglich.
+	///
+	/// Jedes Bildpaar durchlaeuft Filterung, Rendering und Auslesen der Render-Target Textur wie im
+	/// interaktiven Betrieb. Das Ergebnis wird als PPM-Bild gespeichert, zum Schluss wird der
+	/// Durchsatz in Bildern pro Sekunde ausgegeben.
+	class BatchProcessor : public NonCopyable
+	{
+
+	private:
+		BatchOptions m_Options;				///< Optionen des Batch-Durchlaufes
+		OffscreenContext m_Context;			///< OpenGL-Kontext ohne Fenster
+		ISensorInterface* m_pSensorDevice;	///< Eingangsdaten (Oni-Datei oder DirectLook-Aufnahme)
+		GLCamera* m_pCamera;				///< Virtuelle Kamera
+		std::vector<GLCamera*> m_ViewCameras;	///< Kameras der zusaetzlichen Ansichten, siehe BatchOptions::m_ViewHeights
+		Shader* m_pShader;					///< Shader programm for DirectLook
+		GLScene* m_pGLScene;				///< OpenGL scene
+		RecordingWriter m_Recorder;			///< Schreibt die Eingangsdaten optional als DirectLook-Aufnahme
+		AvVideoEncoder m_Encoder;			///< Schreibt die korrigierten Bilder optional als Video
+		OutputRing m_OutputRing;			///< Stellt die korrigierten Bilder optional anderen Prozessen bereit
+		GLubyte* m_pFrameBuffer;			///< Ausgelesene Render-Target Textur
+		unsigned int m_FrameBufferSize;		///< Groesse von m_pFrameBuffer in Byte
+		bool m_HostTimestamps;				///< Liefert der Sensor Zeitstempel der Systemuhr (SensorSynthetic)?
+		LatencyHistogram m_OutputLatency;	///< Latenz von der Aufnahme bis zum Auslesen
+		LatencyHistogram m_SensorSkew;		///< Abstand der Zeitstempel von RGB- und Tiefenbild
+		QualityGovernor m_Governor;			///< Waehlt die Qualitaetsstufe im seriellen Betrieb
+		CpuRenderer m_CpuRenderer;			///< Zeichnet bei BatchOptions::m_CpuRender statt der Grafikkarte
+
+	public:
+		////////////////////////////////////////////////////////////
+		/// \brief Konstruktor
+		///
+		/// \param options Optionen des Batch-Durchlaufes
+		///
+		////////////////////////////////////////////////////////////
+		BatchProcessor( const BatchOptions& options );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Destruktor
+		////////////////////////////////////////////////////////////
+		~BatchProcessor(void);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Erzeugt den OpenGL-Kontext, oeffnet die Eingangsdaten und legt die 3D-Szene an.
+		///
+		/// \return True wenn erfolgreich, false wenn fehlgeschlagen
+		///
+		////////////////////////////////////////////////////////////
+		bool initialize(void);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Verarbeitet alle Bildpaare und gibt die Statistik aus.
+		///
+		/// \return Anzahl der verarbeiteten Bilder
+		///
+		////////////////////////////////////////////////////////////
+		unsigned int run(void);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Prueft das 99. Perzentil der Latenz bis zum Auslesen gegen BatchOptions::m_LatencyBudget.
+		///
+		/// \return True wenn kein Budget gesetzt ist oder es eingehalten wurde
+		///
+		////////////////////////////////////////////////////////////
+		bool checkLatencyBudget(void) const;
+
+	private:
+		////////////////////////////////////////////////////////////
+		/// \brief Fuehrt alle Schritte fuer jedes Bild nacheinander aus.
+		////////////////////////////////////////////////////////////
+		unsigned int runSerial(void);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Fuehrt Aufnahme, Filterung, Mesh-Aufbau, Upload, Rendering, Auslesen und Schreiben
+		/// als Stufen einer Pipeline ueberlappend aus.
+		////////////////////////////////////////////////////////////
+		unsigned int runPipelined(void);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Vergleicht Zeit und Ergebnis von SmoothFilter auf vollem Gitter mit der Filterung auf
+		/// halbem Gitter, einmal mit und einmal ohne RGB-Fuehrung beim Vergroessern.
+		///
+		/// Referenz ist die geglaettete Tiefenkarte in voller Aufloesung. Gezaehlt werden die mittlere
+		/// Abweichung, die Abweichung an Tiefenkanten der Referenz und der Anteil falscher Pixel.
+		///
+		////////////////////////////////////////////////////////////
+		unsigned int runUpsamplingBenchmark(void);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Vergleicht Renderzeit und Bild der Punkte (MESH_POINTS) mit dem Dreiecksnetz.
+		///
+		/// Jedes Bild wird einmal hochgeladen und mit beiden Darstellungen gerendert und ausgelesen.
+		/// Referenz ist das Dreiecksnetz, gezaehlt werden PSNR und der Anteil deutlich abweichender Pixel.
+		///
+		////////////////////////////////////////////////////////////
+		unsigned int runPointBenchmark(void);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Fuehrt alle Schritte wie runSerial() nacheinander aus, zeichnet aber mit dem CpuRenderer.
+		///
+		/// Der OpenGL-Kontext wird nur zum Anlegen der Szene gebraucht. Stufen, zusaetzliche Ansichten,
+		/// Hintergrundvideo und Kopfverfolgung gibt es nur beim Zeichnen mit OpenGL.
+		///
+		////////////////////////////////////////////////////////////
+		unsigned int runCpu(void);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Gibt die GPU-Zeiten der Render-Durchgaenge aus, sofern Timer-Queries verfuegbar sind.
+		////////////////////////////////////////////////////////////
+		void printGpuStatistics(void);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Gibt die Latenz bis zum Auslesen und den Abstand der Sensor-Zeitstempel aus.
+		////////////////////////////////////////////////////////////
+		void printLatency(void) const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Schliesst das Video und gibt Durchsatz, verworfene Bilder und Verzoegerung des Encoders aus.
+		////////////////////////////////////////////////////////////
+		void printEncoder(void);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Gibt die Anzahl der im Shared Memory bereitgestellten Bilder aus.
+		////////////////////////////////////////////////////////////
+		void printOutputRing(void) const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Gibt die Qualitaetsstufe am Ende des Durchlaufes und die Anzahl der Wechsel aus.
+		////////////////////////////////////////////////////////////
+		void printQuality(void) const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Zaehlt den Abstand der Sensor-Zeitstempel und liefert den Aufnahmezeitpunkt zurueck.
+		///
+		/// \return Zeitstempel des Sensors bei SensorSynthetic, sonst der aktuelle Zeitpunkt (Clock::microseconds())
+		///
+		////////////////////////////////////////////////////////////
+		unsigned long long tagCapture( const ImageFrame& imageFrame, const DepthFrame& depthFrame );
+
+		////////////////////////////////////////////////////////////
+		/// \brief Initialisiert GLEW und den OpenGL-Zustand wie SensorGLWidget::initializeGL().
+		////////////////////////////////////////////////////////////
+		bool initializeGL(void);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Erzeugt anhand der Dateiendung das passende Sensor-Objekt.
+		////////////////////////////////////////////////////////////
+		ISensorInterface* createSensor( const std::string& fileName ) const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Speichert eine ausgelesene Render-Target Textur als PPM-Bild.
+		///
+		/// Stufe 0 wird als frame000000.ppm gespeichert, weitere Stufen als frame000000_1.ppm usw.,
+		/// zusaetzliche Ansichten als frame000000_v1.ppm usw.
+		///
+		/// \param frame   Nummer des Bildes
+		/// \param pPixels RGB-Werte der Render-Target Textur
+		/// \param level   Stufe der Ausgabe, bestimmt Groesse und Dateiname
+		/// \param view    Zusaetzliche Ansicht (0 = Hauptansicht, 1 = erste Ansicht aus GLScene::addView() usw.)
+		///
+		/// \return True wenn erfolgreich, false wenn fehlgeschlagen
+		///
+		////////////////////////////////////////////////////////////
+		bool writeFrame( const unsigned int frame, const GLubyte* pPixels, const unsigned int level = 0, const unsigned int view = 0 ) const;
+	};
+};
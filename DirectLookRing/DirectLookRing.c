@@ -0,0 +1,302 @@
+#include "DirectLookRing.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef _WIN32
+	#include <windows.h>
+#else
+	#include <errno.h>
+	#include <fcntl.h>
+	#include <limits.h>
+	#include <linux/futex.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <sys/syscall.h>
+	#include <time.h>
+	#include <unistd.h>
+#endif
+
+struct DirectLookRing
+{
+	const DirectLookRingHeader* header;
+	size_t size;
+#ifdef _WIN32
+	HANDLE mapping;
+	HANDLE events[2];	/* signalled when a frame with an even / odd number is published */
+#endif
+};
+
+/*
+*	checks the header of a freshly mapped block against the layout of this client
+*/
+static int checkHeader(const DirectLookRingHeader* header, size_t size)
+{
+	uint32_t i;
+
+	if(size < sizeof(DirectLookRingHeader) || header->magic != DL_RING_MAGIC || header->version != DL_RING_VERSION
+		|| header->headerSize != sizeof(DirectLookRingHeader) || header->slotCount == 0 || header->slotCount > DL_RING_MAX_SLOTS
+		|| header->totalSize > size || (uint64_t) header->stride * header->height > header->slotSize)
+	{
+		return 0;
+	}
+	for(i = 0; i < header->slotCount; i++)
+	{
+		if(header->slots[i].offset + header->slotSize > header->totalSize)
+		{
+			return 0;
+		}
+	}
+	return 1;
+}
+
+#ifdef _WIN32
+
+DirectLookRing* dlRingOpen(const char* name)
+{
+	char mappingName[DL_RING_NAME_SIZE + 32];
+	char eventName[DL_RING_NAME_SIZE + 32];
+	DirectLookRing* ring;
+	int i;
+	MEMORY_BASIC_INFORMATION info;
+
+	_snprintf(mappingName, sizeof(mappingName), "Local\\directlook_%s", name);
+	mappingName[sizeof(mappingName) - 1] = 0;
+
+	ring = (DirectLookRing*) calloc(1, sizeof(DirectLookRing));
+	if(!ring)
+	{
+		return 0;
+	}
+
+	ring->mapping = OpenFileMappingA(FILE_MAP_READ, FALSE, mappingName);
+	if(!ring->mapping)
+	{
+		free(ring);
+		return 0;
+	}
+	ring->header = (const DirectLookRingHeader*) MapViewOfFile(ring->mapping, FILE_MAP_READ, 0, 0, 0);
+	if(!ring->header || VirtualQuery(ring->header, &info, sizeof(info)) == 0)
+	{
+		dlRingClose(ring);
+		return 0;
+	}
+	ring->size = info.RegionSize;
+	if(!checkHeader(ring->header, ring->size))
+	{
+		dlRingClose(ring);
+		return 0;
+	}
+
+	/* without the events dlRingWait polls */
+	for(i = 0; i < 2; i++)
+	{
+		_snprintf(eventName, sizeof(eventName), "Local\\directlook_%s_frame%d", name, i);
+		eventName[sizeof(eventName) - 1] = 0;
+		ring->events[i] = OpenEventA(SYNCHRONIZE, FALSE, eventName);
+	}
+	return ring;
+}
+
+void dlRingClose(DirectLookRing* ring)
+{
+	if(!ring)
+	{
+		return;
+	}
+	if(ring->events[0])
+	{
+		CloseHandle(ring->events[0]);
+	}
+	if(ring->events[1])
+	{
+		CloseHandle(ring->events[1]);
+	}
+	if(ring->header)
+	{
+		UnmapViewOfFile(ring->header);
+	}
+	if(ring->mapping)
+	{
+		CloseHandle(ring->mapping);
+	}
+	free(ring);
+}
+
+/*
+*	sleeps until the writer signals a frame, at most timeoutMs
+*/
+static void waitForSignal(DirectLookRing* ring, uint32_t published, unsigned int timeoutMs)
+{
+	/* the event of frame published + 1 was reset before "published" was written,
+	so it stays reset until that frame (or the end of the writer) is signalled */
+	const HANDLE event = ring->events[(published + 1) & 1];
+	if(event)
+	{
+		WaitForSingleObject(event, timeoutMs);
+	}
+	else
+	{
+		Sleep(timeoutMs < 1 ? timeoutMs : 1);
+	}
+}
+
+static unsigned long long milliseconds(void)
+{
+	return (unsigned long long) GetTickCount();
+}
+
+#else
+
+DirectLookRing* dlRingOpen(const char* name)
+{
+	char shmName[DL_RING_NAME_SIZE + 32];
+	DirectLookRing* ring;
+	struct stat info;
+	void* address;
+	int fd;
+
+	snprintf(shmName, sizeof(shmName), "/directlook_%s", name);
+
+	fd = shm_open(shmName, O_RDONLY, 0);
+	if(fd < 0)
+	{
+		return 0;
+	}
+	if(fstat(fd, &info) != 0 || info.st_size < (off_t) sizeof(DirectLookRingHeader))
+	{
+		close(fd);
+		return 0;
+	}
+
+	/* the mapping stays valid after the descriptor is closed and after the writer has unlinked the name */
+	address = mmap(0, (size_t) info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if(address == MAP_FAILED)
+	{
+		return 0;
+	}
+
+	ring = (DirectLookRing*) calloc(1, sizeof(DirectLookRing));
+	if(!ring)
+	{
+		munmap(address, (size_t) info.st_size);
+		return 0;
+	}
+	ring->header = (const DirectLookRingHeader*) address;
+	ring->size = (size_t) info.st_size;
+	if(!checkHeader(ring->header, ring->size))
+	{
+		dlRingClose(ring);
+		return 0;
+	}
+	return ring;
+}
+
+void dlRingClose(DirectLookRing* ring)
+{
+	if(!ring)
+	{
+		return;
+	}
+	if(ring->header)
+	{
+		munmap((void*) ring->header, ring->size);
+	}
+	free(ring);
+}
+
+/*
+*	sleeps until the writer changes the futex word "published", at most timeoutMs
+*/
+static void waitForSignal(DirectLookRing* ring, uint32_t published, unsigned int timeoutMs)
+{
+	struct timespec timeout;
+	timeout.tv_sec = timeoutMs / 1000;
+	timeout.tv_nsec = (long) (timeoutMs % 1000) * 1000000L;
+
+	/* returns right away with EAGAIN if the word isn't "published" anymore, so no wakeup is lost */
+	syscall(SYS_futex, &ring->header->published, FUTEX_WAIT, published, &timeout, 0, 0);
+}
+
+static unsigned long long milliseconds(void)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (unsigned long long) now.tv_sec * 1000ULL + (unsigned long long) now.tv_nsec / 1000000ULL;
+}
+
+#endif
+
+const DirectLookRingHeader* dlRingGetHeader(const DirectLookRing* ring)
+{
+	return ring ? ring->header : 0;
+}
+
+int dlRingWait(DirectLookRing* ring, uint64_t lastFrame, unsigned int timeoutMs)
+{
+	const unsigned long long start = milliseconds();
+	const uint32_t last = (uint32_t) lastFrame;
+
+	for(;;)
+	{
+		const uint32_t published = ring->header->published;
+		unsigned long long elapsed;
+
+		if(published != last)
+		{
+			return DL_RING_NEW_FRAME;
+		}
+		if(ring->header->writerState != DL_RING_WRITER_OPEN)
+		{
+			return DL_RING_CLOSED;
+		}
+
+		elapsed = milliseconds() - start;
+		if(elapsed >= timeoutMs)
+		{
+			return DL_RING_TIMEOUT;
+		}
+		waitForSignal(ring, published, timeoutMs - (unsigned int) elapsed);
+	}
+}
+
+int dlRingAcquire(const DirectLookRing* ring, DirectLookRingFrame* frame)
+{
+	const DirectLookRingHeader* header = ring->header;
+	const uint32_t slot = header->latest;
+	const DirectLookRingSlot* pSlot;
+	uint32_t sequence;
+
+	if(slot >= header->slotCount)
+	{
+		return 0;
+	}
+	pSlot = &header->slots[slot];
+
+	/* an odd sequence means the writer has wrapped around and fills this slot again */
+	sequence = pSlot->sequence;
+	DL_RING_BARRIER();
+	if((sequence & 1u) != 0 || pSlot->frame == 0)
+	{
+		return 0;
+	}
+
+	frame->pixels = (const unsigned char*) header + pSlot->offset;
+	frame->width = header->width;
+	frame->height = header->height;
+	frame->stride = header->stride;
+	frame->format = header->format;
+	frame->flags = header->flags;
+	frame->slot = slot;
+	frame->sequence = sequence;
+	frame->frame = pSlot->frame;
+	frame->timestamp = pSlot->timestamp;
+	return dlRingValidate(ring, frame);
+}
+
+int dlRingValidate(const DirectLookRing* ring, const DirectLookRingFrame* frame)
+{
+	DL_RING_BARRIER();
+	return ring->header->slots[frame->slot].sequence == frame->sequence;
+}
@@ -0,0 +1,152 @@
+/*
+*	DirectLookRing - shared memory ring of the corrected DirectLook frames
+*
+*	DirectLook (F9 in the viewer) and DirectLookBatch (--share <name>) publish every frame they read back
+*	into a named shared memory block. Any number of local processes can map it and read the pixels in place,
+*	nothing is copied and no socket is involved. This header describes the layout of the block and a small
+*	C client to read it, it is plain C so other programs can compile DirectLookRing.c into their own build.
+*
+*	Layout: one DirectLookRingHeader followed by slotCount slots of slotSize bytes each. The writer fills the
+*	slots round robin. Every slot is guarded by a sequence lock: its sequence is odd while the writer fills
+*	it and even when it is complete. A reader takes the latest slot, reads the pixels and checks afterwards
+*	with dlRingValidate() that the writer didn't start on that slot meanwhile. With the default of four
+*	slots a reader has three frame times for that.
+*
+*	Signalling: Linux waits on the futex of DirectLookRingHeader::published. Windows has two manual reset
+*	events, one for even and one for odd frame numbers; a reader that has frame n waits on the event of n + 1,
+*	which the writer resets before it publishes frame n. Both are only hints, dlRingWait() always compares
+*	the frame counter itself.
+*
+*	Names: "/directlook_<name>" (POSIX shared memory), "Local\directlook_<name>" (Windows file mapping)
+*	and "Local\directlook_<name>_frame0" / "_frame1" (Windows events).
+*/
+#ifndef DIRECTLOOK_RING_H
+#define DIRECTLOOK_RING_H
+
+#include <stdint.h>
+
+/* outside of extern "C", windows.h declares C++ overloads when it is compiled as C++ */
+#if defined(_MSC_VER)
+	#include <windows.h>
+#endif
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define DL_RING_MAGIC		0x474E5244u		/* "DRNG" */
+#define DL_RING_VERSION		1
+#define DL_RING_MAX_SLOTS	16
+#define DL_RING_NAME_SIZE	64				/* including the terminating zero */
+
+/* pixel formats */
+#define DL_RING_FORMAT_RGB24	1			/* 3 bytes per pixel: R, G, B */
+#define DL_RING_FORMAT_BGR24	2			/* 3 bytes per pixel: B, G, R */
+
+/* header flags */
+#define DL_RING_FLAG_BOTTOM_UP	0x1u		/* the first row is the bottom row of the image (OpenGL) */
+
+/* writer states */
+#define DL_RING_WRITER_CLOSED	0
+#define DL_RING_WRITER_OPEN		1
+
+/* full memory barrier, orders the pixel writes against the sequence numbers */
+#if defined(_MSC_VER)
+	#define DL_RING_BARRIER() MemoryBarrier()
+#else
+	#define DL_RING_BARRIER() __sync_synchronize()
+#endif
+
+/*
+*	one slot of the ring. offset and size never change while the writer is open
+*/
+typedef struct DirectLookRingSlot
+{
+	volatile uint32_t sequence;			/* sequence lock: odd while the writer fills the slot */
+	uint32_t reserved;
+	uint64_t frame;						/* frames published up to and including this one (1 = first frame) */
+	uint64_t timestamp;					/* time of the readback in microseconds, writer clock */
+	uint64_t offset;					/* distance of the pixels from the start of the block in bytes */
+} DirectLookRingSlot;
+
+/*
+*	start of the shared memory block
+*/
+typedef struct DirectLookRingHeader
+{
+	uint32_t magic;						/* DL_RING_MAGIC, written last when the writer creates the block */
+	uint32_t version;					/* DL_RING_VERSION */
+	uint32_t headerSize;				/* sizeof(DirectLookRingHeader) of the writer */
+	uint32_t format;					/* DL_RING_FORMAT_* */
+	uint32_t flags;						/* DL_RING_FLAG_* */
+	uint32_t width;						/* pixels */
+	uint32_t height;					/* pixels */
+	uint32_t stride;					/* bytes per row, rows are packed */
+	uint32_t slotCount;					/* number of slots, at most DL_RING_MAX_SLOTS */
+	uint32_t slotSize;					/* bytes per slot */
+	volatile uint32_t published;		/* low 32 bits of the frame counter of the newest slot, futex word */
+	volatile uint32_t latest;			/* index of the newest slot */
+	volatile uint32_t writerState;		/* DL_RING_WRITER_* */
+	uint32_t writerPid;					/* process id of the writer, a new writer only replaces the ring once it has exited */
+	uint64_t totalSize;					/* size of the whole block in bytes */
+	DirectLookRingSlot slots[DL_RING_MAX_SLOTS];
+} DirectLookRingHeader;
+
+/*
+*	a frame handed out by dlRingAcquire. pixels point into the shared memory block
+*/
+typedef struct DirectLookRingFrame
+{
+	const unsigned char* pixels;
+	uint32_t width;
+	uint32_t height;
+	uint32_t stride;
+	uint32_t format;
+	uint32_t flags;
+	uint32_t slot;
+	uint32_t sequence;					/* sequence of the slot when it was acquired */
+	uint64_t frame;						/* frame counter, see DirectLookRingSlot::frame */
+	uint64_t timestamp;
+} DirectLookRingFrame;
+
+typedef struct DirectLookRing DirectLookRing;
+
+/* return values of dlRingWait */
+#define DL_RING_NEW_FRAME	1
+#define DL_RING_TIMEOUT		0
+#define DL_RING_CLOSED		(-1)
+
+/*
+*	maps the ring "name" read only. returns 0 if there is no such ring or its layout doesn't match
+*/
+DirectLookRing* dlRingOpen(const char* name);
+/*
+*	unmaps the ring, frames acquired from it become invalid
+*/
+void dlRingClose(DirectLookRing* ring);
+/*
+*	header of the ring (format, size, slots)
+*/
+const DirectLookRingHeader* dlRingGetHeader(const DirectLookRing* ring);
+/*
+*	waits until a frame newer than "lastFrame" (0 = none yet) has been published.
+*	returns DL_RING_NEW_FRAME, DL_RING_TIMEOUT or DL_RING_CLOSED if the writer has closed the ring
+*/
+int dlRingWait(DirectLookRing* ring, uint64_t lastFrame, unsigned int timeoutMs);
+/*
+*	takes the newest complete frame without copying it. returns 0 if there is none yet
+*	or the writer is just filling that slot (try again)
+*/
+int dlRingAcquire(const DirectLookRing* ring, DirectLookRingFrame* frame);
+/*
+*	returns 1 if the pixels of "frame" are still the ones that were acquired, 0 if the writer has started
+*	to overwrite the slot. call it after reading (or copying) the pixels and drop the result if it fails
+*/
+int dlRingValidate(const DirectLookRing* ring, const DirectLookRingFrame* frame);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
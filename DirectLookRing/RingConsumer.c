@@ -0,0 +1,137 @@
+/*
+*	RingConsumer - sample reader of a DirectLook frame ring
+*
+*	Usage: RingConsumer <name> [seconds] [snapshot.ppm]
+*
+*	Waits for the frames DirectLook publishes under <name>, reads every frame in place (it only sums the
+*	pixels) and prints once per second how many frames arrived, how many it missed because it was too
+*	slow and how many were overwritten while it was reading. Optionally the first frame is saved as PPM.
+*/
+#include "DirectLookRing.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/*
+*	saves a frame as binary PPM, rows from top to bottom
+*/
+static int writeSnapshot(const char* fileName, const DirectLookRingFrame* frame)
+{
+	FILE* file = fopen(fileName, "wb");
+	uint32_t y;
+
+	if(!file)
+	{
+		return 0;
+	}
+	fprintf(file, "P6\n%u %u\n255\n", frame->width, frame->height);
+	for(y = 0; y < frame->height; y++)
+	{
+		const uint32_t row = (frame->flags & DL_RING_FLAG_BOTTOM_UP) ? frame->height - 1 - y : y;
+		const unsigned char* pixels = frame->pixels + (size_t) row * frame->stride;
+
+		if(frame->format == DL_RING_FORMAT_BGR24)
+		{
+			uint32_t x;
+			unsigned char rgb[3];
+			for(x = 0; x < frame->width; x++)
+			{
+				rgb[0] = pixels[3 * x + 2];
+				rgb[1] = pixels[3 * x + 1];
+				rgb[2] = pixels[3 * x];
+				fwrite(rgb, 1, 3, file);
+			}
+		}
+		else
+		{
+			fwrite(pixels, 1, (size_t) frame->width * 3, file);
+		}
+	}
+	fclose(file);
+	return 1;
+}
+
+int main(int argc, char** argv)
+{
+	DirectLookRing* ring;
+	const DirectLookRingHeader* header;
+	DirectLookRingFrame frame;
+	const char* snapshot = argc > 3 ? argv[3] : 0;
+	const int seconds = argc > 2 ? atoi(argv[2]) : 0;
+	const time_t start = time(0);
+	time_t report = start;
+	uint64_t lastFrame = 0;
+	unsigned long received = 0, missed = 0, torn = 0;
+	unsigned long long checksum = 0;
+
+	if(argc < 2)
+	{
+		printf("Usage: RingConsumer <name> [seconds] [snapshot.ppm]\n");
+		return 1;
+	}
+
+	ring = dlRingOpen(argv[1]);
+	if(!ring)
+	{
+		fprintf(stderr, "No DirectLook ring named %s\n", argv[1]);
+		return 1;
+	}
+	header = dlRingGetHeader(ring);
+	printf("%s: %ux%u, %s, %u slots\n", argv[1], header->width, header->height,
+		header->format == DL_RING_FORMAT_BGR24 ? "BGR24" : "RGB24", header->slotCount);
+
+	while(seconds == 0 || time(0) - start < seconds)
+	{
+		const int result = dlRingWait(ring, lastFrame, 1000);
+		if(result == DL_RING_CLOSED)
+		{
+			printf("Writer closed the ring\n");
+			break;
+		}
+
+		if(result == DL_RING_NEW_FRAME && dlRingAcquire(ring, &frame))
+		{
+			size_t i;
+			const size_t size = (size_t) frame.stride * frame.height;
+			unsigned long long sum = 0;
+
+			/* the pixels are read straight from the shared memory */
+			for(i = 0; i < size; i += 64)
+			{
+				sum += frame.pixels[i];
+			}
+
+			if(!dlRingValidate(ring, &frame))
+			{
+				torn++;
+			}
+			else
+			{
+				if(lastFrame != 0 && frame.frame > lastFrame + 1)
+				{
+					missed += (unsigned long) (frame.frame - lastFrame - 1);
+				}
+				if(snapshot && writeSnapshot(snapshot, &frame))
+				{
+					printf("Saved frame %llu as %s\n", (unsigned long long) frame.frame, snapshot);
+					snapshot = 0;
+				}
+				checksum += sum;
+				received++;
+			}
+			lastFrame = frame.frame;
+		}
+
+		if(time(0) != report)
+		{
+			report = time(0);
+			printf("frame %llu: %lu received, %lu missed, %lu torn\n", (unsigned long long) lastFrame, received, missed, torn);
+		}
+	}
+
+	printf("%lu frames received, %lu missed, %lu torn (checksum %llu)\n", received, missed, torn, checksum);
+	dlRingClose(ring);
+	return 0;
+}
@@ -0,0 +1,32 @@
+#version 120 
+
+uniform sampler2D textureY;
+uniform sampler2D textureU;
+uniform sampler2D textureV;
+uniform float fullRange;		// 1.0 = luma and chroma use 0-255 (JPEG), 0.0 = 16-235 / 16-240 (video)
+
+varying vec2 texcoord;
+
+void main() 
+{	
+	float y = texture2D( textureY, texcoord ).r;
+	float u = texture2D( textureU, texcoord ).r - 0.5;
+	float v = texture2D( textureV, texcoord ).r - 0.5;
+
+	// ITU-R BT.601
+	vec3 rgb;
+	if(fullRange > 0.5)
+	{
+		rgb = vec3( y + 1.402 * v,
+		            y - 0.344 * u - 0.714 * v,
+		            y + 1.772 * u );
+	}
+	else
+	{
+		y = 1.164 * (y - 16.0 / 255.0);
+		rgb = vec3( y + 1.596 * v,
+		            y - 0.391 * u - 0.813 * v,
+		            y + 2.018 * u );
+	}
+	gl_FragColor = vec4( clamp( rgb, 0.0, 1.0 ), 1.0 );
+}
@@ -14,6 +14,7 @@ uniform float cameraWidth;		// Camera texture width
 uniform float cameraHeight;		// Camera texture height
 uniform float depthWidth;		// Depth texture width
 uniform float depthHeight;		// Depth texture height
+uniform float pointSize;		// Splat size in pixels, only used when drawing points
 
 attribute vec3 position;		// Vertex buffer values
 
@@ -44,18 +45,23 @@ void main()
 	// Transform GLScene to opject space
 	float z = depthValue - ((farThreshold - nearThreshold) / 2.0f) - nearThreshold;
 
+	vec4 clipPosition;
 	if(depthValue < farThreshold)
 	{
 		// Transform GLScene to screen space with world matrix
-		gl_Position = normalize( matVP * matW * vec4( position.x, position.y, -z, 1.0 ) );
+		clipPosition = matVP * matW * vec4( position.x, position.y, -z, 1.0 );
 		isBackground = 0.0f;
 	}
 	else
 	{
 		// Transform GLScene to screen space without world matrix
-		gl_Position = normalize( matVP * vec4( position.x, position.y, -z, 1.0 ) );
+		clipPosition = matVP * vec4( position.x, position.y, -z, 1.0 );
 		isBackground = 1;
 	}
+	gl_Position = normalize( clipPosition );
+
+	// GLCamera projects orthographically, so the grid spacing covers the same pixels at every depth
+	gl_PointSize = max( pointSize, 1.0 );
 	
 	// Background enable or disable
 	if(backgroundPlane == 1)
@@ -0,0 +1,12 @@
+#version 120
+
+attribute vec2 position;
+
+varying vec2 texcoord;
+
+void main()
+{
+	// Full-screen quad of GLScene::drawBackgroundVideo, the first row of the video is at the top
+	gl_Position = vec4( position.x, position.y, -1.0, 1.0 );
+	texcoord = vec2( position.x, -position.y ) * vec2( 0.5 ) + vec2( 0.5 );
+}